@@ -0,0 +1,431 @@
+#include "Benchmark.h"
+
+#include "CameraPath.h"
+#include "GpuProfiler.h"
+#include "LogUtility.h"
+#include "Profiler.h"
+#include "RenderMate.h"
+#include "TextureDecoder.h"
+#include "TexturePool.h"
+#include "UploadRing.h"
+#include "VirtualTextureSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace
+{
+    struct GpuZoneAccumulator
+    {
+        double myTotalMilliseconds = 0.0;
+        int mySampleCount = 0;
+    };
+
+    double GetPercentile(const std::vector<double>& someSortedValues, double aPercentile)
+    {
+        if (someSortedValues.empty())
+            return 0.0;
+
+        // Nearest-rank, so every reported value is a frame time that was actually measured
+        const std::size_t rank = static_cast<std::size_t>(aPercentile / 100.0 * static_cast<double>(someSortedValues.size()) + 0.5);
+        return someSortedValues[std::min(std::max<std::size_t>(rank, 1), someSortedValues.size()) - 1];
+    }
+
+    // Model paths and zone names are arbitrary text, so a Windows path or a quote must not break the report
+    void WriteEscapedString(std::FILE* aFile, const char* aString)
+    {
+        std::fputc('"', aFile);
+        for (const char* character = aString; *character; ++character)
+        {
+            const unsigned char value = static_cast<unsigned char>(*character);
+            if (value == '"' || value == '\\')
+                std::fprintf(aFile, "\\%c", value);
+            else if (value < 0x20)
+                std::fprintf(aFile, "\\u%04x", value);
+            else
+                std::fputc(value, aFile);
+        }
+
+        std::fputc('"', aFile);
+    }
+}
+
+double BenchmarkTimer::GetMilliseconds(Clock::time_point aStartTime, Clock::time_point anEndTime)
+{
+    return std::chrono::duration<double, std::milli>(anEndTime - aStartTime).count();
+}
+
+BenchmarkReportWriter::BenchmarkReportWriter(const std::string& aFilepath)
+    : myFilepath(aFilepath)
+    , myFile(std::fopen(aFilepath.c_str(), "w"))
+    , myIsFirstField(true)
+{
+    if (!myFile)
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::File, "Failed to open %s for writing", myFilepath.c_str());
+        return;
+    }
+
+    std::fprintf(myFile, "{");
+}
+
+BenchmarkReportWriter::~BenchmarkReportWriter()
+{
+    if (myFile)
+        std::fclose(myFile);
+}
+
+void BenchmarkReportWriter::WriteInteger(const char* aKey, std::uintmax_t aValue)
+{
+    BeginField(aKey);
+    std::fprintf(myFile, "%ju", aValue);
+}
+
+void BenchmarkReportWriter::WriteNumber(const char* aKey, double aValue, int aPrecision)
+{
+    BeginField(aKey);
+    std::fprintf(myFile, "%.*f", aPrecision, aValue);
+}
+
+bool BenchmarkReportWriter::Close()
+{
+    if (!myFile)
+        return false;
+
+    std::fprintf(myFile, "\n}\n");
+    const bool isWritten = !std::ferror(myFile);
+    const bool isClosed = std::fclose(myFile) == 0;
+    myFile = nullptr;
+
+    if (!isWritten || !isClosed)
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::File, "Failed to write %s", myFilepath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void BenchmarkReportWriter::BeginField(const char* aKey)
+{
+    std::fprintf(myFile, "%s\n  ", myIsFirstField ? "" : ",");
+    WriteEscapedString(myFile, aKey);
+    std::fprintf(myFile, ": ");
+    myIsFirstField = false;
+}
+
+BenchmarkSettings::BenchmarkSettings()
+    : myReportFilepath("BenchmarkReport.json")
+    , myMeasuredFrameCount(600)
+    , myWarmupFrameCount(60)
+    , myCullingBoxCount(0)
+    , myBvhItemCount(0)
+    , myMeshOptimizerSegmentCount(0)
+    , myTextureCompressorSize(0)
+    , myTexturePoolTextureCount(0)
+    , myVirtualTextureSize(0)
+    , myVertexWeldIndexCount(0)
+{
+    // Benchmarks always run headless unless told otherwise, so window size and vsync cannot skew them
+    myAppSettings.myIsHeadless = true;
+}
+
+bool BenchmarkSettings::ParseCommandLine(int anArgumentCount, char** someArguments)
+{
+    std::vector<char*> appArguments;
+    appArguments.push_back(someArguments[0]);
+
+    for (int i = 1; i < anArgumentCount; ++i)
+    {
+        const char* argument = someArguments[i];
+        const bool hasValue = i + 1 < anArgumentCount;
+        if (std::strcmp(argument, "--frames") == 0 && hasValue)
+        {
+            myMeasuredFrameCount = std::atoi(someArguments[++i]);
+        }
+        else if (std::strcmp(argument, "--warmup") == 0 && hasValue)
+        {
+            myWarmupFrameCount = std::atoi(someArguments[++i]);
+        }
+        else if (std::strcmp(argument, "--camera-path") == 0 && hasValue)
+        {
+            myCameraPathFilepath = someArguments[++i];
+        }
+        else if (std::strcmp(argument, "--report") == 0 && hasValue)
+        {
+            myReportFilepath = someArguments[++i];
+        }
+        else if (std::strcmp(argument, "--culling") == 0 && hasValue)
+        {
+            myCullingBoxCount = std::atoi(someArguments[++i]);
+        }
+        else if (std::strcmp(argument, "--bvh") == 0 && hasValue)
+        {
+            myBvhItemCount = std::atoi(someArguments[++i]);
+        }
+        else if (std::strcmp(argument, "--mesh-optimizer") == 0 && hasValue)
+        {
+            myMeshOptimizerSegmentCount = std::atoi(someArguments[++i]);
+        }
+        else if (std::strcmp(argument, "--texture-compressor") == 0 && hasValue)
+        {
+            myTextureCompressorSize = std::atoi(someArguments[++i]);
+        }
+        else if (std::strcmp(argument, "--texture-pool") == 0 && hasValue)
+        {
+            myTexturePoolTextureCount = std::atoi(someArguments[++i]);
+        }
+        else if (std::strcmp(argument, "--virtual-texture") == 0 && hasValue)
+        {
+            myVirtualTextureSize = std::atoi(someArguments[++i]);
+        }
+        else if (std::strcmp(argument, "--vertex-weld") == 0 && hasValue)
+        {
+            myVertexWeldIndexCount = std::atoi(someArguments[++i]);
+        }
+        else if (std::strcmp(argument, "--windowed") == 0)
+        {
+            myAppSettings.myIsHeadless = false;
+        }
+        else
+        {
+            appArguments.push_back(someArguments[i]);
+        }
+    }
+
+    if (!myAppSettings.ParseCommandLine(static_cast<int>(appArguments.size()), appArguments.data()))
+    {
+        LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Benchmark usage: [--frames count] [--warmup count] [--camera-path filepath] [--report filepath] [--culling boxCount] [--bvh itemCount] [--mesh-optimizer segmentCount] [--texture-compressor size] [--texture-pool textureCount] [--virtual-texture size] [--vertex-weld indexCount] [--windowed]");
+        return false;
+    }
+
+    if (myMeasuredFrameCount <= 0)
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::Core, "The benchmark needs at least one measured frame");
+        return false;
+    }
+
+    // Camera playback is driven by frame index, so the timestep has to be fixed even when windowed
+    if (myAppSettings.myFixedTimestep <= 0.0f)
+        myAppSettings.myFixedTimestep = 1.0f / 60.0f;
+
+    myWarmupFrameCount = std::max(myWarmupFrameCount, 0);
+    myAppSettings.myFrameCount = myWarmupFrameCount + myMeasuredFrameCount;
+    return true;
+}
+
+Benchmark::Benchmark(const BenchmarkSettings& someSettings)
+    : mySettings(someSettings)
+{
+}
+
+bool Benchmark::Run()
+{
+    Profiler::SetThreadName("Main");
+
+    const AppSettings& appSettings = mySettings.myAppSettings;
+    const float timestep = appSettings.myFixedTimestep;
+
+    CameraPath cameraPath;
+    if (mySettings.myCameraPathFilepath.empty())
+        cameraPath.CreateOrbit(4.0f, 2.0f, static_cast<float>(mySettings.myMeasuredFrameCount) * timestep);
+    else if (!cameraPath.Load(mySettings.myCameraPathFilepath))
+        return false;
+
+    RenderMate renderMate;
+    renderMate.Initialize(appSettings);
+
+    std::vector<double> frameMilliseconds;
+    std::vector<double> cpuMilliseconds;
+    frameMilliseconds.reserve(mySettings.myMeasuredFrameCount);
+    cpuMilliseconds.reserve(mySettings.myMeasuredFrameCount);
+    std::map<std::string, GpuZoneAccumulator> gpuZones;
+    std::size_t totalDrawCalls = 0;
+    std::size_t totalDrawCommands = 0;
+    std::size_t totalVisibleInstances = 0;
+    std::size_t totalCulledInstances = 0;
+    std::size_t totalOccluders = 0;
+    std::size_t totalClusters = 0;
+    std::size_t totalTriangles = 0;
+    std::size_t totalFrameUploadBytes = 0;
+    std::size_t totalFrameUploadStalls = 0;
+    std::size_t totalVirtualTileRequests = 0;
+    std::size_t totalVirtualTileLoads = 0;
+
+    LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Benchmarking %i frames after %i warmup frames", mySettings.myMeasuredFrameCount, mySettings.myWarmupFrameCount);
+
+    for (int frameIndex = 0; frameIndex < appSettings.myFrameCount && !renderMate.ShouldClose(); ++frameIndex)
+    {
+        // Warmup frames fly the first part of the path as well, so the measured frames start from a warm state at time zero
+        const int pathFrameIndex = std::max(frameIndex - mySettings.myWarmupFrameCount, 0);
+        cameraPath.Apply(static_cast<float>(pathFrameIndex) * timestep, renderMate.GetCamera());
+
+        const auto frameStartTime = std::chrono::steady_clock::now();
+        renderMate.Update(timestep);
+        const auto submitEndTime = std::chrono::steady_clock::now();
+        renderMate.WaitForGpu();
+        const auto frameEndTime = std::chrono::steady_clock::now();
+
+        if (frameIndex < mySettings.myWarmupFrameCount)
+            continue;
+
+        frameMilliseconds.push_back(std::chrono::duration<double, std::milli>(frameEndTime - frameStartTime).count());
+        cpuMilliseconds.push_back(std::chrono::duration<double, std::milli>(submitEndTime - frameStartTime).count());
+
+        const RenderStatistics& statistics = renderMate.GetStatistics();
+        totalDrawCalls += static_cast<std::size_t>(statistics.myDrawCalls);
+        totalDrawCommands += static_cast<std::size_t>(statistics.myDrawCommands);
+        totalVisibleInstances += statistics.myVisibleInstances;
+        totalCulledInstances += statistics.myCulledInstances;
+        totalOccluders += statistics.myOccluders;
+        totalClusters += statistics.myClusters;
+        totalTriangles += statistics.myTriangles;
+        totalFrameUploadBytes += statistics.myUploadBytes;
+        totalFrameUploadStalls += statistics.myUploadStalls;
+        totalVirtualTileRequests += statistics.myVirtualTileRequests;
+        totalVirtualTileLoads += statistics.myVirtualTileLoads;
+
+        for (const GpuZoneResult& zoneResult : renderMate.GetGpuProfiler().GetLatestResults())
+        {
+            GpuZoneAccumulator& accumulator = gpuZones[zoneResult.myName];
+            accumulator.myTotalMilliseconds += zoneResult.myMilliseconds;
+            ++accumulator.mySampleCount;
+        }
+    }
+
+    const std::size_t totalUploadBytes = renderMate.GetTotalUploadedBytes();
+    std::vector<TextureDecodeStatistics> textureDecodeStatistics = renderMate.GetTextureDecoder().GetStatistics();
+    std::sort(textureDecodeStatistics.begin(), textureDecodeStatistics.end(), [](const TextureDecodeStatistics& aLeft, const TextureDecodeStatistics& aRight) { return aLeft.myWorkerIndex < aRight.myWorkerIndex; });
+    const std::size_t textureDecodePeakBytes = renderMate.GetTextureDecoder().GetPeakReservedBytes();
+    const TexturePool& texturePool = renderMate.GetTexturePool();
+    const std::size_t residentTextureCount = texturePool.GetTextureCount();
+    const std::size_t residentTextureBytes = texturePool.GetResidentBytes();
+    const std::size_t evictedTextureCount = texturePool.GetEvictedCount();
+    const UploadRingStatistics uploadRingStatistics = renderMate.GetUploadRingStatistics();
+    const VirtualTextureSystem* virtualTextureSystem = renderMate.GetVirtualTextureSystem();
+    const std::size_t virtualTextureCount = virtualTextureSystem ? virtualTextureSystem->GetTextureCount() : 0;
+    const std::size_t virtualTextureBytes = virtualTextureSystem ? virtualTextureSystem->GetMemoryBytes() : 0;
+    const std::size_t residentVirtualTileCount = virtualTextureSystem ? virtualTextureSystem->GetCache().GetResidentCount() : 0;
+    const std::size_t virtualTileLoadCount = virtualTextureSystem ? virtualTextureSystem->GetCache().GetLoadCount() : 0;
+    const std::size_t evictedVirtualTileCount = virtualTextureSystem ? virtualTextureSystem->GetCache().GetEvictedCount() : 0;
+    renderMate.Destroy();
+
+    if (frameMilliseconds.empty())
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::Core, "No frames were measured");
+        return false;
+    }
+
+    std::vector<double> sortedMilliseconds = frameMilliseconds;
+    std::sort(sortedMilliseconds.begin(), sortedMilliseconds.end());
+    std::vector<double> sortedCpuMilliseconds = cpuMilliseconds;
+    std::sort(sortedCpuMilliseconds.begin(), sortedCpuMilliseconds.end());
+
+    double totalMilliseconds = 0.0;
+    for (const double milliseconds : frameMilliseconds)
+        totalMilliseconds += milliseconds;
+
+    double totalCpuMilliseconds = 0.0;
+    for (const double milliseconds : cpuMilliseconds)
+        totalCpuMilliseconds += milliseconds;
+
+    const double frameCount = static_cast<double>(frameMilliseconds.size());
+    const double averageMilliseconds = totalMilliseconds / frameCount;
+
+    std::FILE* file = std::fopen(mySettings.myReportFilepath.c_str(), "w");
+    if (!file)
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::File, "Failed to open %s for writing", mySettings.myReportFilepath.c_str());
+        return false;
+    }
+
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "  \"frames\": %zu,\n", frameMilliseconds.size());
+    std::fprintf(file, "  \"warmupFrames\": %i,\n", mySettings.myWarmupFrameCount);
+    std::fprintf(file, "  \"timestep\": %f,\n", static_cast<double>(timestep));
+    std::fprintf(file, "  \"headless\": %s,\n", appSettings.myIsHeadless ? "true" : "false");
+    std::fprintf(file, "  \"instancing\": %s,\n", appSettings.myIsInstancingEnabled ? "true" : "false");
+    std::fprintf(file, "  \"multiDraw\": %s,\n", appSettings.myIsMultiDrawEnabled ? "true" : "false");
+    std::fprintf(file, "  \"occlusionCulling\": %s,\n", appSettings.myIsOcclusionCullingEnabled ? "true" : "false");
+    std::fprintf(file, "  \"lod\": %s,\n", appSettings.myIsLodEnabled ? "true" : "false");
+    std::fprintf(file, "  \"clusterCulling\": %s,\n", appSettings.myIsClusterCullingEnabled ? "true" : "false");
+    std::fprintf(file, "  \"textureCompression\": %s,\n", appSettings.myIsTextureCompressionEnabled ? "true" : "false");
+    std::fprintf(file, "  \"virtualTexturing\": %s,\n", appSettings.myIsVirtualTexturingEnabled ? "true" : "false");
+    std::fprintf(file, "  \"instancesPerModel\": %i,\n", appSettings.myInstanceCount);
+    std::fprintf(file, "  \"models\": [");
+    for (std::size_t i = 0; i < appSettings.myModelFilepaths.size(); ++i)
+    {
+        std::fprintf(file, "%s", i > 0 ? ", " : "");
+        WriteEscapedString(file, appSettings.myModelFilepaths[i].c_str());
+    }
+    std::fprintf(file, "],\n");
+    std::fprintf(file, "  \"frameTimeMs\": {\n");
+    std::fprintf(file, "    \"min\": %.4f,\n", sortedMilliseconds.front());
+    std::fprintf(file, "    \"avg\": %.4f,\n", averageMilliseconds);
+    std::fprintf(file, "    \"p50\": %.4f,\n", GetPercentile(sortedMilliseconds, 50.0));
+    std::fprintf(file, "    \"p95\": %.4f,\n", GetPercentile(sortedMilliseconds, 95.0));
+    std::fprintf(file, "    \"p99\": %.4f,\n", GetPercentile(sortedMilliseconds, 99.0));
+    std::fprintf(file, "    \"max\": %.4f\n", sortedMilliseconds.back());
+    std::fprintf(file, "  },\n");
+    std::fprintf(file, "  \"cpuSubmitTimeMs\": {\n");
+    std::fprintf(file, "    \"avg\": %.4f,\n", totalCpuMilliseconds / frameCount);
+    std::fprintf(file, "    \"p50\": %.4f,\n", GetPercentile(sortedCpuMilliseconds, 50.0));
+    std::fprintf(file, "    \"p95\": %.4f\n", GetPercentile(sortedCpuMilliseconds, 95.0));
+    std::fprintf(file, "  },\n");
+    std::fprintf(file, "  \"drawCallsPerFrame\": %.2f,\n", static_cast<double>(totalDrawCalls) / frameCount);
+    std::fprintf(file, "  \"drawCommandsPerFrame\": %.2f,\n", static_cast<double>(totalDrawCommands) / frameCount);
+    std::fprintf(file, "  \"visibleInstancesPerFrame\": %.2f,\n", static_cast<double>(totalVisibleInstances) / frameCount);
+    std::fprintf(file, "  \"culledInstancesPerFrame\": %.2f,\n", static_cast<double>(totalCulledInstances) / frameCount);
+    std::fprintf(file, "  \"occludersPerFrame\": %.2f,\n", static_cast<double>(totalOccluders) / frameCount);
+    std::fprintf(file, "  \"clustersPerFrame\": %.2f,\n", static_cast<double>(totalClusters) / frameCount);
+    std::fprintf(file, "  \"trianglesPerFrame\": %.2f,\n", static_cast<double>(totalTriangles) / frameCount);
+    std::fprintf(file, "  \"uploadBytesDuringFrames\": %zu,\n", totalFrameUploadBytes);
+    std::fprintf(file, "  \"uploadBytesTotal\": %zu,\n", totalUploadBytes);
+    std::fprintf(file, "  \"uploadBudgetBytes\": %zu,\n", appSettings.myUploadByteBudget);
+    std::fprintf(file, "  \"stagedUploadBytes\": %zu,\n", uploadRingStatistics.myStagedBytes);
+    std::fprintf(file, "  \"directUploadBytes\": %zu,\n", uploadRingStatistics.myDirectBytes);
+    std::fprintf(file, "  \"uploadStalls\": %zu,\n", uploadRingStatistics.myStallCount);
+    std::fprintf(file, "  \"uploadStallsDuringFrames\": %zu,\n", totalFrameUploadStalls);
+    std::fprintf(file, "  \"textureDecodeBudgetBytes\": %zu,\n", appSettings.myTextureDecodeByteBudget);
+    std::fprintf(file, "  \"textureDecodePeakBytes\": %zu,\n", textureDecodePeakBytes);
+    std::fprintf(file, "  \"textureBudgetBytes\": %zu,\n", appSettings.myTextureByteBudget);
+    std::fprintf(file, "  \"residentTextures\": %zu,\n", residentTextureCount);
+    std::fprintf(file, "  \"residentTextureBytes\": %zu,\n", residentTextureBytes);
+    std::fprintf(file, "  \"evictedTextures\": %zu,\n", evictedTextureCount);
+    std::fprintf(file, "  \"virtualTextures\": %zu,\n", virtualTextureCount);
+    std::fprintf(file, "  \"virtualTextureBytes\": %zu,\n", virtualTextureBytes);
+    std::fprintf(file, "  \"residentVirtualTiles\": %zu,\n", residentVirtualTileCount);
+    std::fprintf(file, "  \"virtualTileLoads\": %zu,\n", virtualTileLoadCount);
+    std::fprintf(file, "  \"virtualTileLoadsDuringFrames\": %zu,\n", totalVirtualTileLoads);
+    std::fprintf(file, "  \"virtualTileEvictions\": %zu,\n", evictedVirtualTileCount);
+    std::fprintf(file, "  \"virtualTileRequestsPerFrame\": %.2f,\n", static_cast<double>(totalVirtualTileRequests) / frameCount);
+    std::fprintf(file, "  \"textureDecodeThreads\": [");
+    for (std::size_t i = 0; i < textureDecodeStatistics.size(); ++i)
+    {
+        const TextureDecodeStatistics& threadStatistics = textureDecodeStatistics[i];
+        std::fprintf(file, "%s\n    { \"worker\": %i, \"textures\": %zu, \"bytes\": %zu, \"megabytesPerSecond\": %.2f }", i > 0 ? "," : "",
+            threadStatistics.myWorkerIndex, threadStatistics.myTextureCount, threadStatistics.myDecodedBytes, threadStatistics.GetMegabytesPerSecond());
+    }
+    std::fprintf(file, "%s],\n", textureDecodeStatistics.empty() ? "" : "\n  ");
+    std::fprintf(file, "  \"gpuPassMs\": {");
+    bool isFirstZone = true;
+    for (const auto& [name, accumulator] : gpuZones)
+    {
+        std::fprintf(file, "%s\n    ", isFirstZone ? "" : ",");
+        WriteEscapedString(file, name.c_str());
+        std::fprintf(file, ": %.4f", accumulator.myTotalMilliseconds / accumulator.mySampleCount);
+        isFirstZone = false;
+    }
+    std::fprintf(file, "%s}\n", isFirstZone ? "" : "\n  ");
+    std::fprintf(file, "}\n");
+    std::fclose(file);
+
+    LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Frame time avg %.3f ms, p95 %.3f ms, p99 %.3f ms, report written to %s",
+        averageMilliseconds, GetPercentile(sortedMilliseconds, 95.0), GetPercentile(sortedMilliseconds, 99.0), mySettings.myReportFilepath.c_str());
+    return true;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "AppSettings.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+struct BenchmarkSettings
+{
+    BenchmarkSettings();
+
+    // Consumes the benchmark arguments and forwards everything else to AppSettings
+    bool ParseCommandLine(int anArgumentCount, char** someArguments);
+
+    AppSettings myAppSettings;
+    std::string myCameraPathFilepath;
+    std::string myReportFilepath;
+    int myMeasuredFrameCount;
+    int myWarmupFrameCount;
+    // Runs the CPU-only culling benchmark over this many boxes instead of rendering when positive
+    int myCullingBoxCount;
+    // Runs the CPU-only bounding volume hierarchy benchmark over this many items instead of rendering when positive
+    int myBvhItemCount;
+    // Runs the CPU-only mesh optimizer benchmark over a sphere with this many segments around instead of rendering when positive
+    int myMeshOptimizerSegmentCount;
+    // Runs the CPU-only texture compressor benchmark over a square image this many texels wide instead of rendering when positive
+    int myTextureCompressorSize;
+    // Runs the CPU-only texture pool benchmark over this many textures instead of rendering when positive
+    int myTexturePoolTextureCount;
+    // Runs the CPU-only virtual texture benchmark over a square image this many texels wide instead of rendering when positive
+    int myVirtualTextureSize;
+    // Runs the CPU-only vertex weld benchmark over a grid with about this many indices instead of rendering when positive
+    int myVertexWeldIndexCount;
+};
+
+// Renders a fixed number of frames along a scripted camera path and reports frame time percentiles
+// and render statistics as JSON, so runs on the same machine can be compared against each other.
+// CPU submit time is reported separately from the full frame, which makes draw call overhead visible,
+// for example when comparing "--instances 4096" against "--instances 4096 --no-instancing".
+class Benchmark
+{
+public:
+    explicit Benchmark(const BenchmarkSettings& someSettings);
+
+    // Returns false when the benchmark could not run or the report could not be written
+    bool Run();
+
+private:
+    BenchmarkSettings mySettings;
+};
+
+// Shared by the CPU-only benchmark modes, so they all time their work the same way
+namespace BenchmarkTimer
+{
+    using Clock = std::chrono::steady_clock;
+
+    double GetMilliseconds(Clock::time_point aStartTime, Clock::time_point anEndTime);
+}
+
+// Writes the flat JSON object the CPU-only benchmark modes report, one field per line in the order they are written
+class BenchmarkReportWriter
+{
+public:
+    // Logs an error and leaves the writer closed when the file cannot be opened
+    explicit BenchmarkReportWriter(const std::string& aFilepath);
+    ~BenchmarkReportWriter();
+
+    BenchmarkReportWriter(const BenchmarkReportWriter&) = delete;
+    BenchmarkReportWriter& operator=(const BenchmarkReportWriter&) = delete;
+
+    bool IsOpen() const { return myFile != nullptr; }
+
+    void WriteInteger(const char* aKey, std::uintmax_t aValue);
+    void WriteNumber(const char* aKey, double aValue, int aPrecision = 4);
+
+    // Ends the object and closes the file. Returns false, after logging, when anything could not be written.
+    bool Close();
+
+private:
+    void BeginField(const char* aKey);
+
+    std::string myFilepath;
+    std::FILE* myFile;
+    bool myIsFirstField;
+};
@@ -0,0 +1,182 @@
+#include "BvhBenchmark.h"
+
+#include "Benchmark.h"
+#include "BoundingBox.h"
+#include "BoundingVolumeHierarchy.h"
+#include "CullingBounds.h"
+#include "Frustum.h"
+#include "LogUtility.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using BenchmarkTimer::Clock;
+    using BenchmarkTimer::GetMilliseconds;
+
+    BoundingBox CreateBox(const glm::vec3& aCenter, const glm::vec3& someExtents)
+    {
+        BoundingBox box;
+        box.Grow(aCenter - someExtents);
+        box.Grow(aCenter + someExtents);
+        return box;
+    }
+
+    float GetBruteForceRayDistance(const BoundingBox& aBox, const glm::vec3& anOrigin, const glm::vec3& aDirection)
+    {
+        float entryDistance = 0.0f;
+        float exitDistance = std::numeric_limits<float>::max();
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float near = (aBox.myMin[axis] - anOrigin[axis]) / aDirection[axis];
+            const float far = (aBox.myMax[axis] - anOrigin[axis]) / aDirection[axis];
+            entryDistance = std::max(entryDistance, std::min(near, far));
+            exitDistance = std::min(exitDistance, std::max(near, far));
+        }
+
+        return entryDistance <= exitDistance ? entryDistance : std::numeric_limits<float>::infinity();
+    }
+}
+
+namespace BvhBenchmark
+{
+    bool Run(int anItemCount, int anIterationCount, const std::string& aReportFilepath)
+    {
+        std::mt19937 randomEngine(1234);
+        std::uniform_real_distribution<float> positionDistribution(-200.0f, 200.0f);
+        std::uniform_real_distribution<float> sizeDistribution(0.1f, 2.0f);
+        std::uniform_real_distribution<float> unitDistribution(-1.0f, 1.0f);
+
+        std::vector<BoundingBox> boxes(anItemCount);
+        for (BoundingBox& box : boxes)
+        {
+            const glm::vec3 center(positionDistribution(randomEngine), positionDistribution(randomEngine), positionDistribution(randomEngine));
+            box = CreateBox(center, glm::vec3(sizeDistribution(randomEngine), sizeDistribution(randomEngine), sizeDistribution(randomEngine)));
+        }
+
+        BoundingVolumeHierarchy hierarchy;
+
+        const Clock::time_point serialStartTime = Clock::now();
+        hierarchy.Build(boxes, false);
+        const Clock::time_point serialEndTime = Clock::now();
+        hierarchy.Build(boxes, true);
+        const Clock::time_point parallelEndTime = Clock::now();
+
+        // Move a tenth of the items by a small amount, as animated objects would between frames
+        const Clock::time_point refitStartTime = Clock::now();
+        for (int item = 0; item < anItemCount; item += 10)
+        {
+            const glm::vec3 offset(unitDistribution(randomEngine), unitDistribution(randomEngine), unitDistribution(randomEngine));
+            boxes[item].myMin += offset;
+            boxes[item].myMax += offset;
+            hierarchy.UpdateItem(static_cast<uint32_t>(item), boxes[item]);
+        }
+        hierarchy.Refit();
+        const Clock::time_point refitEndTime = Clock::now();
+
+        CullingBounds cullingBounds;
+        for (const BoundingBox& box : boxes)
+            cullingBounds.Add(box);
+
+        const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 150.0f);
+        std::vector<uint32_t> items;
+        std::vector<unsigned char> visibility;
+        double frustumMilliseconds = 0.0;
+        double linearMilliseconds = 0.0;
+        double raycastMilliseconds = 0.0;
+        double nearestMilliseconds = 0.0;
+
+        for (int iteration = 0; iteration < anIterationCount; ++iteration)
+        {
+            const float angle = static_cast<float>(iteration) / static_cast<float>(anIterationCount) * 6.2831853f;
+            const glm::vec3 eye(std::sin(angle) * 50.0f, 0.0f, std::cos(angle) * 50.0f);
+            const Frustum frustum = Frustum::FromViewProjection(projection * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+
+            items.clear();
+            const Clock::time_point frustumStartTime = Clock::now();
+            hierarchy.QueryFrustum(frustum, items);
+            const Clock::time_point frustumEndTime = Clock::now();
+            cullingBounds.Cull(frustum, visibility);
+            const Clock::time_point linearEndTime = Clock::now();
+            frustumMilliseconds += GetMilliseconds(frustumStartTime, frustumEndTime);
+            linearMilliseconds += GetMilliseconds(frustumEndTime, linearEndTime);
+
+            const std::size_t visibleCount = static_cast<std::size_t>(std::count(visibility.begin(), visibility.end(), static_cast<unsigned char>(1)));
+            bool isMatching = items.size() == visibleCount;
+            for (const uint32_t item : items)
+                isMatching = isMatching && visibility[item] == 1;
+
+            if (!isMatching)
+            {
+                LogUtility::PrintError(LogUtility::LogCategory::Core, "Frustum query returned %zu items, linear culling %zu", items.size(), visibleCount);
+                return false;
+            }
+
+            glm::vec3 direction(unitDistribution(randomEngine), unitDistribution(randomEngine), unitDistribution(randomEngine));
+            if (glm::length(direction) < 0.001f)
+                direction = glm::vec3(0.0f, 0.0f, -1.0f);
+            direction = glm::normalize(direction);
+
+            RaycastHit raycastHit;
+            const Clock::time_point raycastStartTime = Clock::now();
+            const bool isRaycastHit = hierarchy.Raycast(eye, direction, 1000.0f, raycastHit);
+            const Clock::time_point raycastEndTime = Clock::now();
+            raycastMilliseconds += GetMilliseconds(raycastStartTime, raycastEndTime);
+
+            NearestHit nearestHit;
+            const Clock::time_point nearestStartTime = Clock::now();
+            const bool isNearestHit = hierarchy.FindNearest(eye, nearestHit);
+            const Clock::time_point nearestEndTime = Clock::now();
+            nearestMilliseconds += GetMilliseconds(nearestStartTime, nearestEndTime);
+
+            float closestRayDistance = std::numeric_limits<float>::infinity();
+            float closestPointDistance = std::numeric_limits<float>::infinity();
+            for (const BoundingBox& box : boxes)
+            {
+                const float rayDistance = GetBruteForceRayDistance(box, eye, direction);
+                if (rayDistance <= 1000.0f)
+                    closestRayDistance = std::min(closestRayDistance, rayDistance);
+
+                const glm::vec3 offset = glm::max(glm::max(box.myMin - eye, eye - box.myMax), glm::vec3(0.0f));
+                closestPointDistance = std::min(closestPointDistance, glm::length(offset));
+            }
+
+            const bool isRaycastMatching = isRaycastHit ? std::fabs(raycastHit.myDistance - closestRayDistance) <= 1e-3f : std::isinf(closestRayDistance);
+            const bool isNearestMatching = isNearestHit && std::fabs(nearestHit.myDistance - closestPointDistance) <= 1e-3f;
+            if (!isRaycastMatching || !isNearestMatching)
+            {
+                LogUtility::PrintError(LogUtility::LogCategory::Core, "Hierarchy query disagrees with brute force in iteration %i", iteration);
+                return false;
+            }
+        }
+
+        const double iterationCount = std::max(anIterationCount, 1);
+
+        BenchmarkReportWriter report(aReportFilepath);
+        if (!report.IsOpen())
+            return false;
+
+        report.WriteInteger("items", anItemCount);
+        report.WriteInteger("nodes", hierarchy.GetNodeCount());
+        report.WriteInteger("iterations", anIterationCount);
+        report.WriteNumber("buildSerialMs", GetMilliseconds(serialStartTime, serialEndTime));
+        report.WriteNumber("buildParallelMs", GetMilliseconds(serialEndTime, parallelEndTime));
+        report.WriteNumber("refitTenthMs", GetMilliseconds(refitStartTime, refitEndTime));
+        report.WriteNumber("frustumQueryMs", frustumMilliseconds / iterationCount);
+        report.WriteNumber("linearCullMs", linearMilliseconds / iterationCount);
+        report.WriteNumber("raycastUs", raycastMilliseconds * 1000.0 / iterationCount);
+        report.WriteNumber("nearestUs", nearestMilliseconds * 1000.0 / iterationCount);
+        if (!report.Close())
+            return false;
+
+        LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Built a hierarchy over %i items in %.3f ms (serial %.3f ms), report written to %s",
+            anItemCount, GetMilliseconds(serialEndTime, parallelEndTime), GetMilliseconds(serialStartTime, serialEndTime), aReportFilepath.c_str());
+        return true;
+    }
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+// CPU-only benchmark of BoundingVolumeHierarchy that needs no GL context. Builds, refits and queries a random scene,
+// and compares every query against a brute force scan so a run also fails when the hierarchy returns a wrong answer.
+namespace BvhBenchmark
+{
+    bool Run(int anItemCount, int anIterationCount, const std::string& aReportFilepath);
+}
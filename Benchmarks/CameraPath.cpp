@@ -0,0 +1,114 @@
+#include "CameraPath.h"
+
+#include "Camera.h"
+#include "LogUtility.h"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/trigonometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+bool CameraPath::Load(const std::string& aFilepath)
+{
+    std::ifstream fileStream(aFilepath);
+    if (!fileStream.is_open())
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::File, "Failed to open camera path %s", aFilepath.c_str());
+        return false;
+    }
+
+    myKeyframes.clear();
+
+    std::string line;
+    while (std::getline(fileStream, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        Keyframe keyframe;
+        std::istringstream lineStream(line);
+        lineStream >> keyframe.myTime
+            >> keyframe.myPosition.x >> keyframe.myPosition.y >> keyframe.myPosition.z
+            >> keyframe.myTarget.x >> keyframe.myTarget.y >> keyframe.myTarget.z;
+
+        if (lineStream.fail())
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::File, "Malformed camera keyframe in %s: %s", aFilepath.c_str(), line.c_str());
+            return false;
+        }
+
+        myKeyframes.push_back(keyframe);
+    }
+
+    if (myKeyframes.empty())
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::File, "Camera path %s has no keyframes", aFilepath.c_str());
+        return false;
+    }
+
+    std::stable_sort(myKeyframes.begin(), myKeyframes.end(), [](const Keyframe& aLeft, const Keyframe& aRight) { return aLeft.myTime < aRight.myTime; });
+    return true;
+}
+
+void CameraPath::CreateOrbit(float aRadius, float aHeight, float aDuration)
+{
+    constexpr int keyframeCount = 64;
+
+    myKeyframes.clear();
+    for (int i = 0; i <= keyframeCount; ++i)
+    {
+        const float progress = static_cast<float>(i) / keyframeCount;
+        const float angle = progress * glm::two_pi<float>();
+
+        Keyframe keyframe;
+        keyframe.myTime = progress * aDuration;
+        keyframe.myPosition = glm::vec3(std::sin(angle) * aRadius, aHeight, std::cos(angle) * aRadius);
+        keyframe.myTarget = glm::vec3(0.0f);
+        myKeyframes.push_back(keyframe);
+    }
+}
+
+void CameraPath::Apply(float aTime, Camera& aCamera) const
+{
+    if (myKeyframes.empty())
+        return;
+
+    const auto nextKeyframe = std::upper_bound(myKeyframes.begin(), myKeyframes.end(), aTime, [](float aValue, const Keyframe& aKeyframe) { return aValue < aKeyframe.myTime; });
+
+    glm::vec3 position;
+    glm::vec3 target;
+    if (nextKeyframe == myKeyframes.begin())
+    {
+        position = nextKeyframe->myPosition;
+        target = nextKeyframe->myTarget;
+    }
+    else if (nextKeyframe == myKeyframes.end())
+    {
+        position = myKeyframes.back().myPosition;
+        target = myKeyframes.back().myTarget;
+    }
+    else
+    {
+        const Keyframe& previousKeyframe = *(nextKeyframe - 1);
+        const float duration = nextKeyframe->myTime - previousKeyframe.myTime;
+        const float alpha = duration > 0.0f ? (aTime - previousKeyframe.myTime) / duration : 1.0f;
+        position = glm::mix(previousKeyframe.myPosition, nextKeyframe->myPosition, alpha);
+        target = glm::mix(previousKeyframe.myTarget, nextKeyframe->myTarget, alpha);
+    }
+
+    // Camera builds its direction from two angles, so convert the look-at target back into them
+    const glm::vec3 offset = target - position;
+    const glm::vec3 direction = glm::length(offset) > 0.0f ? glm::normalize(offset) : glm::vec3(0.0f, 0.0f, -1.0f);
+    aCamera.SetPosition(position);
+    aCamera.SetOrientation(std::atan2(direction.x, direction.z), std::asin(glm::clamp(direction.y, -1.0f, 1.0f)));
+}
+
+float CameraPath::GetDuration() const
+{
+    return myKeyframes.empty() ? 0.0f : myKeyframes.back().myTime;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <string>
+#include <vector>
+
+class Camera;
+
+// A scripted camera flight, sampled by time so that every run sees the exact same views.
+// Keyframes are read from a text file with one "time positionX positionY positionZ targetX targetY targetZ" per line.
+class CameraPath
+{
+public:
+    bool Load(const std::string& aFilepath);
+
+    // An orbit around the origin, used when no path file is given
+    void CreateOrbit(float aRadius, float aHeight, float aDuration);
+
+    void Apply(float aTime, Camera& aCamera) const;
+
+    [[nodiscard]] float GetDuration() const;
+
+private:
+    struct Keyframe
+    {
+        float myTime;
+        glm::vec3 myPosition;
+        glm::vec3 myTarget;
+    };
+
+    std::vector<Keyframe> myKeyframes;
+};
@@ -0,0 +1,161 @@
+#include "CullingBenchmark.h"
+
+#include "Benchmark.h"
+#include "BoundingBox.h"
+#include "CullingBounds.h"
+#include "Frustum.h"
+#include "LogUtility.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using BenchmarkTimer::Clock;
+    using BenchmarkTimer::GetMilliseconds;
+
+    BoundingBox CreateBox(const glm::vec3& aCenter, const glm::vec3& someExtents)
+    {
+        BoundingBox box;
+        box.Grow(aCenter - someExtents);
+        box.Grow(aCenter + someExtents);
+        return box;
+    }
+
+    // Boxes that touch, clear or barely cross the planes of a frustum whose coefficients, like every center and extent,
+    // are small multiples of powers of two. All products and sums are then exact, so the expected visibility is known
+    // regardless of how a path groups its arithmetic, and a box touching a plane has to count as visible.
+    bool CheckBoundaryBoxes()
+    {
+        Frustum frustum;
+        frustum.myPlanes[Frustum::Left] = glm::vec4(1.0f, 0.0f, 0.0f, 8.0f);
+        frustum.myPlanes[Frustum::Right] = glm::vec4(-1.0f, 0.0f, 0.0f, 8.0f);
+        frustum.myPlanes[Frustum::Bottom] = glm::vec4(0.0f, 1.0f, 0.0f, 8.0f);
+        frustum.myPlanes[Frustum::Top] = glm::vec4(0.0f, -1.0f, 0.0f, 8.0f);
+        frustum.myPlanes[Frustum::Near] = glm::vec4(0.5f, 0.25f, 0.25f, 4.0f);
+        frustum.myPlanes[Frustum::Far] = glm::vec4(0.0f, 0.0f, -1.0f, 8.0f);
+
+        CullingBounds cullingBounds;
+        std::vector<unsigned char> expectedVisibility;
+        const auto addBox = [&](const glm::vec3& aCenter, const glm::vec3& someExtents, bool anIsVisible)
+        {
+            cullingBounds.Add(CreateBox(aCenter, someExtents));
+            expectedVisibility.push_back(anIsVisible ? 1 : 0);
+        };
+
+        const glm::vec3 extents(1.0f, 0.5f, 0.25f);
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            for (const float side : { -1.0f, 1.0f })
+            {
+                glm::vec3 direction(0.0f);
+                direction[axis] = side;
+                addBox(direction * (8.0f + extents[axis]), extents, true);
+                addBox(direction * (8.0f + extents[axis] + 0.125f), extents, false);
+                addBox(direction * (8.0f + extents[axis] - 0.125f), extents, true);
+            }
+        }
+
+        addBox(glm::vec3(0.0f, 0.0f, 8.25f), extents, true);
+        addBox(glm::vec3(0.0f, 0.0f, 8.5f), extents, false);
+
+        // The slanted plane: 0.5 * -8 + 0.25 * -1 + 0.25 * -1 + 4 = -0.5, exactly cancelled by the projected radius 0.5 * 0.5 + 0.25 * 0.5 + 0.25 * 0.5
+        const glm::vec3 slantedExtents(0.5f, 0.5f, 0.5f);
+        addBox(glm::vec3(-8.0f, -1.0f, -1.0f), slantedExtents, true);
+        addBox(glm::vec3(-8.5f, -1.0f, -1.0f), slantedExtents, false);
+        addBox(glm::vec3(-7.5f, -1.0f, -1.0f), slantedExtents, true);
+        addBox(glm::vec3(0.0f), slantedExtents, true);
+
+        std::vector<unsigned char> visibility;
+        std::vector<unsigned char> referenceVisibility;
+        cullingBounds.Cull(frustum, visibility);
+        cullingBounds.CullScalar(frustum, referenceVisibility);
+        return visibility == expectedVisibility && referenceVisibility == expectedVisibility;
+    }
+}
+
+namespace CullingBenchmark
+{
+    bool Run(int aBoxCount, int anIterationCount, const std::string& aReportFilepath)
+    {
+        if (!CheckBoundaryBoxes())
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "Culling disagrees with the expected visibility of boxes touching the frustum planes");
+            return false;
+        }
+
+        // A fixed seed keeps the box set, and so the amount of work, identical between runs
+        std::mt19937 randomEngine(1234);
+        std::uniform_real_distribution<float> positionDistribution(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> sizeDistribution(0.1f, 4.0f);
+
+        CullingBounds cullingBounds;
+        for (int boxIndex = 0; boxIndex < aBoxCount; ++boxIndex)
+        {
+            const glm::vec3 center(positionDistribution(randomEngine), positionDistribution(randomEngine), positionDistribution(randomEngine));
+            const glm::vec3 extents(sizeDistribution(randomEngine), sizeDistribution(randomEngine), sizeDistribution(randomEngine));
+            cullingBounds.Add(CreateBox(center, extents));
+        }
+
+        std::vector<unsigned char> visibility;
+        std::vector<unsigned char> referenceVisibility;
+        std::vector<double> simdMilliseconds;
+        std::vector<double> scalarMilliseconds;
+        std::size_t visibleCount = 0;
+
+        const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+        for (int iteration = 0; iteration < anIterationCount; ++iteration)
+        {
+            // Spin the camera around so both mostly visible and mostly culled views are measured
+            const float angle = static_cast<float>(iteration) / static_cast<float>(anIterationCount) * 6.2831853f;
+            const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(std::sin(angle), 0.2f, std::cos(angle)), glm::vec3(0.0f, 1.0f, 0.0f));
+            const Frustum frustum = Frustum::FromViewProjection(projection * view);
+
+            const Clock::time_point simdStartTime = Clock::now();
+            cullingBounds.Cull(frustum, visibility);
+            const Clock::time_point simdEndTime = Clock::now();
+            cullingBounds.CullScalar(frustum, referenceVisibility);
+            const Clock::time_point scalarEndTime = Clock::now();
+
+            simdMilliseconds.push_back(GetMilliseconds(simdStartTime, simdEndTime));
+            scalarMilliseconds.push_back(GetMilliseconds(simdEndTime, scalarEndTime));
+
+            if (visibility != referenceVisibility)
+            {
+                LogUtility::PrintError(LogUtility::LogCategory::Core, "SIMD and scalar culling disagree in iteration %i", iteration);
+                return false;
+            }
+
+            visibleCount += static_cast<std::size_t>(std::count(visibility.begin(), visibility.end(), static_cast<unsigned char>(1)));
+        }
+
+        if (simdMilliseconds.empty())
+            return false;
+
+        std::sort(simdMilliseconds.begin(), simdMilliseconds.end());
+        std::sort(scalarMilliseconds.begin(), scalarMilliseconds.end());
+        const double simdMedian = simdMilliseconds[simdMilliseconds.size() / 2];
+        const double scalarMedian = scalarMilliseconds[scalarMilliseconds.size() / 2];
+        const double nanosecondsPerBox = aBoxCount > 0 ? simdMedian * 1000000.0 / aBoxCount : 0.0;
+
+        BenchmarkReportWriter report(aReportFilepath);
+        if (!report.IsOpen())
+            return false;
+
+        report.WriteInteger("boxes", aBoxCount);
+        report.WriteInteger("iterations", anIterationCount);
+        report.WriteNumber("visibleRatio", static_cast<double>(visibleCount) / (static_cast<double>(aBoxCount) * anIterationCount));
+        report.WriteNumber("simdMedianMs", simdMedian);
+        report.WriteNumber("scalarMedianMs", scalarMedian);
+        report.WriteNumber("simdNsPerBox", nanosecondsPerBox);
+        if (!report.Close())
+            return false;
+
+        LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Culled %i boxes in %.3f ms (scalar %.3f ms), report written to %s", aBoxCount, simdMedian, scalarMedian, aReportFilepath.c_str());
+        return true;
+    }
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+
+// CPU-only benchmark of CullingBounds that needs no GL context. The SIMD kernel is checked against the scalar
+// reference on every iteration, so a run also fails when the two disagree on any box. Before that both have to
+// match the known visibility of boxes touching the frustum planes, computed with arithmetic that is exact.
+namespace CullingBenchmark
+{
+    bool Run(int aBoxCount, int anIterationCount, const std::string& aReportFilepath);
+}
@@ -0,0 +1,39 @@
+#include "Benchmark.h"
+#include "BvhBenchmark.h"
+#include "CullingBenchmark.h"
+#include "MeshOptimizerBenchmark.h"
+#include "TextureCompressorBenchmark.h"
+#include "TexturePoolBenchmark.h"
+#include "VertexWeldBenchmark.h"
+#include "VirtualTextureBenchmark.h"
+
+int main(int anArgumentCount, char** someArguments)
+{
+    BenchmarkSettings settings;
+    if (!settings.ParseCommandLine(anArgumentCount, someArguments))
+        return 1;
+
+    if (settings.myCullingBoxCount > 0)
+        return CullingBenchmark::Run(settings.myCullingBoxCount, settings.myMeasuredFrameCount, settings.myReportFilepath) ? 0 : 1;
+
+    if (settings.myBvhItemCount > 0)
+        return BvhBenchmark::Run(settings.myBvhItemCount, settings.myMeasuredFrameCount, settings.myReportFilepath) ? 0 : 1;
+
+    if (settings.myMeshOptimizerSegmentCount > 0)
+        return MeshOptimizerBenchmark::Run(settings.myMeshOptimizerSegmentCount, settings.myReportFilepath) ? 0 : 1;
+
+    if (settings.myTextureCompressorSize > 0)
+        return TextureCompressorBenchmark::Run(settings.myTextureCompressorSize, settings.myReportFilepath) ? 0 : 1;
+
+    if (settings.myTexturePoolTextureCount > 0)
+        return TexturePoolBenchmark::Run(settings.myTexturePoolTextureCount, settings.myReportFilepath) ? 0 : 1;
+
+    if (settings.myVirtualTextureSize > 0)
+        return VirtualTextureBenchmark::Run(settings.myVirtualTextureSize, settings.myReportFilepath) ? 0 : 1;
+
+    if (settings.myVertexWeldIndexCount > 0)
+        return VertexWeldBenchmark::Run(settings.myVertexWeldIndexCount, settings.myReportFilepath) ? 0 : 1;
+
+    Benchmark benchmark(settings);
+    return benchmark.Run() ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+#include "MeshOptimizerBenchmark.h"
+
+#include "AppDefinitions.h"
+#include "Benchmark.h"
+#include "LogUtility.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include "Vertex.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using BenchmarkTimer::Clock;
+    using BenchmarkTimer::GetMilliseconds;
+    using Triangle = std::array<unsigned int, 3>;
+
+    // Rings of vertices between the poles, with a seam column so texture coordinates wrap like an exported model
+    void CreateSphere(int aSegmentCount, std::vector<Vertex>& someVertices, std::vector<unsigned int>& someIndices)
+    {
+        const int ringCount = std::max(aSegmentCount / 2, 2);
+        for (int ring = 0; ring <= ringCount; ++ring)
+        {
+            const float latitude = static_cast<float>(ring) / static_cast<float>(ringCount) * 3.14159265f;
+            for (int segment = 0; segment <= aSegmentCount; ++segment)
+            {
+                const float longitude = static_cast<float>(segment) / static_cast<float>(aSegmentCount) * 6.2831853f;
+                Vertex vertex;
+                vertex.myPosition = glm::vec3(std::sin(latitude) * std::cos(longitude), std::cos(latitude), std::sin(latitude) * std::sin(longitude));
+                vertex.myTextureCoordinates = glm::vec2(static_cast<float>(segment) / static_cast<float>(aSegmentCount), static_cast<float>(ring) / static_cast<float>(ringCount));
+                someVertices.push_back(vertex);
+            }
+        }
+
+        const unsigned int rowSize = static_cast<unsigned int>(aSegmentCount + 1);
+        for (unsigned int ring = 0; ring < static_cast<unsigned int>(ringCount); ++ring)
+        {
+            for (unsigned int segment = 0; segment < static_cast<unsigned int>(aSegmentCount); ++segment)
+            {
+                const unsigned int topLeft = ring * rowSize + segment;
+                const unsigned int bottomLeft = topLeft + rowSize;
+                someIndices.insert(someIndices.end(), { topLeft, topLeft + 1, bottomLeft });
+                someIndices.insert(someIndices.end(), { topLeft + 1, bottomLeft + 1, bottomLeft });
+            }
+        }
+    }
+
+    // Rotated so the smallest index comes first, which keeps the winding but makes equal triangles compare equal
+    std::vector<Triangle> GetSortedTriangles(const std::vector<unsigned int>& someIndices, const std::vector<unsigned int>& aRemap)
+    {
+        std::vector<Triangle> triangles(someIndices.size() / 3);
+        for (std::size_t i = 0; i < triangles.size(); ++i)
+        {
+            Triangle triangle = { aRemap[someIndices[i * 3]], aRemap[someIndices[i * 3 + 1]], aRemap[someIndices[i * 3 + 2]] };
+            std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+            triangles[i] = triangle;
+        }
+
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    struct MeshletStatistics
+    {
+        double myAverageTriangleCount = 0.0;
+        double myAverageVertexCount = 0.0;
+        // Share of meshlet and viewpoint pairs the normal cone rejects
+        double myConeCulledRatio = 0.0;
+    };
+
+    // Checks the limits, that the meshlets cover the indices in order and that a cone never rejects a meshlet with a triangle facing the viewer
+    bool ValidateMeshlets(const std::vector<Meshlet>& someMeshlets, const std::vector<Vertex>& someVertices, const std::vector<unsigned int>& someIndices, MeshletStatistics& someStatistics)
+    {
+        std::vector<glm::vec3> viewpoints;
+        std::mt19937 random(5678);
+        std::uniform_real_distribution<float> distribution(-4.0f, 4.0f);
+        for (int i = 0; i < 64; ++i)
+            viewpoints.emplace_back(distribution(random), distribution(random), distribution(random));
+
+        uint32_t nextIndex = 0;
+        std::size_t vertexTotal = 0;
+        std::size_t coneCulledCount = 0;
+        std::vector<unsigned int> meshletVertices;
+        for (const Meshlet& meshlet : someMeshlets)
+        {
+            meshletVertices.assign(someIndices.begin() + meshlet.myFirstIndex, someIndices.begin() + meshlet.myFirstIndex + meshlet.myIndexCount);
+            std::sort(meshletVertices.begin(), meshletVertices.end());
+            const std::size_t vertexCount = static_cast<std::size_t>(std::unique(meshletVertices.begin(), meshletVertices.end()) - meshletVertices.begin());
+            if (meshlet.myFirstIndex != nextIndex || meshlet.myIndexCount == 0 || meshlet.myIndexCount / 3 > meshletMaxTriangleCount || vertexCount > meshletMaxVertexCount)
+                return false;
+
+            nextIndex += meshlet.myIndexCount;
+            vertexTotal += vertexCount;
+
+            for (const glm::vec3& viewpoint : viewpoints)
+            {
+                const glm::vec3 toCenter = meshlet.myCenter - viewpoint;
+                if (glm::dot(toCenter, meshlet.myConeAxis) < meshlet.myConeCutoff * glm::length(toCenter) + meshlet.myRadius)
+                    continue;
+
+                ++coneCulledCount;
+                for (uint32_t i = meshlet.myFirstIndex; i < meshlet.myFirstIndex + meshlet.myIndexCount; i += 3)
+                {
+                    const glm::vec3& position0 = someVertices[someIndices[i]].myPosition;
+                    const glm::vec3& position1 = someVertices[someIndices[i + 1]].myPosition;
+                    const glm::vec3& position2 = someVertices[someIndices[i + 2]].myPosition;
+                    if (glm::dot(glm::cross(position1 - position0, position2 - position0), viewpoint - position0) > 1.0e-6f)
+                        return false;
+                }
+            }
+        }
+
+        if (nextIndex != someIndices.size() || someMeshlets.empty())
+            return false;
+
+        someStatistics.myAverageTriangleCount = static_cast<double>(someIndices.size() / 3) / static_cast<double>(someMeshlets.size());
+        someStatistics.myAverageVertexCount = static_cast<double>(vertexTotal) / static_cast<double>(someMeshlets.size());
+        someStatistics.myConeCulledRatio = static_cast<double>(coneCulledCount) / static_cast<double>(someMeshlets.size() * viewpoints.size());
+        return true;
+    }
+}
+
+namespace MeshOptimizerBenchmark
+{
+    bool Run(int aSegmentCount, const std::string& aReportFilepath)
+    {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        CreateSphere(aSegmentCount, vertices, indices);
+
+        // A shuffled triangle order is the worst case an exporter can hand over
+        std::vector<Triangle> shuffledTriangles(indices.size() / 3);
+        for (std::size_t i = 0; i < shuffledTriangles.size(); ++i)
+            shuffledTriangles[i] = { indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2] };
+        std::shuffle(shuffledTriangles.begin(), shuffledTriangles.end(), std::mt19937(1234));
+        for (std::size_t i = 0; i < shuffledTriangles.size(); ++i)
+            std::copy(shuffledTriangles[i].begin(), shuffledTriangles[i].end(), indices.begin() + i * 3);
+
+        const std::vector<unsigned int> originalIndices = indices;
+        const std::vector<Vertex> originalVertices = vertices;
+        const VertexCacheStatistics statisticsBefore = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+
+        const Clock::time_point cacheStartTime = Clock::now();
+        std::vector<unsigned int> cacheIndices = indices;
+        MeshOptimizer::OptimizeVertexCache(cacheIndices, vertices.size());
+        const Clock::time_point cacheEndTime = Clock::now();
+        MeshOptimizer::OptimizeOverdraw(indices, vertices);
+        const Clock::time_point overdrawEndTime = Clock::now();
+        const std::vector<unsigned int> remap = MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+        const Clock::time_point fetchEndTime = Clock::now();
+        const std::vector<Meshlet> meshlets = MeshletBuilder::Build(vertices, indices);
+        const Clock::time_point meshletEndTime = Clock::now();
+
+        const VertexCacheStatistics cacheStatistics = MeshOptimizer::AnalyzeVertexCache(cacheIndices, vertices.size());
+        const VertexCacheStatistics statisticsAfter = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+
+        std::vector<unsigned int> identity(vertices.size());
+        for (std::size_t vertex = 0; vertex < identity.size(); ++vertex)
+            identity[vertex] = static_cast<unsigned int>(vertex);
+
+        if (GetSortedTriangles(originalIndices, remap) != GetSortedTriangles(indices, identity))
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "The optimized mesh does not contain the triangles it started with");
+            return false;
+        }
+
+        bool isFetchLinear = true;
+        unsigned int nextVertex = 0;
+        for (const unsigned int index : indices)
+        {
+            isFetchLinear = isFetchLinear && index <= nextVertex;
+            if (index == nextVertex)
+                ++nextVertex;
+        }
+
+        for (std::size_t vertex = 0; vertex < originalVertices.size(); ++vertex)
+            isFetchLinear = isFetchLinear && vertices[remap[vertex]] == originalVertices[vertex];
+
+        if (!isFetchLinear)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "The optimized vertices are not in the order the indices first use them");
+            return false;
+        }
+
+        MeshletStatistics meshletStatistics;
+        if (!ValidateMeshlets(meshlets, vertices, indices, meshletStatistics))
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "The meshlets exceed their limits, do not cover the mesh or have cones that reject visible triangles");
+            return false;
+        }
+
+        BenchmarkReportWriter report(aReportFilepath);
+        if (!report.IsOpen())
+            return false;
+
+        report.WriteInteger("triangles", indices.size() / 3);
+        report.WriteInteger("vertices", vertices.size());
+        report.WriteInteger("cacheSize", MeshOptimizer::DefaultCacheSize);
+        report.WriteNumber("acmrBefore", statisticsBefore.myAcmr);
+        report.WriteNumber("atvrBefore", statisticsBefore.myAtvr);
+        report.WriteNumber("acmrVertexCache", cacheStatistics.myAcmr);
+        report.WriteNumber("atvrVertexCache", cacheStatistics.myAtvr);
+        report.WriteNumber("acmrAfter", statisticsAfter.myAcmr);
+        report.WriteNumber("atvrAfter", statisticsAfter.myAtvr);
+        report.WriteNumber("vertexCacheMs", GetMilliseconds(cacheStartTime, cacheEndTime));
+        report.WriteNumber("overdrawMs", GetMilliseconds(cacheEndTime, overdrawEndTime));
+        report.WriteNumber("vertexFetchMs", GetMilliseconds(overdrawEndTime, fetchEndTime));
+        report.WriteInteger("meshlets", meshlets.size());
+        report.WriteNumber("trianglesPerMeshlet", meshletStatistics.myAverageTriangleCount, 2);
+        report.WriteNumber("verticesPerMeshlet", meshletStatistics.myAverageVertexCount, 2);
+        report.WriteNumber("coneCulledRatio", meshletStatistics.myConeCulledRatio);
+        report.WriteNumber("meshletMs", GetMilliseconds(fetchEndTime, meshletEndTime));
+        if (!report.Close())
+            return false;
+
+        LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Optimized %zu triangles, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, report written to %s",
+            indices.size() / 3, statisticsBefore.myAcmr, statisticsAfter.myAcmr, statisticsBefore.myAtvr, statisticsAfter.myAtvr, aReportFilepath.c_str());
+        return true;
+    }
+}
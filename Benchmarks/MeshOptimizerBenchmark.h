@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+
+// CPU-only benchmark of MeshOptimizer that needs no GL context. Shuffles the triangles of a sphere, runs the same passes
+// ModelLoader does and reports the vertex cache statistics before and after. A run fails when the optimized mesh does not
+// contain exactly the triangles it started with, with the same winding, or when its vertices are not fetched in order.
+namespace MeshOptimizerBenchmark
+{
+    bool Run(int aSegmentCount, const std::string& aReportFilepath);
+}
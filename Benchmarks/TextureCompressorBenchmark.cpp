@@ -0,0 +1,252 @@
+#include "TextureCompressorBenchmark.h"
+
+#include "Benchmark.h"
+#include "CompressedTexture.h"
+#include "LogUtility.h"
+#include "TextureCache.h"
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using BenchmarkTimer::Clock;
+    using BenchmarkTimer::GetMilliseconds;
+
+    std::vector<unsigned char> CreateImage(int aSize, int aChannelCount)
+    {
+        std::vector<unsigned char> pixels(static_cast<std::size_t>(aSize) * aSize * aChannelCount);
+        std::mt19937 random(4321);
+        std::uniform_int_distribution<int> noise(-6, 6);
+        for (int y = 0; y < aSize; ++y)
+        {
+            for (int x = 0; x < aSize; ++x)
+            {
+                // Frequencies are in texels rather than fractions of the image, so every size is equally hard to compress
+                const float v = static_cast<float>(y) / static_cast<float>(aSize);
+                const bool isChecker = ((x / 32) + (y / 32)) % 2 == 0;
+                const int red = static_cast<int>(255.0f * (0.5f + 0.5f * std::sin(static_cast<float>(x) * 0.02f)));
+                const int green = static_cast<int>(255.0f * (0.5f + 0.5f * std::sin(static_cast<float>(y) * 0.05f)));
+                const int blue = isChecker ? 200 : 40;
+
+                unsigned char* pixel = pixels.data() + (static_cast<std::size_t>(y) * aSize + x) * aChannelCount;
+                pixel[0] = static_cast<unsigned char>(std::clamp(red + noise(random), 0, 255));
+                pixel[1] = static_cast<unsigned char>(std::clamp(green + noise(random), 0, 255));
+                pixel[2] = static_cast<unsigned char>(std::clamp(blue + noise(random), 0, 255));
+                if (aChannelCount == 4)
+                    pixel[3] = static_cast<unsigned char>(255.0f * v);
+            }
+        }
+
+        return pixels;
+    }
+
+    void DecodeColor(uint16_t aColor, float* aDestination)
+    {
+        const int red = (aColor >> 11) & 31;
+        const int green = (aColor >> 5) & 63;
+        const int blue = aColor & 31;
+        aDestination[0] = static_cast<float>((red << 3) | (red >> 2));
+        aDestination[1] = static_cast<float>((green << 2) | (green >> 4));
+        aDestination[2] = static_cast<float>((blue << 3) | (blue >> 2));
+    }
+
+    // Reference decode of the top level into RGBA, written against the format specification rather than the encoder
+    std::vector<float> DecodeTopLevel(const CompressedTexture& aTexture)
+    {
+        const CompressedTextureLevel& level = aTexture.myLevels[0];
+        const bool hasAlpha = aTexture.myCompression == TextureCompression::Bc3;
+        const int blockColumns = (level.myWidth + 3) / 4;
+        std::vector<float> texels(static_cast<std::size_t>(level.myWidth) * level.myHeight * 4, 255.0f);
+        for (std::size_t block = 0; block * (hasAlpha ? 16 : 8) < level.mySize; ++block)
+        {
+            const unsigned char* data = aTexture.myData.data() + level.myOffset + block * (hasAlpha ? 16 : 8);
+            float alphas[8] = {};
+            uint64_t alphaBits = 0;
+            if (hasAlpha)
+            {
+                alphas[0] = data[0];
+                alphas[1] = data[1];
+                for (int step = 1; step < (data[0] > data[1] ? 7 : 5); ++step)
+                    alphas[step + 1] = data[0] > data[1] ? ((7 - step) * alphas[0] + step * alphas[1]) / 7.0f : ((5 - step) * alphas[0] + step * alphas[1]) / 5.0f;
+                if (data[0] <= data[1])
+                    alphas[7] = 255.0f;
+                for (int byte = 0; byte < 6; ++byte)
+                    alphaBits |= static_cast<uint64_t>(data[2 + byte]) << (byte * 8);
+                data += 8;
+            }
+
+            uint16_t color0 = 0;
+            uint16_t color1 = 0;
+            uint32_t indexBits = 0;
+            std::memcpy(&color0, data, sizeof(color0));
+            std::memcpy(&color1, data + 2, sizeof(color1));
+            std::memcpy(&indexBits, data + 4, sizeof(indexBits));
+
+            float palette[4][3] = {};
+            DecodeColor(color0, palette[0]);
+            DecodeColor(color1, palette[1]);
+            for (int channel = 0; channel < 3; ++channel)
+            {
+                if (color0 > color1 || hasAlpha)
+                {
+                    palette[2][channel] = (2.0f * palette[0][channel] + palette[1][channel]) / 3.0f;
+                    palette[3][channel] = (palette[0][channel] + 2.0f * palette[1][channel]) / 3.0f;
+                }
+                else
+                {
+                    palette[2][channel] = (palette[0][channel] + palette[1][channel]) / 2.0f;
+                    palette[3][channel] = 0.0f;
+                }
+            }
+
+            const int blockX = static_cast<int>(block % blockColumns) * 4;
+            const int blockY = static_cast<int>(block / blockColumns) * 4;
+            for (int texel = 0; texel < 16; ++texel)
+            {
+                const int x = blockX + texel % 4;
+                const int y = blockY + texel / 4;
+                if (x >= level.myWidth || y >= level.myHeight)
+                    continue;
+
+                float* destination = texels.data() + (static_cast<std::size_t>(y) * level.myWidth + x) * 4;
+                const float* color = palette[(indexBits >> (texel * 2)) & 3];
+                std::copy(color, color + 3, destination);
+                if (hasAlpha)
+                    destination[3] = alphas[(alphaBits >> (texel * 3)) & 7];
+            }
+        }
+
+        return texels;
+    }
+
+    double GetPsnr(const std::vector<unsigned char>& someSourcePixels, int aChannelCount, const std::vector<float>& someDecodedTexels, int aFirstChannel, int aChannelSpan)
+    {
+        double squaredError = 0.0;
+        std::size_t sampleCount = 0;
+        for (std::size_t texel = 0; texel < someDecodedTexels.size() / 4; ++texel)
+        {
+            for (int channel = aFirstChannel; channel < aFirstChannel + aChannelSpan; ++channel)
+            {
+                const double difference = static_cast<double>(someSourcePixels[texel * aChannelCount + channel]) - someDecodedTexels[texel * 4 + channel];
+                squaredError += difference * difference;
+                ++sampleCount;
+            }
+        }
+
+        const double meanSquaredError = std::max(squaredError / static_cast<double>(sampleCount), 1.0e-10);
+        return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+    }
+
+    bool IsMipChainComplete(const CompressedTexture& aTexture, int aSize)
+    {
+        std::size_t offset = 0;
+        int size = aSize;
+        for (const CompressedTextureLevel& level : aTexture.myLevels)
+        {
+            if (level.myWidth != size || level.myHeight != size || level.myOffset != offset || level.mySize != TextureCompressor::GetLevelSize(aTexture.myCompression, size, size))
+                return false;
+
+            offset += level.mySize;
+            size = std::max(size / 2, 1);
+        }
+
+        return !aTexture.myLevels.empty() && aTexture.myLevels.back().myWidth == 1 && offset == aTexture.myData.size();
+    }
+
+    bool IsCacheRoundTripExact(const CompressedTexture& aTexture)
+    {
+        // The cache stamps itself with the source file, so a stand-in source has to exist while it is written and read
+        const std::string sourcePath = (std::filesystem::temp_directory_path() / "TextureCompressorBenchmark.png").string();
+        {
+            std::ofstream stream(sourcePath, std::ios::binary | std::ios::trunc);
+            stream << "source";
+        }
+
+        CompressedTexture readTexture;
+        const bool isExact = TextureCache::Write(sourcePath, aTexture) && TextureCache::Read(sourcePath, readTexture)
+            && readTexture.myCompression == aTexture.myCompression && readTexture.myData == aTexture.myData && readTexture.myLevels.size() == aTexture.myLevels.size();
+
+        std::error_code errorCode;
+        std::filesystem::remove(sourcePath, errorCode);
+        std::filesystem::remove(TextureCache::GetCachePath(sourcePath), errorCode);
+        return isExact;
+    }
+}
+
+namespace TextureCompressorBenchmark
+{
+    bool Run(int aSize, const std::string& aReportFilepath)
+    {
+        const std::vector<unsigned char> opaquePixels = CreateImage(aSize, 3);
+        const std::vector<unsigned char> translucentPixels = CreateImage(aSize, 4);
+
+        const Clock::time_point bc1StartTime = Clock::now();
+        const CompressedTexture bc1Texture = TextureCompressor::Compress(opaquePixels.data(), aSize, aSize, 3);
+        const Clock::time_point bc1EndTime = Clock::now();
+        const CompressedTexture bc3Texture = TextureCompressor::Compress(translucentPixels.data(), aSize, aSize, 4);
+        const Clock::time_point bc3EndTime = Clock::now();
+
+        if (bc1Texture.myCompression != TextureCompression::Bc1 || bc3Texture.myCompression != TextureCompression::Bc3 || !IsMipChainComplete(bc1Texture, aSize) || !IsMipChainComplete(bc3Texture, aSize))
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "The compressed textures have the wrong format or an incomplete mip chain");
+            return false;
+        }
+
+        const std::vector<float> bc1Texels = DecodeTopLevel(bc1Texture);
+        const std::vector<float> bc3Texels = DecodeTopLevel(bc3Texture);
+        const double bc1Psnr = GetPsnr(opaquePixels, 3, bc1Texels, 0, 3);
+        const double bc3ColorPsnr = GetPsnr(translucentPixels, 4, bc3Texels, 0, 3);
+        const double bc3AlphaPsnr = GetPsnr(translucentPixels, 4, bc3Texels, 3, 1);
+
+        // Thresholds sit well below what this encoder reaches, they catch broken blocks rather than small regressions
+        if (bc1Psnr < 30.0 || bc3ColorPsnr < 30.0 || bc3AlphaPsnr < 30.0)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "The compressed textures are too far from the source, PSNR %.2f, %.2f and %.2f dB", bc1Psnr, bc3ColorPsnr, bc3AlphaPsnr);
+            return false;
+        }
+
+        if (!IsCacheRoundTripExact(bc1Texture) || !IsCacheRoundTripExact(bc3Texture))
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "The texture cache did not return the data it was given");
+            return false;
+        }
+
+        // Against RGBA8 with a full mip chain, which is what the uncompressed path ends up with on most drivers
+        const double uncompressedBytes = static_cast<double>(aSize) * aSize * 4.0 * 4.0 / 3.0;
+        const double megapixels = static_cast<double>(aSize) * aSize / 1.0e6;
+        const double bc1Milliseconds = GetMilliseconds(bc1StartTime, bc1EndTime);
+        const double bc3Milliseconds = GetMilliseconds(bc1EndTime, bc3EndTime);
+
+        BenchmarkReportWriter report(aReportFilepath);
+        if (!report.IsOpen())
+            return false;
+
+        report.WriteInteger("size", aSize);
+        report.WriteInteger("levels", bc1Texture.myLevels.size());
+        report.WriteInteger("bc1Bytes", bc1Texture.myData.size());
+        report.WriteInteger("bc3Bytes", bc3Texture.myData.size());
+        report.WriteNumber("bc1Ratio", uncompressedBytes / static_cast<double>(bc1Texture.myData.size()), 2);
+        report.WriteNumber("bc3Ratio", uncompressedBytes / static_cast<double>(bc3Texture.myData.size()), 2);
+        report.WriteNumber("bc1PsnrDb", bc1Psnr, 2);
+        report.WriteNumber("bc3ColorPsnrDb", bc3ColorPsnr, 2);
+        report.WriteNumber("bc3AlphaPsnrDb", bc3AlphaPsnr, 2);
+        report.WriteNumber("bc1Ms", bc1Milliseconds);
+        report.WriteNumber("bc3Ms", bc3Milliseconds);
+        report.WriteNumber("bc1MegapixelsPerSecond", megapixels / (bc1Milliseconds / 1000.0), 2);
+        report.WriteNumber("bc3MegapixelsPerSecond", megapixels / (bc3Milliseconds / 1000.0), 2);
+        if (!report.Close())
+            return false;
+
+        LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Compressed %ix%i with %zu levels, BC1 %.2f dB in %.1f ms, BC3 %.2f dB in %.1f ms, report written to %s",
+            aSize, aSize, bc1Texture.myLevels.size(), bc1Psnr, bc1Milliseconds, bc3ColorPsnr, bc3Milliseconds, aReportFilepath.c_str());
+        return true;
+    }
+}
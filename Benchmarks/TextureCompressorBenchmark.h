@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+// CPU-only benchmark of TextureCompressor that needs no GL context. Compresses a generated image with gradients, hard edges
+// and noise into BC1 and, with an alpha ramp added, into BC3, and reports encode speed and the quality of the top level.
+// A run fails when either mip chain is incomplete, when the quality falls below what BC1 reaches on such content, or when
+// a TextureCache round trip does not return exactly the data that was written.
+namespace TextureCompressorBenchmark
+{
+    bool Run(int aSize, const std::string& aReportFilepath);
+}
@@ -0,0 +1,169 @@
+#include "TexturePoolBenchmark.h"
+
+#include "Benchmark.h"
+#include "LogUtility.h"
+#include "TexturePool.h"
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace
+{
+    using BenchmarkTimer::Clock;
+    using BenchmarkTimer::GetMilliseconds;
+
+    constexpr std::size_t TextureSize = 1024 * 1024;
+    constexpr int LookupRounds = 16;
+
+    std::string GetTexturePath(int aTextureIndex)
+    {
+        return "Data/Textures/Benchmark/Texture" + std::to_string(aTextureIndex) + ".png";
+    }
+
+    // What TextureLoader used before the pool, kept here as the baseline
+    unsigned int FindLinear(const std::map<std::size_t, unsigned int>& someTextures, const std::string& aFilepath)
+    {
+        const std::size_t hash = std::hash<std::string>{}(aFilepath);
+        for (const std::pair<const std::size_t, unsigned int>& texture : someTextures)
+        {
+            if (texture.first == hash)
+                return texture.second;
+        }
+
+        return 0;
+    }
+
+    bool IsEvictionOrderValid(int aTextureCount)
+    {
+        // Half the textures fit, all of them are added and referenced before any is released
+        TexturePool texturePool(static_cast<std::size_t>(aTextureCount / 2) * TextureSize);
+        std::vector<std::string> paths;
+        for (int i = 0; i < aTextureCount; ++i)
+        {
+            paths.push_back(TexturePool::NormalizePath(GetTexturePath(i)));
+            texturePool.Add(paths.back(), static_cast<unsigned int>(i + 1), TextureSize);
+        }
+
+        std::vector<unsigned int> evictedIdentifiers;
+        texturePool.Evict(evictedIdentifiers);
+        if (!evictedIdentifiers.empty() || texturePool.GetTextureCount() != static_cast<std::size_t>(aTextureCount))
+            return false;
+
+        // The first texture is referenced a second time, so releasing it once has to keep it resident
+        if (texturePool.Acquire(paths[0]) != 1)
+            return false;
+
+        for (int i = 0; i < aTextureCount; ++i)
+        {
+            texturePool.Release(static_cast<unsigned int>(i + 1));
+            texturePool.Evict(evictedIdentifiers);
+        }
+
+        // Everything except the first texture was released once, oldest first, so the evictions have to come out in that order
+        const std::size_t expectedEvictionCount = static_cast<std::size_t>(aTextureCount - aTextureCount / 2);
+        if (evictedIdentifiers.size() != expectedEvictionCount || texturePool.GetResidentBytes() > texturePool.GetByteBudget())
+            return false;
+
+        for (std::size_t i = 0; i < evictedIdentifiers.size(); ++i)
+        {
+            if (evictedIdentifiers[i] != static_cast<unsigned int>(i + 2))
+                return false;
+        }
+
+        // Acquiring a released texture takes it off the eviction list again, so the next eviction has to skip it
+        const unsigned int reacquiredIdentifier = texturePool.Acquire(paths[evictedIdentifiers.size() + 1]);
+        texturePool.Add(TexturePool::NormalizePath("Data/Textures/Benchmark/Extra.png"), static_cast<unsigned int>(aTextureCount + 1), TextureSize);
+        evictedIdentifiers.clear();
+        texturePool.Evict(evictedIdentifiers);
+        if (reacquiredIdentifier != static_cast<unsigned int>(expectedEvictionCount + 2) || evictedIdentifiers.size() != 1 || evictedIdentifiers[0] != reacquiredIdentifier + 1
+            || texturePool.Acquire(paths[0]) != 1)
+            return false;
+
+        // Adding a path that is already resident hands out the resident texture instead of tracking a second one
+        const std::size_t textureCount = texturePool.GetTextureCount();
+        return texturePool.Add(paths[0], static_cast<unsigned int>(aTextureCount + 2), TextureSize) == 1 && texturePool.GetTextureCount() == textureCount;
+    }
+}
+
+namespace TexturePoolBenchmark
+{
+    bool Run(int aTextureCount, const std::string& aReportFilepath)
+    {
+        if (aTextureCount < 8)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "The texture pool benchmark needs at least 8 textures");
+            return false;
+        }
+
+        const std::string normalizedPath = TexturePool::NormalizePath("Data/Textures/Container2.png");
+        if (TexturePool::NormalizePath("./Data/Models/../Textures//Container2.png") != normalizedPath || TexturePool::NormalizePath("Data/Textures/Container2_specular.png") == normalizedPath)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "Paths to the same texture do not normalize to the same key");
+            return false;
+        }
+
+        if (!IsEvictionOrderValid(aTextureCount))
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "The texture pool evicted referenced textures or did not evict in release order");
+            return false;
+        }
+
+        TexturePool texturePool(static_cast<std::size_t>(aTextureCount) * TextureSize);
+        std::map<std::size_t, unsigned int> linearTextures;
+        std::vector<std::string> paths;
+        for (int i = 0; i < aTextureCount; ++i)
+        {
+            paths.push_back(TexturePool::NormalizePath(GetTexturePath(i)));
+            texturePool.Add(paths.back(), static_cast<unsigned int>(i + 1), TextureSize);
+            linearTextures.emplace(std::hash<std::string>{}(paths.back()), static_cast<unsigned int>(i + 1));
+        }
+
+        std::size_t poolChecksum = 0;
+        const Clock::time_point poolStartTime = Clock::now();
+        for (int round = 0; round < LookupRounds; ++round)
+        {
+            for (const std::string& path : paths)
+            {
+                const unsigned int identifier = texturePool.Acquire(path);
+                texturePool.Release(identifier);
+                poolChecksum += identifier;
+            }
+        }
+        const Clock::time_point poolEndTime = Clock::now();
+
+        std::size_t linearChecksum = 0;
+        for (int round = 0; round < LookupRounds; ++round)
+        {
+            for (const std::string& path : paths)
+                linearChecksum += FindLinear(linearTextures, path);
+        }
+        const Clock::time_point linearEndTime = Clock::now();
+
+        if (poolChecksum != linearChecksum)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "The texture pool returned different textures than the linear lookup");
+            return false;
+        }
+
+        const double lookupCount = static_cast<double>(LookupRounds) * aTextureCount;
+        const double poolNanoseconds = GetMilliseconds(poolStartTime, poolEndTime) * 1000000.0 / lookupCount;
+        const double linearNanoseconds = GetMilliseconds(poolEndTime, linearEndTime) * 1000000.0 / lookupCount;
+
+        BenchmarkReportWriter report(aReportFilepath);
+        if (!report.IsOpen())
+            return false;
+
+        report.WriteInteger("textures", aTextureCount);
+        report.WriteNumber("poolLookupNs", poolNanoseconds, 2);
+        report.WriteNumber("linearLookupNs", linearNanoseconds, 2);
+        report.WriteNumber("speedup", linearNanoseconds / poolNanoseconds, 2);
+        if (!report.Close())
+            return false;
+
+        LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Looked up %i textures in %.1f ns with the pool and %.1f ns with a linear scan, report written to %s",
+            aTextureCount, poolNanoseconds, linearNanoseconds, aReportFilepath.c_str());
+        return true;
+    }
+}
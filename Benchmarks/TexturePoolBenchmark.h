@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+// CPU-only benchmark of TexturePool that needs no GL context. Fills a pool over its budget with textures that all stay
+// referenced, releases them again and times lookups against the linear scan over path hashes the pool replaced.
+// A run fails when differently spelled paths do not share a texture, when a referenced texture is evicted, when the
+// evictions do not follow the order the textures were released in, or when the pool ends up over its budget.
+namespace TexturePoolBenchmark
+{
+    bool Run(int aTextureCount, const std::string& aReportFilepath);
+}
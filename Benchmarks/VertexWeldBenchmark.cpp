@@ -0,0 +1,187 @@
+#include "VertexWeldBenchmark.h"
+
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "LogUtility.h"
+#include "Mesh.h"
+#include "Texture.h"
+#include "Vertex.h"
+#include "VertexWeldTable.h"
+#include "VertexWelder.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    using BenchmarkTimer::Clock;
+    using BenchmarkTimer::GetMilliseconds;
+
+    constexpr int SeamSpacing = 16;
+
+    // A square grid of quads, two triangles each, in row order like an exporter writes them. Every SeamSpacing columns the
+    // texture coordinates restart, so the corners on a seam share a position but not a vertex.
+    void CreateGrid(int anIndexCount, tinyobj::attrib_t& someAttributes, std::vector<tinyobj::index_t>& someIndices)
+    {
+        const int quadsPerRow = std::max(static_cast<int>(std::sqrt(static_cast<double>(anIndexCount) / 6.0)), 1);
+        const int rowSize = quadsPerRow + 1;
+        for (int row = 0; row < rowSize; ++row)
+        {
+            for (int column = 0; column < rowSize; ++column)
+            {
+                const float x = static_cast<float>(column) / static_cast<float>(quadsPerRow);
+                const float z = static_cast<float>(row) / static_cast<float>(quadsPerRow);
+                someAttributes.vertices.insert(someAttributes.vertices.end(), { x, std::sin(x * 20.0f) * std::cos(z * 20.0f) * 0.05f, z });
+                someAttributes.texcoords.insert(someAttributes.texcoords.end(), { static_cast<float>(column % SeamSpacing) / SeamSpacing, z });
+            }
+        }
+
+        // The far side of every seam, where the texture coordinates wrap around to 1
+        const int seamOffset = rowSize * rowSize;
+        for (int row = 0; row < rowSize; ++row)
+            someAttributes.texcoords.insert(someAttributes.texcoords.end(), { 1.0f, static_cast<float>(row) / static_cast<float>(quadsPerRow) });
+
+        const auto getIndex = [&](int aRow, int aColumn, bool anIsRightCorner)
+        {
+            tinyobj::index_t index;
+            index.vertex_index = aRow * rowSize + aColumn;
+            index.normal_index = -1;
+            index.texcoord_index = anIsRightCorner && aColumn % SeamSpacing == 0 ? seamOffset + aRow : index.vertex_index;
+            return index;
+        };
+
+        someIndices.reserve(static_cast<std::size_t>(quadsPerRow) * quadsPerRow * 6);
+        for (int row = 0; row < quadsPerRow; ++row)
+        {
+            for (int column = 0; column < quadsPerRow; ++column)
+            {
+                someIndices.insert(someIndices.end(), { getIndex(row, column, false), getIndex(row + 1, column, false), getIndex(row, column + 1, true) });
+                someIndices.insert(someIndices.end(), { getIndex(row, column + 1, true), getIndex(row + 1, column, false), getIndex(row + 1, column + 1, true) });
+            }
+        }
+    }
+
+    Vertex GetVertex(const tinyobj::attrib_t& someAttributes, const tinyobj::index_t& anIndex)
+    {
+        Vertex vertex;
+        const std::size_t position = 3 * static_cast<std::size_t>(anIndex.vertex_index);
+        const std::size_t textureCoordinates = 2 * static_cast<std::size_t>(anIndex.texcoord_index);
+        vertex.myPosition = glm::vec3(someAttributes.vertices[position], someAttributes.vertices[position + 1], someAttributes.vertices[position + 2]);
+        vertex.myColor = glm::vec3(1.0f);
+        vertex.myTextureCoordinates = glm::vec2(someAttributes.texcoords[textureCoordinates], 1.0f - someAttributes.texcoords[textureCoordinates + 1]);
+        return vertex;
+    }
+
+    // The std::hash<Vertex> ModelLoader used before VertexHash::Hash, so the baseline keeps its collisions as well as its lookups
+    struct GlmCombinedVertexHash
+    {
+        size_t operator()(const Vertex& aVertex) const noexcept
+        {
+            return (std::hash<glm::vec3>()(aVertex.myPosition) ^ std::hash<glm::vec2>()(aVertex.myTextureCoordinates) << 1) >> 1;
+        }
+    };
+
+    // The lookups ModelLoader did before VertexWeldTable, a count followed by two subscripts and a node allocation per new vertex
+    void WeldWithUnorderedMap(const tinyobj::attrib_t& someAttributes, const std::vector<tinyobj::index_t>& someIndices, Mesh& aMesh)
+    {
+        std::unordered_map<Vertex, uint32_t, GlmCombinedVertexHash> uniqueVertices;
+        for (const tinyobj::index_t& index : someIndices)
+        {
+            const Vertex vertex = GetVertex(someAttributes, index);
+            if (uniqueVertices.count(vertex) == 0)
+            {
+                uniqueVertices[vertex] = static_cast<uint32_t>(aMesh.myVertices.size());
+                aMesh.myVertices.push_back(vertex);
+            }
+
+            aMesh.myIndices.push_back(uniqueVertices[vertex]);
+        }
+    }
+
+    void WeldWithTable(const tinyobj::attrib_t& someAttributes, const std::vector<tinyobj::index_t>& someIndices, Mesh& aMesh)
+    {
+        VertexWeldTable uniqueVertices(someIndices.size());
+        for (const tinyobj::index_t& index : someIndices)
+            aMesh.myIndices.push_back(uniqueVertices.Insert(GetVertex(someAttributes, index), aMesh.myVertices));
+    }
+}
+
+namespace VertexWeldBenchmark
+{
+    bool Run(int anIndexCount, const std::string& aReportFilepath)
+    {
+        if (JobSystem::GetInstance().GetWorkerCount() == 0)
+            LogUtility::PrintMessage(LogUtility::LogCategory::Core, "The job system has no workers, the parallel weld runs on the calling thread only");
+
+        tinyobj::attrib_t attributes;
+        std::vector<tinyobj::index_t> indices;
+        CreateGrid(anIndexCount, attributes, indices);
+
+        const Clock::time_point serialStartTime = Clock::now();
+        VertexWeldTable serialUniqueVertices(indices.size());
+        Mesh serialMesh;
+        VertexWelder::WeldSerial(attributes, indices, serialUniqueVertices, serialMesh);
+        const Clock::time_point serialEndTime = Clock::now();
+
+        VertexWeldTable parallelUniqueVertices(indices.size());
+        Mesh parallelMesh;
+        VertexWelder::WeldParallel(attributes, indices, parallelUniqueVertices, parallelMesh);
+        const Clock::time_point parallelEndTime = Clock::now();
+
+        // Compared byte for byte, since both paths have to hand the same buffers to the mesh cache and the GPU
+        const bool areVerticesEqual = serialMesh.myVertices.size() == parallelMesh.myVertices.size()
+            && std::memcmp(serialMesh.myVertices.data(), parallelMesh.myVertices.data(), serialMesh.myVertices.size() * sizeof(Vertex)) == 0;
+        if (!areVerticesEqual)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "The parallel weld produced %zu vertices that differ from the %zu of the serial one",
+                parallelMesh.myVertices.size(), serialMesh.myVertices.size());
+            return false;
+        }
+
+        if (serialMesh.myIndices != parallelMesh.myIndices)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "The parallel weld produced indices that differ from the serial one");
+            return false;
+        }
+
+        // Both build their vertices the same way, so the difference is only the lookups
+        const Clock::time_point mapStartTime = Clock::now();
+        Mesh mapMesh;
+        WeldWithUnorderedMap(attributes, indices, mapMesh);
+        const Clock::time_point mapEndTime = Clock::now();
+        Mesh tableMesh;
+        WeldWithTable(attributes, indices, tableMesh);
+        const Clock::time_point tableEndTime = Clock::now();
+
+        if (!(mapMesh.myVertices == tableMesh.myVertices) || mapMesh.myIndices != tableMesh.myIndices || tableMesh.myIndices != serialMesh.myIndices)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "VertexWeldTable welded differently from std::unordered_map");
+            return false;
+        }
+
+        BenchmarkReportWriter report(aReportFilepath);
+        if (!report.IsOpen())
+            return false;
+
+        report.WriteInteger("indices", indices.size());
+        report.WriteInteger("vertices", serialMesh.myVertices.size());
+        report.WriteInteger("workers", JobSystem::GetInstance().GetWorkerCount());
+        report.WriteNumber("serialMs", GetMilliseconds(serialStartTime, serialEndTime));
+        report.WriteNumber("parallelMs", GetMilliseconds(serialEndTime, parallelEndTime));
+        report.WriteNumber("unorderedMapMs", GetMilliseconds(mapStartTime, mapEndTime));
+        report.WriteNumber("weldTableMs", GetMilliseconds(mapEndTime, tableEndTime));
+        if (!report.Close())
+            return false;
+
+        LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Welded %zu indices into %zu vertices, serial %.2f ms, parallel %.2f ms, std::unordered_map %.2f ms, VertexWeldTable %.2f ms, report written to %s",
+            indices.size(), serialMesh.myVertices.size(), GetMilliseconds(serialStartTime, serialEndTime), GetMilliseconds(serialEndTime, parallelEndTime),
+            GetMilliseconds(mapStartTime, mapEndTime), GetMilliseconds(mapEndTime, tableEndTime), aReportFilepath.c_str());
+        return true;
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+// CPU-only benchmark of VertexWelder that needs no GL context. Generates an OBJ style grid whose positions are shared by
+// neighbouring quads and whose texture coordinates are split along seams, then welds it both serially and in parallel.
+// The same indices are then welded with VertexWeldTable and with the std::unordered_map lookups it replaced, which at
+// 10M indices is the comparison the table was built for. A run fails when the two weld paths do not produce bit-identical
+// vertices in the same order and identical indices, or when the table and the map disagree.
+namespace VertexWeldBenchmark
+{
+    bool Run(int anIndexCount, const std::string& aReportFilepath);
+}
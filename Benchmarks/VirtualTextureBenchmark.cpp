@@ -0,0 +1,319 @@
+#include "VirtualTextureBenchmark.h"
+
+#include "AppDefinitions.h"
+#include "Benchmark.h"
+#include "LogUtility.h"
+#include "VirtualTextureCache.h"
+#include "VirtualTexturePageFile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using BenchmarkTimer::Clock;
+    using BenchmarkTimer::GetMilliseconds;
+
+    constexpr int FrameCount = 300;
+    // The window stands still for the last frames, long enough for every tile it covers to arrive
+    constexpr int SettleFrameCount = 60;
+    constexpr int WindowWidth = 1280;
+    constexpr int WindowHeight = 720;
+
+    // Three channels, so the page file has to expand them, and a pattern that differs between neighbouring texels and tiles
+    std::vector<unsigned char> CreateImage(int aSize)
+    {
+        std::vector<unsigned char> pixels(static_cast<std::size_t>(aSize) * aSize * 3);
+        for (int y = 0; y < aSize; ++y)
+        {
+            for (int x = 0; x < aSize; ++x)
+            {
+                unsigned char* pixel = pixels.data() + (static_cast<std::size_t>(y) * aSize + x) * 3;
+                pixel[0] = static_cast<unsigned char>(x * 7 + y);
+                pixel[1] = static_cast<unsigned char>(y * 5 + (x >> 6));
+                pixel[2] = static_cast<unsigned char>((x >> 4) ^ (y >> 4));
+            }
+        }
+
+        return pixels;
+    }
+
+    // The mip chain the page file is expected to hold, built the simplest way rather than the way the page file builds it
+    std::vector<std::vector<unsigned char>> CreateReferenceLevels(const std::vector<unsigned char>& somePixels, int aSize, int aLevelCount)
+    {
+        std::vector<std::vector<unsigned char>> levels(1);
+        levels[0].resize(static_cast<std::size_t>(aSize) * aSize * 4);
+        for (std::size_t texel = 0; texel < static_cast<std::size_t>(aSize) * aSize; ++texel)
+        {
+            std::memcpy(levels[0].data() + texel * 4, somePixels.data() + texel * 3, 3);
+            levels[0][texel * 4 + 3] = 255;
+        }
+
+        for (int level = 1; level < aLevelCount; ++level)
+        {
+            const int sourceSize = std::max(aSize >> (level - 1), 1);
+            const int size = std::max(aSize >> level, 1);
+            const std::vector<unsigned char>& source = levels.back();
+            std::vector<unsigned char> pixels(static_cast<std::size_t>(size) * size * 4);
+            for (int y = 0; y < size; ++y)
+            {
+                for (int x = 0; x < size; ++x)
+                {
+                    for (int channel = 0; channel < 4; ++channel)
+                    {
+                        int sum = 0;
+                        for (int offset = 0; offset < 4; ++offset)
+                        {
+                            const int sourceX = std::min(x * 2 + offset % 2, sourceSize - 1);
+                            const int sourceY = std::min(y * 2 + offset / 2, sourceSize - 1);
+                            sum += source[(static_cast<std::size_t>(sourceY) * sourceSize + sourceX) * 4 + channel];
+                        }
+                        pixels[(static_cast<std::size_t>(y) * size + x) * 4 + channel] = static_cast<unsigned char>((sum + 2) / 4);
+                    }
+                }
+            }
+
+            levels.push_back(std::move(pixels));
+        }
+
+        return levels;
+    }
+
+    // Every texel of every tile, borders included, wrapping around the edges of its level
+    std::size_t CountTileMismatches(const VirtualTexturePageFile& aPageFile, const std::vector<std::vector<unsigned char>>& someReferenceLevels, int aSize)
+    {
+        std::size_t mismatchCount = 0;
+        for (int level = 0; level < aPageFile.GetLevelCount(); ++level)
+        {
+            const int size = std::max(aSize >> level, 1);
+            const std::vector<unsigned char>& reference = someReferenceLevels[level];
+            for (int tileY = 0; tileY < aPageFile.GetTileCountY(level); ++tileY)
+            {
+                for (int tileX = 0; tileX < aPageFile.GetTileCountX(level); ++tileX)
+                {
+                    const unsigned char* tile = aPageFile.GetTile(level, tileX, tileY);
+                    for (int y = 0; y < virtualTextureTileSize; ++y)
+                    {
+                        const int sourceY = ((tileY * VirtualTexturePageFile::TilePayloadSize - virtualTextureTileBorder + y) % size + size) % size;
+                        for (int x = 0; x < virtualTextureTileSize; ++x)
+                        {
+                            const int sourceX = ((tileX * VirtualTexturePageFile::TilePayloadSize - virtualTextureTileBorder + x) % size + size) % size;
+                            if (std::memcmp(tile + (static_cast<std::size_t>(y) * virtualTextureTileSize + x) * 4, reference.data() + (static_cast<std::size_t>(sourceY) * size + sourceX) * 4, 4) != 0)
+                                ++mismatchCount;
+                        }
+                    }
+                }
+            }
+        }
+
+        return mismatchCount;
+    }
+
+    // The tiles a screen sized window covers at aLevel, around a point given in texture coordinates, wrapping like GL_REPEAT
+    void AddWindowTiles(const std::vector<std::pair<int, int>>& someTileCounts, int aSize, int aLevel, float aU, float aV, std::vector<uint32_t>& someTiles)
+    {
+        const int size = std::max(aSize >> aLevel, 1);
+        const int firstX = static_cast<int>(aU * static_cast<float>(size)) - WindowWidth / 2;
+        const int firstY = static_cast<int>(aV * static_cast<float>(size)) - WindowHeight / 2;
+        const int tileCountX = someTileCounts[aLevel].first;
+        const int tileCountY = someTileCounts[aLevel].second;
+        for (int y = firstY; y < firstY + std::min(WindowHeight, size); y += VirtualTexturePageFile::TilePayloadSize / 2)
+        {
+            for (int x = firstX; x < firstX + std::min(WindowWidth, size); x += VirtualTexturePageFile::TilePayloadSize / 2)
+            {
+                const int wrappedX = (x % size + size) % size;
+                const int wrappedY = (y % size + size) % size;
+                someTiles.push_back(VirtualTextureTile::Pack(0, aLevel, std::min(wrappedX / VirtualTexturePageFile::TilePayloadSize, tileCountX - 1),
+                    std::min(wrappedY / VirtualTexturePageFile::TilePayloadSize, tileCountY - 1)));
+            }
+        }
+    }
+
+    // Every entry of every level has to name a resident tile, the tile itself or one of its ancestors
+    bool IsPageTableConsistent(const std::vector<unsigned char>& somePageTable, const std::vector<std::pair<int, int>>& someTileCounts,
+        const std::vector<uint32_t>& someSlotTiles, int aSlotsPerSide)
+    {
+        std::size_t entry = 0;
+        for (int level = 0; level < static_cast<int>(someTileCounts.size()); ++level)
+        {
+            for (int y = 0; y < someTileCounts[level].second; ++y)
+            {
+                for (int x = 0; x < someTileCounts[level].first; ++x, ++entry)
+                {
+                    const unsigned char* pageEntry = somePageTable.data() + entry * 4;
+                    const int residentLevel = pageEntry[2];
+                    const int slot = pageEntry[1] * aSlotsPerSide + pageEntry[0];
+                    if (pageEntry[3] != 255 || residentLevel < level || someSlotTiles[slot] != VirtualTextureTile::Pack(0, residentLevel, x >> (residentLevel - level), y >> (residentLevel - level)))
+                        return false;
+                }
+            }
+        }
+
+        return true;
+    }
+}
+
+namespace VirtualTextureBenchmark
+{
+    bool Run(int aSize, const std::string& aReportFilepath)
+    {
+        // The page file stamps itself with the source file, so a stand-in source has to exist while it is written and opened
+        const std::string sourcePath = (std::filesystem::temp_directory_path() / "VirtualTextureBenchmark.png").string();
+        {
+            std::ofstream stream(sourcePath, std::ios::binary | std::ios::trunc);
+            stream << "source";
+        }
+
+        const std::vector<unsigned char> pixels = CreateImage(aSize);
+        const Clock::time_point writeStartTime = Clock::now();
+        const bool isWritten = VirtualTexturePageFile::Write(sourcePath, pixels.data(), aSize, aSize, 3);
+        const Clock::time_point writeEndTime = Clock::now();
+
+        VirtualTexturePageFile pageFile;
+        const bool isOpen = isWritten && pageFile.Open(sourcePath);
+        std::error_code errorCode;
+        const std::uintmax_t pageFileBytes = std::filesystem::file_size(VirtualTexturePageFile::GetPageFilePath(sourcePath), errorCode);
+        std::filesystem::remove(sourcePath, errorCode);
+        if (!isOpen || pageFile.GetWidth() != aSize || pageFile.GetHeight() != aSize)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "The page file could not be written or opened again");
+            std::filesystem::remove(VirtualTexturePageFile::GetPageFilePath(sourcePath), errorCode);
+            return false;
+        }
+
+        const int levelCount = pageFile.GetLevelCount();
+        const std::size_t mismatchCount = CountTileMismatches(pageFile, CreateReferenceLevels(pixels, aSize, levelCount), aSize);
+
+        std::vector<std::pair<int, int>> tileCounts;
+        std::size_t tileCount = 0;
+        for (int level = 0; level < levelCount; ++level)
+        {
+            tileCounts.emplace_back(pageFile.GetTileCountX(level), pageFile.GetTileCountY(level));
+            tileCount += static_cast<std::size_t>(tileCounts.back().first) * tileCounts.back().second;
+        }
+
+        pageFile.Close();
+        std::filesystem::remove(VirtualTexturePageFile::GetPageFilePath(sourcePath), errorCode);
+        if (mismatchCount > 0)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "%zu texels of the page file differ from the reference mip chain", mismatchCount);
+            return false;
+        }
+
+        // What VirtualTextureSystem does with the feedback, minus the uploads. A model of the slots checks every load and eviction.
+        VirtualTextureCache cache(virtualTexturePhysicalTileCount);
+        std::vector<uint32_t> slotTiles(cache.GetSlotCount(), 0);
+        const uint32_t coarsestTile = VirtualTextureTile::Pack(0, levelCount - 1, 0, 0);
+        VirtualTextureCache::TileLoad coarsestLoad;
+        if (!cache.Pin(coarsestTile, coarsestLoad))
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "The coarsest tile could not be pinned");
+            return false;
+        }
+        slotTiles[coarsestLoad.mySlot] = coarsestTile;
+
+        std::vector<uint32_t> requestedTiles;
+        std::vector<VirtualTextureCache::TileLoad> loads;
+        std::vector<unsigned char> pageTable;
+        std::size_t maxResidentCount = 0;
+        std::size_t maxPendingCount = 0;
+        double updateMilliseconds = 0.0;
+        int failedFrame = -1;
+        for (int frame = 0; frame < FrameCount && failedFrame < 0; ++frame)
+        {
+            // Pans across the texture while zooming out a level at a time and snapping back in, then stops at full detail
+            const int movingFrame = std::min(frame, FrameCount - SettleFrameCount);
+            const int level = std::min((movingFrame / 40) % 4, levelCount - 1);
+            const float u = static_cast<float>(movingFrame) * 0.0037f;
+            const float v = static_cast<float>(movingFrame) * 0.0023f;
+
+            requestedTiles.clear();
+            AddWindowTiles(tileCounts, aSize, frame < FrameCount - SettleFrameCount ? level : 0, u - static_cast<float>(static_cast<int>(u)), v - static_cast<float>(static_cast<int>(v)), requestedTiles);
+            for (std::size_t tile = 0, windowTileCount = requestedTiles.size(); tile < windowTileCount; ++tile)
+            {
+                int x = VirtualTextureTile::GetX(requestedTiles[tile]);
+                int y = VirtualTextureTile::GetY(requestedTiles[tile]);
+                for (int ancestorLevel = VirtualTextureTile::GetLevel(requestedTiles[tile]) + 1; ancestorLevel + 1 < levelCount; ++ancestorLevel)
+                {
+                    x /= 2;
+                    y /= 2;
+                    requestedTiles.push_back(VirtualTextureTile::Pack(0, ancestorLevel, x, y));
+                }
+            }
+
+            loads.clear();
+            const Clock::time_point updateStartTime = Clock::now();
+            cache.Update(requestedTiles, virtualTextureTilesPerFrame, loads);
+            cache.BuildPageTable(0, tileCounts, pageTable);
+            updateMilliseconds += GetMilliseconds(updateStartTime, Clock::now());
+
+            bool isFrameValid = loads.size() <= virtualTextureTilesPerFrame && cache.GetResidentCount() <= cache.GetSlotCount() && cache.FindSlot(coarsestTile) == coarsestLoad.mySlot;
+            for (const VirtualTextureCache::TileLoad& load : loads)
+            {
+                const bool wasRequested = load.myEvictedTile != 0 && std::binary_search(requestedTiles.begin(), requestedTiles.end(), load.myEvictedTile);
+                isFrameValid = isFrameValid && slotTiles[load.mySlot] == load.myEvictedTile && load.myEvictedTile != coarsestTile && !wasRequested;
+                slotTiles[load.mySlot] = load.myTile;
+            }
+
+            isFrameValid = isFrameValid && IsPageTableConsistent(pageTable, tileCounts, slotTiles, cache.GetSlotsPerSide());
+            if (!isFrameValid)
+                failedFrame = frame;
+
+            maxResidentCount = std::max(maxResidentCount, cache.GetResidentCount());
+            maxPendingCount = std::max(maxPendingCount, cache.GetPendingCount());
+        }
+
+        if (failedFrame >= 0)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::Core, "The tile cache went wrong at frame %i", failedFrame);
+            return false;
+        }
+
+        // The window stood still at full detail, so its tiles have to resolve to themselves by now
+        for (const uint32_t tile : requestedTiles)
+        {
+            if (cache.FindSlot(tile) < 0)
+            {
+                LogUtility::PrintError(LogUtility::LogCategory::Core, "%zu tiles are still missing after the window stood still", cache.GetPendingCount());
+                return false;
+            }
+        }
+
+        // Against RGBA8 with a full mip chain, which is what loading the texture whole would keep in video memory
+        const double sourceBytes = static_cast<double>(aSize) * aSize * 4.0 * 4.0 / 3.0;
+        const std::size_t physicalBytes = cache.GetSlotCount() * VirtualTexturePageFile::TileByteSize;
+        const double writeMilliseconds = GetMilliseconds(writeStartTime, writeEndTime);
+
+        BenchmarkReportWriter report(aReportFilepath);
+        if (!report.IsOpen())
+            return false;
+
+        report.WriteInteger("size", aSize);
+        report.WriteInteger("levels", levelCount);
+        report.WriteInteger("tiles", tileCount);
+        report.WriteInteger("pageFileBytes", pageFileBytes);
+        report.WriteNumber("writeMs", writeMilliseconds, 2);
+        report.WriteInteger("frames", FrameCount);
+        report.WriteInteger("tileLoads", cache.GetLoadCount());
+        report.WriteInteger("tileEvictions", cache.GetEvictedCount());
+        report.WriteInteger("maxResidentTiles", maxResidentCount);
+        report.WriteInteger("maxPendingTiles", maxPendingCount);
+        report.WriteNumber("updateMsPerFrame", updateMilliseconds / FrameCount);
+        report.WriteInteger("physicalTextureBytes", physicalBytes);
+        report.WriteInteger("pageTableBytes", pageTable.size());
+        report.WriteNumber("wholeTextureBytes", sourceBytes, 0);
+        report.WriteNumber("videoMemoryRatio", sourceBytes / static_cast<double>(physicalBytes + pageTable.size()), 2);
+        if (!report.Close())
+            return false;
+
+        LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Cooked %ix%i into %zu tiles over %i levels in %.1f ms, streamed %zu tiles over %i frames in %.2f MB instead of %.2f MB, report written to %s",
+            aSize, aSize, tileCount, levelCount, writeMilliseconds, cache.GetLoadCount(), FrameCount, static_cast<double>(physicalBytes + pageTable.size()) / (1024.0 * 1024.0),
+            sourceBytes / (1024.0 * 1024.0), aReportFilepath.c_str());
+        return true;
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+// CPU-only benchmark of the virtual texture page file and tile cache that needs no GL context. Cooks a generated image into a
+// page file, checks every tile and its borders against a reference mip chain, then pans and zooms a screen sized window over
+// the texture for a few hundred frames, feeding the tiles it covers to a VirtualTextureCache the way the feedback pass would.
+// A run fails when a tile differs from the reference, when a frame loads more tiles than allowed, when a slot is handed out
+// while it still holds a pinned tile or one requested that frame, when a page table entry points at a slot that does not hold
+// the tile or ancestor it names, or when the window still has missing tiles after it has stood still for a while.
+namespace VirtualTextureBenchmark
+{
+    bool Run(int aSize, const std::string& aReportFilepath);
+}
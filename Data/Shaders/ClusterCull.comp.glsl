@@ -0,0 +1,132 @@
+#version 450 core
+
+// Tests every meshlet of every instance against the view frustum and its normal cone against the camera, and appends the
+// visible ones as single-instance commands to the command range of their draw
+layout (local_size_x = 64) in;
+
+// Mirrors DrawElementsIndirectCommand
+struct DrawCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+// Mirrors ModelInstance
+struct Instance
+{
+    mat4 transform;
+    vec4 color;
+};
+
+// Mirrors Meshlet
+struct Meshlet
+{
+    vec4 sphere;
+    vec4 cone;
+    uint firstIndex;
+    uint indexCount;
+    uint padding0;
+    uint padding1;
+};
+
+// Mirrors ClusterDraw
+struct ClusterDraw
+{
+    uint firstMeshlet;
+    uint meshletCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+    uint instanceCount;
+    uint commandOffset;
+    uint padding;
+    vec4 quantizationCenter;
+    vec4 quantizationInverseExtents;
+};
+
+// Shared by every program, see FrameUniformBuffer
+layout (std140, binding = 0) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 cameraPosition;
+};
+
+layout (std430, binding = 0) readonly buffer Meshlets { Meshlet meshlets[]; };
+layout (std430, binding = 1) readonly buffer Instances { Instance instances[]; };
+layout (std430, binding = 2) readonly buffer Draws { ClusterDraw draws[]; };
+layout (std430, binding = 3) writeonly buffer Commands { DrawCommand commands[]; };
+layout (std430, binding = 4) buffer DrawCounts { uint drawCounts[]; };
+
+uniform int uDrawCount;
+uniform int uItemCount;
+
+// The draw whose command range contains anItem, the ranges are sorted and contiguous
+uint FindDraw(uint anItem)
+{
+    uint low = 0u;
+    uint high = uint(uDrawCount) - 1u;
+    while (low < high)
+    {
+        uint middle = (low + high + 1u) / 2u;
+        if (draws[middle].commandOffset <= anItem)
+            low = middle;
+        else
+            high = middle - 1u;
+    }
+
+    return low;
+}
+
+bool IsOutsideFrustum(vec3 aCenter, float aRadius)
+{
+    // Gribb and Hartmann, the planes are the sums and differences of the last row with the others
+    mat4 rows = transpose(viewProjection);
+    for (int plane = 0; plane < 6; ++plane)
+    {
+        vec4 equation = rows[3] + ((plane & 1) == 0 ? rows[plane / 2] : -rows[plane / 2]);
+        if (dot(equation.xyz, aCenter) + equation.w < -aRadius * length(equation.xyz))
+            return true;
+    }
+
+    return false;
+}
+
+void main()
+{
+    uint item = gl_GlobalInvocationID.x;
+    if (item >= uint(uItemCount))
+        return;
+
+    uint drawIndex = FindDraw(item);
+    ClusterDraw draw = draws[drawIndex];
+    uint local = item - draw.commandOffset;
+    uint instance = draw.baseInstance + local / draw.meshletCount;
+    Meshlet meshlet = meshlets[draw.firstMeshlet + local % draw.meshletCount];
+
+    // Instance transforms expect quantized positions, so object space bounds are quantized before they are transformed
+    mat4 transform = instances[instance].transform;
+    vec3 inverseExtents = draw.quantizationInverseExtents.xyz;
+    vec3 center = (transform * vec4((meshlet.sphere.xyz - draw.quantizationCenter.xyz) * inverseExtents, 1.0)).xyz;
+    mat3 linear = mat3(transform[0].xyz * inverseExtents.x, transform[1].xyz * inverseExtents.y, transform[2].xyz * inverseExtents.z);
+    float radius = meshlet.sphere.w * max(max(length(linear[0]), length(linear[1])), length(linear[2]));
+
+    if (IsOutsideFrustum(center, radius))
+        return;
+
+    // The cone axis is only rotated correctly when the transform scales uniformly, which every instance in this scene does
+    if (meshlet.cone.w < 1.0)
+    {
+        vec3 axis = normalize(linear * meshlet.cone.xyz);
+        vec3 toCenter = center - cameraPosition.xyz;
+        if (dot(toCenter, axis) >= meshlet.cone.w * length(toCenter) + radius)
+            return;
+    }
+
+    uint slot = atomicAdd(drawCounts[drawIndex], 1u);
+    commands[draw.commandOffset + slot] = DrawCommand(meshlet.indexCount, 1u, draw.firstIndex + meshlet.firstIndex, draw.baseVertex, instance);
+}
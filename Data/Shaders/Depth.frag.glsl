@@ -0,0 +1,6 @@
+#version 450 core
+
+// Occluders only write depth, see OcclusionCuller
+void main()
+{
+}
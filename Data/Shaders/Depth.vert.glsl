@@ -0,0 +1,18 @@
+#version 450 core
+
+layout (location = 0) in vec3 aPosition;
+layout (location = 3) in mat4 aInstanceTransform;
+
+// Shared by every program, see FrameUniformBuffer
+layout (std140, binding = 0) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 cameraPosition;
+};
+
+void main()
+{
+    gl_Position = viewProjection * aInstanceTransform * vec4(aPosition, 1.0);
+}
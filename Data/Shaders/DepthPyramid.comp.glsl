@@ -0,0 +1,37 @@
+#version 450 core
+
+// Reduces one level of the depth pyramid into the next by keeping the farthest depth.
+// With a scale of 1 it copies the occluder depth buffer into level 0 instead.
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (binding = 0) uniform sampler2D uSource;
+layout (r32f, binding = 0) uniform writeonly image2D uDestination;
+
+uniform int uSourceLevel;
+uniform int uScale;
+
+void main()
+{
+    ivec2 destinationSize = imageSize(uDestination);
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(texel, destinationSize)))
+        return;
+
+    // The last row and column also cover the leftover texels of odd source sizes, so no source texel is skipped
+    ivec2 sourceSize = textureSize(uSource, uSourceLevel);
+    ivec2 first = texel * uScale;
+    ivec2 last = first + ivec2(uScale - 1);
+    if (texel.x == destinationSize.x - 1)
+        last.x = sourceSize.x - 1;
+    if (texel.y == destinationSize.y - 1)
+        last.y = sourceSize.y - 1;
+
+    float depth = 0.0;
+    for (int y = first.y; y <= last.y; ++y)
+    {
+        for (int x = first.x; x <= last.x; ++x)
+            depth = max(depth, texelFetch(uSource, ivec2(x, y), uSourceLevel).r);
+    }
+
+    imageStore(uDestination, texel, vec4(depth));
+}
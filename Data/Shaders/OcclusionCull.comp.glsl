@@ -0,0 +1,99 @@
+#version 450 core
+
+// Tests every candidate instance against the depth pyramid and appends the visible ones to the range of their draw command
+layout (local_size_x = 64) in;
+
+// Mirrors DrawElementsIndirectCommand
+struct DrawCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+// Mirrors ModelInstance
+struct Instance
+{
+    mat4 transform;
+    vec4 color;
+};
+
+// Shared by every program, see FrameUniformBuffer
+layout (std140, binding = 0) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 cameraPosition;
+};
+
+layout (std430, binding = 0) readonly buffer CandidateInstances { Instance candidateInstances[]; };
+// World space minimum and maximum corner of each candidate
+layout (std430, binding = 1) readonly buffer CandidateBounds { vec4 candidateBounds[]; };
+layout (std430, binding = 2) readonly buffer CandidateCommands { uint candidateCommands[]; };
+layout (std430, binding = 3) buffer Commands { DrawCommand commands[]; };
+layout (std430, binding = 4) writeonly buffer VisibleInstances { Instance visibleInstances[]; };
+
+layout (binding = 0) uniform sampler2D uDepthPyramid;
+
+uniform int uCandidateCount;
+
+// Mirrors NoCommand in OcclusionCuller.cpp, marks candidates that are drawn by the cluster culling pass instead
+const uint NoCommand = 0xFFFFFFFFu;
+
+bool IsOccluded(vec3 aMin, vec3 aMax)
+{
+    vec2 screenMin = vec2(1.0e30);
+    vec2 screenMax = vec2(-1.0e30);
+    float nearestDepth = 1.0;
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        vec3 position = vec3((corner & 1) != 0 ? aMax.x : aMin.x, (corner & 2) != 0 ? aMax.y : aMin.y, (corner & 4) != 0 ? aMax.z : aMin.z);
+        vec4 clipPosition = viewProjection * vec4(position, 1.0);
+
+        // Boxes reaching behind the camera cannot be projected to a screen rectangle and are always drawn
+        if (clipPosition.w <= 0.0)
+            return false;
+
+        vec3 ndcPosition = clipPosition.xyz / clipPosition.w;
+        screenMin = min(screenMin, ndcPosition.xy * 0.5 + 0.5);
+        screenMax = max(screenMax, ndcPosition.xy * 0.5 + 0.5);
+        nearestDepth = min(nearestDepth, ndcPosition.z * 0.5 + 0.5);
+    }
+
+    ivec2 size = textureSize(uDepthPyramid, 0);
+    ivec2 texelMin = clamp(ivec2(screenMin * vec2(size)), ivec2(0), size - 1);
+    ivec2 texelMax = clamp(ivec2(screenMax * vec2(size)), ivec2(0), size - 1);
+
+    // Pick the finest level where the rectangle spans at most 2x2 texels, so four fetches cover all of it
+    ivec2 span = texelMax - texelMin;
+    int levelCount = textureQueryLevels(uDepthPyramid);
+    int level = max(findMSB(max(span.x, span.y)), 0);
+    while (level + 1 < levelCount && any(greaterThan((texelMax >> level) - (texelMin >> level), ivec2(1))))
+        ++level;
+
+    ivec2 levelMax = textureSize(uDepthPyramid, level) - 1;
+    ivec2 low = min(texelMin >> level, levelMax);
+    ivec2 high = min(texelMax >> level, levelMax);
+    float farthestDepth = max(max(texelFetch(uDepthPyramid, low, level).r, texelFetch(uDepthPyramid, ivec2(high.x, low.y), level).r),
+        max(texelFetch(uDepthPyramid, ivec2(low.x, high.y), level).r, texelFetch(uDepthPyramid, high, level).r));
+
+    return nearestDepth > farthestDepth;
+}
+
+void main()
+{
+    uint candidate = gl_GlobalInvocationID.x;
+    if (candidate >= uint(uCandidateCount) || candidateCommands[candidate] == NoCommand)
+        return;
+
+    if (IsOccluded(candidateBounds[candidate * 2].xyz, candidateBounds[candidate * 2 + 1].xyz))
+        return;
+
+    // Command ranges do not overlap, so compacting within a range cannot write over another command's instances
+    uint command = candidateCommands[candidate];
+    uint slot = atomicAdd(commands[command].instanceCount, 1u);
+    visibleInstances[commands[command].baseInstance + slot] = candidateInstances[candidate];
+}
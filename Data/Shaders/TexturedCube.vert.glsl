@@ -1,19 +1,26 @@
-#version 460 core
+#version 450 core
 
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec4 aVertexColor;
 layout (location = 2) in vec2 aTextureCoordinates;
+layout (location = 3) in mat4 aInstanceTransform;
+layout (location = 7) in vec4 aInstanceColor;
 
 out vec4 vertexColor;
 out vec2 textureCoordinates;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Shared by every program, see FrameUniformBuffer
+layout (std140, binding = 0) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 cameraPosition;
+};
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPosition, 1.0);
-    vertexColor = aVertexColor;
+    gl_Position = viewProjection * aInstanceTransform * vec4(aPosition, 1.0);
+    vertexColor = aVertexColor * aInstanceColor;
     textureCoordinates = aTextureCoordinates;
 }
@@ -0,0 +1,44 @@
+#version 450 core
+
+in vec4 vertexColor;
+in vec2 textureCoordinates;
+
+out vec4 fragmentColor;
+
+// These have to match virtualTextureTileSize and virtualTextureTileBorder in AppDefinitions.h
+const float TileSize = 128.0;
+const float TileBorder = 4.0;
+const float TilePayloadSize = TileSize - 2.0 * TileBorder;
+
+// One texel per tile and level, holding the slot of the tile or of its closest resident ancestor in the physical texture
+// and the level that one is from, see VirtualTextureCache::BuildPageTable
+layout (binding = 0) uniform usampler2D uPageTable;
+layout (binding = 1) uniform sampler2D uPhysicalTexture;
+
+uniform vec2 uVirtualTextureSize;
+uniform int uVirtualTextureLevelCount;
+uniform float uPhysicalTileCount;
+
+vec2 GetLevelSize(float aLevel)
+{
+    return max(floor(uVirtualTextureSize / exp2(aLevel)), vec2(1.0));
+}
+
+void main()
+{
+    // Picked from the unwrapped coordinates, the derivatives of the wrapped ones jump at every seam
+    vec2 texelsX = dFdx(textureCoordinates * uVirtualTextureSize);
+    vec2 texelsY = dFdy(textureCoordinates * uVirtualTextureSize);
+    float level = floor(0.5 * log2(max(dot(texelsX, texelsX), dot(texelsY, texelsY))));
+    level = clamp(level, 0.0, float(uVirtualTextureLevelCount - 1));
+
+    vec2 coordinates = fract(textureCoordinates);
+    ivec2 tile = ivec2(coordinates * GetLevelSize(level) / TilePayloadSize);
+    uvec4 page = texelFetch(uPageTable, tile, int(level));
+
+    // The page points at a coarser level while the tile itself is not resident yet
+    vec2 residentTexel = coordinates * GetLevelSize(float(page.b));
+    vec2 tileTexel = residentTexel - floor(residentTexel / TilePayloadSize) * TilePayloadSize;
+    vec2 physicalTexel = vec2(page.rg) * TileSize + TileBorder + tileTexel;
+    fragmentColor = textureLod(uPhysicalTexture, physicalTexel / (uPhysicalTileCount * TileSize), 0.0) * vertexColor;
+}
@@ -0,0 +1,29 @@
+#version 450 core
+
+in vec2 textureCoordinates;
+
+// The tile the color pass samples at this texel, packed like VirtualTextureTile::Pack
+layout (location = 0) out uint feedbackTile;
+
+// These have to match virtualTextureTileSize and virtualTextureTileBorder in AppDefinitions.h
+const float TileSize = 128.0;
+const float TileBorder = 4.0;
+const float TilePayloadSize = TileSize - 2.0 * TileBorder;
+
+uniform vec2 uVirtualTextureSize;
+uniform int uVirtualTextureLevelCount;
+uniform int uVirtualTextureIndex;
+// Makes up for the smaller target, whose derivatives are larger than the ones of the color pass
+uniform float uLevelBias;
+
+void main()
+{
+    vec2 texelsX = dFdx(textureCoordinates * uVirtualTextureSize);
+    vec2 texelsY = dFdy(textureCoordinates * uVirtualTextureSize);
+    float level = floor(0.5 * log2(max(dot(texelsX, texelsX), dot(texelsY, texelsY))) + uLevelBias);
+    level = clamp(level, 0.0, float(uVirtualTextureLevelCount - 1));
+
+    vec2 levelSize = max(floor(uVirtualTextureSize / exp2(level)), vec2(1.0));
+    uvec2 tile = uvec2(fract(textureCoordinates) * levelSize / TilePayloadSize);
+    feedbackTile = uint(uVirtualTextureIndex + 1) << 24 | uint(level) << 20 | tile.y << 10 | tile.x;
+}
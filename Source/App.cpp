@@ -3,10 +3,12 @@
 #include <filesystem>
 
 #include "LogUtility.h"
+#include "Profiler.h"
 #include "RenderMate.h"
 
-App::App()
-	: myRenderMate(nullptr)
+App::App(const AppSettings& someSettings)
+	: mySettings(someSettings)
+	, myRenderMate(nullptr)
 	, myShouldDestroy(false)
 {
 }
@@ -18,33 +20,46 @@ App::~App()
 
 void App::Initialize()
 {
-#if _WIN32
-	const char* bits = "x86";
-#elif _WIN64
-	const char* bits = "x64";
+	Profiler::SetThreadName("Main");
+
+#if _WIN64
+	const char* platform = "Windows x64";
+#elif _WIN32
+	const char* platform = "Windows x86";
+#elif __linux__
+	const char* platform = "Linux";
+#else
+	const char* platform = "Unknown";
 #endif
 
-	LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Windows %s", bits);
+	LogUtility::PrintMessage(LogUtility::LogCategory::Core, "%s", platform);
+	if (mySettings.myIsHeadless)
+		LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Running headless for %i frames with a timestep of %f", mySettings.myFrameCount, mySettings.myFixedTimestep);
 	LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Current working directory: %s", std::filesystem::current_path().string().c_str());
 
 	myRenderMate = new RenderMate();
-	myRenderMate->Initialize();
+	myRenderMate->Initialize(mySettings);
 }
 
 void App::Run()
 {
 	auto previousTime = std::chrono::high_resolution_clock::now();
+	int frameIndex = 0;
 
 	while (!myShouldDestroy)
 	{
+		PROFILE_SCOPE("Frame");
+
 		auto currentTime = std::chrono::high_resolution_clock::now();
 		auto elapsedTime = currentTime - previousTime;
-		const float deltaTime = std::chrono::duration<float>(elapsedTime).count();
+		const float deltaTime = mySettings.myFixedTimestep > 0.0f ? mySettings.myFixedTimestep : std::chrono::duration<float>(elapsedTime).count();
 		previousTime = currentTime;
 
 		myRenderMate->Update(deltaTime);
+		++frameIndex;
 
-		myShouldDestroy = myRenderMate->ShouldClose();
+		const bool hasRenderedAllFrames = mySettings.myFrameCount > 0 && frameIndex >= mySettings.myFrameCount;
+		myShouldDestroy = myRenderMate->ShouldClose() || hasRenderedAllFrames;
 	}
 }
 
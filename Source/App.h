@@ -1,11 +1,13 @@
 #pragma once
 
+#include "AppSettings.h"
+
 class RenderMate;
 
 class App
 {
 public:
-	App();
+	App(const AppSettings& someSettings);
 	~App();
 
 	void Initialize();
@@ -13,6 +15,7 @@ public:
 	void Destroy() const;
 
 private:
+	AppSettings mySettings;
 	RenderMate* myRenderMate;
 	bool myShouldDestroy;
 };
@@ -1,4 +1,44 @@
 #pragma once
 
+#include <cstddef>
+
 static constexpr int screenWidth = 1280;
 static constexpr int screenHeight = 720;
+// Default for the bytes of meshes and textures the streamer uploads each frame, see AppSettings::myUploadByteBudget
+static constexpr std::size_t uploadBytesPerFrame = 16 * 1024 * 1024;
+// Staging memory uploads are copied into, enough for several frames at the upload budget before it has to wait for the GPU
+static constexpr std::size_t uploadRingBytes = 64 * 1024 * 1024;
+// Decoded texture bytes allowed to wait for their upload at once, so large batches of textures cannot spike memory
+static constexpr std::size_t textureDecodeBytesInFlight = 256 * 1024 * 1024;
+// Video memory textures may keep resident, textures nothing references any more are evicted beyond it
+static constexpr std::size_t textureResidentBytes = 512 * 1024 * 1024;
+static constexpr const char* profilerCaptureFilepath = "ProfilerCapture.json";
+// Largest instances drawn into the occlusion culling depth buffer each frame
+static constexpr std::size_t maxOccluderCount = 64;
+// Levels of detail per mesh including the original, and how far apart in pixels of error their switch points are
+static constexpr std::size_t maxLodCount = 4;
+static constexpr float lodPixelError = 1.0f;
+static constexpr float lodHysteresis = 0.25f;
+// Meshes with more vertices are split into parts that each fit 16-bit indices, 0 keeps them whole with 32-bit indices instead
+static constexpr std::size_t meshSplitVertexCount = 65536;
+// Meshes with at least meshletMinimumTriangleCount triangles are split into clusters this size, which the GPU culls one by one
+static constexpr std::size_t meshletMaxVertexCount = 64;
+static constexpr std::size_t meshletMaxTriangleCount = 124;
+static constexpr std::size_t meshletMinimumTriangleCount = 8192;
+// Cluster culling writes one command per cluster and instance, draws that would need more fall back to whole meshes
+static constexpr std::size_t maxClusterCommandCount = 1 << 20;
+// With virtual texturing, textures at least this wide or tall are streamed in tiles through one shared physical tile cache
+static constexpr int virtualTextureMinimumSize = 4096;
+// Tiles per side of the physical tile cache, which bounds the video memory of all virtual textures together
+static constexpr int virtualTexturePhysicalTileCount = 32;
+// Tiles loaded into the physical tile cache each frame, the rest of the requests wait for the next frames
+static constexpr std::size_t virtualTextureTilesPerFrame = 32;
+// The feedback pass renders at this fraction of the screen size
+static constexpr int virtualTextureFeedbackScale = 8;
+
+// Virtual texture tiles are this many texels wide including a border on every side, these have to match the VirtualTexture shaders in Data/Shaders
+static constexpr int virtualTextureTileSize = 128;
+static constexpr int virtualTextureTileBorder = 4;
+
+// Uniform block binding points, these have to match the layout qualifiers in Data/Shaders
+static constexpr unsigned int frameDataBindingPoint = 0;
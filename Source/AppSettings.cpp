@@ -0,0 +1,133 @@
+#include "AppSettings.h"
+
+#include "AppDefinitions.h"
+#include "LogUtility.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+AppSettings::AppSettings()
+	: myModelFilepaths{ "Data/Models/MagicCube/MagicCube.obj" }
+	, myFrameCount(0)
+	, myInstanceCount(1)
+	, myTextureDecodeByteBudget(textureDecodeBytesInFlight)
+	, myTextureByteBudget(textureResidentBytes)
+	, myUploadByteBudget(uploadBytesPerFrame)
+	, myFixedTimestep(0.0f)
+	, myIsHeadless(false)
+	, myIsInstancingEnabled(true)
+	, myIsMultiDrawEnabled(true)
+	, myIsOcclusionCullingEnabled(false)
+	, myIsLodEnabled(true)
+	, myIsClusterCullingEnabled(true)
+	, myIsTextureCompressionEnabled(true)
+	, myIsVirtualTexturingEnabled(false)
+{
+}
+
+bool AppSettings::ParseCommandLine(int anArgumentCount, char** someArguments)
+{
+	bool hasModelArgument = false;
+	for (int i = 1; i < anArgumentCount; ++i)
+	{
+		const char* argument = someArguments[i];
+		const bool hasValue = i + 1 < anArgumentCount;
+		if (std::strcmp(argument, "--model") == 0 && hasValue)
+		{
+			// The first model on the command line replaces the default one
+			if (!hasModelArgument)
+				myModelFilepaths.clear();
+
+			myModelFilepaths.emplace_back(someArguments[++i]);
+			hasModelArgument = true;
+		}
+		else if (std::strcmp(argument, "--headless") == 0)
+		{
+			myIsHeadless = true;
+		}
+		else if (std::strcmp(argument, "--frames") == 0 && hasValue)
+		{
+			myFrameCount = std::atoi(someArguments[++i]);
+		}
+		else if (std::strcmp(argument, "--timestep") == 0 && hasValue)
+		{
+			myFixedTimestep = static_cast<float>(std::atof(someArguments[++i]));
+		}
+		else if (std::strcmp(argument, "--instances") == 0 && hasValue)
+		{
+			myInstanceCount = std::max(std::atoi(someArguments[++i]), 1);
+		}
+		else if (std::strcmp(argument, "--no-instancing") == 0)
+		{
+			myIsInstancingEnabled = false;
+		}
+		else if (std::strcmp(argument, "--no-multidraw") == 0)
+		{
+			myIsMultiDrawEnabled = false;
+		}
+		else if (std::strcmp(argument, "--occlusion-culling") == 0)
+		{
+			myIsOcclusionCullingEnabled = true;
+		}
+		else if (std::strcmp(argument, "--no-lod") == 0)
+		{
+			myIsLodEnabled = false;
+		}
+		else if (std::strcmp(argument, "--no-cluster-culling") == 0)
+		{
+			myIsClusterCullingEnabled = false;
+		}
+		else if (std::strcmp(argument, "--no-texture-compression") == 0)
+		{
+			myIsTextureCompressionEnabled = false;
+		}
+		else if (std::strcmp(argument, "--virtual-texturing") == 0)
+		{
+			myIsVirtualTexturingEnabled = true;
+		}
+		else if (std::strcmp(argument, "--texture-decode-budget") == 0 && hasValue)
+		{
+			myTextureDecodeByteBudget = static_cast<std::size_t>(std::max(std::atoi(someArguments[++i]), 1)) * 1024 * 1024;
+		}
+		else if (std::strcmp(argument, "--texture-budget") == 0 && hasValue)
+		{
+			myTextureByteBudget = static_cast<std::size_t>(std::max(std::atoi(someArguments[++i]), 1)) * 1024 * 1024;
+		}
+		else if (std::strcmp(argument, "--upload-budget") == 0 && hasValue)
+		{
+			myUploadByteBudget = static_cast<std::size_t>(std::max(std::atoi(someArguments[++i]), 1)) * 1024 * 1024;
+		}
+		else if (std::strcmp(argument, "--output") == 0 && hasValue)
+		{
+			myFrameOutputDirectory = someArguments[++i];
+		}
+		else
+		{
+			LogUtility::PrintError(LogUtility::LogCategory::Core, "Unknown or incomplete argument %s", argument);
+			LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Usage: [--model filepath]... [--headless] [--frames count] [--timestep seconds] [--instances count] [--no-instancing] [--no-multidraw] [--occlusion-culling] [--no-lod] [--no-cluster-culling] [--no-texture-compression] [--virtual-texturing] [--texture-decode-budget megabytes] [--texture-budget megabytes] [--upload-budget megabytes] [--output directory]");
+			return false;
+		}
+	}
+
+	// Headless runs are meant to be reproducible, so they always advance by a fixed timestep,
+	// and since there is no window to close they have to end after a fixed number of frames
+	if (myIsHeadless && myFixedTimestep <= 0.0f)
+		myFixedTimestep = 1.0f / 60.0f;
+
+	if (myIsHeadless && myFrameCount <= 0)
+		myFrameCount = 60;
+
+	// Occlusion culling writes the counts of indirect commands, so it needs the multi-draw path
+	if (myIsOcclusionCullingEnabled && (!myIsInstancingEnabled || !myIsMultiDrawEnabled))
+	{
+		LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Occlusion culling requires instancing and multi-draw, disabling it");
+		myIsOcclusionCullingEnabled = false;
+	}
+
+	// Cluster culling writes whole indirect commands, large meshes are drawn whole without the multi-draw path
+	if (myIsClusterCullingEnabled && (!myIsInstancingEnabled || !myIsMultiDrawEnabled))
+		myIsClusterCullingEnabled = false;
+
+	return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct AppSettings
+{
+	AppSettings();
+
+	// Returns false when the command line could not be parsed
+	bool ParseCommandLine(int anArgumentCount, char** someArguments);
+
+	std::vector<std::string> myModelFilepaths;
+	std::string myFrameOutputDirectory;
+	int myFrameCount;
+	int myInstanceCount;
+	std::size_t myTextureDecodeByteBudget;
+	std::size_t myTextureByteBudget;
+	std::size_t myUploadByteBudget;
+	float myFixedTimestep;
+	bool myIsHeadless;
+	bool myIsInstancingEnabled;
+	bool myIsMultiDrawEnabled;
+	bool myIsOcclusionCullingEnabled;
+	bool myIsLodEnabled;
+	bool myIsClusterCullingEnabled;
+	bool myIsTextureCompressionEnabled;
+	bool myIsVirtualTexturingEnabled;
+};
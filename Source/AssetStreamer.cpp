@@ -0,0 +1,231 @@
+#include "AssetStreamer.h"
+
+#include "FileUtility.h"
+#include "GeometryPool.h"
+#include "JobSystem.h"
+#include "LogUtility.h"
+#include "Mesh.h"
+#include "Model.h"
+#include "ModelLoader.h"
+#include "PackedVertex.h"
+#include "Profiler.h"
+#include "Texture.h"
+#include "Vertex.h"
+
+#include <limits>
+
+AssetStreamer::AssetStreamer(TextureLoader& aTextureLoader, GeometryPool& aGeometryPool, std::size_t aTextureDecodeByteBudget)
+    : myTextureLoader(aTextureLoader)
+    , myGeometryPool(aGeometryPool)
+    , myTextureDecoder(aTextureLoader, aTextureDecodeByteBudget)
+    , myUploadedBytes(0)
+    , myInFlightCount(0)
+{
+}
+
+AssetStreamer::~AssetStreamer()
+{
+    // Jobs still reference this streamer, so wait for them before going away
+    std::unique_lock<std::mutex> lock(myMutex);
+    myCondition.wait(lock, [this]() { return myInFlightCount == 0; });
+}
+
+void AssetStreamer::Destroy()
+{
+    for (const std::pair<const std::string, unsigned int>& textureIdentifier : myTextureIdentifiers)
+        myTextureLoader.ReleaseTexture(textureIdentifier.second);
+
+    myTextureIdentifiers.clear();
+    myPendingModels.clear();
+    myDecodedTextures.clear();
+}
+
+void AssetStreamer::RequestModel(const std::string& aFilepath)
+{
+    {
+        const std::lock_guard<std::mutex> lock(myMutex);
+        ++myInFlightCount;
+    }
+
+    JobSystem::GetInstance().Schedule([this, aFilepath]() { LoadModel(aFilepath); });
+}
+
+void AssetStreamer::ProcessUploads(std::size_t aByteBudget, std::vector<std::shared_ptr<Model>>& someReadyModels)
+{
+    PROFILE_FUNCTION();
+
+    RequestTextures();
+
+    std::vector<TextureData> decodedTextures;
+    myTextureDecoder.TakeDecodedTextures(decodedTextures);
+    for (TextureData& textureData : decodedTextures)
+        myDecodedTextures.emplace_back(std::move(textureData));
+
+    // Always upload at least one item per frame so assets larger than the budget still make progress
+    std::size_t uploadedBytes = 0;
+    while (!myDecodedTextures.empty())
+    {
+        if (uploadedBytes > 0 && uploadedBytes >= aByteBudget)
+            return;
+
+        const TextureData& textureData = myDecodedTextures.front();
+        const unsigned int textureIdentifier = myTextureLoader.UploadTexture(textureData);
+        if (!myTextureIdentifiers.emplace(textureData.myPath, textureIdentifier).second)
+            myTextureLoader.ReleaseTexture(textureIdentifier);
+        uploadedBytes += textureData.GetSize();
+        myUploadedBytes += textureData.GetSize();
+
+        // The decoded bytes only leave the decode budget once they are freed, which lets further textures start decoding
+        const std::string path = textureData.myPath;
+        myDecodedTextures.pop_front();
+        myTextureDecoder.Release(path);
+    }
+
+    while (!myPendingModels.empty())
+    {
+        PendingModel& pendingModel = *myPendingModels.front();
+        std::vector<Mesh>& meshes = pendingModel.myModel->myMeshes;
+        while (pendingModel.myNextMesh < meshes.size())
+        {
+            if (uploadedBytes > 0 && uploadedBytes >= aByteBudget)
+                return;
+
+            Mesh& mesh = meshes[pendingModel.myNextMesh++];
+            mesh.myGeometryAllocation = myGeometryPool.Allocate(mesh.myVertices, mesh.myBounds, mesh.myIndices);
+            const std::size_t vertexStride = mesh.myGeometryAllocation.myHasVertexColors ? PackedVertex::StrideWithColor : PackedVertex::StrideWithoutColor;
+            std::size_t meshBytes = mesh.myVertices.size() * vertexStride + mesh.myIndices.size() * mesh.myGeometryAllocation.GetIndexSize();
+            if (!mesh.myMeshlets.empty())
+            {
+                myGeometryPool.AllocateMeshlets(mesh.myGeometryAllocation, mesh.myMeshlets);
+                meshBytes += mesh.myMeshlets.size() * sizeof(Meshlet);
+            }
+            for (MeshLod& lod : mesh.myLods)
+            {
+                lod.myGeometryAllocation = myGeometryPool.AllocateIndices(mesh.myGeometryAllocation, lod.myIndices);
+                meshBytes += lod.myIndices.size() * lod.myGeometryAllocation.GetIndexSize();
+            }
+            uploadedBytes += meshBytes;
+            myUploadedBytes += meshBytes;
+        }
+
+        if (!ResolveTextures(pendingModel))
+            return;
+
+        someReadyModels.push_back(pendingModel.myModel);
+        myPendingModels.pop_front();
+    }
+
+    // Every model holds its own references by now, so the ones taken while streaming can be given back
+    if (!myTextureIdentifiers.empty() && IsIdle())
+    {
+        for (const std::pair<const std::string, unsigned int>& textureIdentifier : myTextureIdentifiers)
+            myTextureLoader.ReleaseTexture(textureIdentifier.second);
+
+        myTextureIdentifiers.clear();
+        myTextureDecoder.PrintStatistics();
+    }
+}
+
+void AssetStreamer::Flush(std::vector<std::shared_ptr<Model>>& someReadyModels)
+{
+    PROFILE_FUNCTION();
+
+    for (;;)
+    {
+        ProcessUploads(std::numeric_limits<std::size_t>::max(), someReadyModels);
+
+        if (IsIdle())
+            return;
+
+        {
+            std::unique_lock<std::mutex> lock(myMutex);
+            myCondition.wait(lock, [this]() { return myInFlightCount == 0 || !myLoadedModels.empty(); });
+        }
+
+        // Whatever is left after the models are loaded is a model waiting for its textures
+        myTextureDecoder.WaitForDecodedTextures();
+    }
+}
+
+bool AssetStreamer::IsIdle() const
+{
+    {
+        const std::lock_guard<std::mutex> lock(myMutex);
+        if (myInFlightCount != 0 || !myLoadedModels.empty())
+            return false;
+    }
+
+    return myPendingModels.empty() && myDecodedTextures.empty() && myTextureDecoder.IsIdle();
+}
+
+void AssetStreamer::LoadModel(const std::string& aFilepath)
+{
+    PROFILE_FUNCTION();
+
+    std::unique_ptr<PendingModel> pendingModel = std::make_unique<PendingModel>();
+    pendingModel->myModel = ModelLoader::LoadModelData(aFilepath);
+    pendingModel->myDirectory = FileUtility::GetDirectoryFromPath(aFilepath);
+
+    if (!pendingModel->myModel)
+        LogUtility::PrintError(LogUtility::LogCategory::File, "Failed to stream %s", aFilepath.c_str());
+
+    const std::lock_guard<std::mutex> lock(myMutex);
+    if (pendingModel->myModel)
+        myLoadedModels.emplace_back(std::move(pendingModel));
+
+    --myInFlightCount;
+    myCondition.notify_all();
+}
+
+void AssetStreamer::RequestTextures()
+{
+    std::deque<std::unique_ptr<PendingModel>> loadedModels;
+    {
+        const std::lock_guard<std::mutex> lock(myMutex);
+        loadedModels.swap(myLoadedModels);
+    }
+
+    // Textures that are still resident are only referenced again, the rest start decoding right away
+    for (std::unique_ptr<PendingModel>& pendingModel : loadedModels)
+    {
+        for (const Mesh& mesh : pendingModel->myModel->myMeshes)
+        {
+            for (const Texture& texture : mesh.myTextures)
+            {
+                const std::string path = pendingModel->myDirectory + texture.myPath;
+                if (myTextureIdentifiers.count(path) > 0)
+                    continue;
+
+                if (const unsigned int residentTexture = myTextureLoader.AcquireTexture(path))
+                    myTextureIdentifiers.emplace(path, residentTexture);
+                else
+                    myTextureDecoder.Request(path);
+            }
+        }
+
+        myPendingModels.emplace_back(std::move(pendingModel));
+    }
+}
+
+bool AssetStreamer::ResolveTextures(PendingModel& aPendingModel)
+{
+    for (const Mesh& mesh : aPendingModel.myModel->myMeshes)
+    {
+        for (const Texture& texture : mesh.myTextures)
+        {
+            if (myTextureIdentifiers.find(aPendingModel.myDirectory + texture.myPath) == myTextureIdentifiers.end())
+                return false;
+        }
+    }
+
+    for (Mesh& mesh : aPendingModel.myModel->myMeshes)
+    {
+        for (Texture& texture : mesh.myTextures)
+        {
+            texture.myIdentifier = myTextureIdentifiers.at(aPendingModel.myDirectory + texture.myPath);
+            myTextureLoader.AddTextureReference(texture.myIdentifier);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "TextureDecoder.h"
+#include "TextureLoader.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class GeometryPool;
+struct Model;
+
+// Loads models and decodes their textures on the job system, then uploads them to GL on the render thread within a per-frame byte budget.
+// Textures that are not resident any more decode independently of the model that asked for them and upload as soon as they are ready,
+// a model is handed out once its meshes are uploaded and every one of its textures has either been uploaded or failed to decode.
+// Each texture of a handed out model holds a reference in the TexturePool of the TextureLoader.
+class AssetStreamer
+{
+public:
+	AssetStreamer(TextureLoader& aTextureLoader, GeometryPool& aGeometryPool, std::size_t aTextureDecodeByteBudget);
+	~AssetStreamer();
+
+	// Gives back the texture references taken for models that are still uploading, must be called on the render thread while
+	// the GL context still exists. Their meshes stay in the GeometryPool, which only frees its buffers as a whole.
+	void Destroy();
+
+	void RequestModel(const std::string& aFilepath);
+
+	// Must be called on the render thread. Models whose data is fully uploaded are appended to someReadyModels.
+	void ProcessUploads(std::size_t aByteBudget, std::vector<std::shared_ptr<Model>>& someReadyModels);
+
+	// Blocks until every requested model is loaded and uploaded
+	void Flush(std::vector<std::shared_ptr<Model>>& someReadyModels);
+
+	[[nodiscard]] bool IsIdle() const;
+	[[nodiscard]] std::size_t GetUploadedBytes() const { return myUploadedBytes; }
+	[[nodiscard]] const TextureDecoder& GetTextureDecoder() const { return myTextureDecoder; }
+
+private:
+	struct PendingModel
+	{
+		std::shared_ptr<Model> myModel;
+		std::string myDirectory;
+		std::size_t myNextMesh = 0;
+	};
+
+	void LoadModel(const std::string& aFilepath);
+	// Moves the loaded models over to the render thread and requests the textures they need
+	void RequestTextures();
+	// Returns false while some of the textures of the model are still decoding or waiting for their upload
+	[[nodiscard]] bool ResolveTextures(PendingModel& aPendingModel);
+
+	std::deque<std::unique_ptr<PendingModel>> myLoadedModels;
+	// Only touched on the render thread. Every texture identifier holds a reference until streaming goes idle.
+	std::deque<std::unique_ptr<PendingModel>> myPendingModels;
+	std::deque<TextureData> myDecodedTextures;
+	std::unordered_map<std::string, unsigned int> myTextureIdentifiers;
+	mutable std::mutex myMutex;
+	std::condition_variable myCondition;
+	TextureLoader& myTextureLoader;
+	GeometryPool& myGeometryPool;
+	TextureDecoder myTextureDecoder;
+	std::size_t myUploadedBytes;
+	int myInFlightCount;
+};
@@ -0,0 +1,53 @@
+#include "BoundingBox.h"
+
+#include "Vertex.h"
+
+BoundingBox::BoundingBox()
+    : myMin(std::numeric_limits<float>::max())
+    , myMax(std::numeric_limits<float>::lowest())
+{
+}
+
+BoundingBox BoundingBox::FromVertices(const std::vector<Vertex>& someVertices)
+{
+    BoundingBox box;
+    for (const Vertex& vertex : someVertices)
+        box.Grow(vertex.myPosition);
+
+    return box;
+}
+
+void BoundingBox::Grow(const glm::vec3& aPoint)
+{
+    myMin = glm::min(myMin, aPoint);
+    myMax = glm::max(myMax, aPoint);
+}
+
+void BoundingBox::Grow(const BoundingBox& aBox)
+{
+    myMin = glm::min(myMin, aBox.myMin);
+    myMax = glm::max(myMax, aBox.myMax);
+}
+
+BoundingBox BoundingBox::Transform(const glm::mat4& aTransform) const
+{
+    if (IsEmpty())
+        return *this;
+
+    // Arvo's method: the new extents along each axis are the absolute rotation-scale rows applied to the old extents
+    const glm::vec3 center = GetCenter();
+    const glm::vec3 extents = GetExtents();
+    const glm::vec4 transformedCenter = aTransform * glm::vec4(center, 1.0f);
+
+    glm::vec3 transformedExtents(0.0f);
+    for (int column = 0; column < 3; ++column)
+    {
+        const glm::vec4& axis = aTransform[column];
+        transformedExtents += glm::abs(glm::vec3(axis.x, axis.y, axis.z)) * extents[column];
+    }
+
+    BoundingBox box;
+    box.myMin = glm::vec3(transformedCenter.x, transformedCenter.y, transformedCenter.z) - transformedExtents;
+    box.myMax = glm::vec3(transformedCenter.x, transformedCenter.y, transformedCenter.z) + transformedExtents;
+    return box;
+}
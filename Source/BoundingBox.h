@@ -0,0 +1,30 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <limits>
+#include <vector>
+
+struct Vertex;
+
+// Axis-aligned bounding box, empty until the first point is added
+struct BoundingBox
+{
+    BoundingBox();
+
+    static BoundingBox FromVertices(const std::vector<Vertex>& someVertices);
+
+    void Grow(const glm::vec3& aPoint);
+    void Grow(const BoundingBox& aBox);
+
+    // Conservative box around this one after transforming it, which stays tight for rotations and scales
+    [[nodiscard]] BoundingBox Transform(const glm::mat4& aTransform) const;
+
+    [[nodiscard]] bool IsEmpty() const { return myMin.x > myMax.x; }
+    [[nodiscard]] glm::vec3 GetCenter() const { return (myMin + myMax) * 0.5f; }
+    [[nodiscard]] glm::vec3 GetExtents() const { return (myMax - myMin) * 0.5f; }
+    [[nodiscard]] float GetBoundingSphereRadius() const { return glm::length(GetExtents()); }
+
+    glm::vec3 myMin;
+    glm::vec3 myMax;
+};
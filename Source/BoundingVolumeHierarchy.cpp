@@ -0,0 +1,499 @@
+#include "BoundingVolumeHierarchy.h"
+
+#include "Frustum.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace
+{
+    constexpr int BinCount = 16;
+    constexpr uint32_t MaxLeafItemCount = 4;
+    // Leaves larger than this are split even when the heuristic says a leaf is cheaper, to keep leaf tests bounded
+    constexpr uint32_t MaxForcedLeafItemCount = 16;
+    constexpr uint32_t ParallelBuildMinimumItemCount = 1 << 12;
+    constexpr uint32_t ParallelBuildMinimumSubtreeItemCount = 1 << 9;
+
+    enum class FrustumTest
+    {
+        Outside,
+        Intersecting,
+        Inside
+    };
+
+    float GetSurfaceArea(const BoundingBox& aBox)
+    {
+        if (aBox.IsEmpty())
+            return 0.0f;
+
+        const glm::vec3 size = aBox.myMax - aBox.myMin;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    FrustumTest TestFrustum(const Frustum& aFrustum, const BoundingBox& aBox)
+    {
+        const glm::vec3 center = aBox.GetCenter();
+        const glm::vec3 extents = aBox.GetExtents();
+
+        FrustumTest result = FrustumTest::Inside;
+        for (const glm::vec4& plane : aFrustum.myPlanes)
+        {
+            const float distance = center.x * plane.x + center.y * plane.y + center.z * plane.z + plane.w;
+            const float radius = extents.x * std::fabs(plane.x) + extents.y * std::fabs(plane.y) + extents.z * std::fabs(plane.z);
+            if (distance + radius < 0.0f)
+                return FrustumTest::Outside;
+
+            if (distance - radius < 0.0f)
+                result = FrustumTest::Intersecting;
+        }
+
+        return result;
+    }
+
+    // Slab test, returns the entry distance or infinity when the ray misses the box within aMaxDistance
+    float IntersectRay(const BoundingBox& aBox, const glm::vec3& anOrigin, const glm::vec3& anInverseDirection, float aMaxDistance)
+    {
+        const glm::vec3 near = (aBox.myMin - anOrigin) * anInverseDirection;
+        const glm::vec3 far = (aBox.myMax - anOrigin) * anInverseDirection;
+        const glm::vec3 entry = glm::min(near, far);
+        const glm::vec3 exit = glm::max(near, far);
+
+        const float entryDistance = std::max(std::max(entry.x, entry.y), std::max(entry.z, 0.0f));
+        const float exitDistance = std::min(std::min(exit.x, exit.y), std::min(exit.z, aMaxDistance));
+        return entryDistance <= exitDistance ? entryDistance : std::numeric_limits<float>::infinity();
+    }
+
+    float GetDistanceToBox(const BoundingBox& aBox, const glm::vec3& aPoint)
+    {
+        const glm::vec3 offset = glm::max(glm::max(aBox.myMin - aPoint, aPoint - aBox.myMax), glm::vec3(0.0f));
+        return glm::length(offset);
+    }
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+    : myNodeCount(0)
+    , myMaxDepth(0)
+{
+}
+
+void BoundingVolumeHierarchy::Build(const std::vector<BoundingBox>& someItemBounds, bool aIsParallel)
+{
+    PROFILE_FUNCTION();
+
+    Clear();
+    if (someItemBounds.empty())
+        return;
+
+    const uint32_t itemCount = static_cast<uint32_t>(someItemBounds.size());
+    myItemBounds = someItemBounds;
+    myItemCentroids.resize(itemCount);
+    for (uint32_t item = 0; item < itemCount; ++item)
+        myItemCentroids[item] = myItemBounds[item].GetCenter();
+
+    myItemIndices.resize(itemCount);
+    std::iota(myItemIndices.begin(), myItemIndices.end(), 0u);
+    myItemLeaves.resize(itemCount);
+
+    // A binary tree with single item leaves is the largest this can get
+    myNodes.resize(static_cast<std::size_t>(itemCount) * 2);
+    myNodes[0].myParent = NoNode;
+    myNodeCount = 1;
+
+    JobSystem& jobSystem = JobSystem::GetInstance();
+    if (!aIsParallel || jobSystem.GetWorkerCount() == 0 || itemCount < ParallelBuildMinimumItemCount)
+    {
+        BuildNode(0, 0, itemCount);
+    }
+    else
+    {
+        // Split the top levels on this thread until there are enough independent subtrees to keep every worker busy
+        const std::size_t targetTaskCount = (jobSystem.GetWorkerCount() + 1) * 4;
+        std::vector<BuildTask> tasks = { { 0, 0, itemCount } };
+        std::vector<BuildTask> nextTasks;
+        bool hasSplit = true;
+        while (hasSplit && tasks.size() < targetTaskCount)
+        {
+            hasSplit = false;
+            nextTasks.clear();
+            for (const BuildTask& task : tasks)
+            {
+                BuildTask leftTask;
+                BuildTask rightTask;
+                if (task.myItemCount >= ParallelBuildMinimumSubtreeItemCount && SplitNode(task, leftTask, rightTask))
+                {
+                    nextTasks.push_back(leftTask);
+                    nextTasks.push_back(rightTask);
+                    hasSplit = true;
+                }
+                else
+                {
+                    nextTasks.push_back(task);
+                }
+            }
+
+            tasks.swap(nextTasks);
+        }
+
+        jobSystem.ParallelFor(tasks.size(), [this, &tasks](std::size_t aTaskIndex)
+        {
+            PROFILE_SCOPE("BoundingVolumeHierarchy::BuildSubtree");
+            const BuildTask& task = tasks[aTaskIndex];
+            BuildNode(task.myNode, task.myFirstItem, task.myItemCount);
+        });
+    }
+
+    myNodes.resize(myNodeCount);
+
+    // Children are always allocated after their parent, so a forward pass sees every parent's depth first
+    std::vector<uint32_t> depths(myNodes.size(), 0);
+    for (std::size_t nodeIndex = 1; nodeIndex < myNodes.size(); ++nodeIndex)
+    {
+        depths[nodeIndex] = depths[myNodes[nodeIndex].myParent] + 1;
+        myMaxDepth = std::max(myMaxDepth, depths[nodeIndex]);
+    }
+}
+
+void BoundingVolumeHierarchy::Clear()
+{
+    myNodes.clear();
+    myItemIndices.clear();
+    myItemLeaves.clear();
+    myItemBounds.clear();
+    myItemCentroids.clear();
+    myDirtyLeaves.clear();
+    myNodeCount = 0;
+    myMaxDepth = 0;
+}
+
+void BoundingVolumeHierarchy::UpdateItem(uint32_t anItem, const BoundingBox& aBounds)
+{
+    myItemBounds[anItem] = aBounds;
+    myDirtyLeaves.push_back(myItemLeaves[anItem]);
+}
+
+void BoundingVolumeHierarchy::Refit()
+{
+    PROFILE_FUNCTION();
+
+    std::sort(myDirtyLeaves.begin(), myDirtyLeaves.end());
+    myDirtyLeaves.erase(std::unique(myDirtyLeaves.begin(), myDirtyLeaves.end()), myDirtyLeaves.end());
+
+    for (const uint32_t leafIndex : myDirtyLeaves)
+    {
+        Node& leaf = myNodes[leafIndex];
+        leaf.myBounds = BoundingBox();
+        for (uint32_t i = 0; i < leaf.myItemCount; ++i)
+            leaf.myBounds.Grow(myItemBounds[myItemIndices[leaf.myLeftOrFirstItem + i]]);
+
+        // Walk up until a node's bounds stop changing, everything above it is unaffected by this leaf
+        uint32_t nodeIndex = leaf.myParent;
+        while (nodeIndex != NoNode)
+        {
+            Node& node = myNodes[nodeIndex];
+            BoundingBox bounds = myNodes[node.myLeftOrFirstItem].myBounds;
+            bounds.Grow(myNodes[node.myLeftOrFirstItem + 1].myBounds);
+            if (bounds.myMin == node.myBounds.myMin && bounds.myMax == node.myBounds.myMax)
+                break;
+
+            node.myBounds = bounds;
+            nodeIndex = node.myParent;
+        }
+    }
+
+    myDirtyLeaves.clear();
+}
+
+void BoundingVolumeHierarchy::QueryFrustum(const Frustum& aFrustum, std::vector<uint32_t>& someItems) const
+{
+    PROFILE_FUNCTION();
+
+    if (myNodes.empty())
+        return;
+
+    // Depth-first traversal never holds more than one pending sibling per level
+    std::vector<std::pair<uint32_t, bool>> stack;
+    stack.reserve(myMaxDepth + 2);
+    stack.emplace_back(0, false);
+
+    while (!stack.empty())
+    {
+        const Node& node = myNodes[stack.back().first];
+        bool isInside = stack.back().second;
+        stack.pop_back();
+
+        // Once a node is fully inside, so is everything below it
+        if (!isInside)
+        {
+            const FrustumTest test = TestFrustum(aFrustum, node.myBounds);
+            if (test == FrustumTest::Outside)
+                continue;
+
+            isInside = test == FrustumTest::Inside;
+        }
+
+        if (node.myItemCount > 0)
+        {
+            for (uint32_t i = 0; i < node.myItemCount; ++i)
+            {
+                const uint32_t item = myItemIndices[node.myLeftOrFirstItem + i];
+                if (isInside || TestFrustum(aFrustum, myItemBounds[item]) != FrustumTest::Outside)
+                    someItems.push_back(item);
+            }
+
+            continue;
+        }
+
+        stack.emplace_back(node.myLeftOrFirstItem, isInside);
+        stack.emplace_back(node.myLeftOrFirstItem + 1, isInside);
+    }
+}
+
+bool BoundingVolumeHierarchy::Raycast(const glm::vec3& anOrigin, const glm::vec3& aDirection, float aMaxDistance, RaycastHit& aHit) const
+{
+    if (myNodes.empty())
+        return false;
+
+    const glm::vec3 inverseDirection(1.0f / aDirection.x, 1.0f / aDirection.y, 1.0f / aDirection.z);
+    float closestDistance = aMaxDistance;
+    uint32_t closestItem = NoNode;
+
+    std::vector<uint32_t> stack;
+    stack.reserve(myMaxDepth + 2);
+    if (IntersectRay(myNodes[0].myBounds, anOrigin, inverseDirection, closestDistance) < std::numeric_limits<float>::infinity())
+        stack.push_back(0);
+
+    while (!stack.empty())
+    {
+        const Node& node = myNodes[stack.back()];
+        stack.pop_back();
+        if (node.myItemCount > 0)
+        {
+            for (uint32_t i = 0; i < node.myItemCount; ++i)
+            {
+                const uint32_t item = myItemIndices[node.myLeftOrFirstItem + i];
+                const float distance = IntersectRay(myItemBounds[item], anOrigin, inverseDirection, closestDistance);
+                if (distance < closestDistance || (distance == closestDistance && closestItem == NoNode))
+                {
+                    closestDistance = distance;
+                    closestItem = item;
+                }
+            }
+
+            continue;
+        }
+
+        // Visit the nearer child first, so the farther one is more likely to be pruned by the hit found there
+        uint32_t nearChild = node.myLeftOrFirstItem;
+        uint32_t farChild = node.myLeftOrFirstItem + 1;
+        float nearDistance = IntersectRay(myNodes[nearChild].myBounds, anOrigin, inverseDirection, closestDistance);
+        float farDistance = IntersectRay(myNodes[farChild].myBounds, anOrigin, inverseDirection, closestDistance);
+        if (farDistance < nearDistance)
+        {
+            std::swap(nearChild, farChild);
+            std::swap(nearDistance, farDistance);
+        }
+
+        if (farDistance < std::numeric_limits<float>::infinity())
+            stack.push_back(farChild);
+        if (nearDistance < std::numeric_limits<float>::infinity())
+            stack.push_back(nearChild);
+    }
+
+    if (closestItem == NoNode)
+        return false;
+
+    aHit.myItem = closestItem;
+    aHit.myDistance = closestDistance;
+    return true;
+}
+
+bool BoundingVolumeHierarchy::FindNearest(const glm::vec3& aPoint, NearestHit& aHit) const
+{
+    if (myNodes.empty())
+        return false;
+
+    float closestDistance = std::numeric_limits<float>::infinity();
+    uint32_t closestItem = NoNode;
+
+    std::vector<uint32_t> stack;
+    stack.reserve(myMaxDepth + 2);
+    stack.push_back(0);
+
+    while (!stack.empty())
+    {
+        const Node& node = myNodes[stack.back()];
+        stack.pop_back();
+        if (GetDistanceToBox(node.myBounds, aPoint) >= closestDistance)
+            continue;
+
+        if (node.myItemCount > 0)
+        {
+            for (uint32_t i = 0; i < node.myItemCount; ++i)
+            {
+                const uint32_t item = myItemIndices[node.myLeftOrFirstItem + i];
+                const float distance = GetDistanceToBox(myItemBounds[item], aPoint);
+                if (distance < closestDistance)
+                {
+                    closestDistance = distance;
+                    closestItem = item;
+                }
+            }
+
+            continue;
+        }
+
+        uint32_t nearChild = node.myLeftOrFirstItem;
+        uint32_t farChild = node.myLeftOrFirstItem + 1;
+        if (GetDistanceToBox(myNodes[farChild].myBounds, aPoint) < GetDistanceToBox(myNodes[nearChild].myBounds, aPoint))
+            std::swap(nearChild, farChild);
+
+        stack.push_back(farChild);
+        stack.push_back(nearChild);
+    }
+
+    if (closestItem == NoNode)
+        return false;
+
+    aHit.myItem = closestItem;
+    aHit.myDistance = closestDistance;
+    return true;
+}
+
+void BoundingVolumeHierarchy::BuildNode(uint32_t aNodeIndex, uint32_t aFirstItem, uint32_t anItemCount)
+{
+    std::vector<BuildTask> stack = { { aNodeIndex, aFirstItem, anItemCount } };
+    while (!stack.empty())
+    {
+        const BuildTask task = stack.back();
+        stack.pop_back();
+
+        BuildTask leftTask;
+        BuildTask rightTask;
+        if (SplitNode(task, leftTask, rightTask))
+        {
+            stack.push_back(rightTask);
+            stack.push_back(leftTask);
+        }
+        else
+        {
+            MakeLeaf(task.myNode, task.myFirstItem, task.myItemCount);
+        }
+    }
+}
+
+bool BoundingVolumeHierarchy::SplitNode(const BuildTask& aTask, BuildTask& aLeftTask, BuildTask& aRightTask)
+{
+    Node& node = myNodes[aTask.myNode];
+    node.myBounds = BoundingBox();
+    BoundingBox centroidBounds;
+    for (uint32_t i = aTask.myFirstItem; i < aTask.myFirstItem + aTask.myItemCount; ++i)
+    {
+        node.myBounds.Grow(myItemBounds[myItemIndices[i]]);
+        centroidBounds.Grow(myItemCentroids[myItemIndices[i]]);
+    }
+
+    if (aTask.myItemCount <= MaxLeafItemCount)
+        return false;
+
+    // Bin the centroids along every axis and keep the split plane with the lowest surface area cost
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    int bestBin = 0;
+    const glm::vec3 centroidSize = centroidBounds.myMax - centroidBounds.myMin;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (centroidSize[axis] <= 0.0f)
+            continue;
+
+        std::array<BoundingBox, BinCount> binBounds;
+        std::array<uint32_t, BinCount> binCounts = {};
+        const float binScale = BinCount / centroidSize[axis];
+        for (uint32_t i = aTask.myFirstItem; i < aTask.myFirstItem + aTask.myItemCount; ++i)
+        {
+            const uint32_t item = myItemIndices[i];
+            const int bin = std::min(BinCount - 1, static_cast<int>((myItemCentroids[item][axis] - centroidBounds.myMin[axis]) * binScale));
+            binBounds[bin].Grow(myItemBounds[item]);
+            ++binCounts[bin];
+        }
+
+        // Sweep from the right to get the cost of every right side, then from the left to combine them
+        std::array<float, BinCount> rightCosts = {};
+        BoundingBox rightBounds;
+        uint32_t rightCount = 0;
+        for (int bin = BinCount - 1; bin > 0; --bin)
+        {
+            rightBounds.Grow(binBounds[bin]);
+            rightCount += binCounts[bin];
+            rightCosts[bin] = rightCount * GetSurfaceArea(rightBounds);
+        }
+
+        BoundingBox leftBounds;
+        uint32_t leftCount = 0;
+        for (int bin = 0; bin < BinCount - 1; ++bin)
+        {
+            leftBounds.Grow(binBounds[bin]);
+            leftCount += binCounts[bin];
+            const float cost = leftCount * GetSurfaceArea(leftBounds) + rightCosts[bin + 1];
+            if (leftCount > 0 && leftCount < aTask.myItemCount && cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = bin + 1;
+            }
+        }
+    }
+
+    const float leafCost = aTask.myItemCount * GetSurfaceArea(node.myBounds);
+    if (bestCost >= leafCost && aTask.myItemCount <= MaxForcedLeafItemCount)
+        return false;
+
+    uint32_t* first = myItemIndices.data() + aTask.myFirstItem;
+    uint32_t* last = first + aTask.myItemCount;
+    uint32_t* middle = nullptr;
+    if (bestAxis >= 0)
+    {
+        const float binScale = BinCount / centroidSize[bestAxis];
+        const float minimum = centroidBounds.myMin[bestAxis];
+        middle = std::partition(first, last, [&](uint32_t anItem)
+        {
+            return std::min(BinCount - 1, static_cast<int>((myItemCentroids[anItem][bestAxis] - minimum) * binScale)) < bestBin;
+        });
+    }
+    else
+    {
+        // Every centroid is in the same spot, so any split is as good as another
+        middle = first + aTask.myItemCount / 2;
+    }
+
+    const uint32_t leftCount = static_cast<uint32_t>(middle - first);
+    const uint32_t leftChild = AllocateNodePair();
+    node.myLeftOrFirstItem = leftChild;
+    node.myItemCount = 0;
+    myNodes[leftChild].myParent = aTask.myNode;
+    myNodes[leftChild + 1].myParent = aTask.myNode;
+
+    aLeftTask = { leftChild, aTask.myFirstItem, leftCount };
+    aRightTask = { leftChild + 1, aTask.myFirstItem + leftCount, aTask.myItemCount - leftCount };
+    return true;
+}
+
+void BoundingVolumeHierarchy::MakeLeaf(uint32_t aNodeIndex, uint32_t aFirstItem, uint32_t anItemCount)
+{
+    Node& node = myNodes[aNodeIndex];
+    node.myLeftOrFirstItem = aFirstItem;
+    node.myItemCount = anItemCount;
+    for (uint32_t i = aFirstItem; i < aFirstItem + anItemCount; ++i)
+        myItemLeaves[myItemIndices[i]] = aNodeIndex;
+}
+
+uint32_t BoundingVolumeHierarchy::AllocateNodePair()
+{
+    // Subtrees are built concurrently, but they only ever write to the nodes they allocated
+    return myNodeCount.fetch_add(2, std::memory_order_relaxed);
+}
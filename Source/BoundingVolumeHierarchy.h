@@ -0,0 +1,82 @@
+#pragma once
+
+#include "BoundingBox.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Frustum;
+
+struct RaycastHit
+{
+    uint32_t myItem;
+    float myDistance;
+};
+
+struct NearestHit
+{
+    uint32_t myItem;
+    float myDistance;
+};
+
+// Bounding volume hierarchy over a flat array of item boxes, where an item is whatever the caller indexes them by.
+// Built top-down with a binned surface area heuristic, with the subtrees below the first few levels built in parallel.
+// Items can move afterwards, UpdateItem followed by Refit only touches the nodes above the items that changed.
+class BoundingVolumeHierarchy
+{
+public:
+    BoundingVolumeHierarchy();
+
+    void Build(const std::vector<BoundingBox>& someItemBounds, bool aIsParallel = true);
+    void Clear();
+
+    void UpdateItem(uint32_t anItem, const BoundingBox& aBounds);
+    void Refit();
+
+    // Appends every item whose box intersects the frustum
+    void QueryFrustum(const Frustum& aFrustum, std::vector<uint32_t>& someItems) const;
+
+    // Closest item box hit by the ray within aMaxDistance, aDirection does not have to be normalized
+    [[nodiscard]] bool Raycast(const glm::vec3& anOrigin, const glm::vec3& aDirection, float aMaxDistance, RaycastHit& aHit) const;
+
+    // Item whose box is closest to aPoint, a distance of zero means aPoint lies inside the box
+    [[nodiscard]] bool FindNearest(const glm::vec3& aPoint, NearestHit& aHit) const;
+
+    [[nodiscard]] std::size_t GetItemCount() const { return myItemBounds.size(); }
+    [[nodiscard]] std::size_t GetNodeCount() const { return myNodeCount; }
+
+private:
+    static constexpr uint32_t NoNode = UINT32_MAX;
+
+    // Internal nodes store their left child, the right child always follows it. Leaves store a range of myItemIndices.
+    struct Node
+    {
+        BoundingBox myBounds;
+        uint32_t myLeftOrFirstItem;
+        uint32_t myItemCount;
+        uint32_t myParent;
+    };
+
+    struct BuildTask
+    {
+        uint32_t myNode;
+        uint32_t myFirstItem;
+        uint32_t myItemCount;
+    };
+
+    void BuildNode(uint32_t aNodeIndex, uint32_t aFirstItem, uint32_t anItemCount);
+    [[nodiscard]] bool SplitNode(const BuildTask& aTask, BuildTask& aLeftTask, BuildTask& aRightTask);
+    void MakeLeaf(uint32_t aNodeIndex, uint32_t aFirstItem, uint32_t anItemCount);
+    [[nodiscard]] uint32_t AllocateNodePair();
+
+    std::vector<Node> myNodes;
+    std::vector<uint32_t> myItemIndices;
+    std::vector<uint32_t> myItemLeaves;
+    std::vector<BoundingBox> myItemBounds;
+    std::vector<glm::vec3> myItemCentroids;
+    std::vector<uint32_t> myDirtyLeaves;
+    std::atomic<uint32_t> myNodeCount;
+    uint32_t myMaxDepth;
+};
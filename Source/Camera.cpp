@@ -5,6 +5,7 @@
 
 #include "AppDefinitions.h"
 #include "InputManager.h"
+#include "Profiler.h"
 
 Camera::Camera()
 	: myProjection(0.0f)
@@ -34,6 +35,8 @@ Camera::Camera()
 
 void Camera::Update(float aDeltaTime)
 {
+	PROFILE_FUNCTION();
+
 	float movementSpeed = myKeySpeed;
 
 	const InputManager& inputManager = InputManager::GetInstance();
@@ -83,3 +86,9 @@ void Camera::SetPosition(const glm::vec3& aPosition)
 {
 	myPosition = aPosition;
 }
+
+void Camera::SetOrientation(float aHorizontalAngle, float aVerticalAngle)
+{
+	myHorizontalAngle = aHorizontalAngle;
+	myVerticalAngle = aVerticalAngle;
+}
@@ -12,6 +12,7 @@ public:
 
 	void SetViewportSize(const glm::vec2& aSize);
 	void SetPosition(const glm::vec3& aPosition);
+	void SetOrientation(float aHorizontalAngle, float aVerticalAngle);
 
 	const glm::mat4x4& GetProjectionMatrix() const { return myProjection; }
 	const glm::mat4x4& GetViewMatrix() const { return myView; }
@@ -0,0 +1,95 @@
+#include "ClusterCuller.h"
+
+#include "DrawElementsIndirectCommand.h"
+#include "GLUtility.h"
+#include "Profiler.h"
+
+#include <glad/glad.h>
+
+namespace
+{
+    constexpr int CullGroupSize = 64;
+
+    enum StorageBinding : GLuint
+    {
+        MeshletsBinding,
+        InstancesBinding,
+        DrawsBinding,
+        CommandsBinding,
+        DrawCountsBinding
+    };
+}
+
+ClusterCuller::ClusterCuller()
+    : myDrawCapacity(0)
+    , myDrawCountCapacity(0)
+    , myCommandCapacity(0)
+    , myDrawBufferObject(0)
+    , myCommandBufferObject(0)
+    , myDrawCountBufferObject(0)
+    , myHasDrawCount(false)
+{
+}
+
+void ClusterCuller::Initialize()
+{
+    glGenBuffers(1, &myDrawBufferObject);
+    glGenBuffers(1, &myCommandBufferObject);
+    glGenBuffers(1, &myDrawCountBufferObject);
+
+    myCullShader.LoadCompute("Data/Shaders/ClusterCull.comp.glsl");
+    myDrawCountUniform = myCullShader.GetUniform<int>("uDrawCount");
+    myItemCountUniform = myCullShader.GetUniform<int>("uItemCount");
+
+    // glMultiDrawElementsIndirectCount is core in 4.6, software rasterizers that stop at 4.5 draw the full ranges instead
+    myHasDrawCount = GLAD_GL_VERSION_4_6 != 0;
+}
+
+void ClusterCuller::Destroy()
+{
+    glDeleteProgram(myCullShader.myIdentifier);
+    glDeleteBuffers(1, &myDrawBufferObject);
+    glDeleteBuffers(1, &myCommandBufferObject);
+    glDeleteBuffers(1, &myDrawCountBufferObject);
+    myDrawBufferObject = 0;
+    myCommandBufferObject = 0;
+    myDrawCountBufferObject = 0;
+    myDrawCapacity = 0;
+    myDrawCountCapacity = 0;
+    myCommandCapacity = 0;
+}
+
+void ClusterCuller::Cull(const std::vector<ClusterDraw>& someDraws, std::size_t aCommandCount, unsigned int aMeshletBuffer, unsigned int anInstanceBuffer)
+{
+    PROFILE_FUNCTION();
+
+    if (someDraws.empty())
+        return;
+
+    myDrawCounts.assign(someDraws.size(), 0);
+    GLUtility::UploadStorageBuffer(myDrawBufferObject, myDrawCapacity, someDraws.data(), someDraws.size() * sizeof(ClusterDraw));
+    GLUtility::UploadStorageBuffer(myDrawCountBufferObject, myDrawCountCapacity, myDrawCounts.data(), myDrawCounts.size() * sizeof(unsigned int));
+    GLUtility::UploadStorageBuffer(myCommandBufferObject, myCommandCapacity, nullptr, aCommandCount * sizeof(DrawElementsIndirectCommand));
+
+    if (!myHasDrawCount)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, myCommandBufferObject);
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    const GLUtility::ScopedProgramRestore programRestore;
+    myCullShader.Use();
+    myCullShader.Set(myDrawCountUniform, static_cast<int>(someDraws.size()));
+    myCullShader.Set(myItemCountUniform, static_cast<int>(aCommandCount));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MeshletsBinding, aMeshletBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, InstancesBinding, anInstanceBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DrawsBinding, myDrawBufferObject);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CommandsBinding, myCommandBufferObject);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DrawCountsBinding, myDrawCountBufferObject);
+
+    glDispatchCompute(static_cast<GLuint>((aCommandCount + CullGroupSize - 1) / CullGroupSize), 1, 1);
+
+    // Both the commands and their counts are read by the multi-draw
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ClusterDraw.h"
+#include "Shader.h"
+
+#include <cstddef>
+#include <vector>
+
+// GPU culling of meshlets, one compute invocation per meshlet and instance. Meshlets outside the view frustum or whose
+// normal cone faces away from the camera are dropped, the rest are appended as single-instance commands to the command range
+// of their draw and counted in a per-draw count, which glMultiDrawElementsIndirectCount then reads as the number of commands.
+// Without GL 4.6 the command ranges are cleared first and drawn in full, the unused commands then draw nothing.
+class ClusterCuller
+{
+public:
+    ClusterCuller();
+
+    void Initialize();
+    void Destroy();
+
+    void Cull(const std::vector<ClusterDraw>& someDraws, std::size_t aCommandCount, unsigned int aMeshletBuffer, unsigned int anInstanceBuffer);
+
+    [[nodiscard]] bool HasDrawCount() const { return myHasDrawCount; }
+    [[nodiscard]] unsigned int GetCommandBuffer() const { return myCommandBufferObject; }
+    [[nodiscard]] unsigned int GetDrawCountBuffer() const { return myDrawCountBufferObject; }
+
+private:
+    Shader myCullShader;
+    UniformHandle<int> myDrawCountUniform;
+    UniformHandle<int> myItemCountUniform;
+    std::vector<unsigned int> myDrawCounts;
+    std::size_t myDrawCapacity;
+    std::size_t myDrawCountCapacity;
+    std::size_t myCommandCapacity;
+    unsigned int myDrawBufferObject;
+    unsigned int myCommandBufferObject;
+    unsigned int myDrawCountBufferObject;
+    bool myHasDrawCount;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+// A draw of a mesh with meshlets, laid out exactly as ClusterCull.comp.glsl reads it. The culling pass writes one single-instance
+// command per visible meshlet and instance, into the range that starts at myCommandOffset and holds myMeshletCount * myInstanceCount.
+struct ClusterDraw
+{
+    uint32_t myFirstMeshlet = 0;
+    uint32_t myMeshletCount = 0;
+    uint32_t myFirstIndex = 0;
+    int32_t myBaseVertex = 0;
+    uint32_t myBaseInstance = 0;
+    uint32_t myInstanceCount = 0;
+    uint32_t myCommandOffset = 0;
+    uint32_t myPadding = 0;
+    // Meshlet bounds are in object space while the instance transforms expect packed positions, see PackedVertex
+    glm::vec4 myQuantizationCenter = glm::vec4(0.0f);
+    glm::vec4 myQuantizationInverseExtents = glm::vec4(1.0f);
+};
+
+static_assert(sizeof(ClusterDraw) == 64, "ClusterDraw is uploaded as is");
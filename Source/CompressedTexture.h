@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class TextureCompression : uint32_t
+{
+    None,
+    // 4 bits per texel, opaque RGB
+    Bc1,
+    // 8 bits per texel, RGB like Bc1 plus an interpolated alpha block
+    Bc3
+};
+
+// One level of the mip chain, as a range of CompressedTexture::myData
+struct CompressedTextureLevel
+{
+    uint32_t myOffset = 0;
+    uint32_t mySize = 0;
+    int myWidth = 0;
+    int myHeight = 0;
+};
+
+// A block compressed texture with its complete mip chain, ready for glCompressedTexImage2D, see TextureCompressor
+struct CompressedTexture
+{
+    [[nodiscard]] bool IsEmpty() const { return myLevels.empty(); }
+
+    TextureCompression myCompression = TextureCompression::None;
+    std::vector<CompressedTextureLevel> myLevels;
+    std::vector<unsigned char> myData;
+};
@@ -0,0 +1,139 @@
+#include "CullingBounds.h"
+
+#include "BoundingBox.h"
+#include "Frustum.h"
+#include "Profiler.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CULLING_USE_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CULLING_USE_SSE 1
+#endif
+
+#include <cmath>
+
+CullingBounds::CullingBounds()
+    : myCount(0)
+{
+}
+
+void CullingBounds::Clear()
+{
+    myCenterX.clear();
+    myCenterY.clear();
+    myCenterZ.clear();
+    myExtentX.clear();
+    myExtentY.clear();
+    myExtentZ.clear();
+    myCount = 0;
+}
+
+std::size_t CullingBounds::Add(const BoundingBox& aBox)
+{
+    const std::size_t index = myCount++;
+
+    // Keep the arrays a whole number of SIMD widths long, the padding holds empty boxes at the origin that are never read back
+    if (index >= myCenterX.size())
+    {
+        const std::size_t paddedSize = myCenterX.size() + SimdWidth;
+        myCenterX.resize(paddedSize, 0.0f);
+        myCenterY.resize(paddedSize, 0.0f);
+        myCenterZ.resize(paddedSize, 0.0f);
+        myExtentX.resize(paddedSize, 0.0f);
+        myExtentY.resize(paddedSize, 0.0f);
+        myExtentZ.resize(paddedSize, 0.0f);
+    }
+
+    const glm::vec3 center = aBox.GetCenter();
+    const glm::vec3 extents = aBox.GetExtents();
+    myCenterX[index] = center.x;
+    myCenterY[index] = center.y;
+    myCenterZ[index] = center.z;
+    myExtentX[index] = extents.x;
+    myExtentY[index] = extents.y;
+    myExtentZ[index] = extents.z;
+    return index;
+}
+
+void CullingBounds::Cull(const Frustum& aFrustum, std::vector<unsigned char>& someVisibility) const
+{
+    PROFILE_FUNCTION();
+
+    // A box is outside when it lies entirely behind one plane, that is when the signed distance of its center
+    // plus its projected radius dot(abs(normal), extents) is negative
+    someVisibility.resize(myCenterX.size());
+
+#if defined(CULLING_USE_AVX)
+    for (std::size_t boxIndex = 0; boxIndex < myCount; boxIndex += 8)
+    {
+        const __m256 centerX = _mm256_loadu_ps(&myCenterX[boxIndex]);
+        const __m256 centerY = _mm256_loadu_ps(&myCenterY[boxIndex]);
+        const __m256 centerZ = _mm256_loadu_ps(&myCenterZ[boxIndex]);
+        const __m256 extentX = _mm256_loadu_ps(&myExtentX[boxIndex]);
+        const __m256 extentY = _mm256_loadu_ps(&myExtentY[boxIndex]);
+        const __m256 extentZ = _mm256_loadu_ps(&myExtentZ[boxIndex]);
+
+        __m256 isInside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const glm::vec4& plane : aFrustum.myPlanes)
+        {
+            const __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(centerX, _mm256_set1_ps(plane.x)), _mm256_mul_ps(centerY, _mm256_set1_ps(plane.y))),
+                _mm256_add_ps(_mm256_mul_ps(centerZ, _mm256_set1_ps(plane.z)), _mm256_set1_ps(plane.w)));
+            const __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(extentX, _mm256_set1_ps(std::fabs(plane.x))), _mm256_mul_ps(extentY, _mm256_set1_ps(std::fabs(plane.y)))),
+                _mm256_mul_ps(extentZ, _mm256_set1_ps(std::fabs(plane.z))));
+            isInside = _mm256_and_ps(isInside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        const int mask = _mm256_movemask_ps(isInside);
+        for (int lane = 0; lane < 8; ++lane)
+            someVisibility[boxIndex + lane] = static_cast<unsigned char>((mask >> lane) & 1);
+    }
+#elif defined(CULLING_USE_SSE)
+    for (std::size_t boxIndex = 0; boxIndex < myCount; boxIndex += 4)
+    {
+        const __m128 centerX = _mm_loadu_ps(&myCenterX[boxIndex]);
+        const __m128 centerY = _mm_loadu_ps(&myCenterY[boxIndex]);
+        const __m128 centerZ = _mm_loadu_ps(&myCenterZ[boxIndex]);
+        const __m128 extentX = _mm_loadu_ps(&myExtentX[boxIndex]);
+        const __m128 extentY = _mm_loadu_ps(&myExtentY[boxIndex]);
+        const __m128 extentZ = _mm_loadu_ps(&myExtentZ[boxIndex]);
+
+        __m128 isInside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const glm::vec4& plane : aFrustum.myPlanes)
+        {
+            const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(plane.x)), _mm_mul_ps(centerY, _mm_set1_ps(plane.y))),
+                _mm_add_ps(_mm_mul_ps(centerZ, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+            const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extentX, _mm_set1_ps(std::fabs(plane.x))), _mm_mul_ps(extentY, _mm_set1_ps(std::fabs(plane.y)))),
+                _mm_mul_ps(extentZ, _mm_set1_ps(std::fabs(plane.z))));
+            isInside = _mm_and_ps(isInside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+
+        const int mask = _mm_movemask_ps(isInside);
+        for (int lane = 0; lane < 4; ++lane)
+            someVisibility[boxIndex + lane] = static_cast<unsigned char>((mask >> lane) & 1);
+    }
+#else
+    CullScalar(aFrustum, someVisibility);
+#endif
+
+    someVisibility.resize(myCount);
+}
+
+void CullingBounds::CullScalar(const Frustum& aFrustum, std::vector<unsigned char>& someVisibility) const
+{
+    someVisibility.resize(myCount);
+    for (std::size_t boxIndex = 0; boxIndex < myCount; ++boxIndex)
+    {
+        bool isInside = true;
+        for (const glm::vec4& plane : aFrustum.myPlanes)
+        {
+            // Summed in the same order as the SIMD paths, so both round the same way and agree on boxes touching a plane
+            const float distance = (myCenterX[boxIndex] * plane.x + myCenterY[boxIndex] * plane.y) + (myCenterZ[boxIndex] * plane.z + plane.w);
+            const float radius = myExtentX[boxIndex] * std::fabs(plane.x) + myExtentY[boxIndex] * std::fabs(plane.y) + myExtentZ[boxIndex] * std::fabs(plane.z);
+            isInside = isInside && distance + radius >= 0.0f;
+        }
+
+        someVisibility[boxIndex] = isInside ? 1 : 0;
+    }
+}
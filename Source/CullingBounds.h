@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct BoundingBox;
+struct Frustum;
+
+// World-space boxes stored as center and extents in separate arrays, so the culling kernel can load
+// one component of several boxes with a single SIMD load. The arrays are padded to a whole SIMD width.
+class CullingBounds
+{
+public:
+    CullingBounds();
+
+    void Clear();
+    std::size_t Add(const BoundingBox& aBox);
+
+    // Writes 1 for every box that intersects the frustum and 0 for every box fully outside of it.
+    // Uses AVX when the build enables it, SSE2 on other x86 builds and the scalar path elsewhere.
+    void Cull(const Frustum& aFrustum, std::vector<unsigned char>& someVisibility) const;
+    void CullScalar(const Frustum& aFrustum, std::vector<unsigned char>& someVisibility) const;
+
+    [[nodiscard]] std::size_t GetCount() const { return myCount; }
+
+private:
+    static constexpr std::size_t SimdWidth = 8;
+
+    std::vector<float> myCenterX;
+    std::vector<float> myCenterY;
+    std::vector<float> myCenterZ;
+    std::vector<float> myExtentX;
+    std::vector<float> myExtentY;
+    std::vector<float> myExtentZ;
+    std::size_t myCount;
+};
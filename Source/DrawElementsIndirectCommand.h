@@ -0,0 +1,11 @@
+#pragma once
+
+// Layout defined by the GL specification for glMultiDrawElementsIndirect, also mirrored by the DrawCommand struct in Data/Shaders/OcclusionCull.comp.glsl
+struct DrawElementsIndirectCommand
+{
+    unsigned int myCount;
+    unsigned int myInstanceCount;
+    unsigned int myFirstIndex;
+    int myBaseVertex;
+    unsigned int myBaseInstance;
+};
@@ -1,6 +1,19 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
 #include <string>
+#include <thread>
+
+#if _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace FileUtility
 {
@@ -22,4 +35,61 @@ namespace FileUtility
         const std::size_t lastSlashIndex = aPath.find_last_of("/\\");
         return aPath.substr(0, lastSlashIndex + 1);
     }
+
+    // Size and modification time of a file, which the caches written beside source files compare to detect changes
+    static bool GetFileStamp(const std::string& aPath, uint64_t& aSize, int64_t& aModificationTime)
+    {
+        std::error_code errorCode;
+        const uintmax_t size = std::filesystem::file_size(aPath, errorCode);
+        if (errorCode)
+            return false;
+
+        const std::filesystem::file_time_type modificationTime = std::filesystem::last_write_time(aPath, errorCode);
+        if (errorCode)
+            return false;
+
+        aSize = static_cast<uint64_t>(size);
+        aModificationTime = static_cast<int64_t>(modificationTime.time_since_epoch().count());
+        return true;
+    }
+
+    // Writes a file through a temporary file beside it that is renamed over it once complete, so an interrupted write never
+    // leaves a truncated file behind. The temporary name is unique to the process, thread and call, so concurrent writers of
+    // the same file each write their own and the last rename wins with a complete file.
+    // Inline rather than static like the helpers above, so the whole process shares one temporary file counter.
+    inline bool WriteFileAtomically(const std::string& aPath, const std::function<void(std::ofstream&)>& aWriteContents)
+    {
+        static std::atomic<unsigned int> temporaryFileCounter{ 0 };
+#if _WIN32
+        const int processId = _getpid();
+#else
+        const int processId = static_cast<int>(getpid());
+#endif
+        std::ostringstream temporaryPathStream;
+        temporaryPathStream << aPath << '.' << processId << '.' << std::this_thread::get_id() << '.' << temporaryFileCounter++ << ".tmp";
+        const std::string temporaryPath = temporaryPathStream.str();
+
+        bool isWritten = false;
+        std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (stream)
+        {
+            aWriteContents(stream);
+
+            // The last buffered bytes only reach the file on close, which is where a full disk shows up
+            stream.close();
+            isWritten = !stream.fail();
+        }
+
+        std::error_code errorCode;
+        if (isWritten)
+            std::filesystem::rename(temporaryPath, aPath, errorCode);
+
+        if (!isWritten || errorCode)
+        {
+            std::filesystem::remove(temporaryPath, errorCode);
+            return false;
+        }
+
+        return true;
+    }
 }
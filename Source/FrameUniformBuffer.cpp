@@ -0,0 +1,119 @@
+#include "FrameUniformBuffer.h"
+
+#include "AppDefinitions.h"
+#include "Camera.h"
+#include "LogUtility.h"
+#include "Profiler.h"
+
+#include <glad/glad.h>
+
+#include <cassert>
+#include <cstring>
+
+FrameUniformBuffer::FrameUniformBuffer()
+    : myFences{}
+    , myMappedData(nullptr)
+    , mySlotSize(0)
+    , mySlotIndex(0)
+    , myBuffer(0)
+    , myIsPersistent(false)
+{
+}
+
+void FrameUniformBuffer::Initialize()
+{
+    GLint offsetAlignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+    const std::size_t alignment = static_cast<std::size_t>(offsetAlignment > 0 ? offsetAlignment : 256);
+    mySlotSize = (sizeof(FrameData) + alignment - 1) / alignment * alignment;
+
+    glGenBuffers(1, &myBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, myBuffer);
+
+    // Buffer storage is core since OpenGL 4.4 and RenderMate only creates 4.5 and 4.6 contexts
+    assert(GLAD_GL_VERSION_4_4);
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr bufferSize = static_cast<GLsizeiptr>(mySlotSize * FrameLatency);
+    glBufferStorage(GL_UNIFORM_BUFFER, bufferSize, nullptr, flags);
+    myMappedData = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, bufferSize, flags));
+    myIsPersistent = myMappedData != nullptr;
+
+    // Immutable storage cannot be respecified, so a failed map orphans a single slot of a fresh buffer every frame instead
+    if (!myIsPersistent)
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::GL, "Failed to map the frame uniform buffer");
+        glDeleteBuffers(1, &myBuffer);
+        glGenBuffers(1, &myBuffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, myBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(sizeof(FrameData)), nullptr, GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FrameUniformBuffer::Destroy()
+{
+    for (GLsync& fence : myFences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    if (myMappedData)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, myBuffer);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        myMappedData = nullptr;
+    }
+
+    glDeleteBuffers(1, &myBuffer);
+    myBuffer = 0;
+}
+
+void FrameUniformBuffer::Update(const Camera& aCamera)
+{
+    PROFILE_FUNCTION();
+
+    FrameData frameData;
+    frameData.myView = aCamera.GetViewMatrix();
+    frameData.myProjection = aCamera.GetProjectionMatrix();
+    frameData.myViewProjection = frameData.myProjection * frameData.myView;
+    frameData.myCameraPosition = glm::vec4(aCamera.GetPosition(), 1.0f);
+
+    if (!myIsPersistent)
+    {
+        // Orphaning hands the old storage to the driver, so the write does not wait for draws that still read it
+        glBindBuffer(GL_UNIFORM_BUFFER, myBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(sizeof(FrameData)), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(FrameData)), &frameData);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, frameDataBindingPoint, myBuffer);
+        return;
+    }
+
+    mySlotIndex = (mySlotIndex + 1) % FrameLatency;
+
+    // Only blocks when the CPU is more than FrameLatency frames ahead of the GPU
+    GLsync& fence = myFences[mySlotIndex];
+    if (fence)
+    {
+        GLenum waitResult = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        while (waitResult == GL_TIMEOUT_EXPIRED)
+            waitResult = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    const std::size_t offset = mySlotIndex * mySlotSize;
+    std::memcpy(myMappedData + offset, &frameData, sizeof(FrameData));
+    glBindBufferRange(GL_UNIFORM_BUFFER, frameDataBindingPoint, myBuffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(sizeof(FrameData)));
+}
+
+void FrameUniformBuffer::EndFrame()
+{
+    if (myIsPersistent)
+        myFences[mySlotIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+
+typedef struct __GLsync* GLsync;
+
+class Camera;
+
+// Matches the std140 FrameData block in Data/Shaders, so every member has to stay 16-byte aligned
+struct FrameData
+{
+    glm::mat4 myView;
+    glm::mat4 myProjection;
+    glm::mat4 myViewProjection;
+    glm::vec4 myCameraPosition;
+};
+
+// Per-frame camera data shared by every program through one uniform block binding.
+// The buffer is persistently mapped and split into one slot per frame in flight, each guarded by a fence,
+// so writing the next frame never waits on or stalls the draws of the previous ones.
+class FrameUniformBuffer
+{
+public:
+    FrameUniformBuffer();
+
+    void Initialize();
+    void Destroy();
+
+    // Writes the camera into the next slot and binds that slot to frameDataBindingPoint
+    void Update(const Camera& aCamera);
+
+    // Fences the current slot once all draws that read it have been submitted
+    void EndFrame();
+
+private:
+    static constexpr std::size_t FrameLatency = 3;
+
+    std::array<GLsync, FrameLatency> myFences;
+    unsigned char* myMappedData;
+    std::size_t mySlotSize;
+    std::size_t mySlotIndex;
+    unsigned int myBuffer;
+    bool myIsPersistent;
+};
@@ -0,0 +1,26 @@
+#include "Frustum.h"
+
+Frustum Frustum::FromViewProjection(const glm::mat4& aViewProjection)
+{
+    // Gribb and Hartmann: every plane is the last row of the matrix plus or minus one of the others
+    glm::vec4 rows[4];
+    for (int row = 0; row < 4; ++row)
+        rows[row] = glm::vec4(aViewProjection[0][row], aViewProjection[1][row], aViewProjection[2][row], aViewProjection[3][row]);
+
+    Frustum frustum;
+    frustum.myPlanes[Left] = rows[3] + rows[0];
+    frustum.myPlanes[Right] = rows[3] - rows[0];
+    frustum.myPlanes[Bottom] = rows[3] + rows[1];
+    frustum.myPlanes[Top] = rows[3] - rows[1];
+    frustum.myPlanes[Near] = rows[3] + rows[2];
+    frustum.myPlanes[Far] = rows[3] - rows[2];
+
+    for (glm::vec4& plane : frustum.myPlanes)
+    {
+        const float length = glm::length(glm::vec3(plane.x, plane.y, plane.z));
+        if (length > 0.0f)
+            plane = plane / length;
+    }
+
+    return frustum;
+}
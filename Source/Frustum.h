@@ -0,0 +1,25 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+
+// Six normalized planes as (normal, distance), with normals pointing into the frustum
+struct Frustum
+{
+    enum Plane
+    {
+        Left,
+        Right,
+        Bottom,
+        Top,
+        Near,
+        Far,
+        Count
+    };
+
+    // Extracts the planes of a GL clip space (-w <= z <= w) view-projection matrix
+    static Frustum FromViewProjection(const glm::mat4& aViewProjection);
+
+    std::array<glm::vec4, Count> myPlanes;
+};
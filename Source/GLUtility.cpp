@@ -1,5 +1,6 @@
 #include "GLUtility.h"
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 
@@ -62,6 +63,27 @@ namespace GLUtility
         assert(error == GL_NO_ERROR);
     }
 
+    void UploadStorageBuffer(unsigned int aBuffer, std::size_t& aCapacity, const void* someData, std::size_t aSize)
+    {
+        aCapacity = std::max(aCapacity, aSize);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, aBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(std::max<std::size_t>(aCapacity, 1)), nullptr, GL_STREAM_DRAW);
+        if (someData && aSize > 0)
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(aSize), someData);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    ScopedProgramRestore::ScopedProgramRestore()
+        : myProgram(0)
+    {
+        glGetIntegerv(GL_CURRENT_PROGRAM, &myProgram);
+    }
+
+    ScopedProgramRestore::~ScopedProgramRestore()
+    {
+        glUseProgram(static_cast<GLuint>(myProgram));
+    }
+
     void APIENTRY GLDebugMessageCallback(GLenum aSource, GLenum aType, unsigned int anIdentifier, GLenum aSeverity, int /*aLength*/, const char* aMessage, const void* /*anUserParam*/)
     {
         // Ignore insignificant error codes
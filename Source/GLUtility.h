@@ -2,8 +2,29 @@
 
 #include "glad/glad.h"
 
+#include <cstddef>
+
 namespace GLUtility
 {
+	// Orphans the shader storage buffer every frame like InstanceBuffer, and only reallocates it when the data no longer fits.
+	// Without data the buffer is left undefined for a compute pass to fill.
+	void UploadStorageBuffer(unsigned int aBuffer, std::size_t& aCapacity, const void* someData, std::size_t aSize);
+
+	// Puts back the program that was current when it was created. Compute passes dispatched while the caller is in the
+	// middle of drawing hold one, so the program of the caller survives the dispatch.
+	class ScopedProgramRestore
+	{
+	public:
+		ScopedProgramRestore();
+		~ScopedProgramRestore();
+
+		ScopedProgramRestore(const ScopedProgramRestore&) = delete;
+		ScopedProgramRestore& operator=(const ScopedProgramRestore&) = delete;
+
+	private:
+		GLint myProgram;
+	};
+
 	void CheckForGLErrors();
 	void APIENTRY GLDebugMessageCallback(GLenum aSource, GLenum aType, unsigned int anIdentifier, GLenum aSeverity, int aLength, const char* aMessage, const void* anUserParam);
 	void GLFWErrorCallback(int anError, const char* aDescription);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Where a mesh lives inside the GeometryPool buffers, in elements rather than bytes
+struct GeometryAllocation
+{
+    [[nodiscard]] std::size_t GetIndexSize() const { return myHasShortIndices ? sizeof(uint16_t) : sizeof(uint32_t); }
+
+    unsigned int myFirstIndex = 0;
+    unsigned int myIndexCount = 0;
+    int myBaseVertex = 0;
+    // Picks the vertex layout, and with it the stride myBaseVertex counts in, see PackedVertex
+    bool myHasVertexColors = false;
+    // Set when every index fits 16 bits, myFirstIndex then counts in shorts
+    bool myHasShortIndices = false;
+    // Range of the pool's meshlet buffer, empty for meshes drawn whole, see GeometryPool::AllocateMeshlets
+    unsigned int myFirstMeshlet = 0;
+    unsigned int myMeshletCount = 0;
+};
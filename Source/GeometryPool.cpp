@@ -0,0 +1,436 @@
+#include "GeometryPool.h"
+
+#include "AppDefinitions.h"
+#include "BoundingBox.h"
+#include "ClusterCuller.h"
+#include "LogUtility.h"
+#include "Meshlet.h"
+#include "ModelInstance.h"
+#include "OcclusionCuller.h"
+#include "PackedVertex.h"
+#include "Profiler.h"
+#include "UploadRing.h"
+#include "Vertex.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace
+{
+    constexpr std::size_t InitialVertexByteCapacity = (1 << 16) * PackedVertex::StrideWithColor;
+    constexpr std::size_t InitialIndexByteCapacity = (3 << 16) * sizeof(uint32_t);
+    constexpr std::size_t InitialMeshletCapacity = 1 << 12;
+    constexpr GLuint VertexBindingIndex = 0;
+    constexpr GLuint InstanceBindingIndex = 1;
+
+    void SetupVertexArray(GLuint aVertexArrayObject, bool aHasVertexColors)
+    {
+        glBindVertexArray(aVertexArrayObject);
+
+        // Positions are unpacked to [-1, 1] here and the instance transform moves them back into the mesh bounds
+        glVertexAttribFormat(0, 3, GL_SHORT, GL_TRUE, offsetof(PackedVertex, myPosition));
+        glVertexAttribFormat(2, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(PackedVertex, myTextureCoordinates));
+        glVertexAttribBinding(0, VertexBindingIndex);
+        glVertexAttribBinding(2, VertexBindingIndex);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(2);
+
+        if (aHasVertexColors)
+        {
+            glVertexAttribFormat(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(PackedVertex, myColor));
+            glVertexAttribBinding(1, VertexBindingIndex);
+            glEnableVertexAttribArray(1);
+        }
+
+        // A mat4 attribute takes four consecutive locations, one per column
+        for (GLuint column = 0; column < 4; ++column)
+            glVertexAttribFormat(3 + column, 4, GL_FLOAT, GL_FALSE, static_cast<GLuint>(offsetof(ModelInstance, myTransform) + sizeof(glm::vec4) * column));
+        glVertexAttribFormat(7, 4, GL_FLOAT, GL_FALSE, offsetof(ModelInstance, myColor));
+        for (GLuint location = 3; location < 8; ++location)
+        {
+            glVertexAttribBinding(location, InstanceBindingIndex);
+            glEnableVertexAttribArray(location);
+        }
+        glVertexBindingDivisor(InstanceBindingIndex, 1);
+
+        glBindVertexArray(0);
+    }
+}
+
+GeometryPool::GeometryPool(UploadRing& anUploadRing)
+    : myUploadRing(anUploadRing)
+    , myVertexByteCount(0)
+    , myVertexByteCapacity(0)
+    , myIndexByteCount(0)
+    , myIndexByteCapacity(0)
+    , myCommandCapacity(0)
+    , myMeshletCount(0)
+    , myMeshletCapacity(0)
+    , myClusterCommandCount(0)
+    , myVertexArrayObject(0)
+    , myColoredVertexArrayObject(0)
+    , myVertexBufferObject(0)
+    , myElementBufferObject(0)
+    , myIndirectBufferObject(0)
+    , myMeshletBufferObject(0)
+{
+}
+
+void GeometryPool::Initialize()
+{
+    myVertexByteCapacity = InitialVertexByteCapacity;
+    myIndexByteCapacity = InitialIndexByteCapacity;
+
+    glGenBuffers(1, &myVertexBufferObject);
+    glBindBuffer(GL_ARRAY_BUFFER, myVertexBufferObject);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(myVertexByteCapacity), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // The element buffer binding belongs to a VAO, it is attached to both of them by BindBuffers
+    glGenBuffers(1, &myElementBufferObject);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, myElementBufferObject);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(myIndexByteCapacity), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glGenBuffers(1, &myIndirectBufferObject);
+
+    // Only read by the cluster culling pass, never by the vertex stage
+    myMeshletCapacity = InitialMeshletCapacity;
+    glGenBuffers(1, &myMeshletBufferObject);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, myMeshletBufferObject);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(myMeshletCapacity * sizeof(Meshlet)), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // Separate attribute formats let the buffers be replaced when they grow without describing the layout again
+    glGenVertexArrays(1, &myVertexArrayObject);
+    glGenVertexArrays(1, &myColoredVertexArrayObject);
+    SetupVertexArray(myVertexArrayObject, false);
+    SetupVertexArray(myColoredVertexArrayObject, true);
+    BindBuffers(0);
+
+    // Meshes without vertex colors have location 1 disabled and read this instead, it is context state rather than VAO state
+    glVertexAttrib4f(1, 1.0f, 1.0f, 1.0f, 1.0f);
+}
+
+void GeometryPool::Destroy()
+{
+    myInstanceBuffer.Destroy();
+    glDeleteVertexArrays(1, &myVertexArrayObject);
+    glDeleteVertexArrays(1, &myColoredVertexArrayObject);
+    glDeleteBuffers(1, &myVertexBufferObject);
+    glDeleteBuffers(1, &myElementBufferObject);
+    glDeleteBuffers(1, &myIndirectBufferObject);
+    glDeleteBuffers(1, &myMeshletBufferObject);
+    myVertexArrayObject = 0;
+    myColoredVertexArrayObject = 0;
+    myVertexBufferObject = 0;
+    myElementBufferObject = 0;
+    myIndirectBufferObject = 0;
+    myMeshletBufferObject = 0;
+    myVertexByteCount = 0;
+    myIndexByteCount = 0;
+    myMeshletCount = 0;
+}
+
+GeometryAllocation GeometryPool::Allocate(const std::vector<Vertex>& someVertices, const BoundingBox& aBounds, const std::vector<unsigned int>& someIndices)
+{
+    PROFILE_FUNCTION();
+
+    GeometryAllocation vertexAllocation;
+    vertexAllocation.myHasVertexColors = PackedVertex::HasColors(someVertices);
+    const std::vector<unsigned char> packedVertices = PackedVertex::Pack(someVertices, aBounds, vertexAllocation.myHasVertexColors);
+
+    // Both layouts share the buffer, so each allocation starts on a multiple of its own stride for myBaseVertex to reach it
+    const std::size_t stride = vertexAllocation.myHasVertexColors ? PackedVertex::StrideWithColor : PackedVertex::StrideWithoutColor;
+    const std::size_t vertexOffset = (myVertexByteCount + stride - 1) / stride * stride;
+    if (vertexOffset + packedVertices.size() > myVertexByteCapacity)
+    {
+        myVertexByteCapacity = std::max(myVertexByteCapacity * 2, vertexOffset + packedVertices.size());
+        GrowBuffer(myVertexBufferObject, myVertexByteCount, myVertexByteCapacity);
+        BindBuffers(myInstanceBuffer.GetIdentifier());
+    }
+
+    vertexAllocation.myBaseVertex = static_cast<int>(vertexOffset / stride);
+
+    myUploadRing.UploadBuffer(myVertexBufferObject, vertexOffset, packedVertices.data(), packedVertices.size());
+
+    myVertexByteCount = vertexOffset + packedVertices.size();
+    return AllocateIndices(vertexAllocation, someIndices);
+}
+
+GeometryAllocation GeometryPool::AllocateIndices(const GeometryAllocation& aVertexAllocation, const std::vector<unsigned int>& someIndices)
+{
+    GeometryAllocation allocation;
+    allocation.myIndexCount = static_cast<unsigned int>(someIndices.size());
+    allocation.myBaseVertex = aVertexAllocation.myBaseVertex;
+    allocation.myHasVertexColors = aVertexAllocation.myHasVertexColors;
+    allocation.myHasShortIndices = someIndices.empty() || *std::max_element(someIndices.begin(), someIndices.end()) <= UINT16_MAX;
+
+    std::vector<uint16_t> shortIndices;
+    if (allocation.myHasShortIndices)
+        shortIndices.assign(someIndices.begin(), someIndices.end());
+
+    // Like the vertices, both index types share the buffer and each allocation starts on a multiple of its own size
+    const std::size_t indexSize = allocation.GetIndexSize();
+    const std::size_t indexOffset = (myIndexByteCount + indexSize - 1) / indexSize * indexSize;
+    const std::size_t indexBytes = someIndices.size() * indexSize;
+    if (indexOffset + indexBytes > myIndexByteCapacity)
+    {
+        myIndexByteCapacity = std::max(myIndexByteCapacity * 2, indexOffset + indexBytes);
+        GrowBuffer(myElementBufferObject, myIndexByteCount, myIndexByteCapacity);
+        BindBuffers(myInstanceBuffer.GetIdentifier());
+    }
+
+    allocation.myFirstIndex = static_cast<unsigned int>(indexOffset / indexSize);
+
+    const void* indexData = allocation.myHasShortIndices ? static_cast<const void*>(shortIndices.data()) : static_cast<const void*>(someIndices.data());
+    myUploadRing.UploadBuffer(myElementBufferObject, indexOffset, indexData, indexBytes);
+
+    myIndexByteCount = indexOffset + indexBytes;
+    return allocation;
+}
+
+void GeometryPool::AllocateMeshlets(GeometryAllocation& anAllocation, const std::vector<Meshlet>& someMeshlets)
+{
+    PROFILE_FUNCTION();
+
+    if (myMeshletCount + someMeshlets.size() > myMeshletCapacity)
+    {
+        myMeshletCapacity = std::max(myMeshletCapacity * 2, myMeshletCount + someMeshlets.size());
+        GrowBuffer(myMeshletBufferObject, myMeshletCount * sizeof(Meshlet), myMeshletCapacity * sizeof(Meshlet));
+    }
+
+    anAllocation.myFirstMeshlet = static_cast<unsigned int>(myMeshletCount);
+    anAllocation.myMeshletCount = static_cast<unsigned int>(someMeshlets.size());
+
+    myUploadRing.UploadBuffer(myMeshletBufferObject, myMeshletCount * sizeof(Meshlet), someMeshlets.data(), someMeshlets.size() * sizeof(Meshlet));
+
+    myMeshletCount += someMeshlets.size();
+}
+
+void GeometryPool::UploadInstances(const std::vector<ModelInstance>& someInstances)
+{
+    myInstanceBuffer.Upload(someInstances);
+    BindBuffers(myInstanceBuffer.GetIdentifier());
+}
+
+void GeometryPool::AddDraw(const GeometryAllocation& anAllocation, unsigned int aTexture, unsigned int anInstanceCount, unsigned int aBaseInstance)
+{
+    if (anAllocation.myIndexCount == 0 || anInstanceCount == 0)
+        return;
+
+    myQueuedDraws.push_back(MakeQueuedDraw(anAllocation, aTexture, anInstanceCount, aBaseInstance));
+}
+
+void GeometryPool::AddClusterDraw(const GeometryAllocation& anAllocation, const BoundingBox& aBounds, unsigned int aTexture, unsigned int anInstanceCount, unsigned int aBaseInstance)
+{
+    if (anAllocation.myIndexCount == 0 || anInstanceCount == 0)
+        return;
+
+    // Every meshlet of every instance needs a command slot, very dense scenes are better off drawing whole meshes
+    const std::size_t commandCount = static_cast<std::size_t>(anAllocation.myMeshletCount) * anInstanceCount;
+    if (anAllocation.myMeshletCount == 0 || myClusterCommandCount + commandCount > maxClusterCommandCount)
+    {
+        AddDraw(anAllocation, aTexture, anInstanceCount, aBaseInstance);
+        return;
+    }
+
+    QueuedClusterDraw queuedDraw;
+    queuedDraw.myWholeDraw = MakeQueuedDraw(anAllocation, aTexture, anInstanceCount, aBaseInstance);
+    queuedDraw.myDraw.myFirstMeshlet = anAllocation.myFirstMeshlet;
+    queuedDraw.myDraw.myMeshletCount = anAllocation.myMeshletCount;
+    queuedDraw.myDraw.myFirstIndex = anAllocation.myFirstIndex;
+    queuedDraw.myDraw.myBaseVertex = anAllocation.myBaseVertex;
+    queuedDraw.myDraw.myBaseInstance = aBaseInstance;
+    queuedDraw.myDraw.myInstanceCount = anInstanceCount;
+    queuedDraw.myDraw.myCommandOffset = static_cast<unsigned int>(myClusterCommandCount);
+    queuedDraw.myDraw.myQuantizationCenter = glm::vec4(aBounds.GetCenter(), 0.0f);
+    queuedDraw.myDraw.myQuantizationInverseExtents = glm::vec4(1.0f / PackedVertex::GetQuantizationExtents(aBounds), 0.0f);
+    myQueuedClusterDraws.push_back(queuedDraw);
+    myClusterCommandCount += commandCount;
+}
+
+int GeometryPool::Submit(OcclusionCuller* anOcclusionCuller, ClusterCuller* aClusterCuller)
+{
+    PROFILE_FUNCTION();
+
+    // Without a culler the meshlets are never tested, so the meshes are drawn whole
+    if (!aClusterCuller)
+    {
+        for (const QueuedClusterDraw& queuedDraw : myQueuedClusterDraws)
+            myQueuedDraws.push_back(queuedDraw.myWholeDraw);
+        myQueuedClusterDraws.clear();
+    }
+
+    int multiDrawCount = SubmitDraws(anOcclusionCuller);
+    if (aClusterCuller)
+        multiDrawCount += SubmitClusterDraws(*aClusterCuller);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    myQueuedClusterDraws.clear();
+    myClusterCommandCount = 0;
+    return multiDrawCount;
+}
+
+int GeometryPool::SubmitDraws(OcclusionCuller* anOcclusionCuller)
+{
+    if (myQueuedDraws.empty())
+        return 0;
+
+    std::stable_sort(myQueuedDraws.begin(), myQueuedDraws.end(), [](const QueuedDraw& aLeft, const QueuedDraw& aRight) { return aLeft.GetBatchKey() < aRight.GetBatchKey(); });
+
+    myCommands.clear();
+    for (const QueuedDraw& queuedDraw : myQueuedDraws)
+        myCommands.push_back(queuedDraw.myCommand);
+
+    if (anOcclusionCuller)
+    {
+        // The culled commands keep the order of myCommands, so the batches below still line up with them
+        anOcclusionCuller->Cull(myCommands, myInstanceBuffer.GetIdentifier());
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, anOcclusionCuller->GetCommandBuffer());
+        BindBuffers(anOcclusionCuller->GetVisibleInstanceBuffer());
+    }
+    else
+    {
+        // Orphaned every frame, the previous commands may still be in flight
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, myIndirectBufferObject);
+        myCommandCapacity = std::max(myCommandCapacity, myCommands.size());
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(myCommandCapacity * sizeof(DrawElementsIndirectCommand)), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, static_cast<GLsizeiptr>(myCommands.size() * sizeof(DrawElementsIndirectCommand)), myCommands.data());
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+
+    int multiDrawCount = 0;
+    std::size_t batchStart = 0;
+    while (batchStart < myQueuedDraws.size())
+    {
+        const QueuedDraw& firstDraw = myQueuedDraws[batchStart];
+        std::size_t batchEnd = batchStart + 1;
+        while (batchEnd < myQueuedDraws.size() && myQueuedDraws[batchEnd].GetBatchKey() == firstDraw.GetBatchKey())
+            ++batchEnd;
+
+        glBindVertexArray(GetVertexArrayObject(firstDraw.myHasVertexColors));
+        glBindTexture(GL_TEXTURE_2D, firstDraw.myTexture);
+        const std::size_t commandOffset = batchStart * sizeof(DrawElementsIndirectCommand);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, firstDraw.myHasShortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, reinterpret_cast<const void*>(commandOffset), static_cast<GLsizei>(batchEnd - batchStart), 0);
+        ++multiDrawCount;
+
+        batchStart = batchEnd;
+    }
+
+    if (anOcclusionCuller)
+        BindBuffers(myInstanceBuffer.GetIdentifier());
+
+    myQueuedDraws.clear();
+    return multiDrawCount;
+}
+
+int GeometryPool::SubmitClusterDraws(ClusterCuller& aClusterCuller)
+{
+    if (myQueuedClusterDraws.empty())
+        return 0;
+
+    myClusterDraws.clear();
+    for (const QueuedClusterDraw& queuedDraw : myQueuedClusterDraws)
+        myClusterDraws.push_back(queuedDraw.myDraw);
+
+    aClusterCuller.Cull(myClusterDraws, myClusterCommandCount, myMeshletBufferObject, myInstanceBuffer.GetIdentifier());
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, aClusterCuller.GetCommandBuffer());
+    if (aClusterCuller.HasDrawCount())
+        glBindBuffer(GL_PARAMETER_BUFFER, aClusterCuller.GetDrawCountBuffer());
+
+    glActiveTexture(GL_TEXTURE0);
+
+    // Each draw has its own count, so unlike the plain draws they cannot share a multi-draw even when their state matches
+    for (std::size_t drawIndex = 0; drawIndex < myQueuedClusterDraws.size(); ++drawIndex)
+    {
+        const QueuedClusterDraw& queuedDraw = myQueuedClusterDraws[drawIndex];
+        const GLenum indexType = queuedDraw.myWholeDraw.myHasShortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        const std::size_t commandOffset = queuedDraw.myDraw.myCommandOffset * sizeof(DrawElementsIndirectCommand);
+        const GLsizei maxCommandCount = static_cast<GLsizei>(queuedDraw.myDraw.myMeshletCount * queuedDraw.myDraw.myInstanceCount);
+
+        glBindVertexArray(GetVertexArrayObject(queuedDraw.myWholeDraw.myHasVertexColors));
+        glBindTexture(GL_TEXTURE_2D, queuedDraw.myWholeDraw.myTexture);
+        if (aClusterCuller.HasDrawCount())
+        {
+            glMultiDrawElementsIndirectCount(GL_TRIANGLES, indexType, reinterpret_cast<const void*>(commandOffset),
+                static_cast<GLintptr>(drawIndex * sizeof(unsigned int)), maxCommandCount, 0);
+        }
+        else
+        {
+            // The culled commands were cleared before the pass, so the slots behind the visible ones draw nothing
+            glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, reinterpret_cast<const void*>(commandOffset), maxCommandCount, 0);
+        }
+    }
+
+    if (aClusterCuller.HasDrawCount())
+        glBindBuffer(GL_PARAMETER_BUFFER, 0);
+
+    return static_cast<int>(myQueuedClusterDraws.size());
+}
+
+GeometryPool::QueuedDraw GeometryPool::MakeQueuedDraw(const GeometryAllocation& anAllocation, unsigned int aTexture, unsigned int anInstanceCount, unsigned int aBaseInstance)
+{
+    QueuedDraw queuedDraw;
+    queuedDraw.myTexture = aTexture;
+    queuedDraw.myHasVertexColors = anAllocation.myHasVertexColors;
+    queuedDraw.myHasShortIndices = anAllocation.myHasShortIndices;
+    queuedDraw.myCommand.myCount = anAllocation.myIndexCount;
+    queuedDraw.myCommand.myInstanceCount = anInstanceCount;
+    queuedDraw.myCommand.myFirstIndex = anAllocation.myFirstIndex;
+    queuedDraw.myCommand.myBaseVertex = anAllocation.myBaseVertex;
+    queuedDraw.myCommand.myBaseInstance = aBaseInstance;
+    return queuedDraw;
+}
+
+void GeometryPool::Draw(const GeometryAllocation& anAllocation, unsigned int aTexture, unsigned int anInstanceCount, unsigned int aBaseInstance) const
+{
+    glBindVertexArray(GetVertexArrayObject(anAllocation.myHasVertexColors));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, aTexture);
+
+    const std::size_t indexOffset = anAllocation.myFirstIndex * anAllocation.GetIndexSize();
+    const GLenum indexType = anAllocation.myHasShortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, static_cast<GLsizei>(anAllocation.myIndexCount), indexType, reinterpret_cast<const void*>(indexOffset),
+        static_cast<GLsizei>(anInstanceCount), anAllocation.myBaseVertex, aBaseInstance);
+}
+
+void GeometryPool::GrowBuffer(unsigned int& aBuffer, std::size_t aUsedSize, std::size_t aNewCapacity)
+{
+    PROFILE_FUNCTION();
+
+    LogUtility::PrintMessage(LogUtility::LogCategory::Graphics, "Growing geometry pool buffer to %zu bytes", aNewCapacity);
+
+    unsigned int newBuffer = 0;
+    glGenBuffers(1, &newBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(aNewCapacity), nullptr, GL_STATIC_DRAW);
+
+    if (aUsedSize > 0)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, aBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(aUsedSize));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &aBuffer);
+    aBuffer = newBuffer;
+}
+
+void GeometryPool::BindBuffers(unsigned int anInstanceBuffer) const
+{
+    for (const bool hasVertexColors : { false, true })
+    {
+        glBindVertexArray(GetVertexArrayObject(hasVertexColors));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myElementBufferObject);
+        glBindVertexBuffer(VertexBindingIndex, myVertexBufferObject, 0, static_cast<GLsizei>(hasVertexColors ? PackedVertex::StrideWithColor : PackedVertex::StrideWithoutColor));
+        glBindVertexBuffer(InstanceBindingIndex, anInstanceBuffer, 0, sizeof(ModelInstance));
+    }
+    glBindVertexArray(0);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "ClusterDraw.h"
+#include "DrawElementsIndirectCommand.h"
+#include "GeometryAllocation.h"
+#include "InstanceBuffer.h"
+
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+class ClusterCuller;
+class OcclusionCuller;
+class UploadRing;
+struct BoundingBox;
+struct Meshlet;
+struct ModelInstance;
+struct Vertex;
+
+// Sub-allocates static meshes into one shared vertex buffer and one shared index buffer behind a single VAO,
+// so a whole scene can be submitted with a few glMultiDrawElementsIndirect calls instead of one draw per mesh.
+// Vertices are stored as PackedVertex, with one VAO per vertex layout over the same buffers, and indices are 16-bit wherever they fit.
+// Allocations are never freed individually, the pool only grows until Destroy. Uploads are staged through the UploadRing.
+class GeometryPool
+{
+public:
+    explicit GeometryPool(UploadRing& anUploadRing);
+
+    void Initialize();
+    void Destroy();
+
+    // Packs the vertices relative to aBounds, which the instance transforms then have to undo, see PackedVertex
+    GeometryAllocation Allocate(const std::vector<Vertex>& someVertices, const BoundingBox& aBounds, const std::vector<unsigned int>& someIndices);
+    // Adds another index buffer over the vertices of an earlier allocation, such as a level of detail of the same mesh
+    GeometryAllocation AllocateIndices(const GeometryAllocation& aVertexAllocation, const std::vector<unsigned int>& someIndices);
+    // Uploads the meshlets of an allocation into the shared meshlet buffer, their index ranges stay relative to the allocation
+    void AllocateMeshlets(GeometryAllocation& anAllocation, const std::vector<Meshlet>& someMeshlets);
+    void UploadInstances(const std::vector<ModelInstance>& someInstances);
+
+    // Queues a draw for Submit. Draws are grouped by texture since that is the only state that changes between them.
+    void AddDraw(const GeometryAllocation& anAllocation, unsigned int aTexture, unsigned int anInstanceCount, unsigned int aBaseInstance);
+    // Queues a draw of an allocation with meshlets, which Submit culls per meshlet and instance. aBounds are the bounds the
+    // vertices were packed with. Falls back to AddDraw when the meshlet commands of the frame would not fit maxClusterCommandCount.
+    void AddClusterDraw(const GeometryAllocation& anAllocation, const BoundingBox& aBounds, unsigned int aTexture, unsigned int anInstanceCount, unsigned int aBaseInstance);
+
+    // Writes the queued draws to the indirect buffer, issues one multi-draw per texture and vertex layout and returns the number of multi-draws.
+    // With an occlusion culler the commands and instances are taken from its output instead, after it has culled them.
+    // Cluster draws need a cluster culler and get one multi-draw each, they are not occlusion culled.
+    int Submit(OcclusionCuller* anOcclusionCuller = nullptr, ClusterCuller* aClusterCuller = nullptr);
+
+    // Binds the VAO of the allocation and draws it right away, used when multi-draw indirect is disabled
+    void Draw(const GeometryAllocation& anAllocation, unsigned int aTexture, unsigned int anInstanceCount, unsigned int aBaseInstance) const;
+
+    [[nodiscard]] std::size_t GetQueuedDrawCount() const { return myQueuedDraws.size() + myQueuedClusterDraws.size(); }
+    // Meshlets the queued cluster draws will test, counting every instance separately
+    [[nodiscard]] std::size_t GetQueuedClusterCount() const { return myClusterCommandCount; }
+
+private:
+    struct QueuedDraw
+    {
+        // Draws can only share a multi-draw when their texture, vertex layout and index type all match
+        [[nodiscard]] std::tuple<bool, bool, unsigned int> GetBatchKey() const { return std::make_tuple(myHasVertexColors, myHasShortIndices, myTexture); }
+
+        unsigned int myTexture;
+        bool myHasVertexColors;
+        bool myHasShortIndices;
+        DrawElementsIndirectCommand myCommand;
+    };
+
+    struct QueuedClusterDraw
+    {
+        // The same mesh drawn whole, for its state and for when there is no culler to cull the meshlets
+        QueuedDraw myWholeDraw;
+        ClusterDraw myDraw;
+    };
+
+    static QueuedDraw MakeQueuedDraw(const GeometryAllocation& anAllocation, unsigned int aTexture, unsigned int anInstanceCount, unsigned int aBaseInstance);
+
+    static void GrowBuffer(unsigned int& aBuffer, std::size_t aUsedSize, std::size_t aNewCapacity);
+
+    // Points both VAOs at the current vertex, index and instance buffers, after any of them was replaced
+    void BindBuffers(unsigned int anInstanceBuffer) const;
+    [[nodiscard]] unsigned int GetVertexArrayObject(bool aHasVertexColors) const { return aHasVertexColors ? myColoredVertexArrayObject : myVertexArrayObject; }
+    int SubmitDraws(OcclusionCuller* anOcclusionCuller);
+    int SubmitClusterDraws(ClusterCuller& aClusterCuller);
+
+    std::vector<QueuedDraw> myQueuedDraws;
+    std::vector<QueuedClusterDraw> myQueuedClusterDraws;
+    std::vector<DrawElementsIndirectCommand> myCommands;
+    std::vector<ClusterDraw> myClusterDraws;
+    InstanceBuffer myInstanceBuffer;
+    UploadRing& myUploadRing;
+    std::size_t myVertexByteCount;
+    std::size_t myVertexByteCapacity;
+    std::size_t myIndexByteCount;
+    std::size_t myIndexByteCapacity;
+    std::size_t myCommandCapacity;
+    std::size_t myMeshletCount;
+    std::size_t myMeshletCapacity;
+    std::size_t myClusterCommandCount;
+    unsigned int myVertexArrayObject;
+    unsigned int myColoredVertexArrayObject;
+    unsigned int myVertexBufferObject;
+    unsigned int myElementBufferObject;
+    unsigned int myIndirectBufferObject;
+    unsigned int myMeshletBufferObject;
+};
@@ -0,0 +1,155 @@
+#include "GpuProfiler.h"
+
+#include "LogUtility.h"
+#include "Profiler.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+namespace
+{
+    constexpr std::size_t NoZone = static_cast<std::size_t>(-1);
+}
+
+GpuProfiler::GpuProfiler()
+    : myFrames{}
+    , myFrameIndex(0)
+    , myOpenZoneIndex(NoZone)
+    , myTrack(0)
+    , myIsEnabled(false)
+    , myIsInFrame(false)
+{
+}
+
+void GpuProfiler::Initialize()
+{
+    // Timer queries are core since OpenGL 3.3, which includes llvmpipe and every driver we run on
+    if (!GLAD_GL_VERSION_3_3)
+    {
+        LogUtility::PrintMessage(LogUtility::LogCategory::GL, "Timer queries are not supported, GPU profiling is disabled");
+        return;
+    }
+
+    for (Frame& frame : myFrames)
+    {
+        glGenQueries(static_cast<GLsizei>(frame.myQueries.size()), frame.myQueries.data());
+        frame.myZones.reserve(MaxZonesPerFrame);
+        frame.myCpuTime = 0;
+        frame.myGpuTime = 0;
+        frame.myLastQuery = 0;
+        frame.myIsPending = false;
+    }
+
+    myTrack = Profiler::CreateTrack("GPU");
+    myIsEnabled = true;
+}
+
+void GpuProfiler::Destroy()
+{
+    if (!myIsEnabled)
+        return;
+
+    for (Frame& frame : myFrames)
+        glDeleteQueries(static_cast<GLsizei>(frame.myQueries.size()), frame.myQueries.data());
+
+    myIsEnabled = false;
+}
+
+void GpuProfiler::BeginFrame()
+{
+    if (!myIsEnabled)
+        return;
+
+    Frame& frame = myFrames[myFrameIndex % FrameLatency];
+    if (frame.myIsPending)
+        ReadBackFrame(frame);
+
+    // Pair the GPU clock with the CPU clock so GPU zones line up with the CPU zones in a capture
+    frame.myZones.clear();
+    frame.myCpuTime = Profiler::GetTimestamp();
+    glGetInteger64v(GL_TIMESTAMP, &frame.myGpuTime);
+    myOpenZoneIndex = NoZone;
+    myIsInFrame = true;
+}
+
+void GpuProfiler::EndFrame()
+{
+    if (!myIsEnabled || !myIsInFrame)
+        return;
+
+    Frame& frame = myFrames[myFrameIndex % FrameLatency];
+    while (myOpenZoneIndex != NoZone)
+        EndZone();
+
+    frame.myIsPending = !frame.myZones.empty();
+    myIsInFrame = false;
+    ++myFrameIndex;
+}
+
+void GpuProfiler::BeginZone(const char* aName)
+{
+    if (!myIsEnabled || !myIsInFrame)
+        return;
+
+    Frame& frame = myFrames[myFrameIndex % FrameLatency];
+    if (frame.myZones.size() >= MaxZonesPerFrame)
+        return;
+
+    frame.myLastQuery = frame.myQueries[frame.myZones.size() * 2];
+    glQueryCounter(frame.myLastQuery, GL_TIMESTAMP);
+    frame.myZones.push_back(Zone{ aName, myOpenZoneIndex, false });
+    myOpenZoneIndex = frame.myZones.size() - 1;
+}
+
+void GpuProfiler::EndZone()
+{
+    if (!myIsEnabled || !myIsInFrame || myOpenZoneIndex == NoZone)
+        return;
+
+    Frame& frame = myFrames[myFrameIndex % FrameLatency];
+    Zone& zone = frame.myZones[myOpenZoneIndex];
+    frame.myLastQuery = frame.myQueries[myOpenZoneIndex * 2 + 1];
+    glQueryCounter(frame.myLastQuery, GL_TIMESTAMP);
+    zone.myIsEnded = true;
+    myOpenZoneIndex = zone.myParentIndex;
+}
+
+void GpuProfiler::LogResults() const
+{
+    for (const GpuZoneResult& result : myLatestResults)
+        LogUtility::PrintMessage(LogUtility::LogCategory::GL, "GPU %s: %.3f ms", result.myName, result.myMilliseconds);
+}
+
+void GpuProfiler::ReadBackFrame(Frame& aFrame)
+{
+    aFrame.myIsPending = false;
+
+    // Queries complete in order, so the last one issued tells whether the whole frame is available.
+    // A frame that is still in flight after FrameLatency frames is dropped rather than waited on.
+    GLint isAvailable = GL_FALSE;
+    glGetQueryObjectiv(aFrame.myLastQuery, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+    if (isAvailable == GL_FALSE)
+        return;
+
+    myLatestResults.clear();
+    for (std::size_t i = 0; i < aFrame.myZones.size(); ++i)
+    {
+        const Zone& zone = aFrame.myZones[i];
+        if (!zone.myIsEnded)
+            continue;
+
+        GLuint64 beginTime = 0;
+        GLuint64 endTime = 0;
+        glGetQueryObjectui64v(aFrame.myQueries[i * 2], GL_QUERY_RESULT, &beginTime);
+        glGetQueryObjectui64v(aFrame.myQueries[i * 2 + 1], GL_QUERY_RESULT, &endTime);
+
+        const int64_t beginOffset = static_cast<int64_t>(beginTime) - aFrame.myGpuTime;
+        const int64_t endOffset = static_cast<int64_t>(endTime) - aFrame.myGpuTime;
+        const uint64_t cpuBeginTime = static_cast<uint64_t>(std::max<int64_t>(static_cast<int64_t>(aFrame.myCpuTime) + beginOffset, 0));
+        const uint64_t cpuEndTime = static_cast<uint64_t>(std::max<int64_t>(static_cast<int64_t>(aFrame.myCpuTime) + endOffset, 0));
+        Profiler::RecordTrackZone(myTrack, zone.myName, cpuBeginTime, cpuEndTime);
+
+        myLatestResults.push_back(GpuZoneResult{ zone.myName, static_cast<double>(endTime - beginTime) / 1000000.0 });
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+struct GpuZoneResult
+{
+    const char* myName;
+    double myMilliseconds;
+};
+
+// Measures GPU time per pass with GL_TIMESTAMP queries. Queries are kept in a ring of several frames
+// and only read back once available, so measuring never stalls the pipeline.
+class GpuProfiler
+{
+public:
+    GpuProfiler();
+
+    void Initialize();
+    void Destroy();
+
+    void BeginFrame();
+    void EndFrame();
+
+    // aName must outlive the profiler, which in practice means a string literal
+    void BeginZone(const char* aName);
+    void EndZone();
+
+    void LogResults() const;
+
+    [[nodiscard]] const std::vector<GpuZoneResult>& GetLatestResults() const { return myLatestResults; }
+    [[nodiscard]] bool IsEnabled() const { return myIsEnabled; }
+
+    class ScopedZone
+    {
+    public:
+        ScopedZone(GpuProfiler& aGpuProfiler, const char* aName)
+            : myGpuProfiler(aGpuProfiler)
+        {
+            myGpuProfiler.BeginZone(aName);
+        }
+
+        ~ScopedZone() { myGpuProfiler.EndZone(); }
+
+        ScopedZone(const ScopedZone&) = delete;
+        ScopedZone& operator=(const ScopedZone&) = delete;
+
+    private:
+        GpuProfiler& myGpuProfiler;
+    };
+
+private:
+    static constexpr std::size_t FrameLatency = 4;
+    static constexpr std::size_t MaxZonesPerFrame = 32;
+
+    struct Zone
+    {
+        const char* myName;
+        std::size_t myParentIndex;
+        bool myIsEnded;
+    };
+
+    struct Frame
+    {
+        std::array<unsigned int, MaxZonesPerFrame * 2> myQueries;
+        std::vector<Zone> myZones;
+        uint64_t myCpuTime;
+        int64_t myGpuTime;
+        unsigned int myLastQuery;
+        bool myIsPending;
+    };
+
+    void ReadBackFrame(Frame& aFrame);
+
+    std::array<Frame, FrameLatency> myFrames;
+    std::vector<GpuZoneResult> myLatestResults;
+    std::size_t myFrameIndex;
+    std::size_t myOpenZoneIndex;
+    uint32_t myTrack;
+    bool myIsEnabled;
+    bool myIsInFrame;
+};
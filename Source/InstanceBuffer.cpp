@@ -0,0 +1,46 @@
+#include "InstanceBuffer.h"
+
+#include "ModelInstance.h"
+#include "Profiler.h"
+
+#include <glad/glad.h>
+
+InstanceBuffer::InstanceBuffer()
+    : myBufferObject(0)
+    , myCapacity(0)
+    , myCount(0)
+{
+}
+
+void InstanceBuffer::Upload(const std::vector<ModelInstance>& someInstances)
+{
+    PROFILE_FUNCTION();
+
+    if (myBufferObject == 0)
+        glGenBuffers(1, &myBufferObject);
+
+    glBindBuffer(GL_ARRAY_BUFFER, myBufferObject);
+
+    const std::size_t size = someInstances.size() * sizeof(ModelInstance);
+    if (someInstances.size() > myCapacity)
+    {
+        myCapacity = someInstances.size();
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(size), someInstances.data(), GL_DYNAMIC_DRAW);
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(myCapacity * sizeof(ModelInstance)), nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(size), someInstances.data());
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    myCount = someInstances.size();
+}
+
+void InstanceBuffer::Destroy()
+{
+    glDeleteBuffers(1, &myBufferObject);
+    myBufferObject = 0;
+    myCapacity = 0;
+    myCount = 0;
+}
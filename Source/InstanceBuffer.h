@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct ModelInstance;
+
+// GPU copy of a contiguous ModelInstance array, sourced by the instance attributes of every mesh in a model
+class InstanceBuffer
+{
+public:
+    InstanceBuffer();
+
+    // Grows the buffer when needed, otherwise orphans it so the upload never waits on earlier draws
+    void Upload(const std::vector<ModelInstance>& someInstances);
+    void Destroy();
+
+    [[nodiscard]] unsigned int GetIdentifier() const { return myBufferObject; }
+    [[nodiscard]] std::size_t GetCount() const { return myCount; }
+
+private:
+    unsigned int myBufferObject;
+    std::size_t myCapacity;
+    std::size_t myCount;
+};
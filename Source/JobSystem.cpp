@@ -0,0 +1,134 @@
+#include "JobSystem.h"
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace
+{
+    thread_local int currentWorkerIndex = -1;
+
+    struct ParallelForState
+    {
+        std::function<void(std::size_t)> myFunction;
+        std::size_t myTaskCount = 0;
+        std::atomic<std::size_t> myNextTask{ 0 };
+        std::atomic<std::size_t> myCompletedTasks{ 0 };
+        std::mutex myMutex;
+        std::condition_variable myCondition;
+    };
+
+    void RunParallelForTasks(ParallelForState& aState)
+    {
+        for (;;)
+        {
+            const std::size_t taskIndex = aState.myNextTask.fetch_add(1);
+            if (taskIndex >= aState.myTaskCount)
+                return;
+
+            aState.myFunction(taskIndex);
+
+            if (aState.myCompletedTasks.fetch_add(1) + 1 == aState.myTaskCount)
+            {
+                const std::lock_guard<std::mutex> lock(aState.myMutex);
+                aState.myCondition.notify_all();
+            }
+        }
+    }
+}
+
+JobSystem::JobSystem()
+    : myIsStopping(false)
+{
+    // Leave one hardware thread for the render thread
+    const unsigned int hardwareThreadCount = std::thread::hardware_concurrency();
+    const unsigned int workerCount = hardwareThreadCount > 1 ? hardwareThreadCount - 1 : 0;
+    for (unsigned int i = 0; i < workerCount; ++i)
+        myWorkers.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        const std::lock_guard<std::mutex> lock(myMutex);
+        myIsStopping = true;
+    }
+
+    myCondition.notify_all();
+    for (std::thread& worker : myWorkers)
+        worker.join();
+}
+
+void JobSystem::Schedule(std::function<void()> aJob)
+{
+    if (myWorkers.empty())
+    {
+        aJob();
+        return;
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock(myMutex);
+        myJobs.emplace_back(std::move(aJob));
+    }
+
+    myCondition.notify_one();
+}
+
+void JobSystem::ParallelFor(std::size_t aTaskCount, const std::function<void(std::size_t aTaskIndex)>& aFunction)
+{
+    if (aTaskCount == 0)
+        return;
+
+    if (aTaskCount == 1 || myWorkers.empty())
+    {
+        for (std::size_t i = 0; i < aTaskCount; ++i)
+            aFunction(i);
+
+        return;
+    }
+
+    // The state is shared with the helper jobs, which may only get to run after every task has already been taken
+    const std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+    state->myFunction = aFunction;
+    state->myTaskCount = aTaskCount;
+
+    const std::size_t helperCount = std::min(myWorkers.size(), aTaskCount - 1);
+    for (std::size_t i = 0; i < helperCount; ++i)
+        Schedule([state]() { RunParallelForTasks(*state); });
+
+    RunParallelForTasks(*state);
+
+    std::unique_lock<std::mutex> lock(state->myMutex);
+    state->myCondition.wait(lock, [&state]() { return state->myCompletedTasks.load() == state->myTaskCount; });
+}
+
+int JobSystem::GetCurrentWorkerIndex()
+{
+    return currentWorkerIndex;
+}
+
+void JobSystem::WorkerLoop(unsigned int aWorkerIndex)
+{
+    currentWorkerIndex = static_cast<int>(aWorkerIndex);
+    Profiler::SetThreadName("Worker " + std::to_string(aWorkerIndex));
+
+    for (;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(myMutex);
+            myCondition.wait(lock, [this]() { return myIsStopping || !myJobs.empty(); });
+            if (myIsStopping && myJobs.empty())
+                return;
+
+            job = std::move(myJobs.front());
+            myJobs.pop_front();
+        }
+
+        job();
+    }
+}
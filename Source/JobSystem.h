@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem
+{
+public:
+    static JobSystem& GetInstance()
+    {
+        static JobSystem instance;
+        return instance;
+    }
+
+    JobSystem(JobSystem const&) = delete;
+    void operator=(JobSystem const&) = delete;
+
+    void Schedule(std::function<void()> aJob);
+
+    // Runs aFunction for every task index in [0, aTaskCount) across the workers and the calling thread, and returns once all tasks are done
+    void ParallelFor(std::size_t aTaskCount, const std::function<void(std::size_t aTaskIndex)>& aFunction);
+
+    [[nodiscard]] std::size_t GetWorkerCount() const { return myWorkers.size(); }
+    // Index of the worker running the caller, or -1 on threads the job system does not own
+    [[nodiscard]] static int GetCurrentWorkerIndex();
+
+private:
+    JobSystem();
+    ~JobSystem();
+
+    void WorkerLoop(unsigned int aWorkerIndex);
+
+    std::vector<std::thread> myWorkers;
+    std::deque<std::function<void()>> myJobs;
+    std::mutex myMutex;
+    std::condition_variable myCondition;
+    bool myIsStopping;
+};
@@ -1,8 +1,13 @@
 #include "App.h"
+#include "AppSettings.h"
 
-int main()
+int main(int anArgumentCount, char** someArguments)
 {
-    App app;
+    AppSettings settings;
+    if (!settings.ParseCommandLine(anArgumentCount, someArguments))
+        return 1;
+
+    App app(settings);
     app.Initialize();
     app.Run();
     app.Destroy();
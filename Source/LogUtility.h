@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdarg>
+#include <cstdio>
 
 namespace LogUtility
 {
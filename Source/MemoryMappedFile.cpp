@@ -0,0 +1,114 @@
+#include "MemoryMappedFile.h"
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MemoryMappedFile::MemoryMappedFile()
+    : myData(nullptr)
+    , mySize(0)
+#if _WIN32
+    , myFileHandle(INVALID_HANDLE_VALUE)
+    , myMappingHandle(nullptr)
+#else
+    , myFileDescriptor(-1)
+#endif
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+bool MemoryMappedFile::Open(const std::string& aFilepath)
+{
+    Close();
+
+#if _WIN32
+    myFileHandle = CreateFileA(aFilepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (myFileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(myFileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+
+    myMappingHandle = CreateFileMappingA(myFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!myMappingHandle)
+    {
+        Close();
+        return false;
+    }
+
+    myData = static_cast<const unsigned char*>(MapViewOfFile(myMappingHandle, FILE_MAP_READ, 0, 0, 0));
+    mySize = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    myFileDescriptor = open(aFilepath.c_str(), O_RDONLY);
+    if (myFileDescriptor < 0)
+        return false;
+
+    struct stat fileStatus;
+    if (fstat(myFileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+    {
+        Close();
+        return false;
+    }
+
+    void* data = mmap(nullptr, static_cast<std::size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, myFileDescriptor, 0);
+    if (data == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+
+    myData = static_cast<const unsigned char*>(data);
+    mySize = static_cast<std::size_t>(fileStatus.st_size);
+#endif
+
+    if (!myData)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void MemoryMappedFile::Close()
+{
+#if _WIN32
+    if (myData)
+        UnmapViewOfFile(myData);
+
+    if (myMappingHandle)
+        CloseHandle(myMappingHandle);
+
+    if (myFileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(myFileHandle);
+
+    myMappingHandle = nullptr;
+    myFileHandle = INVALID_HANDLE_VALUE;
+#else
+    if (myData)
+        munmap(const_cast<unsigned char*>(myData), mySize);
+
+    if (myFileDescriptor >= 0)
+        close(myFileDescriptor);
+
+    myFileDescriptor = -1;
+#endif
+
+    myData = nullptr;
+    mySize = 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class MemoryMappedFile
+{
+public:
+    MemoryMappedFile();
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    [[nodiscard]] bool Open(const std::string& aFilepath);
+    void Close();
+
+    [[nodiscard]] const unsigned char* GetData() const { return myData; }
+    [[nodiscard]] std::size_t GetSize() const { return mySize; }
+
+private:
+    const unsigned char* myData;
+    std::size_t mySize;
+#if _WIN32
+    void* myFileHandle;
+    void* myMappingHandle;
+#else
+    int myFileDescriptor;
+#endif
+};
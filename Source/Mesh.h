@@ -1,10 +1,15 @@
 #pragma once
 
+#include "BoundingBox.h"
+#include "GeometryAllocation.h"
+#include "MeshLod.h"
+#include "Meshlet.h"
+
+#include <cstddef>
 #include <vector>
 
 struct Texture;
 struct Vertex;
-class Shader;
 
 class Mesh
 {
@@ -12,19 +17,23 @@ public:
     Mesh();
     Mesh(std::vector<Vertex> aVertices, std::vector<unsigned int> aIndices, std::vector<Texture> aTextures);
 
-    void SetupMesh();
-    void Draw() const;
-    void Destroy() const;
-
     std::vector<Vertex> myVertices;
     std::vector<Texture> myTextures;
     std::vector<unsigned int> myIndices;
-    unsigned int myVertexArrayObject;
-    unsigned int myVertexBufferObject;
-
-private:
-    unsigned int myElementBufferObject;
-    unsigned int myVertexAttributePositionIdentifier;
-    unsigned int myVertexAttributeColorsIdentifier;
-    unsigned int myVertexAttributeTextureCoordinatesIdentifier;
+
+    // Set when the mesh is uploaded to a GeometryPool
+    GeometryAllocation myGeometryAllocation;
+
+    // Object-space bounds of myVertices, computed by ModelLoader
+    BoundingBox myBounds;
+
+    // Coarser versions of myIndices from finest to coarsest, level 0 is myIndices itself
+    std::vector<MeshLod> myLods;
+
+    // Clusters of myIndices culled one by one on the GPU, empty for meshes too small to benefit
+    std::vector<Meshlet> myMeshlets;
+
+    [[nodiscard]] std::size_t GetLodCount() const { return myLods.size() + 1; }
+    [[nodiscard]] const GeometryAllocation& GetGeometryAllocation(std::size_t aLod) const { return aLod == 0 ? myGeometryAllocation : myLods[aLod - 1].myGeometryAllocation; }
+    [[nodiscard]] float GetLodError(std::size_t aLod) const { return aLod == 0 ? 0.0f : myLods[aLod - 1].myError; }
 };
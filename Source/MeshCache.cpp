@@ -0,0 +1,336 @@
+#include "MeshCache.h"
+
+#include "FileUtility.h"
+#include "LogUtility.h"
+#include "MemoryMappedFile.h"
+#include "Model.h"
+#include "Profiler.h"
+#include "Texture.h"
+#include "Vertex.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+namespace MeshCache
+{
+    namespace
+    {
+        constexpr char CacheMagic[4] = { 'L', 'O', 'M', 'C' };
+        constexpr uint32_t CacheVersion = 6;
+
+        static_assert(std::is_trivially_copyable_v<Vertex>, "Vertex is copied directly from the cache");
+        static_assert(std::is_trivially_copyable_v<Meshlet>, "Meshlet is copied directly from the cache");
+
+        struct CacheHeader
+        {
+            char myMagic[4];
+            uint32_t myVersion;
+            uint32_t myVertexSize;
+            uint32_t myMeshCount;
+            uint64_t mySourceSize;
+            int64_t mySourceModificationTime;
+            // Followed by that many material libraries, each a path relative to the source and a CacheDependency
+            uint32_t myDependencyCount;
+            uint32_t myPadding;
+        };
+
+        // Stamp of a file the source pulls in, a missing file is stamped as such so the cache goes stale once it appears
+        struct CacheDependency
+        {
+            uint64_t mySize;
+            int64_t myModificationTime;
+        };
+
+        struct CacheMeshHeader
+        {
+            uint32_t myVertexCount;
+            uint32_t myIndexCount;
+            uint32_t myTextureCount;
+            uint32_t myLodCount;
+            uint32_t myMeshletCount;
+        };
+
+        struct CacheLodHeader
+        {
+            uint32_t myIndexCount;
+            float myError;
+        };
+
+        class CacheReader
+        {
+        public:
+            CacheReader(const unsigned char* aData, std::size_t aSize)
+                : myData(aData)
+                , mySize(aSize)
+                , myOffset(0)
+            {}
+
+            bool Read(void* aDestination, std::size_t aSize)
+            {
+                if (aSize > mySize - myOffset)
+                    return false;
+
+                std::memcpy(aDestination, myData + myOffset, aSize);
+                myOffset += aSize;
+                return true;
+            }
+
+            bool ReadString(std::string& aString)
+            {
+                uint32_t length = 0;
+                if (!Read(&length, sizeof(length)) || length > mySize - myOffset)
+                    return false;
+
+                aString.assign(reinterpret_cast<const char*>(myData + myOffset), length);
+                myOffset += length;
+                return true;
+            }
+
+            // Counts come from the file, so they are checked against what is left of it before anything is sized by them
+            [[nodiscard]] bool HasRoom(std::size_t aCount, std::size_t anElementSize) const
+            {
+                return aCount <= (mySize - myOffset) / anElementSize;
+            }
+
+            [[nodiscard]] bool IsAtEnd() const { return myOffset == mySize; }
+
+        private:
+            const unsigned char* myData;
+            std::size_t mySize;
+            std::size_t myOffset;
+        };
+
+        void WriteString(std::ofstream& aStream, const std::string& aString)
+        {
+            const uint32_t length = static_cast<uint32_t>(aString.size());
+            aStream.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            aStream.write(aString.data(), length);
+        }
+
+        CacheDependency GetDependencyStamp(const std::string& aSourceFilepath, const std::string& aDependency)
+        {
+            CacheDependency dependency = { UINT64_MAX, 0 };
+            FileUtility::GetFileStamp(FileUtility::GetDirectoryFromPath(aSourceFilepath) + aDependency, dependency.mySize, dependency.myModificationTime);
+            return dependency;
+        }
+
+        // The material libraries an OBJ names on its mtllib lines, which is where its materials and texture paths come from
+        std::vector<std::string> GetDependencies(const std::string& aSourceFilepath)
+        {
+            std::vector<std::string> dependencies;
+            std::string extension = FileUtility::GetExtensionFromPath(aSourceFilepath);
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char aCharacter) { return static_cast<char>(std::tolower(aCharacter)); });
+            if (extension != "obj")
+                return dependencies;
+
+            std::ifstream stream(aSourceFilepath);
+            std::string line;
+            while (std::getline(stream, line))
+            {
+                if (line.compare(0, 7, "mtllib ") != 0)
+                    continue;
+
+                const std::size_t nameStart = line.find_first_not_of(" \t", 7);
+                const std::size_t nameEnd = line.find_last_not_of(" \t\r");
+                if (nameStart != std::string::npos && std::find(dependencies.begin(), dependencies.end(), line.substr(nameStart, nameEnd + 1 - nameStart)) == dependencies.end())
+                    dependencies.push_back(line.substr(nameStart, nameEnd + 1 - nameStart));
+            }
+
+            return dependencies;
+        }
+    }
+
+    std::string GetCachePath(const std::string& aSourceFilepath)
+    {
+        return FileUtility::GetDirectoryFromPath(aSourceFilepath) + FileUtility::GetNameFromPath(aSourceFilepath) + ".meshcache";
+    }
+
+    bool Read(const std::string& aSourceFilepath, Model& aModel)
+    {
+        PROFILE_SCOPE("MeshCache::Read");
+
+        uint64_t sourceSize = 0;
+        int64_t sourceModificationTime = 0;
+        if (!FileUtility::GetFileStamp(aSourceFilepath, sourceSize, sourceModificationTime))
+            return false;
+
+        const std::string cachePath = GetCachePath(aSourceFilepath);
+        MemoryMappedFile file;
+        if (!file.Open(cachePath))
+            return false;
+
+        CacheReader reader(file.GetData(), file.GetSize());
+        CacheHeader header;
+        if (!reader.Read(&header, sizeof(header)))
+            return false;
+
+        if (std::memcmp(header.myMagic, CacheMagic, sizeof(CacheMagic)) != 0 || header.myVersion != CacheVersion || header.myVertexSize != sizeof(Vertex))
+        {
+            LogUtility::PrintMessage(LogUtility::LogCategory::File, "Ignoring outdated mesh cache %s", cachePath.c_str());
+            return false;
+        }
+
+        if (header.mySourceSize != sourceSize || header.mySourceModificationTime != sourceModificationTime)
+        {
+            LogUtility::PrintMessage(LogUtility::LogCategory::File, "Ignoring stale mesh cache %s", cachePath.c_str());
+            return false;
+        }
+
+        for (uint32_t dependencyIndex = 0; dependencyIndex < header.myDependencyCount; ++dependencyIndex)
+        {
+            std::string dependencyPath;
+            CacheDependency dependency;
+            if (!reader.ReadString(dependencyPath) || !reader.Read(&dependency, sizeof(dependency)))
+                return false;
+
+            const CacheDependency currentDependency = GetDependencyStamp(aSourceFilepath, dependencyPath);
+            if (dependency.mySize != currentDependency.mySize || dependency.myModificationTime != currentDependency.myModificationTime)
+            {
+                LogUtility::PrintMessage(LogUtility::LogCategory::File, "Ignoring stale mesh cache %s, %s changed", cachePath.c_str(), dependencyPath.c_str());
+                return false;
+            }
+        }
+
+        if (!reader.HasRoom(header.myMeshCount, sizeof(CacheMeshHeader)))
+            return false;
+
+        std::vector<Mesh> meshes(header.myMeshCount);
+        for (Mesh& mesh : meshes)
+        {
+            CacheMeshHeader meshHeader;
+            if (!reader.Read(&meshHeader, sizeof(meshHeader)))
+                return false;
+
+            // Every texture takes at least its two string lengths
+            if (!reader.HasRoom(meshHeader.myTextureCount, 2 * sizeof(uint32_t)))
+                return false;
+
+            mesh.myTextures.resize(meshHeader.myTextureCount);
+            for (Texture& texture : mesh.myTextures)
+            {
+                if (!reader.ReadString(texture.myType) || !reader.ReadString(texture.myPath))
+                    return false;
+            }
+
+            if (!reader.HasRoom(meshHeader.myVertexCount, sizeof(Vertex)))
+                return false;
+
+            mesh.myVertices.resize(meshHeader.myVertexCount);
+            if (!reader.Read(mesh.myVertices.data(), mesh.myVertices.size() * sizeof(Vertex)))
+                return false;
+
+            if (!reader.HasRoom(meshHeader.myIndexCount, sizeof(unsigned int)))
+                return false;
+
+            mesh.myIndices.resize(meshHeader.myIndexCount);
+            if (!reader.Read(mesh.myIndices.data(), mesh.myIndices.size() * sizeof(unsigned int)))
+                return false;
+
+            if (!reader.HasRoom(meshHeader.myLodCount, sizeof(CacheLodHeader)))
+                return false;
+
+            mesh.myLods.resize(meshHeader.myLodCount);
+            for (MeshLod& lod : mesh.myLods)
+            {
+                CacheLodHeader lodHeader;
+                if (!reader.Read(&lodHeader, sizeof(lodHeader)))
+                    return false;
+
+                lod.myError = lodHeader.myError;
+                if (!reader.HasRoom(lodHeader.myIndexCount, sizeof(unsigned int)))
+                    return false;
+
+                lod.myIndices.resize(lodHeader.myIndexCount);
+                if (!reader.Read(lod.myIndices.data(), lod.myIndices.size() * sizeof(unsigned int)))
+                    return false;
+            }
+
+            if (!reader.HasRoom(meshHeader.myMeshletCount, sizeof(Meshlet)))
+                return false;
+
+            mesh.myMeshlets.resize(meshHeader.myMeshletCount);
+            if (!reader.Read(mesh.myMeshlets.data(), mesh.myMeshlets.size() * sizeof(Meshlet)))
+                return false;
+        }
+
+        if (!reader.IsAtEnd())
+            return false;
+
+        aModel.myMeshes = std::move(meshes);
+        return true;
+    }
+
+    bool Write(const std::string& aSourceFilepath, const Model& aModel)
+    {
+        PROFILE_SCOPE("MeshCache::Write");
+
+        CacheHeader header;
+        std::memcpy(header.myMagic, CacheMagic, sizeof(CacheMagic));
+        header.myVersion = CacheVersion;
+        header.myVertexSize = sizeof(Vertex);
+        header.myMeshCount = static_cast<uint32_t>(aModel.myMeshes.size());
+        if (!FileUtility::GetFileStamp(aSourceFilepath, header.mySourceSize, header.mySourceModificationTime))
+            return false;
+
+        const std::vector<std::string> dependencies = GetDependencies(aSourceFilepath);
+        header.myDependencyCount = static_cast<uint32_t>(dependencies.size());
+        header.myPadding = 0;
+
+        const std::string cachePath = GetCachePath(aSourceFilepath);
+        const bool isWritten = FileUtility::WriteFileAtomically(cachePath, [&](std::ofstream& aStream)
+        {
+            aStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            for (const std::string& dependencyPath : dependencies)
+            {
+                const CacheDependency dependency = GetDependencyStamp(aSourceFilepath, dependencyPath);
+                WriteString(aStream, dependencyPath);
+                aStream.write(reinterpret_cast<const char*>(&dependency), sizeof(dependency));
+            }
+
+            for (const Mesh& mesh : aModel.myMeshes)
+            {
+                CacheMeshHeader meshHeader;
+                meshHeader.myVertexCount = static_cast<uint32_t>(mesh.myVertices.size());
+                meshHeader.myIndexCount = static_cast<uint32_t>(mesh.myIndices.size());
+                meshHeader.myTextureCount = static_cast<uint32_t>(mesh.myTextures.size());
+                meshHeader.myLodCount = static_cast<uint32_t>(mesh.myLods.size());
+                meshHeader.myMeshletCount = static_cast<uint32_t>(mesh.myMeshlets.size());
+                aStream.write(reinterpret_cast<const char*>(&meshHeader), sizeof(meshHeader));
+
+                for (const Texture& texture : mesh.myTextures)
+                {
+                    WriteString(aStream, texture.myType);
+                    WriteString(aStream, texture.myPath);
+                }
+
+                aStream.write(reinterpret_cast<const char*>(mesh.myVertices.data()), static_cast<std::streamsize>(mesh.myVertices.size() * sizeof(Vertex)));
+                aStream.write(reinterpret_cast<const char*>(mesh.myIndices.data()), static_cast<std::streamsize>(mesh.myIndices.size() * sizeof(unsigned int)));
+
+                for (const MeshLod& lod : mesh.myLods)
+                {
+                    CacheLodHeader lodHeader;
+                    lodHeader.myIndexCount = static_cast<uint32_t>(lod.myIndices.size());
+                    lodHeader.myError = lod.myError;
+                    aStream.write(reinterpret_cast<const char*>(&lodHeader), sizeof(lodHeader));
+                    aStream.write(reinterpret_cast<const char*>(lod.myIndices.data()), static_cast<std::streamsize>(lod.myIndices.size() * sizeof(unsigned int)));
+                }
+
+                aStream.write(reinterpret_cast<const char*>(mesh.myMeshlets.data()), static_cast<std::streamsize>(mesh.myMeshlets.size() * sizeof(Meshlet)));
+            }
+        });
+
+        if (!isWritten)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::File, "Failed to write mesh cache %s", cachePath.c_str());
+            return false;
+        }
+
+        LogUtility::PrintMessage(LogUtility::LogCategory::File, "Wrote mesh cache %s", cachePath.c_str());
+        return true;
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+struct Model;
+
+// Versioned binary cache of the deduplicated mesh data of a model and its levels of detail, written beside its source file.
+// A cache is only used while the size and modification time of the source, and of the material libraries it names, match the ones it was written for.
+namespace MeshCache
+{
+    std::string GetCachePath(const std::string& aSourceFilepath);
+
+    [[nodiscard]] bool Read(const std::string& aSourceFilepath, Model& aModel);
+    bool Write(const std::string& aSourceFilepath, const Model& aModel);
+}
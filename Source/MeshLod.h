@@ -0,0 +1,14 @@
+#pragma once
+
+#include "GeometryAllocation.h"
+
+#include <vector>
+
+// A simplified index buffer over the vertices of its Mesh
+struct MeshLod
+{
+    std::vector<unsigned int> myIndices;
+    // Largest distance the simplified surface deviates from the original one, in object space
+    float myError = 0.0f;
+    GeometryAllocation myGeometryAllocation;
+};
@@ -0,0 +1,265 @@
+#include "MeshOptimizer.h"
+
+#include "Profiler.h"
+#include "Vertex.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+    constexpr unsigned int UnusedVertex = UINT32_MAX;
+
+    struct Cluster
+    {
+        std::size_t myFirstIndex;
+        std::size_t myIndexCount;
+        float mySortKey;
+    };
+
+    // Triangles around every vertex, as offsets into one flat list
+    struct Adjacency
+    {
+        std::vector<uint32_t> myOffsets;
+        std::vector<uint32_t> myTriangles;
+    };
+
+    Adjacency BuildAdjacency(const std::vector<unsigned int>& someIndices, std::size_t aVertexCount)
+    {
+        Adjacency adjacency;
+        adjacency.myOffsets.assign(aVertexCount + 1, 0);
+        for (const unsigned int index : someIndices)
+            ++adjacency.myOffsets[index + 1];
+
+        for (std::size_t vertex = 0; vertex < aVertexCount; ++vertex)
+            adjacency.myOffsets[vertex + 1] += adjacency.myOffsets[vertex];
+
+        std::vector<uint32_t> fill(adjacency.myOffsets.begin(), adjacency.myOffsets.end() - 1);
+        adjacency.myTriangles.resize(someIndices.size());
+        for (std::size_t i = 0; i < someIndices.size(); ++i)
+            adjacency.myTriangles[fill[someIndices[i]]++] = static_cast<uint32_t>(i / 3);
+
+        return adjacency;
+    }
+
+    // Tipsify, optionally recording where the cache was flushed because the fan ran into a dead end
+    void Tipsify(std::vector<unsigned int>& someIndices, std::size_t aVertexCount, std::size_t aCacheSize, std::vector<std::size_t>* someClusterStarts)
+    {
+        const std::size_t triangleCount = someIndices.size() / 3;
+        if (triangleCount == 0)
+            return;
+
+        const Adjacency adjacency = BuildAdjacency(someIndices, aVertexCount);
+        std::vector<uint32_t> liveTriangles(aVertexCount);
+        for (std::size_t vertex = 0; vertex < aVertexCount; ++vertex)
+            liveTriangles[vertex] = adjacency.myOffsets[vertex + 1] - adjacency.myOffsets[vertex];
+
+        std::vector<std::size_t> cacheTimes(aVertexCount, 0);
+        std::vector<bool> isEmitted(triangleCount, false);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        std::vector<unsigned int> result;
+        result.reserve(someIndices.size());
+
+        std::size_t time = aCacheSize + 1;
+        std::size_t cursor = 0;
+        int64_t fanVertex = 0;
+        while (fanVertex >= 0)
+        {
+            candidates.clear();
+            const uint32_t fan = static_cast<uint32_t>(fanVertex);
+            for (uint32_t i = adjacency.myOffsets[fan]; i < adjacency.myOffsets[fan + 1]; ++i)
+            {
+                const uint32_t triangle = adjacency.myTriangles[i];
+                if (isEmitted[triangle])
+                    continue;
+
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    const unsigned int vertex = someIndices[triangle * 3 + corner];
+                    result.push_back(vertex);
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+                    --liveTriangles[vertex];
+                    if (time - cacheTimes[vertex] > aCacheSize)
+                        cacheTimes[vertex] = time++;
+                }
+
+                isEmitted[triangle] = true;
+            }
+
+            // Prefer the candidate that is still in the cache and will stay there while its remaining triangles are emitted
+            int64_t nextVertex = -1;
+            std::size_t bestPriority = 0;
+            for (const uint32_t candidate : candidates)
+            {
+                if (liveTriangles[candidate] == 0)
+                    continue;
+
+                std::size_t priority = 0;
+                if (time - cacheTimes[candidate] + 2 * liveTriangles[candidate] <= aCacheSize)
+                    priority = time - cacheTimes[candidate];
+
+                if (priority > bestPriority || nextVertex < 0)
+                {
+                    bestPriority = priority;
+                    nextVertex = candidate;
+                }
+            }
+
+            if (nextVertex < 0)
+            {
+                // Dead end, go back to the most recent vertex with triangles left, or else the next one in input order
+                while (!deadEnds.empty() && nextVertex < 0)
+                {
+                    const uint32_t vertex = deadEnds.back();
+                    deadEnds.pop_back();
+                    if (liveTriangles[vertex] > 0)
+                        nextVertex = vertex;
+                }
+
+                while (cursor < aVertexCount && nextVertex < 0)
+                {
+                    if (liveTriangles[cursor] > 0)
+                        nextVertex = static_cast<int64_t>(cursor);
+                    ++cursor;
+                }
+
+                // Whatever the new fan starts with has most likely left the cache already
+                if (someClusterStarts && nextVertex >= 0)
+                    someClusterStarts->push_back(result.size());
+            }
+
+            fanVertex = nextVertex;
+        }
+
+        someIndices = std::move(result);
+    }
+}
+
+namespace MeshOptimizer
+{
+    VertexCacheStatistics AnalyzeVertexCache(const std::vector<unsigned int>& someIndices, std::size_t aVertexCount, std::size_t aCacheSize)
+    {
+        VertexCacheStatistics statistics;
+        if (someIndices.empty())
+            return statistics;
+
+        // A vertex is in the FIFO while fewer than aCacheSize misses happened since it was inserted
+        std::vector<std::size_t> insertTimes(aVertexCount, 0);
+        std::vector<bool> isReferenced(aVertexCount, false);
+        std::size_t missCount = 0;
+        std::size_t referencedCount = 0;
+        for (const unsigned int index : someIndices)
+        {
+            if (!isReferenced[index])
+            {
+                isReferenced[index] = true;
+                ++referencedCount;
+            }
+
+            if (insertTimes[index] == 0 || missCount - insertTimes[index] + 1 > aCacheSize)
+            {
+                ++missCount;
+                insertTimes[index] = missCount;
+            }
+        }
+
+        statistics.myAcmr = static_cast<float>(missCount) / static_cast<float>(someIndices.size() / 3);
+        statistics.myAtvr = static_cast<float>(missCount) / static_cast<float>(referencedCount);
+        return statistics;
+    }
+
+    void OptimizeVertexCache(std::vector<unsigned int>& someIndices, std::size_t aVertexCount, std::size_t aCacheSize)
+    {
+        PROFILE_SCOPE("MeshOptimizer::OptimizeVertexCache");
+
+        Tipsify(someIndices, aVertexCount, aCacheSize, nullptr);
+    }
+
+    void OptimizeOverdraw(std::vector<unsigned int>& someIndices, const std::vector<Vertex>& someVertices, float aThreshold, std::size_t aCacheSize)
+    {
+        PROFILE_SCOPE("MeshOptimizer::OptimizeOverdraw");
+
+        std::vector<std::size_t> clusterStarts = { 0 };
+        Tipsify(someIndices, someVertices.size(), aCacheSize, &clusterStarts);
+        clusterStarts.push_back(someIndices.size());
+        if (clusterStarts.size() <= 3)
+            return;
+
+        glm::vec3 meshCentroid(0.0f);
+        for (const Vertex& vertex : someVertices)
+            meshCentroid += vertex.myPosition;
+        meshCentroid /= static_cast<float>(std::max<std::size_t>(someVertices.size(), 1));
+
+        // Clusters facing away from the centre of the mesh are the most likely to be in front, so they are drawn first
+        std::vector<Cluster> clusters;
+        for (std::size_t i = 0; i + 1 < clusterStarts.size(); ++i)
+        {
+            Cluster cluster = { clusterStarts[i], clusterStarts[i + 1] - clusterStarts[i], 0.0f };
+            if (cluster.myIndexCount == 0)
+                continue;
+
+            glm::vec3 normal(0.0f);
+            glm::vec3 centroid(0.0f);
+            float area = 0.0f;
+            for (std::size_t triangle = cluster.myFirstIndex; triangle < cluster.myFirstIndex + cluster.myIndexCount; triangle += 3)
+            {
+                const glm::vec3& position0 = someVertices[someIndices[triangle]].myPosition;
+                const glm::vec3& position1 = someVertices[someIndices[triangle + 1]].myPosition;
+                const glm::vec3& position2 = someVertices[someIndices[triangle + 2]].myPosition;
+                const glm::vec3 triangleNormal = glm::cross(position1 - position0, position2 - position0);
+                const float triangleArea = glm::length(triangleNormal);
+                normal += triangleNormal;
+                centroid += (position0 + position1 + position2) * (triangleArea / 3.0f);
+                area += triangleArea;
+            }
+
+            if (area > 0.0f && glm::length(normal) > 0.0f)
+                cluster.mySortKey = glm::dot(centroid / area - meshCentroid, glm::normalize(normal));
+
+            clusters.push_back(cluster);
+        }
+
+        std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& aLeft, const Cluster& aRight) { return aLeft.mySortKey > aRight.mySortKey; });
+
+        std::vector<unsigned int> sortedIndices;
+        sortedIndices.reserve(someIndices.size());
+        for (const Cluster& cluster : clusters)
+            sortedIndices.insert(sortedIndices.end(), someIndices.begin() + cluster.myFirstIndex, someIndices.begin() + cluster.myFirstIndex + cluster.myIndexCount);
+
+        const float cacheOrderAcmr = AnalyzeVertexCache(someIndices, someVertices.size(), aCacheSize).myAcmr;
+        const float overdrawOrderAcmr = AnalyzeVertexCache(sortedIndices, someVertices.size(), aCacheSize).myAcmr;
+        if (overdrawOrderAcmr <= cacheOrderAcmr * aThreshold)
+            someIndices = std::move(sortedIndices);
+    }
+
+    std::vector<unsigned int> OptimizeVertexFetch(std::vector<Vertex>& someVertices, std::vector<unsigned int>& someIndices)
+    {
+        PROFILE_SCOPE("MeshOptimizer::OptimizeVertexFetch");
+
+        std::vector<unsigned int> remap(someVertices.size(), UnusedVertex);
+        unsigned int nextVertex = 0;
+        for (unsigned int& index : someIndices)
+        {
+            if (remap[index] == UnusedVertex)
+                remap[index] = nextVertex++;
+
+            index = remap[index];
+        }
+
+        // Vertices no triangle uses keep their relative order behind the used ones
+        for (unsigned int& newIndex : remap)
+        {
+            if (newIndex == UnusedVertex)
+                newIndex = nextVertex++;
+        }
+
+        std::vector<Vertex> reorderedVertices(someVertices.size());
+        for (std::size_t vertex = 0; vertex < someVertices.size(); ++vertex)
+            reorderedVertices[remap[vertex]] = someVertices[vertex];
+
+        someVertices = std::move(reorderedVertices);
+        return remap;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct Vertex;
+
+// Post-transform vertex cache statistics of an index buffer, simulated with a FIFO cache
+struct VertexCacheStatistics
+{
+    // Vertices transformed per triangle, 0.5 is the best a regular grid can do and 3 the worst
+    float myAcmr = 0.0f;
+    // Vertices transformed per referenced vertex, 1 means every vertex is transformed once
+    float myAtvr = 0.0f;
+};
+
+// Index and vertex reordering that keeps the triangles of a mesh but changes the order the GPU sees them in
+namespace MeshOptimizer
+{
+    constexpr std::size_t DefaultCacheSize = 16;
+
+    [[nodiscard]] VertexCacheStatistics AnalyzeVertexCache(const std::vector<unsigned int>& someIndices, std::size_t aVertexCount, std::size_t aCacheSize = DefaultCacheSize);
+
+    // Reorders triangles for the post-transform cache with Tipsify (Sander, Nehab and Barczak 2007)
+    void OptimizeVertexCache(std::vector<unsigned int>& someIndices, std::size_t aVertexCount, std::size_t aCacheSize = DefaultCacheSize);
+
+    // Runs OptimizeVertexCache, then sorts the clusters it produced between cache flushes so outward facing ones come first,
+    // which lets them occlude the rest of the mesh. The sort is undone when it costs more than aThreshold times the cache misses.
+    void OptimizeOverdraw(std::vector<unsigned int>& someIndices, const std::vector<Vertex>& someVertices, float aThreshold = 1.05f, std::size_t aCacheSize = DefaultCacheSize);
+
+    // Moves vertices into the order they are first referenced, so vertex fetch walks the buffer linearly.
+    // Returns the new index of every old vertex, for remapping other index buffers over the same vertices.
+    std::vector<unsigned int> OptimizeVertexFetch(std::vector<Vertex>& someVertices, std::vector<unsigned int>& someIndices);
+}
@@ -0,0 +1,459 @@
+#include "MeshSimplifier.h"
+
+#include "Profiler.h"
+#include "Vertex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <tuple>
+#include <unordered_map>
+
+namespace
+{
+    // Border edges are kept in place by planes perpendicular to their triangle, weighted heavily so sliding along the border stays cheap
+    constexpr float BorderWeight = 10.0f;
+    // Collapses that turn a triangle by more than about 75 degrees are rejected, which also keeps slivers from forming
+    constexpr float MinimumNormalAlignment = 0.25f;
+
+    enum class VertexKind : unsigned char
+    {
+        Manifold,
+        Border,
+        Locked
+    };
+
+    // Symmetric 4x4 matrix of the sum of squared distances to a set of planes, plus the total weight of those planes
+    struct Quadric
+    {
+        double myA2 = 0.0;
+        double myB2 = 0.0;
+        double myC2 = 0.0;
+        double myAB = 0.0;
+        double myAC = 0.0;
+        double myBC = 0.0;
+        double myAD = 0.0;
+        double myBD = 0.0;
+        double myCD = 0.0;
+        double myD2 = 0.0;
+        double myWeight = 0.0;
+    };
+
+    struct Collapse
+    {
+        uint32_t myFrom;
+        uint32_t myTo;
+        double myError;
+    };
+
+    void AddPlane(Quadric& aQuadric, const glm::vec3& aNormal, const glm::vec3& aPoint, float aWeight)
+    {
+        const double a = aNormal.x;
+        const double b = aNormal.y;
+        const double c = aNormal.z;
+        const double d = -glm::dot(aNormal, aPoint);
+        aQuadric.myA2 += a * a * aWeight;
+        aQuadric.myB2 += b * b * aWeight;
+        aQuadric.myC2 += c * c * aWeight;
+        aQuadric.myAB += a * b * aWeight;
+        aQuadric.myAC += a * c * aWeight;
+        aQuadric.myBC += b * c * aWeight;
+        aQuadric.myAD += a * d * aWeight;
+        aQuadric.myBD += b * d * aWeight;
+        aQuadric.myCD += c * d * aWeight;
+        aQuadric.myD2 += d * d * aWeight;
+        aQuadric.myWeight += aWeight;
+    }
+
+    void AddQuadric(Quadric& aQuadric, const Quadric& anOther)
+    {
+        aQuadric.myA2 += anOther.myA2;
+        aQuadric.myB2 += anOther.myB2;
+        aQuadric.myC2 += anOther.myC2;
+        aQuadric.myAB += anOther.myAB;
+        aQuadric.myAC += anOther.myAC;
+        aQuadric.myBC += anOther.myBC;
+        aQuadric.myAD += anOther.myAD;
+        aQuadric.myBD += anOther.myBD;
+        aQuadric.myCD += anOther.myCD;
+        aQuadric.myD2 += anOther.myD2;
+        aQuadric.myWeight += anOther.myWeight;
+    }
+
+    // Weighted mean of the squared distances from aPoint to the planes of the quadric
+    double Evaluate(const Quadric& aQuadric, const glm::vec3& aPoint)
+    {
+        const double x = aPoint.x;
+        const double y = aPoint.y;
+        const double z = aPoint.z;
+        const double error = aQuadric.myA2 * x * x + aQuadric.myB2 * y * y + aQuadric.myC2 * z * z
+            + 2.0 * (aQuadric.myAB * x * y + aQuadric.myAC * x * z + aQuadric.myBC * y * z)
+            + 2.0 * (aQuadric.myAD * x + aQuadric.myBD * y + aQuadric.myCD * z) + aQuadric.myD2;
+        return aQuadric.myWeight > 0.0 ? std::max(error, 0.0) / aQuadric.myWeight : 0.0;
+    }
+
+    uint64_t GetEdgeKey(uint32_t aFrom, uint32_t aTo)
+    {
+        return static_cast<uint64_t>(aFrom) << 32 | aTo;
+    }
+
+    // Vertices sharing a position but not their other attributes sit on a seam, and get locked so the seam cannot tear open
+    std::vector<bool> FindSeamVertices(const std::vector<Vertex>& someVertices)
+    {
+        std::vector<uint32_t> order(someVertices.size());
+        for (uint32_t vertex = 0; vertex < order.size(); ++vertex)
+            order[vertex] = vertex;
+
+        const auto getPosition = [&someVertices](uint32_t aVertex)
+        {
+            const glm::vec3& position = someVertices[aVertex].myPosition;
+            return std::make_tuple(position.x, position.y, position.z);
+        };
+        std::sort(order.begin(), order.end(), [&getPosition](uint32_t aLeft, uint32_t aRight) { return getPosition(aLeft) < getPosition(aRight); });
+
+        std::vector<bool> isSeam(someVertices.size(), false);
+        for (std::size_t i = 1; i < order.size(); ++i)
+        {
+            if (getPosition(order[i - 1]) == getPosition(order[i]))
+            {
+                isSeam[order[i - 1]] = true;
+                isSeam[order[i]] = true;
+            }
+        }
+
+        return isSeam;
+    }
+
+    class Simplifier
+    {
+    public:
+        Simplifier(const std::vector<Vertex>& someVertices, const std::vector<unsigned int>& someIndices)
+            : myVertices(someVertices)
+            , myIndices(someIndices)
+            , myIsSeam(FindSeamVertices(someVertices))
+            , myQuadrics(someVertices.size())
+            , myKinds(someVertices.size())
+            , myBorderNext(someVertices.size())
+            , myBorderPrevious(someVertices.size())
+            , myRemap(someVertices.size())
+            , myIsCollapsedThisPass(someVertices.size())
+        {
+            RemoveDegenerateTriangles();
+            ClassifyVertices();
+
+            for (std::size_t triangle = 0; triangle < myIndices.size(); triangle += 3)
+            {
+                const glm::vec3& position0 = GetPosition(myIndices[triangle]);
+                const glm::vec3& position1 = GetPosition(myIndices[triangle + 1]);
+                const glm::vec3& position2 = GetPosition(myIndices[triangle + 2]);
+                const glm::vec3 normal = glm::cross(position1 - position0, position2 - position0);
+                const float doubleArea = glm::length(normal);
+                if (doubleArea <= 0.0f)
+                    continue;
+
+                for (int corner = 0; corner < 3; ++corner)
+                    AddPlane(myQuadrics[myIndices[triangle + corner]], normal / doubleArea, position0, doubleArea * 0.5f);
+
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    const uint32_t from = myIndices[triangle + corner];
+                    const uint32_t to = myIndices[triangle + (corner + 1) % 3];
+                    if (myEdgeCounts.find(GetEdgeKey(to, from)) != myEdgeCounts.end())
+                        continue;
+
+                    const glm::vec3 edge = GetPosition(to) - GetPosition(from);
+                    const float edgeLength = glm::length(edge);
+                    if (edgeLength <= 0.0f)
+                        continue;
+
+                    const glm::vec3 borderNormal = glm::normalize(glm::cross(edge, normal));
+                    AddPlane(myQuadrics[from], borderNormal, GetPosition(from), edgeLength * edgeLength * BorderWeight);
+                    AddPlane(myQuadrics[to], borderNormal, GetPosition(from), edgeLength * edgeLength * BorderWeight);
+                }
+            }
+        }
+
+        std::vector<unsigned int> Run(std::size_t aTargetIndexCount, float aMaxError, float& anError)
+        {
+            const double maxError = static_cast<double>(aMaxError) * aMaxError;
+            double largestError = 0.0;
+            while (myIndices.size() > aTargetIndexCount)
+            {
+                BuildAdjacency();
+                GatherCollapses();
+
+                // Each collapse removes about two triangles, aim for the target without overshooting it much
+                const std::size_t collapseGoal = (myIndices.size() - aTargetIndexCount) / 6 + 1;
+                std::size_t collapseCount = 0;
+                std::fill(myIsCollapsedThisPass.begin(), myIsCollapsedThisPass.end(), false);
+                for (uint32_t vertex = 0; vertex < myRemap.size(); ++vertex)
+                    myRemap[vertex] = vertex;
+
+                for (const Collapse& collapse : myCollapses)
+                {
+                    if (collapse.myError > maxError || collapseCount >= collapseGoal)
+                        break;
+
+                    if (myIsCollapsedThisPass[collapse.myFrom] || myIsCollapsedThisPass[collapse.myTo])
+                        continue;
+
+                    if (!IsLinkConditionMet(collapse.myFrom, collapse.myTo) || HasTriangleFlips(collapse.myFrom, collapse.myTo))
+                        continue;
+
+                    myRemap[collapse.myFrom] = collapse.myTo;
+                    myIsCollapsedThisPass[collapse.myFrom] = true;
+                    myIsCollapsedThisPass[collapse.myTo] = true;
+                    AddQuadric(myQuadrics[collapse.myTo], myQuadrics[collapse.myFrom]);
+                    largestError = std::max(largestError, collapse.myError);
+                    ++collapseCount;
+                }
+
+                if (collapseCount == 0)
+                    break;
+
+                for (unsigned int& index : myIndices)
+                    index = myRemap[index];
+
+                RemoveDegenerateTriangles();
+                ClassifyVertices();
+            }
+
+            anError = static_cast<float>(std::sqrt(largestError));
+            return myIndices;
+        }
+
+    private:
+        [[nodiscard]] const glm::vec3& GetPosition(uint32_t aVertex) const { return myVertices[aVertex].myPosition; }
+
+        void RemoveDegenerateTriangles()
+        {
+            std::size_t writeIndex = 0;
+            for (std::size_t triangle = 0; triangle < myIndices.size(); triangle += 3)
+            {
+                const unsigned int index0 = myIndices[triangle];
+                const unsigned int index1 = myIndices[triangle + 1];
+                const unsigned int index2 = myIndices[triangle + 2];
+                if (index0 == index1 || index1 == index2 || index2 == index0)
+                    continue;
+
+                myIndices[writeIndex++] = index0;
+                myIndices[writeIndex++] = index1;
+                myIndices[writeIndex++] = index2;
+            }
+
+            myIndices.resize(writeIndex);
+        }
+
+        // A border vertex has exactly one outgoing and one incoming edge without a twin, anything else that is not a closed fan is locked
+        void ClassifyVertices()
+        {
+            myEdgeCounts.clear();
+            for (std::size_t triangle = 0; triangle < myIndices.size(); triangle += 3)
+            {
+                for (int corner = 0; corner < 3; ++corner)
+                    ++myEdgeCounts[GetEdgeKey(myIndices[triangle + corner], myIndices[triangle + (corner + 1) % 3])];
+            }
+
+            std::vector<uint32_t> outgoingBorderCounts(myVertices.size(), 0);
+            std::vector<uint32_t> incomingBorderCounts(myVertices.size(), 0);
+            std::fill(myKinds.begin(), myKinds.end(), VertexKind::Manifold);
+            for (const auto& [key, count] : myEdgeCounts)
+            {
+                const uint32_t from = static_cast<uint32_t>(key >> 32);
+                const uint32_t to = static_cast<uint32_t>(key);
+                if (count > 1)
+                {
+                    myKinds[from] = VertexKind::Locked;
+                    myKinds[to] = VertexKind::Locked;
+                }
+                else if (myEdgeCounts.find(GetEdgeKey(to, from)) == myEdgeCounts.end())
+                {
+                    ++outgoingBorderCounts[from];
+                    ++incomingBorderCounts[to];
+                    myBorderNext[from] = to;
+                    myBorderPrevious[to] = from;
+                }
+            }
+
+            for (uint32_t vertex = 0; vertex < myVertices.size(); ++vertex)
+            {
+                if (myIsSeam[vertex])
+                    myKinds[vertex] = VertexKind::Locked;
+                else if (myKinds[vertex] == VertexKind::Manifold && (outgoingBorderCounts[vertex] > 0 || incomingBorderCounts[vertex] > 0))
+                    myKinds[vertex] = outgoingBorderCounts[vertex] == 1 && incomingBorderCounts[vertex] == 1 ? VertexKind::Border : VertexKind::Locked;
+            }
+        }
+
+        void BuildAdjacency()
+        {
+            myAdjacencyOffsets.assign(myVertices.size() + 1, 0);
+            for (const unsigned int index : myIndices)
+                ++myAdjacencyOffsets[index + 1];
+
+            for (std::size_t vertex = 0; vertex < myVertices.size(); ++vertex)
+                myAdjacencyOffsets[vertex + 1] += myAdjacencyOffsets[vertex];
+
+            std::vector<uint32_t> fill(myAdjacencyOffsets.begin(), myAdjacencyOffsets.end() - 1);
+            myAdjacentTriangles.resize(myIndices.size());
+            for (std::size_t i = 0; i < myIndices.size(); ++i)
+                myAdjacentTriangles[fill[myIndices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        [[nodiscard]] bool CanCollapse(uint32_t aFrom, uint32_t aTo) const
+        {
+            switch (myKinds[aFrom])
+            {
+            case VertexKind::Manifold:
+                return true;
+            case VertexKind::Border:
+                return myBorderNext[aFrom] == aTo || myBorderPrevious[aFrom] == aTo;
+            default:
+                return false;
+            }
+        }
+
+        void GatherCollapses()
+        {
+            myCollapses.clear();
+            for (std::size_t triangle = 0; triangle < myIndices.size(); triangle += 3)
+            {
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    const uint32_t vertex0 = myIndices[triangle + corner];
+                    const uint32_t vertex1 = myIndices[triangle + (corner + 1) % 3];
+
+                    // Interior edges are seen from both of their triangles, only gather them once
+                    if (vertex0 > vertex1 && myEdgeCounts.find(GetEdgeKey(vertex1, vertex0)) != myEdgeCounts.end())
+                        continue;
+
+                    for (const auto& [from, to] : { std::make_pair(vertex0, vertex1), std::make_pair(vertex1, vertex0) })
+                    {
+                        if (!CanCollapse(from, to))
+                            continue;
+
+                        Quadric quadric = myQuadrics[from];
+                        AddQuadric(quadric, myQuadrics[to]);
+                        myCollapses.push_back({ from, to, Evaluate(quadric, GetPosition(to)) });
+                    }
+                }
+            }
+
+            std::sort(myCollapses.begin(), myCollapses.end(), [](const Collapse& aLeft, const Collapse& aRight) { return aLeft.myError < aRight.myError; });
+        }
+
+        void GatherNeighbours(uint32_t aVertex, std::vector<uint32_t>& someNeighbours) const
+        {
+            someNeighbours.clear();
+            for (uint32_t i = myAdjacencyOffsets[aVertex]; i < myAdjacencyOffsets[aVertex + 1]; ++i)
+            {
+                const std::size_t triangle = static_cast<std::size_t>(myAdjacentTriangles[i]) * 3;
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    const uint32_t neighbour = myRemap[myIndices[triangle + corner]];
+                    if (neighbour != aVertex)
+                        someNeighbours.push_back(neighbour);
+                }
+            }
+
+            std::sort(someNeighbours.begin(), someNeighbours.end());
+            someNeighbours.erase(std::unique(someNeighbours.begin(), someNeighbours.end()), someNeighbours.end());
+        }
+
+        // The only neighbours both ends may share are the tips of the triangles on the edge, otherwise the collapse pinches the surface
+        [[nodiscard]] bool IsLinkConditionMet(uint32_t aFrom, uint32_t aTo)
+        {
+            GatherNeighbours(aFrom, myFromNeighbours);
+            GatherNeighbours(aTo, myToNeighbours);
+
+            std::size_t sharedCount = 0;
+            std::size_t fromIndex = 0;
+            std::size_t toIndex = 0;
+            while (fromIndex < myFromNeighbours.size() && toIndex < myToNeighbours.size())
+            {
+                if (myFromNeighbours[fromIndex] < myToNeighbours[toIndex])
+                {
+                    ++fromIndex;
+                }
+                else if (myToNeighbours[toIndex] < myFromNeighbours[fromIndex])
+                {
+                    ++toIndex;
+                }
+                else
+                {
+                    ++sharedCount;
+                    ++fromIndex;
+                    ++toIndex;
+                }
+            }
+
+            std::size_t edgeTriangleCount = 0;
+            for (uint32_t i = myAdjacencyOffsets[aFrom]; i < myAdjacencyOffsets[aFrom + 1]; ++i)
+            {
+                const std::size_t triangle = static_cast<std::size_t>(myAdjacentTriangles[i]) * 3;
+                const uint32_t vertex0 = myRemap[myIndices[triangle]];
+                const uint32_t vertex1 = myRemap[myIndices[triangle + 1]];
+                const uint32_t vertex2 = myRemap[myIndices[triangle + 2]];
+                if (vertex0 == aTo || vertex1 == aTo || vertex2 == aTo)
+                    ++edgeTriangleCount;
+            }
+
+            return edgeTriangleCount > 0 && sharedCount <= edgeTriangleCount;
+        }
+
+        [[nodiscard]] bool HasTriangleFlips(uint32_t aFrom, uint32_t aTo) const
+        {
+            for (uint32_t i = myAdjacencyOffsets[aFrom]; i < myAdjacencyOffsets[aFrom + 1]; ++i)
+            {
+                const std::size_t triangle = static_cast<std::size_t>(myAdjacentTriangles[i]) * 3;
+                uint32_t vertices[3] = { myRemap[myIndices[triangle]], myRemap[myIndices[triangle + 1]], myRemap[myIndices[triangle + 2]] };
+
+                // Triangles on the collapsed edge disappear, and ones already degenerate from other collapses do not matter
+                if (vertices[0] == aTo || vertices[1] == aTo || vertices[2] == aTo)
+                    continue;
+                if (vertices[0] == vertices[1] || vertices[1] == vertices[2] || vertices[2] == vertices[0])
+                    continue;
+
+                const glm::vec3 normal = glm::cross(GetPosition(vertices[1]) - GetPosition(vertices[0]), GetPosition(vertices[2]) - GetPosition(vertices[0]));
+                for (uint32_t& vertex : vertices)
+                {
+                    if (vertex == aFrom)
+                        vertex = aTo;
+                }
+
+                const glm::vec3 collapsedNormal = glm::cross(GetPosition(vertices[1]) - GetPosition(vertices[0]), GetPosition(vertices[2]) - GetPosition(vertices[0]));
+                if (glm::dot(normal, collapsedNormal) <= MinimumNormalAlignment * glm::length(normal) * glm::length(collapsedNormal))
+                    return true;
+            }
+
+            return false;
+        }
+
+        const std::vector<Vertex>& myVertices;
+        std::vector<unsigned int> myIndices;
+        std::vector<bool> myIsSeam;
+        std::vector<Quadric> myQuadrics;
+        std::vector<VertexKind> myKinds;
+        std::vector<uint32_t> myBorderNext;
+        std::vector<uint32_t> myBorderPrevious;
+        std::vector<uint32_t> myRemap;
+        std::vector<bool> myIsCollapsedThisPass;
+        std::vector<uint32_t> myAdjacencyOffsets;
+        std::vector<uint32_t> myAdjacentTriangles;
+        std::vector<uint32_t> myFromNeighbours;
+        std::vector<uint32_t> myToNeighbours;
+        std::vector<Collapse> myCollapses;
+        std::unordered_map<uint64_t, uint32_t> myEdgeCounts;
+    };
+}
+
+namespace MeshSimplifier
+{
+    std::vector<unsigned int> Simplify(const std::vector<Vertex>& someVertices, const std::vector<unsigned int>& someIndices,
+        std::size_t aTargetIndexCount, float aMaxError, float& anError)
+    {
+        PROFILE_SCOPE("MeshSimplifier::Simplify");
+
+        Simplifier simplifier(someVertices, someIndices);
+        return simplifier.Run(aTargetIndexCount, aMaxError, anError);
+    }
+}
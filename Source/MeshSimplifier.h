@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct Vertex;
+
+// Quadric error metric simplification after Garland and Heckbert. Collapses never move or create vertices, they snap one
+// vertex onto a neighbour, so every level of detail is just another index buffer over the vertices of the original mesh.
+// Vertices on open borders only slide along the border and vertices on texture seams never move, which keeps both intact.
+namespace MeshSimplifier
+{
+    // Collapses edges in order of increasing error until at most aTargetIndexCount indices remain, or until the next collapse
+    // would deviate more than aMaxError from the original surface. anError receives the largest deviation, in object space.
+    [[nodiscard]] std::vector<unsigned int> Simplify(const std::vector<Vertex>& someVertices, const std::vector<unsigned int>& someIndices,
+        std::size_t aTargetIndexCount, float aMaxError, float& anError);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+// A cluster of at most meshletMaxVertexCount vertices and meshletMaxTriangleCount triangles, stored as a contiguous range of
+// the indices of its mesh. Laid out exactly as the cluster culling shader reads it, see ClusterCull.comp.glsl.
+struct Meshlet
+{
+    // Object-space bounding sphere of the triangles
+    glm::vec3 myCenter = glm::vec3(0.0f);
+    float myRadius = 0.0f;
+
+    // Every triangle faces away from a viewer where dot(center - viewer, axis) >= cutoff * distance + radius,
+    // a cutoff of 1 never passes the test and marks clusters whose normals spread too far for a cone
+    glm::vec3 myConeAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    float myConeCutoff = 1.0f;
+
+    uint32_t myFirstIndex = 0;
+    uint32_t myIndexCount = 0;
+    uint32_t myPadding[2] = { 0, 0 };
+};
+
+static_assert(sizeof(Meshlet) == 48, "Meshlet is uploaded as is");
@@ -0,0 +1,118 @@
+#include "MeshletBuilder.h"
+
+#include "AppDefinitions.h"
+#include "BoundingBox.h"
+#include "Profiler.h"
+#include "Vertex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+    // Normal cones wider than this are almost hemispheres, which no viewer outside the cluster sees entirely from behind
+    constexpr float MinimumConeDot = 0.1f;
+
+    void ComputeBounds(const std::vector<Vertex>& someVertices, const std::vector<unsigned int>& someIndices, Meshlet& aMeshlet)
+    {
+        BoundingBox bounds;
+        for (uint32_t i = aMeshlet.myFirstIndex; i < aMeshlet.myFirstIndex + aMeshlet.myIndexCount; ++i)
+            bounds.Grow(someVertices[someIndices[i]].myPosition);
+
+        aMeshlet.myCenter = bounds.GetCenter();
+        aMeshlet.myRadius = 0.0f;
+        for (uint32_t i = aMeshlet.myFirstIndex; i < aMeshlet.myFirstIndex + aMeshlet.myIndexCount; ++i)
+            aMeshlet.myRadius = std::max(aMeshlet.myRadius, glm::length(someVertices[someIndices[i]].myPosition - aMeshlet.myCenter));
+
+        std::vector<glm::vec3> normals;
+        glm::vec3 normalSum(0.0f);
+        for (uint32_t i = aMeshlet.myFirstIndex; i < aMeshlet.myFirstIndex + aMeshlet.myIndexCount; i += 3)
+        {
+            const glm::vec3& position0 = someVertices[someIndices[i]].myPosition;
+            const glm::vec3& position1 = someVertices[someIndices[i + 1]].myPosition;
+            const glm::vec3& position2 = someVertices[someIndices[i + 2]].myPosition;
+            const glm::vec3 normal = glm::cross(position1 - position0, position2 - position0);
+            const float length = glm::length(normal);
+            if (length <= 0.0f)
+                continue;
+
+            normals.push_back(normal / length);
+            normalSum += normals.back();
+        }
+
+        aMeshlet.myConeAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+        aMeshlet.myConeCutoff = 1.0f;
+        const float axisLength = glm::length(normalSum);
+        if (normals.empty() || axisLength <= 0.0f)
+            return;
+
+        const glm::vec3 axis = normalSum / axisLength;
+        float minimumDot = 1.0f;
+        for (const glm::vec3& normal : normals)
+            minimumDot = std::min(minimumDot, glm::dot(axis, normal));
+
+        if (minimumDot <= MinimumConeDot)
+            return;
+
+        // The cone of normals has a half angle of acos(minimumDot), the cutoff is the cosine of the angle past 90 degrees
+        aMeshlet.myConeAxis = axis;
+        aMeshlet.myConeCutoff = std::sqrt(1.0f - minimumDot * minimumDot);
+    }
+}
+
+namespace MeshletBuilder
+{
+    std::vector<Meshlet> Build(const std::vector<Vertex>& someVertices, const std::vector<unsigned int>& someIndices)
+    {
+        PROFILE_SCOPE("MeshletBuilder::Build");
+
+        std::vector<Meshlet> meshlets;
+        meshlets.reserve(someIndices.size() / 3 / meshletMaxTriangleCount + 1);
+
+        // The meshlet a vertex was last counted in, which avoids clearing a set of unique vertices for every meshlet
+        std::vector<uint32_t> vertexMeshlets(someVertices.size(), UINT32_MAX);
+        Meshlet meshlet;
+        std::size_t vertexCount = 0;
+        for (std::size_t triangle = 0; triangle < someIndices.size(); triangle += 3)
+        {
+            const uint32_t meshletIndex = static_cast<uint32_t>(meshlets.size());
+            std::size_t newVertexCount = 0;
+            for (std::size_t corner = 0; corner < 3; ++corner)
+            {
+                if (vertexMeshlets[someIndices[triangle + corner]] != meshletIndex)
+                    ++newVertexCount;
+            }
+
+            const bool isFull = meshlet.myIndexCount / 3 >= meshletMaxTriangleCount || vertexCount + newVertexCount > meshletMaxVertexCount;
+            if (isFull)
+            {
+                ComputeBounds(someVertices, someIndices, meshlet);
+                meshlets.push_back(meshlet);
+                meshlet = Meshlet();
+                meshlet.myFirstIndex = static_cast<uint32_t>(triangle);
+                vertexCount = 0;
+            }
+
+            for (std::size_t corner = 0; corner < 3; ++corner)
+            {
+                uint32_t& vertexMeshlet = vertexMeshlets[someIndices[triangle + corner]];
+                if (vertexMeshlet != static_cast<uint32_t>(meshlets.size()))
+                {
+                    vertexMeshlet = static_cast<uint32_t>(meshlets.size());
+                    ++vertexCount;
+                }
+            }
+
+            meshlet.myIndexCount += 3;
+        }
+
+        if (meshlet.myIndexCount > 0)
+        {
+            ComputeBounds(someVertices, someIndices, meshlet);
+            meshlets.push_back(meshlet);
+        }
+
+        return meshlets;
+    }
+}
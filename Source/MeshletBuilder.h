@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Meshlet.h"
+
+#include <vector>
+
+struct Vertex;
+
+// Splits an index buffer into meshlets by walking its triangles in order, so it should already be sorted for the vertex cache,
+// which keeps the triangles of each meshlet close together. The indices themselves are left untouched, every meshlet is a
+// contiguous range of them, which lets the GPU draw any subset of meshlets as indirect draws over the same index buffer.
+namespace MeshletBuilder
+{
+    [[nodiscard]] std::vector<Meshlet> Build(const std::vector<Vertex>& someVertices, const std::vector<unsigned int>& someIndices);
+}
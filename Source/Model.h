@@ -1,8 +1,12 @@
 #pragma once
 
 #include "Mesh.h"
+#include "ModelInstance.h"
 
 struct Model
 {
 	std::vector<Mesh> myMeshes;
+
+	// Every mesh is drawn once per instance
+	std::vector<ModelInstance> myInstances;
 };
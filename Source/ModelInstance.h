@@ -0,0 +1,10 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Per-instance vertex attributes, laid out exactly as they are read by the vertex shaders at locations 3 to 7
+struct ModelInstance
+{
+    glm::mat4 myTransform = glm::mat4(1.0f);
+    glm::vec4 myColor = glm::vec4(1.0f);
+};
@@ -1,25 +1,223 @@
 #include "ModelLoader.h"
 
+#include "AppDefinitions.h"
 #include "FileUtility.h"
 #include "LogUtility.h"
 #include "Mesh.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
 #include "Model.h"
+#include "Profiler.h"
 #include "Texture.h"
-#include "VertexHash.h"
+#include "Vertex.h"
+#include "VertexWeldTable.h"
+#include "VertexWelder.h"
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
-#include <glm/gtx/hash.hpp>
 
-#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <set>
 
-ModelLoader::ModelLoader(TextureLoader& aTextureLoader)
-    : myTextureLoader(aTextureLoader)
+namespace
 {
+    // Every level of detail aims for half the triangles of the previous one, and is dropped when it saves less than a tenth
+    constexpr float LodIndexRatio = 0.5f;
+    constexpr float LodMinimumReduction = 0.9f;
+    constexpr std::size_t LodMinimumIndexCount = 3 * 64;
+    // Largest deviation a level may introduce, relative to the radius of the mesh bounds
+    constexpr float LodMaxRelativeError = 0.05f;
+
+    void GenerateLods(Mesh& aMesh)
+    {
+        PROFILE_FUNCTION();
+
+        // Reserved up front since each level is simplified from the indices of the one before it
+        aMesh.myLods.clear();
+        aMesh.myLods.reserve(maxLodCount - 1);
+        const float maxError = BoundingBox::FromVertices(aMesh.myVertices).GetBoundingSphereRadius() * LodMaxRelativeError;
+        const std::vector<unsigned int>* previousIndices = &aMesh.myIndices;
+        float previousError = 0.0f;
+        while (aMesh.GetLodCount() < maxLodCount && previousIndices->size() >= LodMinimumIndexCount)
+        {
+            const std::size_t targetIndexCount = static_cast<std::size_t>(static_cast<float>(previousIndices->size() / 3) * LodIndexRatio) * 3;
+            MeshLod lod;
+            lod.myIndices = MeshSimplifier::Simplify(aMesh.myVertices, *previousIndices, targetIndexCount, maxError, lod.myError);
+            if (static_cast<float>(lod.myIndices.size()) > static_cast<float>(previousIndices->size()) * LodMinimumReduction)
+                break;
+
+            // Errors add up since every level is simplified from the previous one
+            lod.myError += previousError;
+            previousError = lod.myError;
+            aMesh.myLods.push_back(std::move(lod));
+            previousIndices = &aMesh.myLods.back().myIndices;
+        }
+    }
+
+    // Walks the triangles in vertex cache order and starts a new part whenever the next one could overflow meshSplitVertexCount,
+    // which keeps every part spatially coherent. Parts are simplified separately, so their shared borders only slide along each other.
+    void SplitMesh(Mesh& aMesh, std::vector<Mesh>& someParts)
+    {
+        PROFILE_FUNCTION();
+
+        MeshOptimizer::OptimizeVertexCache(aMesh.myIndices, aMesh.myVertices.size());
+
+        std::vector<unsigned int> remap(aMesh.myVertices.size(), UINT32_MAX);
+        std::vector<unsigned int> partVertices;
+        Mesh part;
+        for (std::size_t triangle = 0; triangle < aMesh.myIndices.size(); triangle += 3)
+        {
+            if (part.myVertices.size() + 3 > meshSplitVertexCount)
+            {
+                for (const unsigned int vertex : partVertices)
+                    remap[vertex] = UINT32_MAX;
+                partVertices.clear();
+                someParts.push_back(std::move(part));
+                part = Mesh();
+            }
+
+            for (std::size_t corner = 0; corner < 3; ++corner)
+            {
+                const unsigned int vertex = aMesh.myIndices[triangle + corner];
+                if (remap[vertex] == UINT32_MAX)
+                {
+                    remap[vertex] = static_cast<unsigned int>(part.myVertices.size());
+                    part.myVertices.push_back(aMesh.myVertices[vertex]);
+                    partVertices.push_back(vertex);
+                }
+
+                part.myIndices.push_back(remap[vertex]);
+            }
+        }
+
+        if (!part.myIndices.empty())
+            someParts.push_back(std::move(part));
+    }
+
+    void SplitLargeMeshes(Model& aModel)
+    {
+        std::vector<Mesh> meshes;
+        for (Mesh& mesh : aModel.myMeshes)
+        {
+            if (mesh.myVertices.size() <= meshSplitVertexCount)
+            {
+                meshes.push_back(std::move(mesh));
+                continue;
+            }
+
+            const std::size_t firstPart = meshes.size();
+            SplitMesh(mesh, meshes);
+            for (std::size_t part = firstPart; part < meshes.size(); ++part)
+                meshes[part].myTextures = mesh.myTextures;
+
+            LogUtility::PrintMessage(LogUtility::LogCategory::File, "- split a mesh of %zu vertices into %zu parts", mesh.myVertices.size(), meshes.size() - firstPart);
+        }
+
+        aModel.myMeshes = std::move(meshes);
+    }
+
+    // Reorders the indices of every level for the vertex cache, and then the vertices for fetch in the order level 0 uses them
+    void OptimizeMesh(Mesh& aMesh)
+    {
+        PROFILE_FUNCTION();
+
+        MeshOptimizer::OptimizeOverdraw(aMesh.myIndices, aMesh.myVertices);
+        GenerateLods(aMesh);
+
+        // Vertex fetch ordering below renames vertices but keeps every index in place, so the meshlet ranges stay valid
+        aMesh.myMeshlets.clear();
+        if (aMesh.myIndices.size() / 3 >= meshletMinimumTriangleCount)
+            aMesh.myMeshlets = MeshletBuilder::Build(aMesh.myVertices, aMesh.myIndices);
+        for (MeshLod& lod : aMesh.myLods)
+            MeshOptimizer::OptimizeVertexCache(lod.myIndices, aMesh.myVertices.size());
+
+        const std::vector<unsigned int> remap = MeshOptimizer::OptimizeVertexFetch(aMesh.myVertices, aMesh.myIndices);
+        for (MeshLod& lod : aMesh.myLods)
+        {
+            for (unsigned int& index : lod.myIndices)
+                index = remap[index];
+        }
+    }
+
+    void AccumulateVertexCacheStatistics(const Model& aModel, VertexCacheStatistics& someStatistics)
+    {
+        // Weighted by triangles and vertices so the model reads as if it were one mesh
+        float triangleCount = 0.0f;
+        float vertexCount = 0.0f;
+        for (const Mesh& mesh : aModel.myMeshes)
+        {
+            const VertexCacheStatistics statistics = MeshOptimizer::AnalyzeVertexCache(mesh.myIndices, mesh.myVertices.size());
+            const float meshTriangleCount = static_cast<float>(mesh.myIndices.size() / 3);
+            const float meshVertexCount = static_cast<float>(mesh.myVertices.size());
+            someStatistics.myAcmr += statistics.myAcmr * meshTriangleCount;
+            someStatistics.myAtvr += statistics.myAtvr * meshVertexCount;
+            triangleCount += meshTriangleCount;
+            vertexCount += meshVertexCount;
+        }
+
+        someStatistics.myAcmr /= std::max(triangleCount, 1.0f);
+        someStatistics.myAtvr /= std::max(vertexCount, 1.0f);
+    }
+}
+
+std::shared_ptr<Model> ModelLoader::LoadModelData(const std::string& aFilepath)
+{
+    PROFILE_FUNCTION();
+
+    const std::string& fileName = FileUtility::GetNameFromPath(aFilepath);
+
+    std::shared_ptr<Model> model = std::make_shared<Model>();
+    if (MeshCache::Read(aFilepath, *model))
+    {
+        LogUtility::PrintMessage(LogUtility::LogCategory::File, "Loading %s from mesh cache", fileName.c_str());
+    }
+    else
+    {
+        model = ParseModel(aFilepath);
+        if (!model)
+            return nullptr;
+
+        VertexCacheStatistics statisticsBefore;
+        AccumulateVertexCacheStatistics(*model, statisticsBefore);
+
+        if (meshSplitVertexCount > 0)
+            SplitLargeMeshes(*model);
+
+        for (Mesh& mesh : model->myMeshes)
+            OptimizeMesh(mesh);
+
+        VertexCacheStatistics statisticsAfter;
+        AccumulateVertexCacheStatistics(*model, statisticsAfter);
+        LogUtility::PrintMessage(LogUtility::LogCategory::File, "- vertex cache ACMR: %.3f -> %.3f, ATVR: %.3f -> %.3f",
+            statisticsBefore.myAcmr, statisticsAfter.myAcmr, statisticsBefore.myAtvr, statisticsAfter.myAtvr);
+
+        MeshCache::Write(aFilepath, *model);
+    }
+
+    for (Mesh& mesh : model->myMeshes)
+        mesh.myBounds = BoundingBox::FromVertices(mesh.myVertices);
+
+    LogUtility::PrintMessage(LogUtility::LogCategory::File, "- meshes: %i", model->myMeshes.size());
+    if (!model->myMeshes.empty())
+    {
+        LogUtility::PrintMessage(LogUtility::LogCategory::File, "- indices: %i", model->myMeshes[0].myIndices.size());
+        LogUtility::PrintMessage(LogUtility::LogCategory::File, "- vertices: %i", model->myMeshes[0].myVertices.size());
+        LogUtility::PrintMessage(LogUtility::LogCategory::File, "- levels of detail: %i", model->myMeshes[0].GetLodCount());
+        LogUtility::PrintMessage(LogUtility::LogCategory::File, "- meshlets: %zu", model->myMeshes[0].myMeshlets.size());
+    }
+
+    LogUtility::PrintMessage(LogUtility::LogCategory::File, "Loaded %s", fileName.c_str());
+
+    return model;
 }
 
-std::shared_ptr<Model> ModelLoader::LoadModel(const std::string& aFilepath) const
+std::shared_ptr<Model> ModelLoader::ParseModel(const std::string& aFilepath)
 {
+    PROFILE_FUNCTION();
+
     tinyobj::attrib_t attributes;
     std::vector<tinyobj::shape_t> shapes;
     std::vector<tinyobj::material_t> materials;
@@ -54,77 +252,37 @@ std::shared_ptr<Model> ModelLoader::LoadModel(const std::string& aFilepath) cons
         LogUtility::PrintMessage(LogUtility::LogCategory::File, "- diffuse_texname: %s", material.diffuse_texname.c_str());
 
     std::shared_ptr<Model> model = std::make_shared<Model>();
-    std::unordered_map<Vertex, uint32_t> uniqueVertices;
+    std::size_t indexCount = 0;
+    for (const tinyobj::shape_t& shape : shapes)
+        indexCount += shape.mesh.indices.size();
+
+    VertexWeldTable uniqueVertices(indexCount);
     Mesh mesh;
 
     for (const tinyobj::shape_t& shape : shapes)
     {
-        for (const tinyobj::index_t& index : shape.mesh.indices)
-        {
-            Vertex vertex;
-            size_t vertexIndexStride = 3 * static_cast<size_t>(index.vertex_index);
-            vertex.myPosition.x = attributes.vertices[vertexIndexStride];
-            vertex.myPosition.y = attributes.vertices[vertexIndexStride + 1];
-            vertex.myPosition.z = attributes.vertices[vertexIndexStride + 2];
-
-             if (!attributes.colors.empty())
-             {
-                 vertex.myColor.x = attributes.colors[vertexIndexStride];
-                 vertex.myColor.y = attributes.colors[vertexIndexStride + 1];
-                 vertex.myColor.z = attributes.colors[vertexIndexStride + 2];
-             }
-             else
-             {
-                vertex.myColor = glm::vec3(1.0f);
-             }
-
-            if (!attributes.texcoords.empty())
-            {
-                const size_t textureCoordinatesIndexStride = 2 * static_cast<size_t>(index.texcoord_index);
-                vertex.myTextureCoordinates.x = attributes.texcoords[textureCoordinatesIndexStride];
-                vertex.myTextureCoordinates.y = 1.0f - attributes.texcoords[textureCoordinatesIndexStride + 1];
-            }
-
-            if (uniqueVertices.count(vertex) == 0)
-            {
-                uniqueVertices[vertex] = static_cast<uint32_t>(mesh.myVertices.size());
-                mesh.myVertices.push_back(vertex);
-            }
-
-            mesh.myIndices.push_back(uniqueVertices[vertex]);
-        }
+        VertexWelder::Weld(attributes, shape.mesh.indices, uniqueVertices, mesh);
 
         model->myMeshes.push_back(mesh);
     }
 
-    std::map<std::string, unsigned int> textures;
+    std::set<std::string> textures;
     for (const tinyobj::material_t& material : materials)
     {
         if (!material.diffuse_texname.empty())
-        {
-            if (textures.find(material.diffuse_texname) == textures.end())
-            {
-                const unsigned int textureIdentifier = myTextureLoader.LoadTexture(directory + material.diffuse_texname);
-                textures.insert(std::make_pair(material.diffuse_texname, textureIdentifier));
-            }
-        }
+            textures.insert(material.diffuse_texname);
     }
 
-    for (const std::pair<std::string, unsigned int> pair : textures)
+    for (const std::string& texturePath : textures)
     {
         Texture texture;
-        texture.myPath = pair.first;
-        texture.myIdentifier = pair.second;
+        texture.myPath = texturePath;
         texture.myType = "texture_diffuse";
-        model->myMeshes[0].myTextures.push_back(texture);
+        if (!model->myMeshes.empty())
+            model->myMeshes[0].myTextures.push_back(texture);
     }
 
     LogUtility::PrintMessage(LogUtility::LogCategory::File, "- textures: %i", textures.size());
-    LogUtility::PrintMessage(LogUtility::LogCategory::File, "- meshes: %i", model->myMeshes.size());
-    LogUtility::PrintMessage(LogUtility::LogCategory::File, "- indices: %i", model->myMeshes[0].myIndices.size());
-    LogUtility::PrintMessage(LogUtility::LogCategory::File, "- vertices: %i", model->myMeshes[0].myVertices.size());
-
-    LogUtility::PrintMessage(LogUtility::LogCategory::File, "Loaded %s", fileName.c_str());
 
     return model;
 }
@@ -2,20 +2,15 @@
 
 #include <memory>
 #include <string>
-#include <vector>
-
-#include "TextureLoader.h"
 
 struct Model;
 
 class ModelLoader
 {
 public:
-	ModelLoader(TextureLoader& aTextureLoader);
-
-	[[nodiscard]] std::shared_ptr<Model> LoadModel(const std::string& aFilepath) const;
+	// Loads the meshes and texture paths of a model without touching GL, so it is safe to call from any thread
+	[[nodiscard]] static std::shared_ptr<Model> LoadModelData(const std::string& aFilepath);
 
 private:
-	std::vector<std::shared_ptr<Model>> myModels;
-	TextureLoader& myTextureLoader;
+	[[nodiscard]] static std::shared_ptr<Model> ParseModel(const std::string& aFilepath);
 };
@@ -0,0 +1,207 @@
+#include "OcclusionCuller.h"
+
+#include "BoundingBox.h"
+#include "GLUtility.h"
+#include "LogUtility.h"
+#include "ModelInstance.h"
+#include "Profiler.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+    constexpr int PyramidGroupSize = 8;
+    constexpr int CullGroupSize = 64;
+    // Candidates no command covers, such as instances of cluster draws, which are culled per meshlet instead
+    constexpr unsigned int NoCommand = UINT32_MAX;
+
+    enum StorageBinding : GLuint
+    {
+        CandidateInstancesBinding,
+        CandidateBoundsBinding,
+        CandidateCommandsBinding,
+        CommandsBinding,
+        VisibleInstancesBinding
+    };
+}
+
+OcclusionCuller::OcclusionCuller()
+    : myCandidateBoundsCapacity(0)
+    , myCandidateCommandsCapacity(0)
+    , myCommandCapacity(0)
+    , myVisibleInstanceCapacity(0)
+    , myFramebufferObject(0)
+    , myDepthTexture(0)
+    , myDepthPyramidTexture(0)
+    , myCandidateBoundsBufferObject(0)
+    , myCandidateCommandsBufferObject(0)
+    , myCommandBufferObject(0)
+    , myVisibleInstanceBufferObject(0)
+    , myWidth(0)
+    , myHeight(0)
+    , myLevelCount(0)
+    , myPreviousFramebuffer(0)
+    , myPreviousViewport{}
+{
+}
+
+void OcclusionCuller::Initialize(int aWidth, int aHeight)
+{
+    myWidth = aWidth;
+    myHeight = aHeight;
+    myLevelCount = static_cast<int>(std::floor(std::log2(static_cast<float>(std::max(aWidth, aHeight))))) + 1;
+
+    glGenTextures(1, &myDepthTexture);
+    glBindTexture(GL_TEXTURE_2D, myDepthTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, aWidth, aHeight);
+
+    // Every level is read with texelFetch, so the pyramid needs no filtering
+    glGenTextures(1, &myDepthPyramidTexture);
+    glBindTexture(GL_TEXTURE_2D, myDepthPyramidTexture);
+    glTexStorage2D(GL_TEXTURE_2D, myLevelCount, GL_R32F, aWidth, aHeight);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &myFramebufferObject);
+    glBindFramebuffer(GL_FRAMEBUFFER, myFramebufferObject);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, myDepthTexture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        LogUtility::PrintError(LogUtility::LogCategory::Graphics, "Occluder framebuffer is incomplete");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenBuffers(1, &myCandidateBoundsBufferObject);
+    glGenBuffers(1, &myCandidateCommandsBufferObject);
+    glGenBuffers(1, &myCommandBufferObject);
+    glGenBuffers(1, &myVisibleInstanceBufferObject);
+
+    myDepthPyramidShader.LoadCompute("Data/Shaders/DepthPyramid.comp.glsl");
+    mySourceLevelUniform = myDepthPyramidShader.GetUniform<int>("uSourceLevel");
+    myScaleUniform = myDepthPyramidShader.GetUniform<int>("uScale");
+
+    myCullShader.LoadCompute("Data/Shaders/OcclusionCull.comp.glsl");
+    myCandidateCountUniform = myCullShader.GetUniform<int>("uCandidateCount");
+}
+
+void OcclusionCuller::Destroy()
+{
+    glDeleteProgram(myDepthPyramidShader.myIdentifier);
+    glDeleteProgram(myCullShader.myIdentifier);
+    glDeleteFramebuffers(1, &myFramebufferObject);
+    glDeleteTextures(1, &myDepthTexture);
+    glDeleteTextures(1, &myDepthPyramidTexture);
+    glDeleteBuffers(1, &myCandidateBoundsBufferObject);
+    glDeleteBuffers(1, &myCandidateCommandsBufferObject);
+    glDeleteBuffers(1, &myCommandBufferObject);
+    glDeleteBuffers(1, &myVisibleInstanceBufferObject);
+    myFramebufferObject = 0;
+    myDepthTexture = 0;
+    myDepthPyramidTexture = 0;
+    myCandidateBoundsBufferObject = 0;
+    myCandidateCommandsBufferObject = 0;
+    myCommandBufferObject = 0;
+    myVisibleInstanceBufferObject = 0;
+    myCandidateBoundsCapacity = 0;
+    myCandidateCommandsCapacity = 0;
+    myCommandCapacity = 0;
+    myVisibleInstanceCapacity = 0;
+}
+
+void OcclusionCuller::BeginOccluders()
+{
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &myPreviousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, myPreviousViewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, myFramebufferObject);
+    glViewport(0, 0, myWidth, myHeight);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void OcclusionCuller::EndOccluders()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(myPreviousFramebuffer));
+    glViewport(myPreviousViewport[0], myPreviousViewport[1], myPreviousViewport[2], myPreviousViewport[3]);
+
+    BuildDepthPyramid();
+}
+
+void OcclusionCuller::SetCandidateBounds(const std::vector<BoundingBox>& someBounds)
+{
+    myCandidateBounds.resize(someBounds.size() * 2);
+    for (std::size_t candidate = 0; candidate < someBounds.size(); ++candidate)
+    {
+        myCandidateBounds[candidate * 2] = glm::vec4(someBounds[candidate].myMin, 1.0f);
+        myCandidateBounds[candidate * 2 + 1] = glm::vec4(someBounds[candidate].myMax, 1.0f);
+    }
+}
+
+void OcclusionCuller::Cull(const std::vector<DrawElementsIndirectCommand>& someCommands, unsigned int aCandidateInstanceBuffer)
+{
+    PROFILE_FUNCTION();
+
+    const std::size_t candidateCount = myCandidateBounds.size() / 2;
+    myCommands = someCommands;
+    myCandidateCommands.assign(candidateCount, NoCommand);
+    for (std::size_t commandIndex = 0; commandIndex < myCommands.size(); ++commandIndex)
+    {
+        DrawElementsIndirectCommand& command = myCommands[commandIndex];
+        for (unsigned int instance = command.myBaseInstance; instance < command.myBaseInstance + command.myInstanceCount && instance < candidateCount; ++instance)
+            myCandidateCommands[instance] = static_cast<unsigned int>(commandIndex);
+        command.myInstanceCount = 0;
+    }
+
+    GLUtility::UploadStorageBuffer(myCandidateBoundsBufferObject, myCandidateBoundsCapacity, myCandidateBounds.data(), myCandidateBounds.size() * sizeof(glm::vec4));
+    GLUtility::UploadStorageBuffer(myCandidateCommandsBufferObject, myCandidateCommandsCapacity, myCandidateCommands.data(), myCandidateCommands.size() * sizeof(unsigned int));
+    GLUtility::UploadStorageBuffer(myCommandBufferObject, myCommandCapacity, myCommands.data(), myCommands.size() * sizeof(DrawElementsIndirectCommand));
+    GLUtility::UploadStorageBuffer(myVisibleInstanceBufferObject, myVisibleInstanceCapacity, nullptr, candidateCount * sizeof(ModelInstance));
+
+    if (candidateCount == 0)
+        return;
+
+    const GLUtility::ScopedProgramRestore programRestore;
+    myCullShader.Use();
+    myCullShader.Set(myCandidateCountUniform, static_cast<int>(candidateCount));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CandidateInstancesBinding, aCandidateInstanceBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CandidateBoundsBinding, myCandidateBoundsBufferObject);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CandidateCommandsBinding, myCandidateCommandsBufferObject);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CommandsBinding, myCommandBufferObject);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VisibleInstancesBinding, myVisibleInstanceBufferObject);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, myDepthPyramidTexture);
+
+    glDispatchCompute(static_cast<GLuint>((candidateCount + CullGroupSize - 1) / CullGroupSize), 1, 1);
+
+    // The commands are read by the multi-draw and the compacted instances as vertex attributes
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+void OcclusionCuller::BuildDepthPyramid()
+{
+    PROFILE_FUNCTION();
+
+    myDepthPyramidShader.Use();
+    glActiveTexture(GL_TEXTURE0);
+
+    // Level 0 is a copy of the occluder depth, since a depth texture cannot be bound as a storage image
+    for (int level = 0; level < myLevelCount; ++level)
+    {
+        const int levelWidth = std::max(myWidth >> level, 1);
+        const int levelHeight = std::max(myHeight >> level, 1);
+
+        glBindTexture(GL_TEXTURE_2D, level == 0 ? myDepthTexture : myDepthPyramidTexture);
+        myDepthPyramidShader.Set(mySourceLevelUniform, level == 0 ? 0 : level - 1);
+        myDepthPyramidShader.Set(myScaleUniform, level == 0 ? 1 : 2);
+        glBindImageTexture(0, myDepthPyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+        glDispatchCompute(static_cast<GLuint>((levelWidth + PyramidGroupSize - 1) / PyramidGroupSize), static_cast<GLuint>((levelHeight + PyramidGroupSize - 1) / PyramidGroupSize), 1);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
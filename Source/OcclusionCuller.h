@@ -0,0 +1,65 @@
+#pragma once
+
+#include "DrawElementsIndirectCommand.h"
+#include "Shader.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+struct BoundingBox;
+
+// GPU occlusion culling against a hierarchical depth buffer. Occluders are drawn into a depth-only target between
+// BeginOccluders and EndOccluders, which reduces that depth into a mip chain where every texel holds the farthest depth
+// below it. Cull then tests the bounds of every candidate instance against that chain in a compute pass and writes the
+// survivors to the instance counts of an indirect command buffer, so hidden instances never reach the rasterizer.
+class OcclusionCuller
+{
+public:
+    OcclusionCuller();
+
+    void Initialize(int aWidth, int aHeight);
+    void Destroy();
+
+    void BeginOccluders();
+    void EndOccluders();
+
+    // World bounds of the candidate instances, in the same order as the instance buffer passed to Cull
+    void SetCandidateBounds(const std::vector<BoundingBox>& someBounds);
+
+    // Every candidate belongs to the command whose instance range contains it. The commands are copied with zero instances
+    // and the pass counts the visible ones back in, compacting them into GetVisibleInstanceBuffer at the same offsets.
+    void Cull(const std::vector<DrawElementsIndirectCommand>& someCommands, unsigned int aCandidateInstanceBuffer);
+
+    [[nodiscard]] unsigned int GetCommandBuffer() const { return myCommandBufferObject; }
+    [[nodiscard]] unsigned int GetVisibleInstanceBuffer() const { return myVisibleInstanceBufferObject; }
+
+private:
+    void BuildDepthPyramid();
+
+    Shader myDepthPyramidShader;
+    Shader myCullShader;
+    UniformHandle<int> mySourceLevelUniform;
+    UniformHandle<int> myScaleUniform;
+    UniformHandle<int> myCandidateCountUniform;
+    std::vector<glm::vec4> myCandidateBounds;
+    std::vector<unsigned int> myCandidateCommands;
+    std::vector<DrawElementsIndirectCommand> myCommands;
+    std::size_t myCandidateBoundsCapacity;
+    std::size_t myCandidateCommandsCapacity;
+    std::size_t myCommandCapacity;
+    std::size_t myVisibleInstanceCapacity;
+    unsigned int myFramebufferObject;
+    unsigned int myDepthTexture;
+    unsigned int myDepthPyramidTexture;
+    unsigned int myCandidateBoundsBufferObject;
+    unsigned int myCandidateCommandsBufferObject;
+    unsigned int myCommandBufferObject;
+    unsigned int myVisibleInstanceBufferObject;
+    int myWidth;
+    int myHeight;
+    int myLevelCount;
+    int myPreviousFramebuffer;
+    int myPreviousViewport[4];
+};
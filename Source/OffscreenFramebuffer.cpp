@@ -0,0 +1,98 @@
+#include "OffscreenFramebuffer.h"
+
+#include "LogUtility.h"
+
+#include <glad/glad.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include <cstring>
+
+OffscreenFramebuffer::OffscreenFramebuffer()
+    : myFramebufferObject(0)
+    , myColorRenderbuffer(0)
+    , myDepthRenderbuffer(0)
+    , myWidth(0)
+    , myHeight(0)
+{
+}
+
+bool OffscreenFramebuffer::Create(int aWidth, int aHeight)
+{
+    myWidth = aWidth;
+    myHeight = aHeight;
+
+    glGenRenderbuffers(1, &myColorRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, myColorRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, aWidth, aHeight);
+
+    glGenRenderbuffers(1, &myDepthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, myDepthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, aWidth, aHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &myFramebufferObject);
+    glBindFramebuffer(GL_FRAMEBUFFER, myFramebufferObject);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, myColorRenderbuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, myDepthRenderbuffer);
+
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::GL, "Offscreen framebuffer is incomplete: %i", status);
+        return false;
+    }
+
+    return true;
+}
+
+void OffscreenFramebuffer::Destroy()
+{
+    glDeleteFramebuffers(1, &myFramebufferObject);
+    glDeleteRenderbuffers(1, &myColorRenderbuffer);
+    glDeleteRenderbuffers(1, &myDepthRenderbuffer);
+    myFramebufferObject = 0;
+    myColorRenderbuffer = 0;
+    myDepthRenderbuffer = 0;
+}
+
+void OffscreenFramebuffer::Bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, myFramebufferObject);
+    glViewport(0, 0, myWidth, myHeight);
+}
+
+void OffscreenFramebuffer::ReadPixels(std::vector<unsigned char>& somePixels) const
+{
+    const std::size_t rowSize = static_cast<std::size_t>(myWidth) * 4;
+    somePixels.resize(rowSize * myHeight);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, myFramebufferObject);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, myWidth, myHeight, GL_RGBA, GL_UNSIGNED_BYTE, somePixels.data());
+
+    // GL returns the bottom row first
+    std::vector<unsigned char> row(rowSize);
+    for (int y = 0; y < myHeight / 2; ++y)
+    {
+        unsigned char* top = somePixels.data() + rowSize * y;
+        unsigned char* bottom = somePixels.data() + rowSize * (myHeight - 1 - y);
+        std::memcpy(row.data(), top, rowSize);
+        std::memcpy(top, bottom, rowSize);
+        std::memcpy(bottom, row.data(), rowSize);
+    }
+}
+
+bool OffscreenFramebuffer::SaveToFile(const std::string& aFilepath) const
+{
+    std::vector<unsigned char> pixels;
+    ReadPixels(pixels);
+    if (stbi_write_png(aFilepath.c_str(), myWidth, myHeight, 4, pixels.data(), myWidth * 4) == 0)
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::File, "Failed to write frame %s", aFilepath.c_str());
+        return false;
+    }
+
+    return true;
+}
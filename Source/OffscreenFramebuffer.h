@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Color and depth render target that does not depend on a window, used for headless rendering
+class OffscreenFramebuffer
+{
+public:
+    OffscreenFramebuffer();
+
+    bool Create(int aWidth, int aHeight);
+    void Destroy();
+
+    void Bind() const;
+
+    // Reads the color attachment back as tightly packed RGBA8 rows, top row first
+    void ReadPixels(std::vector<unsigned char>& somePixels) const;
+    bool SaveToFile(const std::string& aFilepath) const;
+
+    [[nodiscard]] int GetWidth() const { return myWidth; }
+    [[nodiscard]] int GetHeight() const { return myHeight; }
+
+private:
+    unsigned int myFramebufferObject;
+    unsigned int myColorRenderbuffer;
+    unsigned int myDepthRenderbuffer;
+    int myWidth;
+    int myHeight;
+};
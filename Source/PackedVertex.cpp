@@ -0,0 +1,72 @@
+#include "PackedVertex.h"
+
+#include "BoundingBox.h"
+#include "Vertex.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    int16_t PackSnorm(float aValue)
+    {
+        return static_cast<int16_t>(std::lround(std::clamp(aValue, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    uint8_t PackUnorm(float aValue)
+    {
+        return static_cast<uint8_t>(std::lround(std::clamp(aValue, 0.0f, 1.0f) * 255.0f));
+    }
+}
+
+std::vector<unsigned char> PackedVertex::Pack(const std::vector<Vertex>& someVertices, const BoundingBox& aBounds, bool aHasColors)
+{
+    const std::size_t stride = aHasColors ? StrideWithColor : StrideWithoutColor;
+    std::vector<unsigned char> bytes(someVertices.size() * stride);
+
+    const glm::vec3 center = aBounds.GetCenter();
+    const glm::vec3 inverseExtents = 1.0f / GetQuantizationExtents(aBounds);
+
+    for (std::size_t i = 0; i < someVertices.size(); ++i)
+    {
+        const Vertex& vertex = someVertices[i];
+        const glm::vec3 position = (vertex.myPosition - center) * inverseExtents;
+
+        PackedVertex packedVertex;
+        packedVertex.myPosition[0] = PackSnorm(position.x);
+        packedVertex.myPosition[1] = PackSnorm(position.y);
+        packedVertex.myPosition[2] = PackSnorm(position.z);
+        packedVertex.myPosition[3] = 0;
+        packedVertex.myTextureCoordinates[0] = glm::packHalf1x16(vertex.myTextureCoordinates.x);
+        packedVertex.myTextureCoordinates[1] = glm::packHalf1x16(vertex.myTextureCoordinates.y);
+        packedVertex.myColor[0] = PackUnorm(vertex.myColor.x);
+        packedVertex.myColor[1] = PackUnorm(vertex.myColor.y);
+        packedVertex.myColor[2] = PackUnorm(vertex.myColor.z);
+        packedVertex.myColor[3] = 255;
+        std::memcpy(bytes.data() + i * stride, &packedVertex, stride);
+    }
+
+    return bytes;
+}
+
+bool PackedVertex::HasColors(const std::vector<Vertex>& someVertices)
+{
+    return std::any_of(someVertices.begin(), someVertices.end(), [](const Vertex& aVertex) { return aVertex.myColor != glm::vec3(1.0f); });
+}
+
+glm::mat4 PackedVertex::GetDequantizationTransform(const BoundingBox& aBounds)
+{
+    return glm::translate(glm::mat4(1.0f), aBounds.GetCenter()) * glm::scale(glm::mat4(1.0f), GetQuantizationExtents(aBounds));
+}
+
+glm::vec3 PackedVertex::GetQuantizationExtents(const BoundingBox& aBounds)
+{
+    // Flat meshes have no extent along one axis, a tiny one keeps the transform invertible and every position on it packs to zero
+    const glm::vec3 extents = aBounds.GetExtents();
+    const float minimumExtent = std::max(std::max(std::max(extents.x, extents.y), extents.z) * 1.0e-4f, 1.0e-6f);
+    return glm::max(extents, glm::vec3(minimumExtent));
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct BoundingBox;
+struct Vertex;
+
+// Vertex as it is stored on the GPU, half the size of Vertex. Positions are normalized 16-bit integers within the mesh bounds,
+// texture coordinates are half floats and colors are RGBA8. Meshes whose vertices are all white leave the color out entirely,
+// which takes the stride down to 12 bytes, and read the white generic attribute value instead.
+struct PackedVertex
+{
+    static constexpr std::size_t StrideWithColor = 16;
+    static constexpr std::size_t StrideWithoutColor = 12;
+
+    // Packs the vertices back to back as raw bytes, with colors only when aHasColors is set
+    static std::vector<unsigned char> Pack(const std::vector<Vertex>& someVertices, const BoundingBox& aBounds, bool aHasColors);
+
+    // Whether any vertex has a color other than the white ModelLoader gives vertices without one
+    static bool HasColors(const std::vector<Vertex>& someVertices);
+
+    // Object-space transform from packed positions back to the positions they were packed from
+    static glm::mat4 GetDequantizationTransform(const BoundingBox& aBounds);
+
+    // Half the size of the bounds along every axis, never zero so positions can be quantized again on the GPU
+    static glm::vec3 GetQuantizationExtents(const BoundingBox& aBounds);
+
+    // The fourth component is unused and keeps the texture coordinates 4-byte aligned
+    int16_t myPosition[4];
+    uint16_t myTextureCoordinates[2];
+    uint8_t myColor[4];
+};
+
+static_assert(sizeof(PackedVertex) == PackedVertex::StrideWithColor, "PackedVertex is uploaded as is");
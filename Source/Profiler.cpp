@@ -0,0 +1,210 @@
+#include "Profiler.h"
+
+#include "LogUtility.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Profiler
+{
+    namespace
+    {
+        constexpr std::size_t ThreadEventCapacity = 1 << 16;
+
+        struct ZoneEvent
+        {
+            const char* myName;
+            uint64_t myStartTime;
+            uint64_t myEndTime;
+        };
+
+        // Written by its owning thread only, read by the exporter
+        struct ThreadBuffer
+        {
+            std::array<ZoneEvent, ThreadEventCapacity> myEvents;
+            std::atomic<uint64_t> myWriteIndex{ 0 };
+            uint32_t myThreadIdentifier = 0;
+            std::string myThreadName;
+        };
+
+        struct Registry
+        {
+            std::vector<std::shared_ptr<ThreadBuffer>> myThreadBuffers;
+            std::mutex myMutex;
+        };
+
+        Registry& GetRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        const std::chrono::steady_clock::time_point& GetEpoch()
+        {
+            static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+            return epoch;
+        }
+
+        ThreadBuffer& CreateThreadBuffer(const std::string& aName)
+        {
+            const std::shared_ptr<ThreadBuffer> threadBuffer = std::make_shared<ThreadBuffer>();
+            Registry& registry = GetRegistry();
+            const std::lock_guard<std::mutex> lock(registry.myMutex);
+            threadBuffer->myThreadIdentifier = static_cast<uint32_t>(registry.myThreadBuffers.size());
+            threadBuffer->myThreadName = aName.empty() ? "Thread " + std::to_string(threadBuffer->myThreadIdentifier) : aName;
+            registry.myThreadBuffers.push_back(threadBuffer);
+            return *threadBuffer;
+        }
+
+        ThreadBuffer& GetThreadBuffer()
+        {
+            thread_local ThreadBuffer* threadBuffer = nullptr;
+            if (!threadBuffer)
+                threadBuffer = &CreateThreadBuffer("");
+
+            return *threadBuffer;
+        }
+
+        void WriteEvent(ThreadBuffer& aThreadBuffer, const char* aName, uint64_t aStartTime, uint64_t anEndTime)
+        {
+            const uint64_t writeIndex = aThreadBuffer.myWriteIndex.load(std::memory_order_relaxed);
+            aThreadBuffer.myEvents[writeIndex & (ThreadEventCapacity - 1)] = ZoneEvent{ aName, aStartTime, anEndTime };
+            aThreadBuffer.myWriteIndex.store(writeIndex + 1, std::memory_order_release);
+        }
+
+        void WriteEscapedString(std::ofstream& aStream, const char* aString)
+        {
+            aStream << '"';
+            for (const char* character = aString; *character; ++character)
+            {
+                if (*character == '"' || *character == '\\')
+                    aStream << '\\';
+
+                aStream << *character;
+            }
+
+            aStream << '"';
+        }
+
+        void WriteMicroseconds(std::ofstream& aStream, uint64_t aNanoseconds)
+        {
+            const uint64_t fraction = aNanoseconds % 1000;
+            aStream << aNanoseconds / 1000 << '.' << static_cast<char>('0' + fraction / 100) << static_cast<char>('0' + fraction / 10 % 10) << static_cast<char>('0' + fraction % 10);
+        }
+    }
+
+    uint64_t GetTimestamp()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - GetEpoch()).count());
+    }
+
+    void RecordZone(const char* aName, uint64_t aStartTime, uint64_t anEndTime)
+    {
+        WriteEvent(GetThreadBuffer(), aName, aStartTime, anEndTime);
+    }
+
+    void SetThreadName(const std::string& aName)
+    {
+        ThreadBuffer& threadBuffer = GetThreadBuffer();
+        const std::lock_guard<std::mutex> lock(GetRegistry().myMutex);
+        threadBuffer.myThreadName = aName;
+    }
+
+    uint32_t CreateTrack(const std::string& aName)
+    {
+        return CreateThreadBuffer(aName).myThreadIdentifier;
+    }
+
+    // A track has a single writer just like a thread buffer, which is whoever owns the track
+    void RecordTrackZone(uint32_t aTrack, const char* aName, uint64_t aStartTime, uint64_t anEndTime)
+    {
+        std::shared_ptr<ThreadBuffer> threadBuffer;
+        {
+            Registry& registry = GetRegistry();
+            const std::lock_guard<std::mutex> lock(registry.myMutex);
+            if (aTrack >= registry.myThreadBuffers.size())
+                return;
+
+            threadBuffer = registry.myThreadBuffers[aTrack];
+        }
+
+        WriteEvent(*threadBuffer, aName, aStartTime, anEndTime);
+    }
+
+    bool WriteChromeTrace(const std::string& aFilepath)
+    {
+        std::ofstream stream(aFilepath, std::ios::trunc);
+        if (!stream)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::File, "Failed to write profiler capture %s", aFilepath.c_str());
+            return false;
+        }
+
+        std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+        std::vector<std::string> threadNames;
+        {
+            Registry& registry = GetRegistry();
+            const std::lock_guard<std::mutex> lock(registry.myMutex);
+            threadBuffers = registry.myThreadBuffers;
+            for (const std::shared_ptr<ThreadBuffer>& threadBuffer : threadBuffers)
+                threadNames.push_back(threadBuffer->myThreadName);
+        }
+
+        std::size_t eventCount = 0;
+        std::vector<ZoneEvent> events;
+        stream << "{\"traceEvents\":[";
+        for (std::size_t i = 0; i < threadBuffers.size(); ++i)
+        {
+            const ThreadBuffer& threadBuffer = *threadBuffers[i];
+            if (i > 0)
+                stream << ',';
+
+            stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadBuffer.myThreadIdentifier << ",\"args\":{\"name\":";
+            WriteEscapedString(stream, threadNames[i].c_str());
+            stream << "}}";
+
+            // The owning thread keeps writing while we copy, so drop whatever it may have overwritten in the meantime
+            const uint64_t endIndex = threadBuffer.myWriteIndex.load(std::memory_order_acquire);
+            const uint64_t beginIndex = endIndex > ThreadEventCapacity ? endIndex - ThreadEventCapacity : 0;
+            events.clear();
+            for (uint64_t index = beginIndex; index < endIndex; ++index)
+                events.push_back(threadBuffer.myEvents[index & (ThreadEventCapacity - 1)]);
+
+            // Keeps the copies above from being reordered after the reload, which would make the overwrite check look at stale slots
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            // The slot of latestIndex may be half written already, so it is dropped along with the ones written over before it
+            const uint64_t latestIndex = threadBuffer.myWriteIndex.load(std::memory_order_acquire);
+            const uint64_t firstIntactIndex = latestIndex + 1 > ThreadEventCapacity ? latestIndex + 1 - ThreadEventCapacity : 0;
+            const uint64_t overwrittenCount = firstIntactIndex > beginIndex ? firstIntactIndex - beginIndex : 0;
+            for (std::size_t eventIndex = static_cast<std::size_t>(std::min<uint64_t>(overwrittenCount, events.size())); eventIndex < events.size(); ++eventIndex)
+            {
+                const ZoneEvent& event = events[eventIndex];
+                stream << ",{\"name\":";
+                WriteEscapedString(stream, event.myName);
+                stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadBuffer.myThreadIdentifier << ",\"ts\":";
+                WriteMicroseconds(stream, event.myStartTime);
+                stream << ",\"dur\":";
+                WriteMicroseconds(stream, event.myEndTime - event.myStartTime);
+                stream << '}';
+                ++eventCount;
+            }
+        }
+
+        stream << "],\"displayTimeUnit\":\"ms\"}\n";
+        if (!stream)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::File, "Failed to write profiler capture %s", aFilepath.c_str());
+            return false;
+        }
+
+        LogUtility::PrintMessage(LogUtility::LogCategory::File, "Wrote profiler capture %s with %i events", aFilepath.c_str(), static_cast<int>(eventCount));
+        return true;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Lightweight CPU profiler. Every thread records its zones into its own lock-free ring buffer,
+// which keeps the most recent events around so they can be exported as a Chrome trace_event capture.
+namespace Profiler
+{
+    // Nanoseconds since the profiler was first used
+    [[nodiscard]] uint64_t GetTimestamp();
+
+    // aName must outlive the profiler, which in practice means a string literal
+    void RecordZone(const char* aName, uint64_t aStartTime, uint64_t anEndTime);
+    void SetThreadName(const std::string& aName);
+
+    // Tracks show up next to the threads in a capture and take zones with timestamps measured elsewhere, e.g. on the GPU
+    [[nodiscard]] uint32_t CreateTrack(const std::string& aName);
+    void RecordTrackZone(uint32_t aTrack, const char* aName, uint64_t aStartTime, uint64_t anEndTime);
+
+    // Writes all events still held by the ring buffers, viewable in chrome://tracing or Perfetto
+    bool WriteChromeTrace(const std::string& aFilepath);
+
+    class ScopedZone
+    {
+    public:
+        explicit ScopedZone(const char* aName)
+            : myName(aName)
+            , myStartTime(GetTimestamp())
+        {}
+
+        ~ScopedZone() { RecordZone(myName, myStartTime, GetTimestamp()); }
+
+        ScopedZone(const ScopedZone&) = delete;
+        ScopedZone& operator=(const ScopedZone&) = delete;
+
+    private:
+        const char* myName;
+        uint64_t myStartTime;
+    };
+}
+
+#define PROFILER_CONCATENATE_IMPLEMENTATION(aFirst, aSecond) aFirst##aSecond
+#define PROFILER_CONCATENATE(aFirst, aSecond) PROFILER_CONCATENATE_IMPLEMENTATION(aFirst, aSecond)
+#define PROFILE_SCOPE(aName) const Profiler::ScopedZone PROFILER_CONCATENATE(profilerZone, __LINE__)(aName)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
@@ -1,103 +1,628 @@
 #include "RenderMate.h"
 
 #include "AppDefinitions.h"
+#include "AppSettings.h"
+#include "AssetStreamer.h"
 #include "Camera.h"
+#include "FrameUniformBuffer.h"
+#include "Frustum.h"
 #include "GLUtility.h"
+#include "GeometryPool.h"
+#include "GpuProfiler.h"
 #include "LogUtility.h"
 #include "InputManager.h"
 #include "Mesh.h"
-#include "ModelLoader.h"
+#include "ClusterCuller.h"
+#include "OcclusionCuller.h"
+#include "OffscreenFramebuffer.h"
+#include "PackedVertex.h"
+#include "Profiler.h"
 #include "Shader.h"
+#include "Texture.h"
 #include "TextureLoader.h"
+#include "UploadRing.h"
+#include "VirtualTextureFeedback.h"
+#include "VirtualTextureSystem.h"
 
 #include <GLFW/glfw3.h>
 #include <glm/gtx/transform.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+
 RenderMate::RenderMate()
     : myWindow(nullptr)
     , myCamera(nullptr)
     , myShader(nullptr)
+    , myDepthShader(nullptr)
     , myTextureLoader(nullptr)
-    , myModelLoader(nullptr)
+    , myAssetStreamer(nullptr)
+    , myGpuProfiler(nullptr)
+    , myFrameUniformBuffer(nullptr)
+    , myUploadRing(nullptr)
+    , myGeometryPool(nullptr)
+    , myOcclusionCuller(nullptr)
+    , myClusterCuller(nullptr)
+    , myOffscreenFramebuffer(nullptr)
+    , myVirtualTextureSystem(nullptr)
+    , myVirtualTextureFeedback(nullptr)
+    , myUploadByteBudget(uploadBytesPerFrame)
+    , myFramebufferHeight(screenHeight)
+    , myFrameIndex(0)
+    , myInstanceCount(1)
+    , myIsHeadless(false)
+    , myIsInstancingEnabled(true)
+    , myIsMultiDrawEnabled(true)
+    , myIsLodEnabled(true)
+    , myWasLeftMouseButtonDown(false)
 {
 }
 
 RenderMate::~RenderMate()
 {
-    delete myModelLoader;
+    delete myAssetStreamer;
+    delete myGpuProfiler;
+    delete myFrameUniformBuffer;
+    delete myUploadRing;
+    delete myGeometryPool;
+    delete myOcclusionCuller;
+    delete myClusterCuller;
+    delete myOffscreenFramebuffer;
+    delete myVirtualTextureSystem;
+    delete myVirtualTextureFeedback;
     delete myTextureLoader;
     delete myShader;
+    delete myDepthShader;
     delete myCamera;
 }
 
-void RenderMate::Initialize()
+void RenderMate::Initialize(const AppSettings& someSettings)
 {
+    myIsHeadless = someSettings.myIsHeadless;
+    myIsInstancingEnabled = someSettings.myIsInstancingEnabled;
+    myIsMultiDrawEnabled = someSettings.myIsMultiDrawEnabled;
+    myIsLodEnabled = someSettings.myIsLodEnabled;
+    myInstanceCount = someSettings.myInstanceCount;
+    myFrameOutputDirectory = someSettings.myFrameOutputDirectory;
+    myUploadByteBudget = someSettings.myUploadByteBudget;
+
     CreateWindow();
     CreateContext();
 
+    if (myIsHeadless)
+    {
+        myOffscreenFramebuffer = new OffscreenFramebuffer();
+        if (!myOffscreenFramebuffer->Create(screenWidth, screenHeight))
+        {
+            // The hidden window still has a default framebuffer, so the frames render there and are just not saved
+            LogUtility::PrintError(LogUtility::LogCategory::GL, "Failed to create the offscreen framebuffer, rendering to the default framebuffer without frame output");
+            myOffscreenFramebuffer->Destroy();
+            delete myOffscreenFramebuffer;
+            myOffscreenFramebuffer = nullptr;
+        }
+    }
+
+    if (!myFrameOutputDirectory.empty())
+    {
+        std::error_code errorCode;
+        std::filesystem::create_directories(myFrameOutputDirectory, errorCode);
+    }
+
+    myGpuProfiler = new GpuProfiler();
+    myGpuProfiler->Initialize();
+
+    myFrameUniformBuffer = new FrameUniformBuffer();
+    myFrameUniformBuffer->Initialize();
+
+    myUploadRing = new UploadRing();
+    myUploadRing->Initialize(uploadRingBytes);
+
+    myGeometryPool = new GeometryPool(*myUploadRing);
+    myGeometryPool->Initialize();
+
     myCamera = new Camera();
     myCamera->SetPosition(glm::vec3(0.0f, 0.0f, 3.0f));
 
     myShader = new Shader();
     myShader->Load("Data/Shaders/TexturedCube.vert.glsl", "Data/Shaders/TexturedCube.frag.glsl");
 
-    const std::string objFilepath = "Data/Models/MagicCube/MagicCube.obj";
+    if (someSettings.myIsOcclusionCullingEnabled)
+    {
+        myDepthShader = new Shader();
+        myDepthShader->Load("Data/Shaders/Depth.vert.glsl", "Data/Shaders/Depth.frag.glsl");
 
-    myTextureLoader = new TextureLoader();
-    myModelLoader = new ModelLoader(*myTextureLoader);
-    if (const std::shared_ptr<Model> model = myModelLoader->LoadModel(objFilepath))
-        myModels.emplace_back(model);
+        myOcclusionCuller = new OcclusionCuller();
+        myOcclusionCuller->Initialize(screenWidth, screenHeight);
+    }
 
-    for (const std::shared_ptr<Model>& model : myModels)
+    if (someSettings.myIsClusterCullingEnabled)
     {
-        for (Mesh& mesh : model->myMeshes)
-            mesh.SetupMesh();
+        myClusterCuller = new ClusterCuller();
+        myClusterCuller->Initialize();
+    }
+
+    if (someSettings.myIsVirtualTexturingEnabled)
+    {
+        myVirtualTextureSystem = new VirtualTextureSystem(*myUploadRing);
+        myVirtualTextureSystem->Initialize();
+
+        myVirtualTextureFeedback = new VirtualTextureFeedback();
+        myVirtualTextureFeedback->Initialize(screenWidth / virtualTextureFeedbackScale, screenHeight / virtualTextureFeedbackScale);
+    }
+
+    myTextureLoader = new TextureLoader(*myUploadRing, myVirtualTextureSystem, someSettings.myIsTextureCompressionEnabled, someSettings.myTextureByteBudget);
+    myAssetStreamer = new AssetStreamer(*myTextureLoader, *myGeometryPool, someSettings.myTextureDecodeByteBudget);
+    for (const std::string& modelFilepath : someSettings.myModelFilepaths)
+        myAssetStreamer->RequestModel(modelFilepath);
+
+    // Headless frames have to be reproducible, so they cannot depend on how far streaming got
+    if (myIsHeadless)
+    {
+        myAssetStreamer->Flush(myModels);
+        for (const std::shared_ptr<Model>& model : myModels)
+            SetupInstances(*model);
+        BuildDrawList();
+
+        // Fences the flushed uploads so the first frame does not count them
+        myUploadRing->EndFrame();
     }
 }
 
-void RenderMate::Update(float aDeltaTime) const
+void RenderMate::Update(float aDeltaTime)
 {
-    if (InputManager::GetInstance().IsKeyDown(Keys::Escape))
+    PROFILE_FUNCTION();
+
+    myGpuProfiler->BeginFrame();
+    myStatistics = RenderStatistics();
+
+    if (myOffscreenFramebuffer)
+        myOffscreenFramebuffer->Bind();
+
+    const std::size_t previousUploadedBytes = myAssetStreamer->GetUploadedBytes();
+    const std::size_t previousModelCount = myModels.size();
+    myAssetStreamer->ProcessUploads(myUploadByteBudget, myModels);
+    if (myModels.size() > previousModelCount)
+    {
+        for (std::size_t modelIndex = previousModelCount; modelIndex < myModels.size(); ++modelIndex)
+            SetupInstances(*myModels[modelIndex]);
+        BuildDrawList();
+    }
+    myStatistics.myUploadBytes = myAssetStreamer->GetUploadedBytes() - previousUploadedBytes;
+
+    if (myVirtualTextureSystem)
+        UpdateVirtualTextures();
+
+    const InputManager& inputManager = InputManager::GetInstance();
+    if (inputManager.IsKeyDown(Keys::Escape))
         glfwSetWindowShouldClose(myWindow, true);
 
+    for (const Keys key : inputManager.GetPressedKeysThisFrame())
+    {
+        if (key == Keys::F9)
+            Profiler::WriteChromeTrace(profilerCaptureFilepath);
+
+        if (key == Keys::F10)
+            myGpuProfiler->LogResults();
+    }
+
+    const bool isLeftMouseButtonDown = inputManager.IsMouseButtonDown(MouseButtons::Left);
+    if (isLeftMouseButtonDown && !myWasLeftMouseButtonDown)
+        PickAtCursor();
+    myWasLeftMouseButtonDown = isLeftMouseButtonDown;
+
     myCamera->Update(aDeltaTime);
+    myFrameUniformBuffer->Update(*myCamera);
+
+    {
+        PROFILE_SCOPE("Clear");
+        const GpuProfiler::ScopedZone gpuZone(*myGpuProfiler, "Clear");
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    {
+        PROFILE_SCOPE("Cull");
+        const Frustum frustum = Frustum::FromViewProjection(myCamera->GetProjectionMatrix() * myCamera->GetViewMatrix());
+        myCullingBounds.Cull(frustum, myVisibility);
+
+        const int framebufferHeight = myOffscreenFramebuffer ? myOffscreenFramebuffer->GetHeight() : myFramebufferHeight;
+        // Pixels covered by one world unit at a distance of one unit, which turns a level's object space error into pixels
+        const float pixelsPerUnit = myCamera->GetProjectionMatrix()[1][1] * 0.5f * static_cast<float>(framebufferHeight);
+
+        // Visible instances are packed per mesh and then per level of detail, so each level can reach its own through baseInstance.
+        // The packed copies also take the mesh dequantization, since the pool stores positions relative to the mesh bounds.
+        myInstances.clear();
+        myVisibleBounds.clear();
+        for (MeshDraw& meshDraw : myMeshDraws)
+        {
+            const Mesh& mesh = *meshDraw.myMesh;
+            const std::vector<ModelInstance>& instances = meshDraw.myModel->myInstances;
+            if (myIsLodEnabled && mesh.GetLodCount() > 1)
+            {
+                for (std::size_t instanceIndex = 0; instanceIndex < instances.size(); ++instanceIndex)
+                {
+                    const std::size_t item = meshDraw.myFirstBounds + instanceIndex;
+                    if (myVisibility[item])
+                        myInstanceLods[item] = SelectLod(mesh, instances[instanceIndex].myTransform, myWorldBounds[item], myInstanceLods[item], pixelsPerUnit);
+                }
+            }
+
+            const glm::mat4 dequantization = PackedVertex::GetDequantizationTransform(mesh.myBounds);
+            meshDraw.myBaseInstance = static_cast<unsigned int>(myInstances.size());
+            meshDraw.myLodInstanceCounts.fill(0);
+            for (std::size_t lod = 0; lod < mesh.GetLodCount(); ++lod)
+            {
+                const std::size_t lodBaseInstance = myInstances.size();
+                for (std::size_t instanceIndex = 0; instanceIndex < instances.size(); ++instanceIndex)
+                {
+                    const std::size_t item = meshDraw.myFirstBounds + instanceIndex;
+                    if (!myVisibility[item] || myInstanceLods[item] != lod)
+                        continue;
+
+                    myInstances.push_back(instances[instanceIndex]);
+                    myInstances.back().myTransform *= dequantization;
+                    if (myOcclusionCuller)
+                        myVisibleBounds.push_back(myWorldBounds[item]);
+                }
+
+                meshDraw.myLodInstanceCounts[lod] = static_cast<unsigned int>(myInstances.size() - lodBaseInstance);
+            }
+
+            meshDraw.myInstanceCount = static_cast<unsigned int>(myInstances.size()) - meshDraw.myBaseInstance;
+        }
+
+        myStatistics.myVisibleInstances = myInstances.size();
+        myStatistics.myCulledInstances = myCullingBounds.GetCount() - myInstances.size();
+        if (!myInstances.empty())
+            myGeometryPool->UploadInstances(myInstances);
+    }
 
-    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (myOcclusionCuller && !myInstances.empty())
+    {
+        PROFILE_SCOPE("Occluders");
+        const GpuProfiler::ScopedZone gpuZone(*myGpuProfiler, "Occluders");
+        SelectOccluders();
+        myOcclusionCuller->SetCandidateBounds(myVisibleBounds);
+
+        myOcclusionCuller->BeginOccluders();
+        myDepthShader->Use();
+        for (const Occluder& occluder : myOccluders)
+            myGeometryPool->Draw(occluder.myMesh->myGeometryAllocation, 0, 1, occluder.myInstance);
+        myOcclusionCuller->EndOccluders();
+
+        myStatistics.myOccluders = myOccluders.size();
+        myStatistics.myDrawCalls += static_cast<int>(myOccluders.size());
+    }
 
-    const glm::mat4 projection = myCamera->GetProjectionMatrix();
-    const glm::mat4 view = myCamera->GetViewMatrix();
-    glm::mat4 modelMatrix = glm::mat4(1.0f);
-    modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 0.0f, 0.0f)); // Translate it down so it's at the center of the scene
-    modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0f, 1.0f, 1.0f)); // It's a bit too big for our scene, so scale it down
+    {
+        PROFILE_SCOPE("Draw");
+        const GpuProfiler::ScopedZone gpuZone(*myGpuProfiler, "Draw");
+        myShader->Use();
+
+        myVirtualTextureDraws.clear();
+        for (const MeshDraw& meshDraw : myMeshDraws)
+        {
+            const Mesh& mesh = *meshDraw.myMesh;
+            const unsigned int texture = mesh.myTextures.empty() ? 0 : mesh.myTextures[0].myIdentifier;
+            const VirtualTexture* virtualTexture = myVirtualTextureSystem && texture != 0 ? myVirtualTextureSystem->FindTexture(texture) : nullptr;
+            unsigned int baseInstance = meshDraw.myBaseInstance;
+            for (std::size_t lod = 0; lod < mesh.GetLodCount(); ++lod)
+            {
+                const unsigned int instanceCount = meshDraw.myLodInstanceCounts[lod];
+                if (instanceCount == 0)
+                    continue;
+
+                const GeometryAllocation& allocation = mesh.GetGeometryAllocation(lod);
+                if (virtualTexture)
+                {
+                    myVirtualTextureDraws.push_back({ &allocation, virtualTexture, instanceCount, baseInstance });
+                }
+                else if (!myIsInstancingEnabled)
+                {
+                    // One draw per instance, kept as the baseline the benchmark compares instancing against
+                    for (unsigned int instanceIndex = 0; instanceIndex < instanceCount; ++instanceIndex)
+                        myGeometryPool->Draw(allocation, texture, 1, baseInstance + instanceIndex);
+                    myStatistics.myDrawCalls += static_cast<int>(instanceCount);
+                    myStatistics.myDrawCommands += static_cast<int>(instanceCount);
+                }
+                else if (myIsMultiDrawEnabled && myClusterCuller && lod == 0 && allocation.myMeshletCount > 0)
+                {
+                    // Only the full detail level is split into meshlets, the simplified ones are small enough to draw whole
+                    myGeometryPool->AddClusterDraw(allocation, mesh.myBounds, texture, instanceCount, baseInstance);
+                    ++myStatistics.myDrawCommands;
+                }
+                else if (myIsMultiDrawEnabled)
+                {
+                    myGeometryPool->AddDraw(allocation, texture, instanceCount, baseInstance);
+                    ++myStatistics.myDrawCommands;
+                }
+                else
+                {
+                    myGeometryPool->Draw(allocation, texture, instanceCount, baseInstance);
+                    ++myStatistics.myDrawCalls;
+                    ++myStatistics.myDrawCommands;
+                }
+
+                myStatistics.myTriangles += allocation.myIndexCount / 3 * static_cast<std::size_t>(instanceCount);
+                baseInstance += instanceCount;
+            }
+        }
+
+        myStatistics.myClusters = myGeometryPool->GetQueuedClusterCount();
+        myStatistics.myDrawCalls += myGeometryPool->Submit(myOcclusionCuller, myClusterCuller);
+
+        if (!myVirtualTextureDraws.empty())
+            DrawVirtualTextures(false);
+    }
 
-    for (const std::shared_ptr<Model>& model : myModels)
+    if (!myVirtualTextureDraws.empty())
     {
-        for (Mesh& mesh : model->myMeshes)
-            mesh.Draw();
+        PROFILE_SCOPE("VirtualTextureFeedback");
+        const GpuProfiler::ScopedZone gpuZone(*myGpuProfiler, "VirtualTextureFeedback");
+        myVirtualTextureFeedback->Begin();
+        DrawVirtualTextures(true);
+        myVirtualTextureFeedback->End();
     }
 
-    myShader->Use();
-    myShader->SetMat4("model", modelMatrix);
-    myShader->SetMat4("projection", projection);
-    myShader->SetMat4("view", view);
+    myFrameUniformBuffer->EndFrame();
 
-    glfwSwapBuffers(myWindow);
+    const UploadRingStatistics uploadRingStatistics = myUploadRing->EndFrame();
+    myStatistics.myStagedUploadBytes = uploadRingStatistics.myStagedBytes;
+    myStatistics.myDirectUploadBytes = uploadRingStatistics.myDirectBytes;
+    myStatistics.myUploadStalls = uploadRingStatistics.myStallCount;
+
+    if (myOffscreenFramebuffer && !myFrameOutputDirectory.empty())
+    {
+        PROFILE_SCOPE("SaveFrame");
+        char fileName[32];
+        std::snprintf(fileName, sizeof(fileName), "Frame_%05i.png", myFrameIndex);
+        myOffscreenFramebuffer->SaveToFile((std::filesystem::path(myFrameOutputDirectory) / fileName).string());
+    }
+
+    if (!myIsHeadless)
+    {
+        PROFILE_SCOPE("Swap");
+        const GpuProfiler::ScopedZone gpuZone(*myGpuProfiler, "Swap");
+        glfwSwapBuffers(myWindow);
+    }
+
+    myGpuProfiler->EndFrame();
+    ++myFrameIndex;
+
+    InputManager::GetInstance().ClearKeyActionsThisFrame();
     glfwPollEvents();
 }
 
 void RenderMate::Destroy() const
 {
-    for (const std::shared_ptr<Model>& model : myModels)
+    myGpuProfiler->Destroy();
+    myFrameUniformBuffer->Destroy();
+
+    if (myOffscreenFramebuffer)
+        myOffscreenFramebuffer->Destroy();
+
+    myAssetStreamer->Destroy();
+    myGeometryPool->Destroy();
+    myTextureLoader->Destroy();
+
+    if (myVirtualTextureSystem)
     {
-        for (Mesh& mesh : model->myMeshes)
-            mesh.Destroy();
+        myVirtualTextureSystem->Destroy();
+        myVirtualTextureFeedback->Destroy();
     }
 
+    myUploadRing->Destroy();
+
+    if (myOcclusionCuller)
+        myOcclusionCuller->Destroy();
+
+    if (myClusterCuller)
+        myClusterCuller->Destroy();
+
     glfwDestroyWindow(myWindow);
     glfwTerminate();
 }
 
+void RenderMate::SetupInstances(Model& aModel) const
+{
+    // A single instance keeps the model at the origin, more are laid out on a grid that extends away from the camera
+    const int gridSize = static_cast<int>(std::ceil(std::cbrt(static_cast<float>(myInstanceCount))));
+    const float gridScale = gridSize > 1 ? 1.0f / static_cast<float>(gridSize - 1) : 0.0f;
+    const float spacing = 2.5f;
+    const float gridOffset = 0.5f * spacing * static_cast<float>(gridSize - 1);
+
+    aModel.myInstances.resize(myInstanceCount);
+    for (int instanceIndex = 0; instanceIndex < myInstanceCount; ++instanceIndex)
+    {
+        const int x = instanceIndex % gridSize;
+        const int y = instanceIndex / gridSize % gridSize;
+        const int z = instanceIndex / (gridSize * gridSize);
+
+        ModelInstance& instance = aModel.myInstances[instanceIndex];
+        instance.myTransform = glm::translate(glm::vec3(x * spacing - gridOffset, y * spacing - gridOffset, -z * spacing));
+        instance.myColor = glm::vec4(1.0f - 0.5f * x * gridScale, 1.0f - 0.5f * y * gridScale, 1.0f - 0.5f * z * gridScale, 1.0f);
+    }
+}
+
+void RenderMate::BuildDrawList()
+{
+    PROFILE_FUNCTION();
+
+    // Instances never move, so their world bounds are computed once per mesh and instance when models arrive
+    myMeshDraws.clear();
+    myCullingBounds.Clear();
+    myWorldBounds.clear();
+    for (const std::shared_ptr<Model>& model : myModels)
+    {
+        for (const Mesh& mesh : model->myMeshes)
+        {
+            MeshDraw meshDraw;
+            meshDraw.myMesh = &mesh;
+            meshDraw.myModel = model.get();
+            meshDraw.myFirstBounds = myCullingBounds.GetCount();
+            meshDraw.myBaseInstance = 0;
+            meshDraw.myInstanceCount = 0;
+            meshDraw.myLodInstanceCounts.fill(0);
+            myMeshDraws.push_back(meshDraw);
+
+            for (const ModelInstance& instance : model->myInstances)
+            {
+                myWorldBounds.push_back(mesh.myBounds.Transform(instance.myTransform));
+                myCullingBounds.Add(myWorldBounds.back());
+            }
+        }
+    }
+
+    // Every instance starts at full detail and coarsens from there once it is seen
+    myInstanceLods.assign(myWorldBounds.size(), 0);
+
+    // Shares its item indices with myCullingBounds, so an item maps back to a mesh draw the same way
+    myBoundingVolumeHierarchy.Build(myWorldBounds);
+}
+
+unsigned char RenderMate::SelectLod(const Mesh& aMesh, const glm::mat4& aTransform, const BoundingBox& aWorldBounds, unsigned char aCurrentLod, float aPixelsPerUnit) const
+{
+    // The longest axis of the transform bounds how far an object space error can stretch, the bounds of a rotated
+    // instance grow on their own and would overstate it
+    const float scale = std::max({ glm::length(glm::vec3(aTransform[0])), glm::length(glm::vec3(aTransform[1])), glm::length(glm::vec3(aTransform[2])) });
+    const float worldRadius = aWorldBounds.GetBoundingSphereRadius();
+    const float distance = std::max(glm::length(aWorldBounds.GetCenter() - myCamera->GetPosition()) - worldRadius, 0.001f);
+    const float pixelsPerObjectUnit = scale * aPixelsPerUnit / distance;
+
+    // Switching coarser needs the error to fall clearly below the threshold and switching finer needs it to rise clearly above it,
+    // so an instance sitting right at a switch point does not pop back and forth every frame
+    std::size_t lod = aCurrentLod;
+    while (lod + 1 < aMesh.GetLodCount() && aMesh.GetLodError(lod + 1) * pixelsPerObjectUnit < lodPixelError * (1.0f - lodHysteresis))
+        ++lod;
+    while (lod > 0 && aMesh.GetLodError(lod) * pixelsPerObjectUnit > lodPixelError * (1.0f + lodHysteresis))
+        --lod;
+
+    return static_cast<unsigned char>(lod);
+}
+
+void RenderMate::SelectOccluders()
+{
+    PROFILE_FUNCTION();
+
+    // The instances that cover the most of the screen hide the most, estimated from their bounding spheres
+    const glm::vec3& cameraPosition = myCamera->GetPosition();
+    myOccluders.clear();
+    for (const MeshDraw& meshDraw : myMeshDraws)
+    {
+        for (unsigned int instance = meshDraw.myBaseInstance; instance < meshDraw.myBaseInstance + meshDraw.myInstanceCount; ++instance)
+        {
+            const BoundingBox& bounds = myVisibleBounds[instance];
+            const float distance = std::max(glm::length(bounds.GetCenter() - cameraPosition), 0.001f);
+            myOccluders.push_back({ meshDraw.myMesh, instance, bounds.GetBoundingSphereRadius() / distance });
+        }
+    }
+
+    if (myOccluders.size() > maxOccluderCount)
+    {
+        std::nth_element(myOccluders.begin(), myOccluders.begin() + maxOccluderCount, myOccluders.end(), [](const Occluder& aLeft, const Occluder& aRight)
+        {
+            return aLeft.myScreenSize > aRight.myScreenSize;
+        });
+        myOccluders.resize(maxOccluderCount);
+    }
+}
+
+void RenderMate::UpdateVirtualTextures()
+{
+    PROFILE_FUNCTION();
+
+    // Feedback is read back a few frames late, headless frames wait for the previous one so they stream the same tiles every run
+    myRequestedVirtualTiles.clear();
+    myVirtualTextureFeedback->Read(myRequestedVirtualTiles, myIsHeadless);
+
+    myStatistics.myVirtualTileRequests = myRequestedVirtualTiles.size();
+    myStatistics.myVirtualTileLoads = myVirtualTextureSystem->Update(myRequestedVirtualTiles);
+    myStatistics.myPendingVirtualTiles = myVirtualTextureSystem->GetCache().GetPendingCount();
+}
+
+void RenderMate::DrawVirtualTextures(bool anIsFeedback)
+{
+    myVirtualTextureSystem->BeginDraw(anIsFeedback);
+    for (const VirtualTextureDraw& virtualTextureDraw : myVirtualTextureDraws)
+    {
+        myVirtualTextureSystem->SetTexture(*virtualTextureDraw.myTexture, anIsFeedback);
+        myGeometryPool->Draw(*virtualTextureDraw.myAllocation, virtualTextureDraw.myTexture->myPageTable, virtualTextureDraw.myInstanceCount, virtualTextureDraw.myBaseInstance);
+    }
+
+    myStatistics.myDrawCalls += static_cast<int>(myVirtualTextureDraws.size());
+    if (!anIsFeedback)
+        myStatistics.myDrawCommands += static_cast<int>(myVirtualTextureDraws.size());
+}
+
+void RenderMate::PickAtCursor() const
+{
+    PROFILE_FUNCTION();
+
+    int windowWidth;
+    int windowHeight;
+    glfwGetWindowSize(myWindow, &windowWidth, &windowHeight);
+    if (windowWidth <= 0 || windowHeight <= 0)
+        return;
+
+    // Unproject the cursor onto the near and far planes to get a world space ray
+    const InputManager& inputManager = InputManager::GetInstance();
+    const float x = 2.0f * inputManager.GetCursorXPosition() / static_cast<float>(windowWidth) - 1.0f;
+    const float y = 1.0f - 2.0f * inputManager.GetCursorYPosition() / static_cast<float>(windowHeight);
+    const glm::mat4 inverseViewProjection = glm::inverse(myCamera->GetProjectionMatrix() * myCamera->GetViewMatrix());
+    const glm::vec4 nearPoint = inverseViewProjection * glm::vec4(x, y, -1.0f, 1.0f);
+    const glm::vec4 farPoint = inverseViewProjection * glm::vec4(x, y, 1.0f, 1.0f);
+    const glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+    const glm::vec3 direction = glm::vec3(farPoint) / farPoint.w - origin;
+
+    RaycastHit hit;
+    if (!myBoundingVolumeHierarchy.Raycast(origin, direction, 1.0f, hit))
+    {
+        LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Picked nothing");
+        return;
+    }
+
+    const auto meshDraw = std::upper_bound(myMeshDraws.begin(), myMeshDraws.end(), hit.myItem, [](uint32_t anItem, const MeshDraw& aMeshDraw)
+    {
+        return anItem < aMeshDraw.myFirstBounds;
+    }) - 1;
+    const auto model = std::find_if(myModels.begin(), myModels.end(), [&meshDraw](const std::shared_ptr<Model>& aModel)
+    {
+        return aModel.get() == meshDraw->myModel;
+    });
+
+    LogUtility::PrintMessage(LogUtility::LogCategory::Core, "Picked model %zu, mesh %zu, instance %zu",
+        static_cast<std::size_t>(model - myModels.begin()),
+        static_cast<std::size_t>(meshDraw->myMesh - meshDraw->myModel->myMeshes.data()),
+        hit.myItem - meshDraw->myFirstBounds);
+}
+
+void RenderMate::WaitForGpu() const
+{
+    glFinish();
+}
+
+std::size_t RenderMate::GetTotalUploadedBytes() const
+{
+    return myAssetStreamer->GetUploadedBytes();
+}
+
+const TextureDecoder& RenderMate::GetTextureDecoder() const
+{
+    return myAssetStreamer->GetTextureDecoder();
+}
+
+const TexturePool& RenderMate::GetTexturePool() const
+{
+    return myTextureLoader->GetTexturePool();
+}
+
+const UploadRingStatistics& RenderMate::GetUploadRingStatistics() const
+{
+    return myUploadRing->GetTotalStatistics();
+}
+
 bool RenderMate::ShouldClose() const
 {
     return glfwWindowShouldClose(myWindow);
@@ -105,32 +630,49 @@ bool RenderMate::ShouldClose() const
 
 void RenderMate::CreateWindow()
 {
-    glfwSetErrorCallback(GLUtility::GLFWErrorCallback);
-
-    if (glfwInit() == GLFW_FALSE)
+#if defined(GLFW_PLATFORM_NULL)
+    // Without a display, try the null platform first, which creates a surfaceless EGL context on drivers such as Mesa llvmpipe.
+    // The error callback is installed afterwards since this attempt is expected to fail on machines without EGL.
+    if (myIsHeadless && glfwPlatformSupported(GLFW_PLATFORM_NULL))
     {
-        LogUtility::PrintError(LogUtility::LogCategory::GLFW, "Failed to initialize GLFW");
-        glfwTerminate();
-        return;
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+        if (glfwInit() == GLFW_TRUE)
+        {
+            myWindow = CreateGLWindow(false);
+            if (myWindow)
+                LogUtility::PrintMessage(LogUtility::LogCategory::GLFW, "Created a surfaceless context");
+            else
+                glfwTerminate();
+        }
+
+        glfwInitHint(GLFW_PLATFORM, GLFW_ANY_PLATFORM);
     }
+#endif
 
-    glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_API);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+    glfwSetErrorCallback(GLUtility::GLFWErrorCallback);
 
-    myWindow = glfwCreateWindow(screenWidth, screenHeight, "LearnOpenGL", nullptr, nullptr);
     if (!myWindow)
     {
-        LogUtility::PrintError(LogUtility::LogCategory::GLFW, "Failed to create a GLFW window");
-        glfwTerminate();
-        return;
+        if (glfwInit() == GLFW_FALSE)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::GLFW, "Failed to initialize GLFW");
+            glfwTerminate();
+            return;
+        }
+
+        myWindow = CreateGLWindow(!myIsHeadless);
+        if (!myWindow)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::GLFW, "Failed to create a GLFW window");
+            glfwTerminate();
+            return;
+        }
     }
 
     glfwMakeContextCurrent(myWindow);
     glfwSetWindowUserPointer(myWindow, this);
+    glfwGetFramebufferSize(myWindow, nullptr, &myFramebufferHeight);
+    glfwSetFramebufferSizeCallback(myWindow, FrameBufferSizeCallback);
     glfwSetKeyCallback(myWindow, KeyCallback);
     glfwSetInputMode(myWindow, GLFW_STICKY_KEYS, GL_TRUE);
     glfwSetCursorPosCallback(myWindow, CursorCallback);
@@ -145,9 +687,34 @@ void RenderMate::CreateWindow()
     LogUtility::PrintMessage(LogUtility::LogCategory::GLFW, "GLFW %i.%i.%i", major, minor, revision);
 }
 
+GLFWwindow* RenderMate::CreateGLWindow(bool aIsVisible)
+{
+    glfwDefaultWindowHints();
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_API);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, aIsVisible ? GLFW_TRUE : GLFW_FALSE);
+#if defined(GLFW_PLATFORM_NULL)
+    if (glfwGetPlatform() == GLFW_PLATFORM_NULL)
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+#endif
+
+    // Prefer 4.6 but accept 4.5, which is the highest version software rasterizers such as llvmpipe expose
+    for (const int minorVersion : { 6, 5 })
+    {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minorVersion);
+        if (GLFWwindow* window = glfwCreateWindow(screenWidth, screenHeight, "LearnOpenGL", nullptr, nullptr))
+            return window;
+    }
+
+    return nullptr;
+}
+
 void RenderMate::CreateContext()
 {
-    if (gladLoadGL() == 0)
+    if (gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)) == 0)
     {
         LogUtility::PrintError(LogUtility::LogCategory::GLAD, "Failed to initialize GLAD");
         return;
@@ -180,6 +747,11 @@ void RenderMate::CreateContext()
 void RenderMate::FrameBufferSizeCallback(GLFWwindow* aWindow, int aWidth, int aHeight)
 {
     glViewport(0, 0, aWidth, aHeight);
+
+    // A minimized window reports zero, keep the last real height until it is restored
+    RenderMate* renderMate = static_cast<RenderMate*>(glfwGetWindowUserPointer(aWindow));
+    if (renderMate && aHeight > 0)
+        renderMate->myFramebufferHeight = aHeight;
 }
 
 void RenderMate::KeyCallback(GLFWwindow* /*aWindow*/, int aKey, int aScancode, int anAction, int aMode)
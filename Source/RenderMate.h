@@ -1,13 +1,35 @@
 #pragma once
 
+#include "AppDefinitions.h"
+#include "BoundingVolumeHierarchy.h"
+#include "CullingBounds.h"
 #include "Model.h"
+#include "RenderStatistics.h"
 
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <string>
 
-class TextureLoader;
-class ModelLoader;
+class AssetStreamer;
 class Shader;
+class FrameUniformBuffer;
+class GeometryPool;
+class ClusterCuller;
+class OcclusionCuller;
+class OffscreenFramebuffer;
+class TextureDecoder;
+class TextureLoader;
+class TexturePool;
+class UploadRing;
+class VirtualTextureFeedback;
+class VirtualTextureSystem;
 class Camera;
+class GpuProfiler;
+struct AppSettings;
+struct GeometryAllocation;
+struct VirtualTexture;
+struct UploadRingStatistics;
 struct GLFWwindow;
 
 class RenderMate
@@ -16,25 +38,108 @@ public:
 	RenderMate();
 	~RenderMate();
 
-	void Initialize();
-	void Update(float aDeltaTime) const;
+	void Initialize(const AppSettings& someSettings);
+	void Update(float aDeltaTime);
 	void Destroy() const;
 
+	// Blocks until the GPU has finished all submitted work
+	void WaitForGpu() const;
+
 	[[nodiscard]] bool ShouldClose() const;
+	[[nodiscard]] Camera& GetCamera() const { return *myCamera; }
+	[[nodiscard]] const GpuProfiler& GetGpuProfiler() const { return *myGpuProfiler; }
+	[[nodiscard]] const RenderStatistics& GetStatistics() const { return myStatistics; }
+	[[nodiscard]] std::size_t GetTotalUploadedBytes() const;
+	[[nodiscard]] const TextureDecoder& GetTextureDecoder() const;
+	[[nodiscard]] const TexturePool& GetTexturePool() const;
+	// Everything staged since Initialize, including the uploads of a headless flush
+	[[nodiscard]] const UploadRingStatistics& GetUploadRingStatistics() const;
+	// nullptr unless virtual texturing is enabled
+	[[nodiscard]] const VirtualTextureSystem* GetVirtualTextureSystem() const { return myVirtualTextureSystem; }
 
 private:
 	void CreateWindow();
+	static GLFWwindow* CreateGLWindow(bool aIsVisible);
 	static void CreateContext();
+	void SetupInstances(Model& aModel) const;
+	void BuildDrawList();
+	void PickAtCursor() const;
+	[[nodiscard]] unsigned char SelectLod(const Mesh& aMesh, const glm::mat4& aTransform, const BoundingBox& aWorldBounds, unsigned char aCurrentLod, float aPixelsPerUnit) const;
+	void SelectOccluders();
+	void UpdateVirtualTextures();
+	void DrawVirtualTextures(bool anIsFeedback);
 	static void FrameBufferSizeCallback(GLFWwindow* aWindow, int aWidth, int aHeight);
 	static void KeyCallback(GLFWwindow* aWindow, int aKey, int aScancode, int anAction, int aMode);
 	static void CursorCallback(GLFWwindow* aWindow, double aXPosition, double aYPosition);
 	static void ScrollCallback(GLFWwindow* aWindow, double aXOffset, double aYOffset);
 	static void MouseButtonCallback(GLFWwindow* aWindow, int aButton, int anAction, int aModifiers);
 
+	// One per mesh of every model, pointing at the culling bounds of the mesh's first instance.
+	// The visible instances start at myBaseInstance, sorted by level of detail.
+	struct MeshDraw
+	{
+		const Mesh* myMesh;
+		const Model* myModel;
+		std::size_t myFirstBounds;
+		unsigned int myBaseInstance;
+		unsigned int myInstanceCount;
+		std::array<unsigned int, maxLodCount> myLodInstanceCounts;
+	};
+
+	// A visible instance drawn into the occlusion depth buffer, myInstance indexes the packed instance buffer
+	struct Occluder
+	{
+		const Mesh* myMesh;
+		unsigned int myInstance;
+		float myScreenSize;
+	};
+
+	// Drawn after the rest with the virtual texture program, once for color and once more into the feedback target
+	struct VirtualTextureDraw
+	{
+		const GeometryAllocation* myAllocation;
+		const VirtualTexture* myTexture;
+		unsigned int myInstanceCount;
+		unsigned int myBaseInstance;
+	};
+
 	std::vector<std::shared_ptr<Model>> myModels;
+	std::vector<MeshDraw> myMeshDraws;
+	std::vector<ModelInstance> myInstances;
+	std::vector<unsigned char> myVisibility;
+	std::vector<unsigned char> myInstanceLods;
+	std::vector<BoundingBox> myWorldBounds;
+	std::vector<BoundingBox> myVisibleBounds;
+	std::vector<Occluder> myOccluders;
+	std::vector<VirtualTextureDraw> myVirtualTextureDraws;
+	std::vector<uint32_t> myRequestedVirtualTiles;
+	CullingBounds myCullingBounds;
+	BoundingVolumeHierarchy myBoundingVolumeHierarchy;
 	GLFWwindow* myWindow;
 	Camera* myCamera;
 	Shader* myShader;
+	Shader* myDepthShader;
 	TextureLoader* myTextureLoader;
-	ModelLoader* myModelLoader;
+	AssetStreamer* myAssetStreamer;
+	GpuProfiler* myGpuProfiler;
+	FrameUniformBuffer* myFrameUniformBuffer;
+	UploadRing* myUploadRing;
+	GeometryPool* myGeometryPool;
+	OcclusionCuller* myOcclusionCuller;
+	ClusterCuller* myClusterCuller;
+	OffscreenFramebuffer* myOffscreenFramebuffer;
+	VirtualTextureSystem* myVirtualTextureSystem;
+	VirtualTextureFeedback* myVirtualTextureFeedback;
+	RenderStatistics myStatistics;
+	std::string myFrameOutputDirectory;
+	std::size_t myUploadByteBudget;
+	// Kept up to date by FrameBufferSizeCallback, so level of detail selection follows the window
+	int myFramebufferHeight;
+	int myFrameIndex;
+	int myInstanceCount;
+	bool myIsHeadless;
+	bool myIsInstancingEnabled;
+	bool myIsMultiDrawEnabled;
+	bool myIsLodEnabled;
+	bool myWasLeftMouseButtonDown;
 };
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+struct RenderStatistics
+{
+    // API calls, a multi-draw counts once however many commands it carries
+    int myDrawCalls = 0;
+    int myDrawCommands = 0;
+    std::size_t myTriangles = 0;
+    // Mesh instances that passed or failed frustum culling
+    std::size_t myVisibleInstances = 0;
+    std::size_t myCulledInstances = 0;
+    // Instances drawn into the occlusion culling depth buffer, the occlusion results themselves stay on the GPU
+    std::size_t myOccluders = 0;
+    // Meshlets tested by cluster culling, once per instance, the survivors are only known to the GPU
+    std::size_t myClusters = 0;
+    std::size_t myUploadBytes = 0;
+    // How those uploads reached the GPU, through the upload ring or straight from client memory, and how often the ring was full
+    std::size_t myStagedUploadBytes = 0;
+    std::size_t myDirectUploadBytes = 0;
+    std::size_t myUploadStalls = 0;
+    // Distinct tiles the virtual texture feedback asked for, how many of them were loaded and how many are still missing
+    std::size_t myVirtualTileRequests = 0;
+    std::size_t myVirtualTileLoads = 0;
+    std::size_t myPendingVirtualTiles = 0;
+};
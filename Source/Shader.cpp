@@ -5,6 +5,7 @@
 #include <glad/glad.h>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <cstring>
 #include <sstream>
 #include <fstream>
 
@@ -81,6 +82,7 @@ void Shader::Load(const char* aVertexFilepath, const char* aFragmentFilepath, co
 		glAttachShader(myIdentifier, geometry);
 	glLinkProgram(myIdentifier);
 	CheckCompileErrors(myIdentifier, "PROGRAM");
+	ReflectUniforms();
 
 	glDeleteShader(vertexShaderIdentifier);
 	glDeleteShader(fragmentShaderIdentifier);
@@ -88,6 +90,40 @@ void Shader::Load(const char* aVertexFilepath, const char* aFragmentFilepath, co
 		glDeleteShader(geometry);
 }
 
+void Shader::LoadCompute(const char* aComputeFilepath)
+{
+	std::string computeCode;
+	std::ifstream computeShaderFile;
+
+	computeShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+	try
+	{
+		computeShaderFile.open(aComputeFilepath);
+		std::stringstream cShaderStream;
+		cShaderStream << computeShaderFile.rdbuf();
+		computeShaderFile.close();
+		computeCode = cShaderStream.str();
+	}
+	catch (std::ifstream::failure& aException)
+	{
+		LogUtility::PrintError(LogUtility::LogCategory::GL, aException.what());
+	}
+
+	const char* computeShaderCode = computeCode.c_str();
+	const unsigned int computeShaderIdentifier = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(computeShaderIdentifier, 1, &computeShaderCode, nullptr);
+	glCompileShader(computeShaderIdentifier);
+	CheckCompileErrors(computeShaderIdentifier, "COMPUTE");
+
+	myIdentifier = glCreateProgram();
+	glAttachShader(myIdentifier, computeShaderIdentifier);
+	glLinkProgram(myIdentifier);
+	CheckCompileErrors(myIdentifier, "PROGRAM");
+	ReflectUniforms();
+
+	glDeleteShader(computeShaderIdentifier);
+}
+
 void Shader::Use() const
 {
 	glUseProgram(myIdentifier);
@@ -138,6 +174,51 @@ void Shader::SetMat4(const std::string& aName, const glm::mat4& aValue) const
 	glUniformMatrix4fv(GetLocation(aName), 1, GL_FALSE, glm::value_ptr(aValue));
 }
 
+void Shader::Set(UniformHandle<bool> aHandle, bool aValue) const
+{
+	glUniform1i(aHandle.myLocation, static_cast<int>(aValue));
+}
+
+void Shader::Set(UniformHandle<int> aHandle, int aValue) const
+{
+	glUniform1i(aHandle.myLocation, aValue);
+}
+
+void Shader::Set(UniformHandle<float> aHandle, float aValue) const
+{
+	glUniform1f(aHandle.myLocation, aValue);
+}
+
+void Shader::Set(UniformHandle<glm::vec2> aHandle, const glm::vec2& aValue) const
+{
+	glUniform2fv(aHandle.myLocation, 1, glm::value_ptr(aValue));
+}
+
+void Shader::Set(UniformHandle<glm::vec3> aHandle, const glm::vec3& aValue) const
+{
+	glUniform3fv(aHandle.myLocation, 1, glm::value_ptr(aValue));
+}
+
+void Shader::Set(UniformHandle<glm::vec4> aHandle, const glm::vec4& aValue) const
+{
+	glUniform4fv(aHandle.myLocation, 1, glm::value_ptr(aValue));
+}
+
+void Shader::Set(UniformHandle<glm::mat2> aHandle, const glm::mat2& aValue) const
+{
+	glUniformMatrix2fv(aHandle.myLocation, 1, GL_FALSE, glm::value_ptr(aValue));
+}
+
+void Shader::Set(UniformHandle<glm::mat3> aHandle, const glm::mat3& aValue) const
+{
+	glUniformMatrix3fv(aHandle.myLocation, 1, GL_FALSE, glm::value_ptr(aValue));
+}
+
+void Shader::Set(UniformHandle<glm::mat4> aHandle, const glm::mat4& aValue) const
+{
+	glUniformMatrix4fv(aHandle.myLocation, 1, GL_FALSE, glm::value_ptr(aValue));
+}
+
 void Shader::CheckCompileErrors(const unsigned int aShader, const std::string& aType)
 {
 	GLint success;
@@ -162,7 +243,117 @@ void Shader::CheckCompileErrors(const unsigned int aShader, const std::string& a
 	}
 }
 
+void Shader::ReflectUniforms()
+{
+	myUniforms.clear();
+
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(myIdentifier, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(myIdentifier, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	std::vector<GLchar> nameBuffer(static_cast<std::size_t>(maxNameLength) + 1);
+	myUniforms.reserve(uniformCount);
+	for (GLint uniformIndex = 0; uniformIndex < uniformCount; ++uniformIndex)
+	{
+		GLsizei nameLength = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(myIdentifier, static_cast<GLuint>(uniformIndex), static_cast<GLsizei>(nameBuffer.size()), &nameLength, &size, &type, nameBuffer.data());
+
+		// Members of uniform blocks have no location and are set through their buffer instead
+		const GLint location = glGetUniformLocation(myIdentifier, nameBuffer.data());
+		if (location < 0)
+			continue;
+
+		// Arrays are reported as "name[0]", but are looked up by their plain name
+		std::string name(nameBuffer.data(), nameLength);
+		if (size > 1 && name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+			name.resize(name.size() - 3);
+
+		myUniforms.push_back({ std::move(name), location, type, size });
+	}
+}
+
 int Shader::GetLocation(const std::string& aName) const
 {
+	for (const Uniform& uniform : myUniforms)
+	{
+		if (uniform.myName == aName)
+			return uniform.myLocation;
+	}
+
+	// Only the first element of an array is reflected, other elements such as "name[2]" are left to GL
 	return glGetUniformLocation(myIdentifier, aName.c_str());
 }
+
+int Shader::FindUniformLocation(const char* aName, unsigned int aType) const
+{
+	for (const Uniform& uniform : myUniforms)
+	{
+		if (std::strcmp(uniform.myName.c_str(), aName) != 0)
+			continue;
+
+		// Samplers are set through their texture unit index
+		const bool isSampler = uniform.myType == GL_SAMPLER_2D || uniform.myType == GL_SAMPLER_3D || uniform.myType == GL_SAMPLER_CUBE || uniform.myType == GL_SAMPLER_2D_ARRAY || uniform.myType == GL_SAMPLER_2D_SHADOW;
+		const bool isCompatible = uniform.myType == aType || (aType == GL_INT && (isSampler || uniform.myType == GL_BOOL));
+		if (!isCompatible)
+			LogUtility::PrintError(LogUtility::LogCategory::GL, "Uniform %s has type 0x%04X but was requested as 0x%04X", aName, uniform.myType, aType);
+
+		return uniform.myLocation;
+	}
+
+	// Only the first element of an array is reflected, so its other elements are left to GL without a type check
+	const GLint location = glGetUniformLocation(myIdentifier, aName);
+	if (location >= 0)
+		return location;
+
+	// Not an error, the compiler strips uniforms that do not contribute to the output
+	LogUtility::PrintMessage(LogUtility::LogCategory::GL, "Uniform %s is not active in program %u", aName, myIdentifier);
+	return -1;
+}
+
+unsigned int Shader::GetUniformType(const bool*)
+{
+	return GL_BOOL;
+}
+
+unsigned int Shader::GetUniformType(const int*)
+{
+	return GL_INT;
+}
+
+unsigned int Shader::GetUniformType(const float*)
+{
+	return GL_FLOAT;
+}
+
+unsigned int Shader::GetUniformType(const glm::vec2*)
+{
+	return GL_FLOAT_VEC2;
+}
+
+unsigned int Shader::GetUniformType(const glm::vec3*)
+{
+	return GL_FLOAT_VEC3;
+}
+
+unsigned int Shader::GetUniformType(const glm::vec4*)
+{
+	return GL_FLOAT_VEC4;
+}
+
+unsigned int Shader::GetUniformType(const glm::mat2*)
+{
+	return GL_FLOAT_MAT2;
+}
+
+unsigned int Shader::GetUniformType(const glm::mat3*)
+{
+	return GL_FLOAT_MAT3;
+}
+
+unsigned int Shader::GetUniformType(const glm::mat4*)
+{
+	return GL_FLOAT_MAT4;
+}
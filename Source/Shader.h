@@ -3,6 +3,17 @@
 #include <glm/glm.hpp>
 
 #include <string>
+#include <vector>
+
+// A uniform location resolved once after linking. The value type is part of the handle,
+// so a handle can only be passed to the setter that matches the uniform's declared type.
+template <typename T>
+struct UniformHandle
+{
+    [[nodiscard]] bool IsValid() const { return myLocation >= 0; }
+
+    int myLocation = -1;
+};
 
 class Shader
 {
@@ -10,6 +21,7 @@ public:
     Shader();
 
     void Load(const char* aVertexFilepath, const char* aFragmentFilepath, const char* aGeometryFilepath = nullptr);
+    void LoadCompute(const char* aComputeFilepath);
     void Use() const;
 
     void SetBool(const std::string& aName, const bool aValue) const;
@@ -22,9 +34,51 @@ public:
     void SetMat3(const std::string& aName, const glm::mat3& aValue) const;
     void SetMat4(const std::string& aName, const glm::mat4& aValue) const;
 
+    // Resolves a uniform from the reflection data gathered at link time, meant to be called once after Load
+    template <typename T>
+    [[nodiscard]] UniformHandle<T> GetUniform(const char* aName) const
+    {
+        UniformHandle<T> handle;
+        handle.myLocation = FindUniformLocation(aName, GetUniformType(static_cast<const T*>(nullptr)));
+        return handle;
+    }
+
+    // Setters for resolved handles, these do no lookups and no allocations
+    void Set(UniformHandle<bool> aHandle, bool aValue) const;
+    void Set(UniformHandle<int> aHandle, int aValue) const;
+    void Set(UniformHandle<float> aHandle, float aValue) const;
+    void Set(UniformHandle<glm::vec2> aHandle, const glm::vec2& aValue) const;
+    void Set(UniformHandle<glm::vec3> aHandle, const glm::vec3& aValue) const;
+    void Set(UniformHandle<glm::vec4> aHandle, const glm::vec4& aValue) const;
+    void Set(UniformHandle<glm::mat2> aHandle, const glm::mat2& aValue) const;
+    void Set(UniformHandle<glm::mat3> aHandle, const glm::mat3& aValue) const;
+    void Set(UniformHandle<glm::mat4> aHandle, const glm::mat4& aValue) const;
+
     unsigned int myIdentifier;
 
 private:
+    struct Uniform
+    {
+        std::string myName;
+        int myLocation;
+        unsigned int myType;
+        int mySize;
+    };
+
     static void CheckCompileErrors(const unsigned int aShader, const std::string& aType);
+    void ReflectUniforms();
     [[nodiscard]] int GetLocation(const std::string& aName) const;
+    [[nodiscard]] int FindUniformLocation(const char* aName, unsigned int aType) const;
+
+    static unsigned int GetUniformType(const bool*);
+    static unsigned int GetUniformType(const int*);
+    static unsigned int GetUniformType(const float*);
+    static unsigned int GetUniformType(const glm::vec2*);
+    static unsigned int GetUniformType(const glm::vec3*);
+    static unsigned int GetUniformType(const glm::vec4*);
+    static unsigned int GetUniformType(const glm::mat2*);
+    static unsigned int GetUniformType(const glm::mat3*);
+    static unsigned int GetUniformType(const glm::mat4*);
+
+    std::vector<Uniform> myUniforms;
 };
@@ -0,0 +1,209 @@
+#include "TextureCache.h"
+
+#include "CompressedTexture.h"
+#include "FileUtility.h"
+#include "LogUtility.h"
+#include "MemoryMappedFile.h"
+#include "Profiler.h"
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace TextureCache
+{
+    namespace
+    {
+        constexpr char DdsMagic[4] = { 'D', 'D', 'S', ' ' };
+        constexpr char CacheMagic[4] = { 'L', 'O', 'T', 'C' };
+        constexpr uint32_t CacheVersion = 1;
+        // Past what GL implementations allow, and level sizes are stored in 32 bits
+        constexpr uint32_t MaxTextureSize = 32768;
+
+        constexpr uint32_t DdsHeaderFlags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;
+        constexpr uint32_t DdsPixelFormatFourCC = 0x4;
+        constexpr uint32_t DdsCapsTexture = 0x1000;
+        constexpr uint32_t DdsCapsComplex = 0x8;
+        constexpr uint32_t DdsCapsMipmap = 0x400000;
+
+        // The layout of DDS_PIXELFORMAT
+        struct DdsPixelFormat
+        {
+            uint32_t mySize;
+            uint32_t myFlags;
+            char myFourCC[4];
+            uint32_t myRgbBitCount;
+            uint32_t myBitMasks[4];
+        };
+
+        // The words of DDS_HEADER::dwReserved1 this cache uses, which are only 4-byte aligned, so 64-bit values are split in two
+        struct CacheStamp
+        {
+            char myMagic[4];
+            uint32_t myVersion;
+            uint32_t mySourceSize[2];
+            uint32_t mySourceModificationTime[2];
+            uint32_t myUnused[5];
+        };
+
+        // The layout of DDS_HEADER, which follows the magic
+        struct DdsHeader
+        {
+            uint32_t mySize;
+            uint32_t myFlags;
+            uint32_t myHeight;
+            uint32_t myWidth;
+            uint32_t myPitchOrLinearSize;
+            uint32_t myDepth;
+            uint32_t myMipMapCount;
+            CacheStamp myStamp;
+            DdsPixelFormat myPixelFormat;
+            uint32_t myCaps[4];
+            uint32_t myReserved2;
+        };
+
+        static_assert(sizeof(CacheStamp) == 11 * sizeof(uint32_t), "The stamp has to fit dwReserved1");
+        static_assert(sizeof(DdsHeader) == 124, "DdsHeader has to match DDS_HEADER");
+
+        const char* GetFourCC(TextureCompression aCompression)
+        {
+            return aCompression == TextureCompression::Bc3 ? "DXT5" : "DXT1";
+        }
+    }
+
+    std::string GetCachePath(const std::string& aSourceFilepath)
+    {
+        // The extension of the source stays in the name, textures that only differ in it must not share a cache
+        return aSourceFilepath + ".dds";
+    }
+
+    bool Read(const std::string& aSourceFilepath, CompressedTexture& aTexture)
+    {
+        PROFILE_SCOPE("TextureCache::Read");
+
+        uint64_t sourceSize = 0;
+        int64_t sourceModificationTime = 0;
+        if (!FileUtility::GetFileStamp(aSourceFilepath, sourceSize, sourceModificationTime))
+            return false;
+
+        const std::string cachePath = GetCachePath(aSourceFilepath);
+        MemoryMappedFile file;
+        if (!file.Open(cachePath))
+            return false;
+
+        DdsHeader header;
+        if (file.GetSize() < sizeof(DdsMagic) + sizeof(header) || std::memcmp(file.GetData(), DdsMagic, sizeof(DdsMagic)) != 0)
+            return false;
+
+        std::memcpy(&header, file.GetData() + sizeof(DdsMagic), sizeof(header));
+        if (std::memcmp(header.myStamp.myMagic, CacheMagic, sizeof(CacheMagic)) != 0 || header.myStamp.myVersion != CacheVersion)
+        {
+            LogUtility::PrintMessage(LogUtility::LogCategory::File, "Ignoring outdated texture cache %s", cachePath.c_str());
+            return false;
+        }
+
+        uint64_t cachedSourceSize = 0;
+        int64_t cachedSourceModificationTime = 0;
+        std::memcpy(&cachedSourceSize, header.myStamp.mySourceSize, sizeof(cachedSourceSize));
+        std::memcpy(&cachedSourceModificationTime, header.myStamp.mySourceModificationTime, sizeof(cachedSourceModificationTime));
+        if (cachedSourceSize != sourceSize || cachedSourceModificationTime != sourceModificationTime)
+        {
+            LogUtility::PrintMessage(LogUtility::LogCategory::File, "Ignoring stale texture cache %s", cachePath.c_str());
+            return false;
+        }
+
+        CompressedTexture texture;
+        if (std::memcmp(header.myPixelFormat.myFourCC, "DXT1", 4) == 0)
+            texture.myCompression = TextureCompression::Bc1;
+        else if (std::memcmp(header.myPixelFormat.myFourCC, "DXT5", 4) == 0)
+            texture.myCompression = TextureCompression::Bc3;
+        else
+            return false;
+
+        // The counts come from the file, a chain longer than the full one down to 1x1 or larger than the file is corrupt
+        if (header.myWidth == 0 || header.myHeight == 0 || header.myWidth > MaxTextureSize || header.myHeight > MaxTextureSize)
+            return false;
+
+        uint32_t maxMipMapCount = 1;
+        while ((std::max(header.myWidth, header.myHeight) >> maxMipMapCount) > 0)
+            ++maxMipMapCount;
+
+        if (header.myMipMapCount > maxMipMapCount)
+            return false;
+
+        int width = static_cast<int>(header.myWidth);
+        int height = static_cast<int>(header.myHeight);
+        std::size_t offset = 0;
+        const std::size_t dataSize = file.GetSize() - sizeof(DdsMagic) - sizeof(header);
+        for (uint32_t level = 0; level < header.myMipMapCount && offset <= dataSize; ++level)
+        {
+            CompressedTextureLevel textureLevel;
+            textureLevel.myOffset = static_cast<uint32_t>(offset);
+            textureLevel.mySize = static_cast<uint32_t>(TextureCompressor::GetLevelSize(texture.myCompression, width, height));
+            textureLevel.myWidth = width;
+            textureLevel.myHeight = height;
+            texture.myLevels.push_back(textureLevel);
+
+            offset += textureLevel.mySize;
+            width = std::max(width / 2, 1);
+            height = std::max(height / 2, 1);
+        }
+
+        if (texture.myLevels.empty() || offset != dataSize)
+            return false;
+
+        const unsigned char* data = file.GetData() + sizeof(DdsMagic) + sizeof(header);
+        texture.myData.assign(data, data + dataSize);
+        aTexture = std::move(texture);
+        return true;
+    }
+
+    bool Write(const std::string& aSourceFilepath, const CompressedTexture& aTexture)
+    {
+        PROFILE_SCOPE("TextureCache::Write");
+
+        if (aTexture.IsEmpty())
+            return false;
+
+        DdsHeader header = {};
+        header.mySize = sizeof(DdsHeader);
+        header.myFlags = DdsHeaderFlags;
+        header.myWidth = static_cast<uint32_t>(aTexture.myLevels[0].myWidth);
+        header.myHeight = static_cast<uint32_t>(aTexture.myLevels[0].myHeight);
+        header.myPitchOrLinearSize = aTexture.myLevels[0].mySize;
+        header.myMipMapCount = static_cast<uint32_t>(aTexture.myLevels.size());
+        std::memcpy(header.myStamp.myMagic, CacheMagic, sizeof(CacheMagic));
+        header.myStamp.myVersion = CacheVersion;
+        uint64_t sourceSize = 0;
+        int64_t sourceModificationTime = 0;
+        if (!FileUtility::GetFileStamp(aSourceFilepath, sourceSize, sourceModificationTime))
+            return false;
+
+        std::memcpy(header.myStamp.mySourceSize, &sourceSize, sizeof(sourceSize));
+        std::memcpy(header.myStamp.mySourceModificationTime, &sourceModificationTime, sizeof(sourceModificationTime));
+
+        header.myPixelFormat.mySize = sizeof(DdsPixelFormat);
+        header.myPixelFormat.myFlags = DdsPixelFormatFourCC;
+        std::memcpy(header.myPixelFormat.myFourCC, GetFourCC(aTexture.myCompression), 4);
+        header.myCaps[0] = DdsCapsTexture | DdsCapsComplex | DdsCapsMipmap;
+
+        const std::string cachePath = GetCachePath(aSourceFilepath);
+        const bool isWritten = FileUtility::WriteFileAtomically(cachePath, [&](std::ofstream& aStream)
+        {
+            aStream.write(DdsMagic, sizeof(DdsMagic));
+            aStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            aStream.write(reinterpret_cast<const char*>(aTexture.myData.data()), static_cast<std::streamsize>(aTexture.myData.size()));
+        });
+
+        if (!isWritten)
+        {
+            LogUtility::PrintError(LogUtility::LogCategory::File, "Failed to write texture cache %s", cachePath.c_str());
+            return false;
+        }
+
+        LogUtility::PrintMessage(LogUtility::LogCategory::File, "Wrote texture cache %s", cachePath.c_str());
+        return true;
+    }
+}
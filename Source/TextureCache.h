@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+struct CompressedTexture;
+
+// Cooked textures, stored as DDS files with their full mip chain beside the source image so other tools can open them.
+// The size and modification time of the source are kept in the reserved words of the header, a cache is only used while they match.
+namespace TextureCache
+{
+    std::string GetCachePath(const std::string& aSourceFilepath);
+
+    [[nodiscard]] bool Read(const std::string& aSourceFilepath, CompressedTexture& aTexture);
+    bool Write(const std::string& aSourceFilepath, const CompressedTexture& aTexture);
+}
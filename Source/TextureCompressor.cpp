@@ -0,0 +1,374 @@
+#include "TextureCompressor.h"
+
+#include "Profiler.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr int BlockSize = 4;
+    constexpr int BlockTexelCount = BlockSize * BlockSize;
+
+    // RGBA8, whatever the channel count of the source
+    using Texel = std::array<uint8_t, 4>;
+    using Block = std::array<Texel, BlockTexelCount>;
+
+    glm::vec3 GetColor(const Texel& aTexel)
+    {
+        return glm::vec3(static_cast<float>(aTexel[0]), static_cast<float>(aTexel[1]), static_cast<float>(aTexel[2]));
+    }
+
+    uint16_t PackRgb565(const glm::vec3& aColor)
+    {
+        const glm::vec3 clamped = glm::clamp(aColor, glm::vec3(0.0f), glm::vec3(255.0f));
+        const uint16_t red = static_cast<uint16_t>(clamped.x * 31.0f / 255.0f + 0.5f);
+        const uint16_t green = static_cast<uint16_t>(clamped.y * 63.0f / 255.0f + 0.5f);
+        const uint16_t blue = static_cast<uint16_t>(clamped.z * 31.0f / 255.0f + 0.5f);
+        return static_cast<uint16_t>((red << 11) | (green << 5) | blue);
+    }
+
+    // Expands the way decoders do, by replicating the high bits into the low ones
+    glm::vec3 UnpackRgb565(uint16_t aColor)
+    {
+        const int red = (aColor >> 11) & 31;
+        const int green = (aColor >> 5) & 63;
+        const int blue = aColor & 31;
+        return glm::vec3(static_cast<float>((red << 3) | (red >> 2)), static_cast<float>((green << 2) | (green >> 4)), static_cast<float>((blue << 3) | (blue >> 2)));
+    }
+
+    // Index 0 and 1 are the endpoints, 2 and 3 lie a third of the way from each of them in four color mode
+    std::array<glm::vec3, 4> GetPalette(uint16_t aColor0, uint16_t aColor1)
+    {
+        const glm::vec3 color0 = UnpackRgb565(aColor0);
+        const glm::vec3 color1 = UnpackRgb565(aColor1);
+        return { color0, color1, (color0 * 2.0f + color1) / 3.0f, (color0 + color1 * 2.0f) / 3.0f };
+    }
+
+    float SelectIndices(const Block& aBlock, uint16_t aColor0, uint16_t aColor1, std::array<uint8_t, BlockTexelCount>& someIndices)
+    {
+        const std::array<glm::vec3, 4> palette = GetPalette(aColor0, aColor1);
+        float error = 0.0f;
+        for (int texel = 0; texel < BlockTexelCount; ++texel)
+        {
+            const glm::vec3 color = GetColor(aBlock[texel]);
+            float bestDistance = FLT_MAX;
+            for (uint8_t index = 0; index < 4; ++index)
+            {
+                const glm::vec3 difference = color - palette[index];
+                const float distance = glm::dot(difference, difference);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    someIndices[texel] = index;
+                }
+            }
+
+            error += bestDistance;
+        }
+
+        return error;
+    }
+
+    // Solves for the endpoints that minimize the squared error of the current index assignment
+    bool RefineEndpoints(const Block& aBlock, const std::array<uint8_t, BlockTexelCount>& someIndices, glm::vec3& aColor0, glm::vec3& aColor1)
+    {
+        constexpr float Weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+        float alphaAlpha = 0.0f;
+        float alphaBeta = 0.0f;
+        float betaBeta = 0.0f;
+        glm::vec3 alphaColor(0.0f);
+        glm::vec3 betaColor(0.0f);
+        for (int texel = 0; texel < BlockTexelCount; ++texel)
+        {
+            const float alpha = Weights[someIndices[texel]];
+            const float beta = 1.0f - alpha;
+            const glm::vec3 color = GetColor(aBlock[texel]);
+            alphaAlpha += alpha * alpha;
+            alphaBeta += alpha * beta;
+            betaBeta += beta * beta;
+            alphaColor += color * alpha;
+            betaColor += color * beta;
+        }
+
+        const float determinant = alphaAlpha * betaBeta - alphaBeta * alphaBeta;
+        if (std::abs(determinant) < 1.0e-6f)
+            return false;
+
+        aColor0 = (alphaColor * betaBeta - betaColor * alphaBeta) / determinant;
+        aColor1 = (betaColor * alphaAlpha - alphaColor * alphaBeta) / determinant;
+        return true;
+    }
+
+    void WriteColorBlock(uint16_t aColor0, uint16_t aColor1, const std::array<uint8_t, BlockTexelCount>& someIndices, unsigned char* aDestination)
+    {
+        uint32_t indexBits = 0;
+        for (int texel = 0; texel < BlockTexelCount; ++texel)
+            indexBits |= static_cast<uint32_t>(someIndices[texel]) << (texel * 2);
+
+        std::memcpy(aDestination, &aColor0, sizeof(aColor0));
+        std::memcpy(aDestination + 2, &aColor1, sizeof(aColor1));
+        std::memcpy(aDestination + 4, &indexBits, sizeof(indexBits));
+    }
+
+    // Always uses four color mode, which Bc3 requires and which is never worse for opaque Bc1 blocks
+    void EncodeColorBlock(const Block& aBlock, unsigned char* aDestination)
+    {
+        glm::vec3 mean(0.0f);
+        for (const Texel& texel : aBlock)
+            mean += GetColor(texel);
+        mean /= static_cast<float>(BlockTexelCount);
+
+        // Rows of the symmetric covariance matrix
+        glm::vec3 covariance[3] = { glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f) };
+        glm::vec3 minimum(255.0f);
+        glm::vec3 maximum(0.0f);
+        for (const Texel& texel : aBlock)
+        {
+            const glm::vec3 color = GetColor(texel);
+            const glm::vec3 offset = color - mean;
+            for (int row = 0; row < 3; ++row)
+                covariance[row] += offset * offset[row];
+            minimum = glm::min(minimum, color);
+            maximum = glm::max(maximum, color);
+        }
+
+        // A few power iterations from the bounding box diagonal are enough to find the dominant axis of 16 colors
+        glm::vec3 axis = maximum - minimum;
+        for (int iteration = 0; iteration < 4 && glm::dot(axis, axis) > 0.0f; ++iteration)
+        {
+            axis = glm::vec3(glm::dot(covariance[0], axis), glm::dot(covariance[1], axis), glm::dot(covariance[2], axis));
+            const float length = glm::length(axis);
+            if (length <= 0.0f)
+                break;
+            axis /= length;
+        }
+
+        std::array<uint8_t, BlockTexelCount> indices = {};
+        if (glm::dot(axis, axis) <= 0.0f)
+        {
+            const uint16_t color = PackRgb565(mean);
+            WriteColorBlock(color, color, indices, aDestination);
+            return;
+        }
+
+        float minimumProjection = FLT_MAX;
+        float maximumProjection = -FLT_MAX;
+        for (const Texel& texel : aBlock)
+        {
+            const float projection = glm::dot(GetColor(texel) - mean, axis);
+            minimumProjection = std::min(minimumProjection, projection);
+            maximumProjection = std::max(maximumProjection, projection);
+        }
+
+        // Insetting the endpoints by a sixteenth of the range trades the extremes for a better fit of everything between them
+        const float inset = (maximumProjection - minimumProjection) / 16.0f;
+        glm::vec3 endpoint0 = mean + axis * (maximumProjection - inset);
+        glm::vec3 endpoint1 = mean + axis * (minimumProjection + inset);
+
+        uint16_t color0 = PackRgb565(endpoint0);
+        uint16_t color1 = PackRgb565(endpoint1);
+        float error = SelectIndices(aBlock, color0, color1, indices);
+
+        std::array<uint8_t, BlockTexelCount> refinedIndices = {};
+        if (RefineEndpoints(aBlock, indices, endpoint0, endpoint1))
+        {
+            const uint16_t refinedColor0 = PackRgb565(endpoint0);
+            const uint16_t refinedColor1 = PackRgb565(endpoint1);
+            const float refinedError = SelectIndices(aBlock, refinedColor0, refinedColor1, refinedIndices);
+            if (refinedError < error)
+            {
+                color0 = refinedColor0;
+                color1 = refinedColor1;
+                indices = refinedIndices;
+            }
+        }
+
+        // Four color mode is selected by the first endpoint being the larger one, swapping them swaps the meaning of the indices
+        if (color0 < color1)
+        {
+            std::swap(color0, color1);
+            for (uint8_t& index : indices)
+                index ^= 1;
+        }
+        else if (color0 == color1)
+        {
+            indices.fill(0);
+        }
+
+        WriteColorBlock(color0, color1, indices, aDestination);
+    }
+
+    // Eight interpolated alphas between the block minimum and maximum, 3-bit indices packed into the last 6 bytes
+    void EncodeAlphaBlock(const Block& aBlock, unsigned char* aDestination)
+    {
+        uint8_t alpha0 = 0;
+        uint8_t alpha1 = 255;
+        for (const Texel& texel : aBlock)
+        {
+            alpha0 = std::max(alpha0, texel[3]);
+            alpha1 = std::min(alpha1, texel[3]);
+        }
+
+        uint64_t indexBits = 0;
+        if (alpha0 > alpha1)
+        {
+            float palette[8] = { static_cast<float>(alpha0), static_cast<float>(alpha1) };
+            for (int step = 1; step < 7; ++step)
+                palette[step + 1] = (static_cast<float>(7 - step) * alpha0 + static_cast<float>(step) * alpha1) / 7.0f;
+
+            for (int texel = 0; texel < BlockTexelCount; ++texel)
+            {
+                uint64_t bestIndex = 0;
+                float bestDistance = FLT_MAX;
+                for (uint64_t index = 0; index < 8; ++index)
+                {
+                    const float distance = std::abs(static_cast<float>(aBlock[texel][3]) - palette[index]);
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        bestIndex = index;
+                    }
+                }
+
+                indexBits |= bestIndex << (texel * 3);
+            }
+        }
+
+        aDestination[0] = alpha0;
+        aDestination[1] = alpha1;
+        for (int byte = 0; byte < 6; ++byte)
+            aDestination[2 + byte] = static_cast<unsigned char>(indexBits >> (byte * 8));
+    }
+
+    // Texels past the edge of levels smaller than a block repeat the last row and column
+    Block ReadBlock(const std::vector<Texel>& someTexels, int aWidth, int aHeight, int aBlockX, int aBlockY)
+    {
+        Block block;
+        for (int y = 0; y < BlockSize; ++y)
+        {
+            for (int x = 0; x < BlockSize; ++x)
+            {
+                const int texelX = std::min(aBlockX * BlockSize + x, aWidth - 1);
+                const int texelY = std::min(aBlockY * BlockSize + y, aHeight - 1);
+                block[y * BlockSize + x] = someTexels[static_cast<std::size_t>(texelY) * aWidth + texelX];
+            }
+        }
+
+        return block;
+    }
+
+    std::vector<Texel> Downsample(const std::vector<Texel>& someTexels, int aWidth, int aHeight, int aNewWidth, int aNewHeight)
+    {
+        std::vector<Texel> texels(static_cast<std::size_t>(aNewWidth) * aNewHeight);
+        for (int y = 0; y < aNewHeight; ++y)
+        {
+            for (int x = 0; x < aNewWidth; ++x)
+            {
+                const int x0 = std::min(x * 2, aWidth - 1);
+                const int x1 = std::min(x * 2 + 1, aWidth - 1);
+                const int y0 = std::min(y * 2, aHeight - 1);
+                const int y1 = std::min(y * 2 + 1, aHeight - 1);
+                const Texel& texel00 = someTexels[static_cast<std::size_t>(y0) * aWidth + x0];
+                const Texel& texel01 = someTexels[static_cast<std::size_t>(y0) * aWidth + x1];
+                const Texel& texel10 = someTexels[static_cast<std::size_t>(y1) * aWidth + x0];
+                const Texel& texel11 = someTexels[static_cast<std::size_t>(y1) * aWidth + x1];
+                Texel& texel = texels[static_cast<std::size_t>(y) * aNewWidth + x];
+                for (int channel = 0; channel < 4; ++channel)
+                    texel[channel] = static_cast<uint8_t>((texel00[channel] + texel01[channel] + texel10[channel] + texel11[channel] + 2) / 4);
+            }
+        }
+
+        return texels;
+    }
+}
+
+namespace TextureCompressor
+{
+    bool IsSupported(int aChannelCount)
+    {
+        return aChannelCount == 1 || aChannelCount == 3 || aChannelCount == 4;
+    }
+
+    CompressedTexture Compress(const unsigned char* somePixels, int aWidth, int aHeight, int aChannelCount)
+    {
+        PROFILE_SCOPE("TextureCompressor::Compress");
+
+        CompressedTexture texture;
+        if (!somePixels || aWidth <= 0 || aHeight <= 0 || !IsSupported(aChannelCount))
+            return texture;
+
+        std::vector<Texel> texels(static_cast<std::size_t>(aWidth) * aHeight);
+        bool hasAlpha = false;
+        for (std::size_t texel = 0; texel < texels.size(); ++texel)
+        {
+            const unsigned char* pixel = somePixels + texel * aChannelCount;
+            if (aChannelCount == 1)
+                texels[texel] = { pixel[0], 0, 0, 255 };
+            else
+                texels[texel] = { pixel[0], pixel[1], pixel[2], aChannelCount == 4 ? pixel[3] : static_cast<uint8_t>(255) };
+
+            hasAlpha = hasAlpha || texels[texel][3] != 255;
+        }
+
+        texture.myCompression = hasAlpha ? TextureCompression::Bc3 : TextureCompression::Bc1;
+
+        int width = aWidth;
+        int height = aHeight;
+        for (;;)
+        {
+            CompressedTextureLevel level;
+            level.myOffset = static_cast<uint32_t>(texture.myData.size());
+            level.mySize = static_cast<uint32_t>(GetLevelSize(texture.myCompression, width, height));
+            level.myWidth = width;
+            level.myHeight = height;
+            texture.myLevels.push_back(level);
+            texture.myData.resize(texture.myData.size() + level.mySize);
+
+            const int blockColumns = (width + BlockSize - 1) / BlockSize;
+            const int blockRows = (height + BlockSize - 1) / BlockSize;
+            unsigned char* destination = texture.myData.data() + level.myOffset;
+            for (int blockY = 0; blockY < blockRows; ++blockY)
+            {
+                for (int blockX = 0; blockX < blockColumns; ++blockX)
+                {
+                    const Block block = ReadBlock(texels, width, height, blockX, blockY);
+                    if (hasAlpha)
+                    {
+                        EncodeAlphaBlock(block, destination);
+                        destination += 8;
+                    }
+
+                    EncodeColorBlock(block, destination);
+                    destination += 8;
+                }
+            }
+
+            if (width == 1 && height == 1)
+                break;
+
+            const int nextWidth = std::max(width / 2, 1);
+            const int nextHeight = std::max(height / 2, 1);
+            texels = Downsample(texels, width, height, nextWidth, nextHeight);
+            width = nextWidth;
+            height = nextHeight;
+        }
+
+        return texture;
+    }
+
+    std::size_t GetLevelSize(TextureCompression aCompression, int aWidth, int aHeight)
+    {
+        if (aCompression == TextureCompression::None)
+            return 0;
+
+        const std::size_t blockCount = static_cast<std::size_t>((aWidth + BlockSize - 1) / BlockSize) * static_cast<std::size_t>((aHeight + BlockSize - 1) / BlockSize);
+        return blockCount * (aCompression == TextureCompression::Bc3 ? 16 : 8);
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "CompressedTexture.h"
+
+#include <cstddef>
+
+// Block compression of 8-bit textures into BC1 and BC3. Every block is fitted along the principal axis of its colors and then
+// refined once with least squares, which is slower than a bounding box fit but much closer to offline encoders on gradients.
+namespace TextureCompressor
+{
+    // Whether TextureCompressor can encode pixels with this many channels
+    [[nodiscard]] bool IsSupported(int aChannelCount);
+
+    // Builds the mip chain with a box filter and encodes every level. One channel textures keep sampling as red only,
+    // like GL_RED, and four channel textures only pay for alpha with Bc3 when some texel is not opaque.
+    [[nodiscard]] CompressedTexture Compress(const unsigned char* somePixels, int aWidth, int aHeight, int aChannelCount);
+
+    // Size in bytes of one level, every started 4x4 block takes a whole block
+    [[nodiscard]] std::size_t GetLevelSize(TextureCompression aCompression, int aWidth, int aHeight);
+}
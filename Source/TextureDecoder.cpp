@@ -0,0 +1,194 @@
+#include "TextureDecoder.h"
+
+#include "JobSystem.h"
+#include "LogUtility.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <utility>
+
+TextureDecoder::TextureDecoder(const TextureLoader& aTextureLoader, std::size_t aByteBudget)
+    : myTextureLoader(aTextureLoader)
+    , myByteBudget(aByteBudget)
+    , myReservedBytes(0)
+    , myPeakReservedBytes(0)
+    , myJobCount(0)
+{
+}
+
+TextureDecoder::~TextureDecoder()
+{
+    // Jobs still reference this decoder, so wait for them before going away
+    std::unique_lock<std::mutex> lock(myMutex);
+    myCondition.wait(lock, [this]() { return myJobCount == 0; });
+}
+
+void TextureDecoder::Request(const std::string& aFilepath)
+{
+    {
+        const std::lock_guard<std::mutex> lock(myMutex);
+        if (!myRequestedTextures.emplace(aFilepath, 0).second)
+            return;
+
+        ++myJobCount;
+    }
+
+    JobSystem::GetInstance().Schedule([this, aFilepath]() { MeasureTexture(aFilepath); });
+}
+
+void TextureDecoder::TakeDecodedTextures(std::vector<TextureData>& someTextures)
+{
+    const std::lock_guard<std::mutex> lock(myMutex);
+    for (TextureData& textureData : myDecodedTextures)
+        someTextures.emplace_back(std::move(textureData));
+
+    myDecodedTextures.clear();
+}
+
+void TextureDecoder::Release(const std::string& aFilepath)
+{
+    std::vector<WaitingTexture> admittedTextures;
+    {
+        const std::lock_guard<std::mutex> lock(myMutex);
+        const std::unordered_map<std::string, std::size_t>::iterator requestedTexture = myRequestedTextures.find(aFilepath);
+        if (requestedTexture == myRequestedTextures.end())
+            return;
+
+        myReservedBytes -= requestedTexture->second;
+        myRequestedTextures.erase(requestedTexture);
+        AdmitWaitingTextures(admittedTextures);
+    }
+
+    ScheduleDecodes(admittedTextures);
+}
+
+void TextureDecoder::WaitForDecodedTextures()
+{
+    std::unique_lock<std::mutex> lock(myMutex);
+    myCondition.wait(lock, [this]() { return !myDecodedTextures.empty() || myJobCount == 0; });
+}
+
+bool TextureDecoder::IsIdle() const
+{
+    const std::lock_guard<std::mutex> lock(myMutex);
+    return myJobCount == 0 && myWaitingTextures.empty() && myDecodedTextures.empty();
+}
+
+std::size_t TextureDecoder::GetPeakReservedBytes() const
+{
+    const std::lock_guard<std::mutex> lock(myMutex);
+    return myPeakReservedBytes;
+}
+
+std::vector<TextureDecodeStatistics> TextureDecoder::GetStatistics() const
+{
+    const std::lock_guard<std::mutex> lock(myMutex);
+    return myStatistics;
+}
+
+void TextureDecoder::PrintStatistics() const
+{
+    std::vector<TextureDecodeStatistics> statistics = GetStatistics();
+    std::sort(statistics.begin(), statistics.end(), [](const TextureDecodeStatistics& aLeft, const TextureDecodeStatistics& aRight) { return aLeft.myWorkerIndex < aRight.myWorkerIndex; });
+    for (const TextureDecodeStatistics& threadStatistics : statistics)
+    {
+        const std::string threadName = threadStatistics.myWorkerIndex < 0 ? "Calling thread" : "Worker " + std::to_string(threadStatistics.myWorkerIndex);
+        LogUtility::PrintMessage(LogUtility::LogCategory::File, "%s decoded %zu textures, %.2f MB at %.2f MB/s", threadName.c_str(), threadStatistics.myTextureCount,
+            static_cast<double>(threadStatistics.myDecodedBytes) / (1024.0 * 1024.0), threadStatistics.GetMegabytesPerSecond());
+    }
+
+    LogUtility::PrintMessage(LogUtility::LogCategory::File, "Decoded textures peaked at %.2f MB of a %.2f MB budget",
+        static_cast<double>(GetPeakReservedBytes()) / (1024.0 * 1024.0), static_cast<double>(myByteBudget) / (1024.0 * 1024.0));
+}
+
+void TextureDecoder::MeasureTexture(const std::string& aFilepath)
+{
+    const std::size_t size = myTextureLoader.GetDecodedSize(aFilepath);
+
+    bool isReserved = false;
+    {
+        const std::lock_guard<std::mutex> lock(myMutex);
+
+        // Textures are admitted in request order, so a large one cannot be starved by smaller ones behind it
+        if (myWaitingTextures.empty() && CanReserve(size))
+        {
+            myRequestedTextures[aFilepath] = size;
+            myReservedBytes += size;
+            myPeakReservedBytes = std::max(myPeakReservedBytes, myReservedBytes);
+            isReserved = true;
+        }
+        else
+        {
+            myWaitingTextures.push_back({ aFilepath, size });
+        }
+    }
+
+    if (isReserved)
+    {
+        // Already counted as a job, so the decode runs as part of this one
+        DecodeTexture(aFilepath);
+        return;
+    }
+
+    const std::lock_guard<std::mutex> lock(myMutex);
+    --myJobCount;
+    myCondition.notify_all();
+}
+
+void TextureDecoder::DecodeTexture(const std::string& aFilepath)
+{
+    PROFILE_FUNCTION();
+
+    const uint64_t startTime = Profiler::GetTimestamp();
+    TextureData textureData;
+    if (!myTextureLoader.DecodeTexture(aFilepath, textureData))
+    {
+        textureData = TextureData();
+        textureData.myPath = aFilepath;
+    }
+    const uint64_t endTime = Profiler::GetTimestamp();
+
+    const int workerIndex = JobSystem::GetCurrentWorkerIndex();
+    const std::lock_guard<std::mutex> lock(myMutex);
+    std::vector<TextureDecodeStatistics>::iterator threadStatistics = std::find_if(myStatistics.begin(), myStatistics.end(),
+        [workerIndex](const TextureDecodeStatistics& someStatistics) { return someStatistics.myWorkerIndex == workerIndex; });
+    if (threadStatistics == myStatistics.end())
+    {
+        myStatistics.emplace_back();
+        threadStatistics = myStatistics.end() - 1;
+        threadStatistics->myWorkerIndex = workerIndex;
+    }
+
+    ++threadStatistics->myTextureCount;
+    threadStatistics->myDecodedBytes += static_cast<std::size_t>(textureData.myWidth) * textureData.myHeight * textureData.myChannels;
+    threadStatistics->myDecodeNanoseconds += endTime - startTime;
+
+    myDecodedTextures.emplace_back(std::move(textureData));
+    --myJobCount;
+    myCondition.notify_all();
+}
+
+bool TextureDecoder::CanReserve(std::size_t aSize) const
+{
+    return myReservedBytes == 0 || myReservedBytes + aSize <= myByteBudget;
+}
+
+void TextureDecoder::AdmitWaitingTextures(std::vector<WaitingTexture>& someAdmittedTextures)
+{
+    while (!myWaitingTextures.empty() && CanReserve(myWaitingTextures.front().mySize))
+    {
+        WaitingTexture& waitingTexture = myWaitingTextures.front();
+        myRequestedTextures[waitingTexture.myFilepath] = waitingTexture.mySize;
+        myReservedBytes += waitingTexture.mySize;
+        myPeakReservedBytes = std::max(myPeakReservedBytes, myReservedBytes);
+        ++myJobCount;
+        someAdmittedTextures.emplace_back(std::move(waitingTexture));
+        myWaitingTextures.pop_front();
+    }
+}
+
+void TextureDecoder::ScheduleDecodes(const std::vector<WaitingTexture>& someTextures)
+{
+    for (const WaitingTexture& texture : someTextures)
+        JobSystem::GetInstance().Schedule([this, texture]() { DecodeTexture(texture.myFilepath); });
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "TextureLoader.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct TextureDecodeStatistics
+{
+    [[nodiscard]] double GetMegabytesPerSecond() const { return myDecodeNanoseconds > 0 ? static_cast<double>(myDecodedBytes) / static_cast<double>(myDecodeNanoseconds) * 1.0e9 / (1024.0 * 1024.0) : 0.0; }
+
+    // Worker of the job system that did the decoding, -1 for threads outside of it
+    int myWorkerIndex = -1;
+    std::size_t myTextureCount = 0;
+    std::size_t myDecodedBytes = 0;
+    uint64_t myDecodeNanoseconds = 0;
+};
+
+// Decodes textures on the job system for a single consumer on the thread owning the GL context. Every request first reads
+// the image header to learn its decoded size, and only starts decoding while the bytes of all textures that are decoding
+// or waiting to be released stay under the budget. A single texture larger than the budget still decodes on its own.
+class TextureDecoder
+{
+public:
+    TextureDecoder(const TextureLoader& aTextureLoader, std::size_t aByteBudget);
+    ~TextureDecoder();
+
+    TextureDecoder(const TextureDecoder&) = delete;
+    TextureDecoder& operator=(const TextureDecoder&) = delete;
+
+    // Safe to call from any thread. A path that is still queued, decoding or unreleased is not decoded a second time.
+    void Request(const std::string& aFilepath);
+
+    // Appends every texture decoded since the last call. Textures that failed to decode arrive without data, so the
+    // caller knows to stop waiting for them. Their bytes keep counting against the budget until Release is called.
+    void TakeDecodedTextures(std::vector<TextureData>& someTextures);
+    void Release(const std::string& aFilepath);
+
+    // Blocks until there are decoded textures to take or nothing is left to decode
+    void WaitForDecodedTextures();
+
+    [[nodiscard]] bool IsIdle() const;
+    [[nodiscard]] std::size_t GetPeakReservedBytes() const;
+    [[nodiscard]] std::vector<TextureDecodeStatistics> GetStatistics() const;
+    void PrintStatistics() const;
+
+private:
+    struct WaitingTexture
+    {
+        std::string myFilepath;
+        std::size_t mySize;
+    };
+
+    void MeasureTexture(const std::string& aFilepath);
+    void DecodeTexture(const std::string& aFilepath);
+    [[nodiscard]] bool CanReserve(std::size_t aSize) const;
+    // Moves waiting textures that fit the budget into someAdmittedTextures, must be called with the mutex held
+    void AdmitWaitingTextures(std::vector<WaitingTexture>& someAdmittedTextures);
+    void ScheduleDecodes(const std::vector<WaitingTexture>& someTextures);
+
+    const TextureLoader& myTextureLoader;
+    // Reserved bytes of every requested path that has not been released yet
+    std::unordered_map<std::string, std::size_t> myRequestedTextures;
+    std::deque<WaitingTexture> myWaitingTextures;
+    std::vector<TextureData> myDecodedTextures;
+    std::vector<TextureDecodeStatistics> myStatistics;
+    mutable std::mutex myMutex;
+    std::condition_variable myCondition;
+    std::size_t myByteBudget;
+    std::size_t myReservedBytes;
+    std::size_t myPeakReservedBytes;
+    int myJobCount;
+};
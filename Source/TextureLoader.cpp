@@ -1,77 +1,288 @@
 #include "TextureLoader.h"
 
 #include "LogUtility.h"
+#include "Profiler.h"
+#include "TextureCache.h"
+#include "TextureCompressor.h"
+#include "UploadRing.h"
+#include "VirtualTexturePageFile.h"
+#include "VirtualTextureSystem.h"
 
 #include <glad/glad.h>
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
-unsigned int TextureLoader::LoadTexture(const std::string& aFilepath)
+#include <utility>
+#include <vector>
+
+namespace
 {
-    const std::size_t hash = std::hash<std::string>{}(aFilepath);
+    // What the driver most likely keeps, uncompressed RGB is padded to RGBA and the mip chain adds a third
+    std::size_t GetResidentSize(const TextureData& aTextureData)
+    {
+        if (!aTextureData.myCompressedTexture.IsEmpty())
+            return aTextureData.myCompressedTexture.myData.size();
 
-   for (const std::pair<std::size_t, unsigned int> loadedTexture : myLoadedTextures)
-   {
-       if (loadedTexture.first == hash)
-       {
-           return loadedTexture.second;
-       }
-   }
+        const std::size_t texelSize = aTextureData.myChannels == 3 ? 4 : static_cast<std::size_t>(aTextureData.myChannels);
+        return static_cast<std::size_t>(aTextureData.myWidth) * aTextureData.myHeight * texelSize * 4 / 3;
+    }
+}
 
-    unsigned int textureIdentifier = 0;
+TextureData::TextureData()
+    : myPixels(nullptr)
+    , myWidth(0)
+    , myHeight(0)
+    , myChannels(0)
+    , myIsVirtual(false)
+{
+}
+
+TextureData::~TextureData()
+{
+    stbi_image_free(myPixels);
+}
+
+TextureData::TextureData(TextureData&& anOther) noexcept
+    : myPath(std::move(anOther.myPath))
+    , myCompressedTexture(std::move(anOther.myCompressedTexture))
+    , myPixels(std::exchange(anOther.myPixels, nullptr))
+    , myWidth(anOther.myWidth)
+    , myHeight(anOther.myHeight)
+    , myChannels(anOther.myChannels)
+    , myIsVirtual(anOther.myIsVirtual)
+{
+}
+
+TextureData& TextureData::operator=(TextureData&& anOther) noexcept
+{
+    if (this != &anOther)
+    {
+        stbi_image_free(myPixels);
+        myPath = std::move(anOther.myPath);
+        myCompressedTexture = std::move(anOther.myCompressedTexture);
+        myPixels = std::exchange(anOther.myPixels, nullptr);
+        myWidth = anOther.myWidth;
+        myHeight = anOther.myHeight;
+        myChannels = anOther.myChannels;
+        myIsVirtual = anOther.myIsVirtual;
+    }
+
+    return *this;
+}
+
+TextureLoader::TextureLoader(UploadRing& anUploadRing, VirtualTextureSystem* aVirtualTextureSystem, bool anIsCompressionEnabled, std::size_t aByteBudget)
+    : myTexturePool(aByteBudget)
+    , myUploadRing(anUploadRing)
+    , myVirtualTextureSystem(aVirtualTextureSystem)
+    , myIsCompressionEnabled(anIsCompressionEnabled && GLAD_GL_EXT_texture_compression_s3tc)
+{
+}
+
+void TextureLoader::Destroy()
+{
+    std::vector<unsigned int> textureIdentifiers;
+    myTexturePool.Clear(textureIdentifiers);
+    DeleteTextures(textureIdentifiers);
+}
+
+std::size_t TextureLoader::GetDecodedSize(const std::string& aFilepath) const
+{
     int width = 0;
     int height = 0;
     int channels = 0;
-    unsigned char* data = stbi_load(aFilepath.c_str(), &width, &height, &channels, 0);
-    if (!data)
+    if (!stbi_info(aFilepath.c_str(), &width, &height, &channels))
+        return 0;
+
+    // Also reserved when the page file is already cooked, checking it here is not worth it since that decode returns right away
+    std::size_t size = static_cast<std::size_t>(width) * height * channels;
+    if (myVirtualTextureSystem && VirtualTextureSystem::IsVirtualSize(width, height))
+        size += VirtualTexturePageFile::GetWriteWorkingSize(width, height);
+
+    return size;
+}
+
+bool TextureLoader::DecodeTexture(const std::string& aFilepath, TextureData& aTextureData) const
+{
+    PROFILE_FUNCTION();
+
+    aTextureData.myPath = aFilepath;
+    if (myVirtualTextureSystem && stbi_info(aFilepath.c_str(), &aTextureData.myWidth, &aTextureData.myHeight, &aTextureData.myChannels)
+        && VirtualTextureSystem::IsVirtualSize(aTextureData.myWidth, aTextureData.myHeight))
+    {
+        // Only the header is checked here, the render thread maps the page file again when it adds the texture
+        VirtualTexturePageFile pageFile;
+        aTextureData.myIsVirtual = pageFile.Open(aFilepath);
+        if (!aTextureData.myIsVirtual)
+        {
+            unsigned char* pixels = stbi_load(aFilepath.c_str(), &aTextureData.myWidth, &aTextureData.myHeight, &aTextureData.myChannels, 0);
+            aTextureData.myIsVirtual = VirtualTexturePageFile::Write(aFilepath, pixels, aTextureData.myWidth, aTextureData.myHeight, aTextureData.myChannels);
+            stbi_image_free(pixels);
+        }
+
+        if (aTextureData.myIsVirtual)
+            return true;
+
+        LogUtility::PrintError(LogUtility::LogCategory::File, "Failed to cook %s into a virtual texture, loading it whole", aFilepath.c_str());
+    }
+
+    if (myIsCompressionEnabled && TextureCache::Read(aFilepath, aTextureData.myCompressedTexture))
+    {
+        aTextureData.myWidth = aTextureData.myCompressedTexture.myLevels[0].myWidth;
+        aTextureData.myHeight = aTextureData.myCompressedTexture.myLevels[0].myHeight;
+        aTextureData.myChannels = aTextureData.myCompressedTexture.myCompression == TextureCompression::Bc3 ? 4 : 3;
+        return true;
+    }
+
+    aTextureData.myPixels = stbi_load(aFilepath.c_str(), &aTextureData.myWidth, &aTextureData.myHeight, &aTextureData.myChannels, 0);
+    if (!aTextureData.myPixels)
     {
         LogUtility::PrintError(LogUtility::LogCategory::File, "Texture failed to load at path: %s", aFilepath.c_str());
-        stbi_image_free(data);
+        return false;
+    }
 
-        return textureIdentifier;
+    if (myIsCompressionEnabled && TextureCompressor::IsSupported(aTextureData.myChannels))
+    {
+        aTextureData.myCompressedTexture = TextureCompressor::Compress(aTextureData.myPixels, aTextureData.myWidth, aTextureData.myHeight, aTextureData.myChannels);
+        TextureCache::Write(aFilepath, aTextureData.myCompressedTexture);
+        stbi_image_free(aTextureData.myPixels);
+        aTextureData.myPixels = nullptr;
     }
 
-    GLenum format = GL_RED;
-    switch (channels)
+    return true;
+}
+
+unsigned int TextureLoader::UploadTexture(const TextureData& aTextureData)
+{
+    PROFILE_FUNCTION();
+
+    const std::string normalizedPath = TexturePool::NormalizePath(aTextureData.myPath);
+    if (const unsigned int loadedTexture = myTexturePool.Acquire(normalizedPath))
+        return loadedTexture;
+
+    if (aTextureData.myIsVirtual)
     {
-        case 1:
-        {
-            format = GL_RED;
-            break;
-        }
-        case 3:
-        {
-            format = GL_RGB;
-            break;
-        }
-        case 4:
-        {
-            format = GL_RGBA;
-            break;
-        }
-        default:
-        {
-            LogUtility::PrintError(LogUtility::LogCategory::File, "Failed to map the right number of channels: %i", channels);
-            break;
-        }
+        const unsigned int pageTable = myVirtualTextureSystem->AddTexture(aTextureData.myPath);
+        if (pageTable == 0)
+            return 0;
+
+        const unsigned int pooledPageTable = myTexturePool.Add(normalizedPath, pageTable, myVirtualTextureSystem->FindTexture(pageTable)->myPageTableBytes);
+        if (pooledPageTable != pageTable)
+            DeleteTextures({ pageTable });
+
+        EvictTextures();
+        return pooledPageTable;
     }
 
+    const CompressedTexture& compressedTexture = aTextureData.myCompressedTexture;
+    if (!aTextureData.myPixels && compressedTexture.IsEmpty())
+        return 0;
+
+    unsigned int textureIdentifier = 0;
+    glGenTextures(1, &textureIdentifier);
+    glBindTexture(GL_TEXTURE_2D, textureIdentifier);
+
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    glGenTextures(1, &textureIdentifier);
-    glBindTexture(GL_TEXTURE_2D, textureIdentifier);
-    glTexImage2D(GL_TEXTURE_2D, 0, static_cast<int>(format), width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    // Once staged, the texels are read from the unpack buffer and the data pointers below become offsets into it
+    const unsigned char* textureData = myUploadRing.StagePixels(compressedTexture.IsEmpty() ? aTextureData.myPixels : compressedTexture.myData.data(), aTextureData.GetSize());
+
+    if (!compressedTexture.IsEmpty())
+    {
+        // The mip chain was cooked along with the texture, so there is nothing left to generate
+        const GLenum internalFormat = compressedTexture.myCompression == TextureCompression::Bc3 ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(compressedTexture.myLevels.size()) - 1);
+        for (std::size_t level = 0; level < compressedTexture.myLevels.size(); ++level)
+        {
+            const CompressedTextureLevel& textureLevel = compressedTexture.myLevels[level];
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), internalFormat, textureLevel.myWidth, textureLevel.myHeight, 0,
+                static_cast<GLsizei>(textureLevel.mySize), textureData + textureLevel.myOffset);
+        }
+    }
+    else
+    {
+        GLenum format = GL_RED;
+        switch (aTextureData.myChannels)
+        {
+            case 1:
+            {
+                format = GL_RED;
+                break;
+            }
+            case 3:
+            {
+                format = GL_RGB;
+                break;
+            }
+            case 4:
+            {
+                format = GL_RGBA;
+                break;
+            }
+            default:
+            {
+                LogUtility::PrintError(LogUtility::LogCategory::File, "Failed to map the right number of channels: %i", aTextureData.myChannels);
+                break;
+            }
+        }
+
+        glTexImage2D(GL_TEXTURE_2D, 0, static_cast<int>(format), aTextureData.myWidth, aTextureData.myHeight, 0, format, GL_UNSIGNED_BYTE, textureData);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    stbi_image_free(data);
+    const unsigned int pooledTextureIdentifier = myTexturePool.Add(normalizedPath, textureIdentifier, GetResidentSize(aTextureData));
+    if (pooledTextureIdentifier != textureIdentifier)
+    {
+        DeleteTextures({ textureIdentifier });
+        return pooledTextureIdentifier;
+    }
 
-    myLoadedTextures.emplace(hash, textureIdentifier);
+    EvictTextures();
 
-    LogUtility::PrintMessage(LogUtility::LogCategory::File, "Loaded %s with identifier %i, format %i, width %i and height %i", aFilepath.c_str(), textureIdentifier, channels, width, height);
+    LogUtility::PrintMessage(LogUtility::LogCategory::File, "Loaded %s with identifier %i, format %i, width %i and height %i%s", aTextureData.myPath.c_str(), textureIdentifier, aTextureData.myChannels,
+        aTextureData.myWidth, aTextureData.myHeight, compressedTexture.IsEmpty() ? "" : (compressedTexture.myCompression == TextureCompression::Bc3 ? ", compressed to BC3" : ", compressed to BC1"));
 
     return textureIdentifier;
 }
+
+unsigned int TextureLoader::AcquireTexture(const std::string& aFilepath)
+{
+    return myTexturePool.Acquire(TexturePool::NormalizePath(aFilepath));
+}
+
+void TextureLoader::AddTextureReference(unsigned int anIdentifier)
+{
+    myTexturePool.AddReference(anIdentifier);
+}
+
+void TextureLoader::ReleaseTexture(unsigned int anIdentifier)
+{
+    myTexturePool.Release(anIdentifier);
+    EvictTextures();
+}
+
+void TextureLoader::EvictTextures()
+{
+    std::vector<unsigned int> evictedIdentifiers;
+    myTexturePool.Evict(evictedIdentifiers);
+    if (evictedIdentifiers.empty())
+        return;
+
+    DeleteTextures(evictedIdentifiers);
+    LogUtility::PrintMessage(LogUtility::LogCategory::File, "Evicted %zu textures, %.2f of %.2f MB resident", evictedIdentifiers.size(),
+        static_cast<double>(myTexturePool.GetResidentBytes()) / (1024.0 * 1024.0), static_cast<double>(myTexturePool.GetByteBudget()) / (1024.0 * 1024.0));
+}
+
+void TextureLoader::DeleteTextures(const std::vector<unsigned int>& someIdentifiers) const
+{
+    for (const unsigned int identifier : someIdentifiers)
+    {
+        if (!myVirtualTextureSystem || !myVirtualTextureSystem->RemoveTexture(identifier))
+            glDeleteTextures(1, &identifier);
+    }
+}
@@ -1,13 +1,73 @@
 #pragma once
 
+#include "CompressedTexture.h"
+#include "TexturePool.h"
+
 #include <string>
-#include <map>
+#include <vector>
+
+class UploadRing;
+class VirtualTextureSystem;
+
+// Decoded pixels or cooked blocks of a texture that still have to be uploaded on the render thread
+struct TextureData
+{
+	TextureData();
+	~TextureData();
+	TextureData(TextureData&& anOther) noexcept;
+	TextureData& operator=(TextureData&& anOther) noexcept;
+	TextureData(const TextureData&) = delete;
+	TextureData& operator=(const TextureData&) = delete;
+
+	[[nodiscard]] std::size_t GetSize() const { return myPixels ? static_cast<std::size_t>(myWidth) * myHeight * myChannels : myCompressedTexture.myData.size(); }
 
+	std::string myPath;
+	// Only one of the two is set, the pixels are released once they have been compressed
+	CompressedTexture myCompressedTexture;
+	unsigned char* myPixels;
+	int myWidth;
+	int myHeight;
+	int myChannels;
+	// Set instead of either when the texture was cooked into a virtual texture page file, see VirtualTextureSystem
+	bool myIsVirtual;
+};
+
+// With compression enabled, textures are cooked into BC1 or BC3 with a full mip chain the first time they are decoded and
+// read back from the TextureCache afterwards, which skips both the image decode and the mip generation on the GPU.
+// Uploaded textures are shared through a TexturePool, every identifier handed out carries a reference that has to be released.
+// Texels are staged through the UploadRing and read from it as the pixel unpack buffer.
+// With a VirtualTextureSystem, textures it takes as virtual are cooked into page files instead and their identifier is a page table.
 class TextureLoader
 {
 public:
-	unsigned int LoadTexture(const std::string& aFilepath);
+	// Must be constructed after the GL context, compression is turned off when the context has no S3TC support
+	TextureLoader(UploadRing& anUploadRing, VirtualTextureSystem* aVirtualTextureSystem, bool anIsCompressionEnabled, std::size_t aByteBudget);
+
+	// Deletes every texture, must be called while the GL context still exists
+	void Destroy();
+
+	// Safe to call from any thread. Reads only the image header and returns 0 when it cannot be read.
+	// Includes the working memory of cooking the image into a virtual texture when it is large enough to become one.
+	[[nodiscard]] std::size_t GetDecodedSize(const std::string& aFilepath) const;
+	// Safe to call from any thread
+	[[nodiscard]] bool DecodeTexture(const std::string& aFilepath, TextureData& aTextureData) const;
+	// The rest must be called on the thread owning the GL context
+	unsigned int UploadTexture(const TextureData& aTextureData);
+	// Returns the texture with a new reference when it is resident, otherwise 0
+	[[nodiscard]] unsigned int AcquireTexture(const std::string& aFilepath);
+	void AddTextureReference(unsigned int anIdentifier);
+	void ReleaseTexture(unsigned int anIdentifier);
+
+	[[nodiscard]] bool IsCompressionEnabled() const { return myIsCompressionEnabled; }
+	[[nodiscard]] const TexturePool& GetTexturePool() const { return myTexturePool; }
 
 private:
-	std::map<std::size_t, unsigned int> myLoadedTextures;
+	void EvictTextures();
+	// Removes virtual textures from the VirtualTextureSystem and deletes the rest
+	void DeleteTextures(const std::vector<unsigned int>& someIdentifiers) const;
+
+	TexturePool myTexturePool;
+	UploadRing& myUploadRing;
+	VirtualTextureSystem* myVirtualTextureSystem;
+	bool myIsCompressionEnabled;
 };
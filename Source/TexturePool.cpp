@@ -0,0 +1,92 @@
+#include "TexturePool.h"
+
+#include <filesystem>
+#include <system_error>
+
+TexturePool::TexturePool(std::size_t aByteBudget)
+    : myByteBudget(aByteBudget)
+    , myResidentBytes(0)
+    , myEvictedCount(0)
+{
+}
+
+std::string TexturePool::NormalizePath(const std::string& aFilepath)
+{
+    std::error_code errorCode;
+    const std::filesystem::path absolutePath = std::filesystem::absolute(aFilepath, errorCode);
+    return (errorCode ? std::filesystem::path(aFilepath) : absolutePath).lexically_normal().generic_string();
+}
+
+unsigned int TexturePool::Acquire(const std::string& aNormalizedPath)
+{
+    const std::unordered_map<std::string, unsigned int>::const_iterator identifier = myIdentifiers.find(aNormalizedPath);
+    if (identifier == myIdentifiers.end())
+        return 0;
+
+    AddReference(identifier->second);
+    return identifier->second;
+}
+
+unsigned int TexturePool::Add(const std::string& aNormalizedPath, unsigned int anIdentifier, std::size_t aSize)
+{
+    if (anIdentifier == 0)
+        return 0;
+
+    const std::pair<std::unordered_map<std::string, unsigned int>::iterator, bool> identifier = myIdentifiers.emplace(aNormalizedPath, anIdentifier);
+    if (!identifier.second)
+    {
+        AddReference(identifier.first->second);
+        return identifier.first->second;
+    }
+
+    myTextures.emplace(anIdentifier, ResidentTexture{ aNormalizedPath, aSize, 1, myUnreferencedTextures.end() });
+    myResidentBytes += aSize;
+    return anIdentifier;
+}
+
+void TexturePool::AddReference(unsigned int anIdentifier)
+{
+    const std::unordered_map<unsigned int, ResidentTexture>::iterator texture = myTextures.find(anIdentifier);
+    if (texture == myTextures.end())
+        return;
+
+    if (texture->second.myReferenceCount++ == 0)
+        myUnreferencedTextures.erase(texture->second.myUnreferencedPosition);
+}
+
+void TexturePool::Release(unsigned int anIdentifier)
+{
+    const std::unordered_map<unsigned int, ResidentTexture>::iterator texture = myTextures.find(anIdentifier);
+    if (texture == myTextures.end() || texture->second.myReferenceCount == 0)
+        return;
+
+    if (--texture->second.myReferenceCount == 0)
+        texture->second.myUnreferencedPosition = myUnreferencedTextures.insert(myUnreferencedTextures.end(), anIdentifier);
+}
+
+void TexturePool::Evict(std::vector<unsigned int>& someEvictedIdentifiers)
+{
+    while (myResidentBytes > myByteBudget && !myUnreferencedTextures.empty())
+    {
+        const unsigned int identifier = myUnreferencedTextures.front();
+        myUnreferencedTextures.pop_front();
+
+        const std::unordered_map<unsigned int, ResidentTexture>::iterator texture = myTextures.find(identifier);
+        myResidentBytes -= texture->second.mySize;
+        myIdentifiers.erase(texture->second.myPath);
+        myTextures.erase(texture);
+        someEvictedIdentifiers.push_back(identifier);
+        ++myEvictedCount;
+    }
+}
+
+void TexturePool::Clear(std::vector<unsigned int>& someIdentifiers)
+{
+    for (const std::pair<const unsigned int, ResidentTexture>& texture : myTextures)
+        someIdentifiers.push_back(texture.first);
+
+    myTextures.clear();
+    myIdentifiers.clear();
+    myUnreferencedTextures.clear();
+    myResidentBytes = 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Book-keeping of the textures resident on the GPU, keyed on their normalized path. Every user of a texture holds a reference,
+// and textures that lost their last reference stay resident for reuse until the pool runs over its budget, at which point the
+// least recently released ones are evicted first. The pool never touches GL itself, evicted identifiers are returned for deletion.
+class TexturePool
+{
+public:
+    explicit TexturePool(std::size_t aByteBudget);
+
+    // Absolute and lexically normal with forward slashes, so different spellings of one file share a texture
+    [[nodiscard]] static std::string NormalizePath(const std::string& aFilepath);
+
+    // Returns the texture with a new reference when aNormalizedPath is resident, otherwise 0
+    [[nodiscard]] unsigned int Acquire(const std::string& aNormalizedPath);
+    // Registers a texture that was just created, with one reference for the caller, and returns its identifier. When
+    // aNormalizedPath is already resident the existing texture is acquired and returned instead, and the caller deletes its own.
+    unsigned int Add(const std::string& aNormalizedPath, unsigned int anIdentifier, std::size_t aSize);
+    void AddReference(unsigned int anIdentifier);
+    void Release(unsigned int anIdentifier);
+
+    // Removes unreferenced textures, least recently released first, until the pool fits its budget again
+    void Evict(std::vector<unsigned int>& someEvictedIdentifiers);
+    // Forgets every texture regardless of references, for when the GL context goes away
+    void Clear(std::vector<unsigned int>& someIdentifiers);
+
+    [[nodiscard]] std::size_t GetByteBudget() const { return myByteBudget; }
+    [[nodiscard]] std::size_t GetResidentBytes() const { return myResidentBytes; }
+    [[nodiscard]] std::size_t GetTextureCount() const { return myTextures.size(); }
+    [[nodiscard]] std::size_t GetUnreferencedCount() const { return myUnreferencedTextures.size(); }
+    [[nodiscard]] std::size_t GetEvictedCount() const { return myEvictedCount; }
+
+private:
+    struct ResidentTexture
+    {
+        std::string myPath;
+        std::size_t mySize;
+        int myReferenceCount;
+        // Only valid while myReferenceCount is 0
+        std::list<unsigned int>::iterator myUnreferencedPosition;
+    };
+
+    std::unordered_map<unsigned int, ResidentTexture> myTextures;
+    std::unordered_map<std::string, unsigned int> myIdentifiers;
+    // Least recently released at the front
+    std::list<unsigned int> myUnreferencedTextures;
+    std::size_t myByteBudget;
+    std::size_t myResidentBytes;
+    std::size_t myEvictedCount;
+};
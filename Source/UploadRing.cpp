@@ -0,0 +1,217 @@
+#include "UploadRing.h"
+
+#include "LogUtility.h"
+#include "Profiler.h"
+
+#include <glad/glad.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+UploadRing::UploadRing()
+    : myMappedData(nullptr)
+    , myCapacity(0)
+    , myHead(0)
+    , myTail(0)
+    , myUsedBytes(0)
+    , myUnfencedBytes(0)
+    , myBuffer(0)
+{
+}
+
+void UploadRing::Initialize(std::size_t aCapacity)
+{
+    // Buffer storage is core since OpenGL 4.4 and RenderMate only creates 4.5 and 4.6 contexts
+    assert(GLAD_GL_VERSION_4_4);
+    if (aCapacity == 0)
+    {
+        LogUtility::PrintMessage(LogUtility::LogCategory::GL, "Uploading without a staging ring");
+        return;
+    }
+
+    myCapacity = aCapacity;
+    glGenBuffers(1, &myBuffer);
+    glBindBuffer(GL_COPY_READ_BUFFER, myBuffer);
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_COPY_READ_BUFFER, static_cast<GLsizeiptr>(myCapacity), nullptr, flags);
+    myMappedData = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(myCapacity), flags));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    if (!myMappedData)
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::GL, "Failed to map the upload ring");
+        glDeleteBuffers(1, &myBuffer);
+        myBuffer = 0;
+        myCapacity = 0;
+    }
+}
+
+void UploadRing::Destroy()
+{
+    for (FencedRange& fencedRange : myFencedRanges)
+        glDeleteSync(fencedRange.myFence);
+    myFencedRanges.clear();
+
+    if (myMappedData)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, myBuffer);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        myMappedData = nullptr;
+    }
+
+    glDeleteBuffers(1, &myBuffer);
+    myBuffer = 0;
+    myCapacity = 0;
+    myHead = 0;
+    myTail = 0;
+    myUsedBytes = 0;
+    myUnfencedBytes = 0;
+}
+
+bool UploadRing::Stage(const void* someData, std::size_t aSize, std::size_t anAlignment, std::size_t& anOffset)
+{
+    PROFILE_FUNCTION();
+
+    if (!myMappedData || aSize > myCapacity)
+        return false;
+
+    RetireRanges(false);
+    while (!Allocate(aSize, anAlignment, anOffset))
+    {
+        // Everything free has been handed out, so this has to wait for the GPU, after fencing what it has not been given yet
+        if (myUnfencedBytes > 0)
+            FenceStagedRange();
+
+        if (myFencedRanges.empty())
+            return false;
+
+        ++myFrameStatistics.myStallCount;
+        RetireRanges(true);
+    }
+
+    std::memcpy(myMappedData + anOffset, someData, aSize);
+    myFrameStatistics.myStagedBytes += aSize;
+    ++myFrameStatistics.myStagedCount;
+    return true;
+}
+
+void UploadRing::AddDirectUpload(std::size_t aSize)
+{
+    myFrameStatistics.myDirectBytes += aSize;
+}
+
+const unsigned char* UploadRing::StagePixels(const void* someData, std::size_t aSize)
+{
+    std::size_t stagedOffset = 0;
+    if (!Stage(someData, aSize, sizeof(uint32_t), stagedOffset))
+    {
+        AddDirectUpload(aSize);
+        return static_cast<const unsigned char*>(someData);
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, myBuffer);
+    return reinterpret_cast<const unsigned char*>(stagedOffset);
+}
+
+void UploadRing::UploadBuffer(unsigned int aBuffer, std::size_t anOffset, const void* someData, std::size_t aSize)
+{
+    if (aSize == 0)
+        return;
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, aBuffer);
+
+    std::size_t stagedOffset = 0;
+    if (Stage(someData, aSize, sizeof(uint32_t), stagedOffset))
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, myBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(stagedOffset), static_cast<GLintptr>(anOffset), static_cast<GLsizeiptr>(aSize));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+    else
+    {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(anOffset), static_cast<GLsizeiptr>(aSize), someData);
+        AddDirectUpload(aSize);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+UploadRingStatistics UploadRing::EndFrame()
+{
+    if (myUnfencedBytes > 0)
+        FenceStagedRange();
+
+    RetireRanges(false);
+
+    const UploadRingStatistics frameStatistics = myFrameStatistics;
+    myTotalStatistics.myStagedBytes += frameStatistics.myStagedBytes;
+    myTotalStatistics.myStagedCount += frameStatistics.myStagedCount;
+    myTotalStatistics.myDirectBytes += frameStatistics.myDirectBytes;
+    myTotalStatistics.myStallCount += frameStatistics.myStallCount;
+    myFrameStatistics = UploadRingStatistics();
+    return frameStatistics;
+}
+
+bool UploadRing::Allocate(std::size_t aSize, std::size_t anAlignment, std::size_t& anOffset)
+{
+    if (myUsedBytes == 0)
+    {
+        myHead = 0;
+        myTail = 0;
+    }
+
+    // With the head ahead of the tail the free space is the end of the ring plus its start, otherwise the gap up to the tail
+    const std::size_t alignedHead = (myHead + anAlignment - 1) / anAlignment * anAlignment;
+    std::size_t offset = alignedHead;
+    std::size_t padding = alignedHead - myHead;
+    if (myUsedBytes == 0 || myHead > myTail)
+    {
+        if (alignedHead + aSize > myCapacity)
+        {
+            if (aSize > myTail && myUsedBytes > 0)
+                return false;
+
+            offset = 0;
+            padding = myCapacity - myHead;
+        }
+    }
+    else if (myHead == myTail || alignedHead + aSize > myTail)
+    {
+        return false;
+    }
+
+    anOffset = offset;
+    myHead = offset + aSize;
+    myUsedBytes += padding + aSize;
+    myUnfencedBytes += padding + aSize;
+    return true;
+}
+
+void UploadRing::FenceStagedRange()
+{
+    myFencedRanges.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), myHead, myUnfencedBytes });
+    myUnfencedBytes = 0;
+}
+
+void UploadRing::RetireRanges(bool aShouldWait)
+{
+    while (!myFencedRanges.empty())
+    {
+        FencedRange& fencedRange = myFencedRanges.front();
+        GLenum waitResult = glClientWaitSync(fencedRange.myFence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        while (aShouldWait && waitResult == GL_TIMEOUT_EXPIRED)
+            waitResult = glClientWaitSync(fencedRange.myFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+
+        if (waitResult == GL_TIMEOUT_EXPIRED)
+            return;
+
+        glDeleteSync(fencedRange.myFence);
+        myTail = fencedRange.myEnd;
+        myUsedBytes -= fencedRange.mySize;
+        myFencedRanges.pop_front();
+        aShouldWait = false;
+    }
+}
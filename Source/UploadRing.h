@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+
+typedef struct __GLsync* GLsync;
+
+struct UploadRingStatistics
+{
+    std::size_t myStagedBytes = 0;
+    std::size_t myStagedCount = 0;
+    // Uploads that went straight from client memory, because there is no ring or they are larger than all of it
+    std::size_t myDirectBytes = 0;
+    // Times staging had to wait for the GPU to consume older uploads before their part of the ring could be reused
+    std::size_t myStallCount = 0;
+};
+
+// Persistently mapped staging buffer for texture and buffer uploads. Data is copied into the ring on the CPU and pulled into
+// its destination by the GPU, as the pixel unpack buffer of a texture upload or as the source of a buffer copy, so the driver
+// never has to hold on to client memory. The uploads of every frame are fenced at EndFrame and their part of the ring is reused
+// once that fence signaled, so staging only blocks when the uploads in flight would fill the whole ring.
+class UploadRing
+{
+public:
+    UploadRing();
+
+    // Needs buffer storage, so the ring stays unavailable and every upload goes direct before OpenGL 4.4
+    void Initialize(std::size_t aCapacity);
+    void Destroy();
+
+    [[nodiscard]] bool IsAvailable() const { return myMappedData != nullptr; }
+    [[nodiscard]] unsigned int GetBuffer() const { return myBuffer; }
+
+    // Copies someData into the ring and returns where it went in anOffset. Fails without a ring or when aSize does not fit into it.
+    [[nodiscard]] bool Stage(const void* someData, std::size_t aSize, std::size_t anAlignment, std::size_t& anOffset);
+    // Failed stages count as direct uploads, since that is what the caller falls back to
+    void AddDirectUpload(std::size_t aSize);
+
+    // Stages someData for a texture upload and binds the ring as the pixel unpack buffer, then returns what the upload has to be
+    // given as its data, an offset into the ring or someData itself when it could not be staged. Unbind the unpack buffer afterwards.
+    [[nodiscard]] const unsigned char* StagePixels(const void* someData, std::size_t aSize);
+
+    // Writes someData into aBuffer at anOffset through the ring, or straight from client memory when it cannot be staged
+    void UploadBuffer(unsigned int aBuffer, std::size_t anOffset, const void* someData, std::size_t aSize);
+
+    // Fences everything staged since the last call and returns the statistics of the frame it ends
+    UploadRingStatistics EndFrame();
+
+    [[nodiscard]] const UploadRingStatistics& GetTotalStatistics() const { return myTotalStatistics; }
+
+private:
+    struct FencedRange
+    {
+        GLsync myFence;
+        // Where the ring head was when the fence was inserted, and everything the range holds including wrap padding
+        std::size_t myEnd;
+        std::size_t mySize;
+    };
+
+    [[nodiscard]] bool Allocate(std::size_t aSize, std::size_t anAlignment, std::size_t& anOffset);
+    void FenceStagedRange();
+    // Frees the ranges whose fences signaled, waiting for the oldest one first when aShouldWait is set
+    void RetireRanges(bool aShouldWait);
+
+    std::deque<FencedRange> myFencedRanges;
+    UploadRingStatistics myFrameStatistics;
+    UploadRingStatistics myTotalStatistics;
+    unsigned char* myMappedData;
+    std::size_t myCapacity;
+    std::size_t myHead;
+    std::size_t myTail;
+    std::size_t myUsedBytes;
+    std::size_t myUnfencedBytes;
+    unsigned int myBuffer;
+};
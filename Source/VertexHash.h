@@ -2,14 +2,50 @@
 
 #include "Vertex.h"
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+namespace VertexHash
+{
+    inline uint32_t GetFloatBits(float aValue)
+    {
+        // -0.0f compares equal to 0.0f, so it has to hash the same as well
+        if (aValue == 0.0f)
+            aValue = 0.0f;
+
+        uint32_t bits;
+        std::memcpy(&bits, &aValue, sizeof(bits));
+        return bits;
+    }
+
+    inline uint64_t MixBits(uint64_t aHash, uint32_t aBits)
+    {
+        aHash ^= aBits;
+        aHash *= 0xbf58476d1ce4e5b9ull;
+        return aHash ^ (aHash >> 31);
+    }
+
+    // Hashes exactly the fields compared by Vertex::operator==
+    inline uint64_t Hash(const Vertex& aVertex)
+    {
+        uint64_t hash = 0x9e3779b97f4a7c15ull;
+        hash = MixBits(hash, GetFloatBits(aVertex.myPosition.x));
+        hash = MixBits(hash, GetFloatBits(aVertex.myPosition.y));
+        hash = MixBits(hash, GetFloatBits(aVertex.myPosition.z));
+        hash = MixBits(hash, GetFloatBits(aVertex.myTextureCoordinates.x));
+        hash = MixBits(hash, GetFloatBits(aVertex.myTextureCoordinates.y));
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        return hash ^ (hash >> 33);
+    }
+}
 
 template<>
 struct std::hash<Vertex>
 {
     size_t operator()(const Vertex& aVertex) const noexcept
     {
-        return (std::hash<glm::vec3>()(aVertex.myPosition) ^ std::hash<glm::vec2>()(aVertex.myTextureCoordinates) << 1) >> 1;
+        return static_cast<size_t>(VertexHash::Hash(aVertex));
     }
 };
@@ -0,0 +1,70 @@
+#include "VertexWeldTable.h"
+
+#include "Vertex.h"
+#include "VertexHash.h"
+
+namespace
+{
+    std::size_t GetNextPowerOfTwo(std::size_t aValue)
+    {
+        std::size_t powerOfTwo = 16;
+        while (powerOfTwo < aValue)
+            powerOfTwo <<= 1;
+
+        return powerOfTwo;
+    }
+}
+
+VertexWeldTable::VertexWeldTable(std::size_t anIndexCount)
+    : myMask(0)
+    , myCount(0)
+{
+    // Sized for the index count, and Insert grows it once it is three quarters full, so only a mesh with more unique vertices
+    // than three quarters of its indices ever grows. Welded meshes usually have far fewer, which keeps the probe sequences short.
+    mySlots.resize(GetNextPowerOfTwo(anIndexCount), Slot{ 0, EmptyIndex });
+    myMask = mySlots.size() - 1;
+}
+
+uint32_t VertexWeldTable::Insert(const Vertex& aVertex, std::vector<Vertex>& someVertices)
+{
+    if ((myCount + 1) * 4 > mySlots.size() * 3)
+        Grow(someVertices);
+
+    const uint64_t hash = VertexHash::Hash(aVertex);
+    const uint32_t fingerprint = static_cast<uint32_t>(hash >> 32);
+    for (std::size_t slotIndex = static_cast<std::size_t>(hash) & myMask;; slotIndex = (slotIndex + 1) & myMask)
+    {
+        Slot& slot = mySlots[slotIndex];
+        if (slot.myIndex == EmptyIndex)
+        {
+            slot.myFingerprint = fingerprint;
+            slot.myIndex = static_cast<uint32_t>(someVertices.size());
+            someVertices.push_back(aVertex);
+            ++myCount;
+            return slot.myIndex;
+        }
+
+        if (slot.myFingerprint == fingerprint && someVertices[slot.myIndex] == aVertex)
+            return slot.myIndex;
+    }
+}
+
+void VertexWeldTable::Grow(const std::vector<Vertex>& someVertices)
+{
+    std::vector<Slot> oldSlots(mySlots.size() * 2, Slot{ 0, EmptyIndex });
+    mySlots.swap(oldSlots);
+    myMask = mySlots.size() - 1;
+
+    for (const Slot& oldSlot : oldSlots)
+    {
+        if (oldSlot.myIndex == EmptyIndex)
+            continue;
+
+        const uint64_t hash = VertexHash::Hash(someVertices[oldSlot.myIndex]);
+        std::size_t slotIndex = static_cast<std::size_t>(hash) & myMask;
+        while (mySlots[slotIndex].myIndex != EmptyIndex)
+            slotIndex = (slotIndex + 1) & myMask;
+
+        mySlots[slotIndex] = oldSlot;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Vertex;
+
+// Flat open-addressing table mapping vertices to their index in a vertex array, used to weld duplicate vertices.
+// Every lookup is a single linear probe sequence over 8 byte slots without any per-vertex allocation.
+class VertexWeldTable
+{
+public:
+    explicit VertexWeldTable(std::size_t anIndexCount);
+
+    // Returns the index of the vertex equal to aVertex in someVertices, appending aVertex first when there is none
+    uint32_t Insert(const Vertex& aVertex, std::vector<Vertex>& someVertices);
+
+    [[nodiscard]] std::size_t GetCount() const { return myCount; }
+
+private:
+    struct Slot
+    {
+        uint32_t myFingerprint;
+        uint32_t myIndex;
+    };
+
+    static constexpr uint32_t EmptyIndex = UINT32_MAX;
+
+    void Grow(const std::vector<Vertex>& someVertices);
+
+    std::vector<Slot> mySlots;
+    std::size_t myMask;
+    std::size_t myCount;
+};
@@ -0,0 +1,119 @@
+#include "VertexWelder.h"
+
+#include "JobSystem.h"
+#include "Mesh.h"
+#include "Profiler.h"
+#include "Vertex.h"
+#include "VertexWeldTable.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+    constexpr std::size_t ParallelWeldMinimumIndexCount = 1 << 16;
+    constexpr std::size_t ParallelWeldMinimumChunkSize = 1 << 14;
+
+    // The unique vertices of one chunk of indices in order of first occurrence, and the chunk indices pointing into them
+    struct WeldChunk
+    {
+        std::vector<Vertex> myUniqueVertices;
+        std::vector<uint32_t> myLocalIndices;
+        std::vector<uint32_t> myRemap;
+    };
+
+    Vertex BuildVertex(const tinyobj::attrib_t& someAttributes, const tinyobj::index_t& anIndex)
+    {
+        Vertex vertex;
+        size_t vertexIndexStride = 3 * static_cast<size_t>(anIndex.vertex_index);
+        vertex.myPosition.x = someAttributes.vertices[vertexIndexStride];
+        vertex.myPosition.y = someAttributes.vertices[vertexIndexStride + 1];
+        vertex.myPosition.z = someAttributes.vertices[vertexIndexStride + 2];
+
+        if (!someAttributes.colors.empty())
+        {
+            vertex.myColor.x = someAttributes.colors[vertexIndexStride];
+            vertex.myColor.y = someAttributes.colors[vertexIndexStride + 1];
+            vertex.myColor.z = someAttributes.colors[vertexIndexStride + 2];
+        }
+        else
+        {
+            vertex.myColor = glm::vec3(1.0f);
+        }
+
+        if (!someAttributes.texcoords.empty())
+        {
+            const size_t textureCoordinatesIndexStride = 2 * static_cast<size_t>(anIndex.texcoord_index);
+            vertex.myTextureCoordinates.x = someAttributes.texcoords[textureCoordinatesIndexStride];
+            vertex.myTextureCoordinates.y = 1.0f - someAttributes.texcoords[textureCoordinatesIndexStride + 1];
+        }
+
+        return vertex;
+    }
+}
+
+namespace VertexWelder
+{
+    void WeldSerial(const tinyobj::attrib_t& someAttributes, const std::vector<tinyobj::index_t>& someIndices, VertexWeldTable& someUniqueVertices, Mesh& aMesh)
+    {
+        PROFILE_FUNCTION();
+
+        for (const tinyobj::index_t& index : someIndices)
+        {
+            const Vertex vertex = BuildVertex(someAttributes, index);
+            aMesh.myIndices.push_back(someUniqueVertices.Insert(vertex, aMesh.myVertices));
+        }
+    }
+
+    void WeldParallel(const tinyobj::attrib_t& someAttributes, const std::vector<tinyobj::index_t>& someIndices, VertexWeldTable& someUniqueVertices, Mesh& aMesh)
+    {
+        PROFILE_FUNCTION();
+
+        JobSystem& jobSystem = JobSystem::GetInstance();
+        const std::size_t desiredChunkCount = (jobSystem.GetWorkerCount() + 1) * 4;
+        const std::size_t chunkSize = std::max((someIndices.size() + desiredChunkCount - 1) / desiredChunkCount, ParallelWeldMinimumChunkSize);
+        const std::size_t chunkCount = (someIndices.size() + chunkSize - 1) / chunkSize;
+        std::vector<WeldChunk> chunks(chunkCount);
+
+        jobSystem.ParallelFor(chunkCount, [&](std::size_t aChunkIndex)
+        {
+            PROFILE_SCOPE("WeldChunk");
+
+            WeldChunk& chunk = chunks[aChunkIndex];
+            const std::size_t begin = aChunkIndex * chunkSize;
+            const std::size_t end = std::min(begin + chunkSize, someIndices.size());
+            VertexWeldTable localUniqueVertices(end - begin);
+            chunk.myLocalIndices.reserve(end - begin);
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                const Vertex vertex = BuildVertex(someAttributes, someIndices[i]);
+                chunk.myLocalIndices.push_back(localUniqueVertices.Insert(vertex, chunk.myUniqueVertices));
+            }
+        });
+
+        for (WeldChunk& chunk : chunks)
+        {
+            chunk.myRemap.resize(chunk.myUniqueVertices.size());
+            for (std::size_t i = 0; i < chunk.myUniqueVertices.size(); ++i)
+                chunk.myRemap[i] = someUniqueVertices.Insert(chunk.myUniqueVertices[i], aMesh.myVertices);
+        }
+
+        const std::size_t indexOffset = aMesh.myIndices.size();
+        aMesh.myIndices.resize(indexOffset + someIndices.size());
+        jobSystem.ParallelFor(chunkCount, [&](std::size_t aChunkIndex)
+        {
+            const WeldChunk& chunk = chunks[aChunkIndex];
+            unsigned int* indices = aMesh.myIndices.data() + indexOffset + aChunkIndex * chunkSize;
+            for (std::size_t i = 0; i < chunk.myLocalIndices.size(); ++i)
+                indices[i] = chunk.myRemap[chunk.myLocalIndices[i]];
+        });
+    }
+
+    void Weld(const tinyobj::attrib_t& someAttributes, const std::vector<tinyobj::index_t>& someIndices, VertexWeldTable& someUniqueVertices, Mesh& aMesh)
+    {
+        if (someIndices.size() >= ParallelWeldMinimumIndexCount && JobSystem::GetInstance().GetWorkerCount() > 0)
+            WeldParallel(someAttributes, someIndices, someUniqueVertices, aMesh);
+        else
+            WeldSerial(someAttributes, someIndices, someUniqueVertices, aMesh);
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <tiny_obj_loader.h>
+
+#include <vector>
+
+class Mesh;
+class VertexWeldTable;
+
+// Builds the vertices the indices of an OBJ shape point at and appends them to a mesh, reusing equal ones.
+// Both paths produce exactly the same vertices and indices, the parallel one welds chunks of indices on their own
+// and merges them in index order so vertices keep their global order of first occurrence.
+namespace VertexWelder
+{
+    void WeldSerial(const tinyobj::attrib_t& someAttributes, const std::vector<tinyobj::index_t>& someIndices, VertexWeldTable& someUniqueVertices, Mesh& aMesh);
+    void WeldParallel(const tinyobj::attrib_t& someAttributes, const std::vector<tinyobj::index_t>& someIndices, VertexWeldTable& someUniqueVertices, Mesh& aMesh);
+    // Takes the parallel path for shapes large enough to pay for the merge, when there are workers to run it
+    void Weld(const tinyobj::attrib_t& someAttributes, const std::vector<tinyobj::index_t>& someIndices, VertexWeldTable& someUniqueVertices, Mesh& aMesh);
+}
@@ -0,0 +1,182 @@
+#include "VirtualTextureCache.h"
+
+#include <algorithm>
+
+VirtualTextureCache::VirtualTextureCache(int aSlotsPerSide)
+    : myFrameIndex(0)
+    , myPinnedCount(0)
+    , myPendingCount(0)
+    , myLoadCount(0)
+    , myEvictedCount(0)
+    , mySlotsPerSide(aSlotsPerSide)
+{
+    // Handed out from the back, so the first tiles get the first slots
+    for (int slot = static_cast<int>(GetSlotCount()) - 1; slot >= 0; --slot)
+        myFreeSlots.push_back(slot);
+}
+
+bool VirtualTextureCache::Pin(uint32_t aTile, TileLoad& aLoad)
+{
+    const std::unordered_map<uint32_t, ResidentTile>::iterator residentTile = myResidentTiles.find(aTile);
+    if (residentTile != myResidentTiles.end())
+    {
+        if (!residentTile->second.myIsPinned)
+        {
+            myLeastRecentlyUsedTiles.erase(residentTile->second.myLeastRecentlyUsedPosition);
+            residentTile->second.myIsPinned = true;
+            ++myPinnedCount;
+        }
+
+        aLoad = TileLoad{ aTile, residentTile->second.mySlot, 0 };
+        return true;
+    }
+
+    if (!AllocateSlot(aTile, true, aLoad))
+        return false;
+
+    ++myPinnedCount;
+    return true;
+}
+
+void VirtualTextureCache::RemoveTexture(int aTexture)
+{
+    for (std::unordered_map<uint32_t, ResidentTile>::iterator residentTile = myResidentTiles.begin(); residentTile != myResidentTiles.end();)
+    {
+        if (VirtualTextureTile::GetTexture(residentTile->first) != aTexture)
+        {
+            ++residentTile;
+            continue;
+        }
+
+        if (residentTile->second.myIsPinned)
+            --myPinnedCount;
+        else
+            myLeastRecentlyUsedTiles.erase(residentTile->second.myLeastRecentlyUsedPosition);
+
+        myFreeSlots.push_back(residentTile->second.mySlot);
+        residentTile = myResidentTiles.erase(residentTile);
+    }
+}
+
+void VirtualTextureCache::Update(std::vector<uint32_t>& someRequestedTiles, std::size_t aMaxLoadCount, std::vector<TileLoad>& someLoads)
+{
+    ++myFrameIndex;
+
+    std::sort(someRequestedTiles.begin(), someRequestedTiles.end());
+    someRequestedTiles.erase(std::unique(someRequestedTiles.begin(), someRequestedTiles.end()), someRequestedTiles.end());
+
+    myMissingTiles.clear();
+    for (const uint32_t tile : someRequestedTiles)
+    {
+        const std::unordered_map<uint32_t, ResidentTile>::iterator residentTile = myResidentTiles.find(tile);
+        if (residentTile == myResidentTiles.end())
+        {
+            myMissingTiles.push_back(tile);
+            continue;
+        }
+
+        residentTile->second.myLastRequestedFrame = myFrameIndex;
+        if (!residentTile->second.myIsPinned)
+            myLeastRecentlyUsedTiles.splice(myLeastRecentlyUsedTiles.end(), myLeastRecentlyUsedTiles, residentTile->second.myLeastRecentlyUsedPosition);
+    }
+
+    // Coarse tiles cover the most screen and are what finer tiles fall back to, ties keep the packed order so loads are reproducible
+    std::sort(myMissingTiles.begin(), myMissingTiles.end(), [](uint32_t aLeft, uint32_t aRight)
+    {
+        const int leftLevel = VirtualTextureTile::GetLevel(aLeft);
+        const int rightLevel = VirtualTextureTile::GetLevel(aRight);
+        return leftLevel != rightLevel ? leftLevel > rightLevel : aLeft < aRight;
+    });
+
+    std::size_t loadCount = 0;
+    for (const uint32_t tile : myMissingTiles)
+    {
+        TileLoad load;
+        if (loadCount == aMaxLoadCount || !AllocateSlot(tile, false, load))
+            break;
+
+        someLoads.push_back(load);
+        ++loadCount;
+    }
+
+    myPendingCount = myMissingTiles.size() - loadCount;
+}
+
+void VirtualTextureCache::BuildPageTable(int aTexture, const std::vector<std::pair<int, int>>& someTileCounts, std::vector<unsigned char>& aPageTable) const
+{
+    std::vector<std::size_t> levelOffsets;
+    std::size_t entryCount = 0;
+    for (const std::pair<int, int>& tileCount : someTileCounts)
+    {
+        levelOffsets.push_back(entryCount);
+        entryCount += static_cast<std::size_t>(tileCount.first) * tileCount.second;
+    }
+
+    aPageTable.assign(entryCount * 4, 0);
+    for (int level = static_cast<int>(someTileCounts.size()) - 1; level >= 0; --level)
+    {
+        const int tileCountX = someTileCounts[level].first;
+        for (int y = 0; y < someTileCounts[level].second; ++y)
+        {
+            for (int x = 0; x < tileCountX; ++x)
+            {
+                unsigned char* entry = aPageTable.data() + (levelOffsets[level] + static_cast<std::size_t>(y) * tileCountX + x) * 4;
+                const int slot = FindSlot(VirtualTextureTile::Pack(aTexture, level, x, y));
+                if (slot >= 0)
+                {
+                    entry[0] = static_cast<unsigned char>(slot % mySlotsPerSide);
+                    entry[1] = static_cast<unsigned char>(slot / mySlotsPerSide);
+                    entry[2] = static_cast<unsigned char>(level);
+                    entry[3] = 255;
+                }
+                else if (level + 1 < static_cast<int>(someTileCounts.size()))
+                {
+                    // Every level halves the texels and keeps the tile size, so the tile above covers this one and its three neighbours
+                    const int parentTileCountX = someTileCounts[level + 1].first;
+                    const unsigned char* parentEntry = aPageTable.data() + (levelOffsets[level + 1] + static_cast<std::size_t>(y / 2) * parentTileCountX + x / 2) * 4;
+                    std::copy(parentEntry, parentEntry + 4, entry);
+                }
+            }
+        }
+    }
+}
+
+int VirtualTextureCache::FindSlot(uint32_t aTile) const
+{
+    const std::unordered_map<uint32_t, ResidentTile>::const_iterator residentTile = myResidentTiles.find(aTile);
+    return residentTile == myResidentTiles.end() ? -1 : residentTile->second.mySlot;
+}
+
+bool VirtualTextureCache::AllocateSlot(uint32_t aTile, bool anIsPinned, TileLoad& aLoad)
+{
+    aLoad = TileLoad{ aTile, -1, 0 };
+    if (!myFreeSlots.empty())
+    {
+        aLoad.mySlot = myFreeSlots.back();
+        myFreeSlots.pop_back();
+    }
+    else
+    {
+        if (myLeastRecentlyUsedTiles.empty())
+            return false;
+
+        const uint32_t evictedTile = myLeastRecentlyUsedTiles.front();
+        const std::unordered_map<uint32_t, ResidentTile>::iterator residentTile = myResidentTiles.find(evictedTile);
+        if (residentTile->second.myLastRequestedFrame == myFrameIndex)
+            return false;
+
+        aLoad.mySlot = residentTile->second.mySlot;
+        aLoad.myEvictedTile = evictedTile;
+        myLeastRecentlyUsedTiles.pop_front();
+        myResidentTiles.erase(residentTile);
+        ++myEvictedCount;
+    }
+
+    ResidentTile residentTile{ aLoad.mySlot, anIsPinned, myFrameIndex, myLeastRecentlyUsedTiles.end() };
+    if (!anIsPinned)
+        residentTile.myLeastRecentlyUsedPosition = myLeastRecentlyUsedTiles.insert(myLeastRecentlyUsedTiles.end(), aTile);
+
+    myResidentTiles.emplace(aTile, residentTile);
+    ++myLoadCount;
+    return true;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// A tile of a virtual texture packed into 32 bits, the way the feedback pass writes it, so 0 is no tile.
+// This has to match Data/Shaders/VirtualTextureFeedback.frag.glsl.
+namespace VirtualTextureTile
+{
+    constexpr int MaxTextureCount = 255;
+    constexpr int MaxLevelCount = 16;
+    constexpr int MaxTileCount = 1024;
+
+    [[nodiscard]] inline uint32_t Pack(int aTexture, int aLevel, int aX, int aY)
+    {
+        return static_cast<uint32_t>(aTexture + 1) << 24 | static_cast<uint32_t>(aLevel) << 20 | static_cast<uint32_t>(aY) << 10 | static_cast<uint32_t>(aX);
+    }
+
+    [[nodiscard]] inline int GetTexture(uint32_t aTile) { return static_cast<int>(aTile >> 24) - 1; }
+    [[nodiscard]] inline int GetLevel(uint32_t aTile) { return static_cast<int>(aTile >> 20 & 0xF); }
+    [[nodiscard]] inline int GetY(uint32_t aTile) { return static_cast<int>(aTile >> 10 & 0x3FF); }
+    [[nodiscard]] inline int GetX(uint32_t aTile) { return static_cast<int>(aTile & 0x3FF); }
+}
+
+// Assigns the tiles of all virtual textures to the slots of one physical tile cache, a square of aSlotsPerSide by aSlotsPerSide tiles.
+// Tiles stay resident until their slot is needed for a tile that was requested, then the least recently requested tile goes first.
+// Tiles requested in the current frame are never evicted, the loads that would need their slots wait for a later frame instead.
+// Pure bookkeeping, the owner uploads the tiles it is handed slots for.
+class VirtualTextureCache
+{
+public:
+    struct TileLoad
+    {
+        uint32_t myTile;
+        int mySlot;
+        // The tile that had the slot before, 0 when the slot was free
+        uint32_t myEvictedTile;
+    };
+
+    explicit VirtualTextureCache(int aSlotsPerSide);
+
+    // Makes a tile resident for good, used for the coarsest level of every texture so every lookup resolves to something.
+    // Returns false when every slot holds a pinned tile or a tile requested this frame.
+    [[nodiscard]] bool Pin(uint32_t aTile, TileLoad& aLoad);
+    // Frees every slot of a texture, pinned or not
+    void RemoveTexture(int aTexture);
+
+    // Marks the requested tiles as used and hands out slots to at most aMaxLoadCount of the missing ones, coarsest level first,
+    // so a texture sharpens one level at a time. someRequestedTiles may contain duplicates and is sorted in place.
+    void Update(std::vector<uint32_t>& someRequestedTiles, std::size_t aMaxLoadCount, std::vector<TileLoad>& someLoads);
+
+    // Writes the page table of a texture, every level from the finest to the coarsest, with one RGBA8 entry per tile holding
+    // the slot of the tile or of its closest resident ancestor and the level that one is from. someTileCounts are x and y per level.
+    void BuildPageTable(int aTexture, const std::vector<std::pair<int, int>>& someTileCounts, std::vector<unsigned char>& aPageTable) const;
+
+    // Returns -1 when the tile is not resident
+    [[nodiscard]] int FindSlot(uint32_t aTile) const;
+
+    [[nodiscard]] int GetSlotsPerSide() const { return mySlotsPerSide; }
+    [[nodiscard]] std::size_t GetSlotCount() const { return static_cast<std::size_t>(mySlotsPerSide) * mySlotsPerSide; }
+    [[nodiscard]] std::size_t GetResidentCount() const { return myResidentTiles.size(); }
+    [[nodiscard]] std::size_t GetPinnedCount() const { return myPinnedCount; }
+    // Missing tiles the last Update had no load or no slot for
+    [[nodiscard]] std::size_t GetPendingCount() const { return myPendingCount; }
+    [[nodiscard]] std::size_t GetLoadCount() const { return myLoadCount; }
+    [[nodiscard]] std::size_t GetEvictedCount() const { return myEvictedCount; }
+
+private:
+    struct ResidentTile
+    {
+        int mySlot;
+        bool myIsPinned;
+        uint64_t myLastRequestedFrame;
+        // Only valid while the tile is not pinned
+        std::list<uint32_t>::iterator myLeastRecentlyUsedPosition;
+    };
+
+    // Takes a free slot, or the slot of the least recently requested tile when that was not requested this frame
+    [[nodiscard]] bool AllocateSlot(uint32_t aTile, bool anIsPinned, TileLoad& aLoad);
+
+    std::unordered_map<uint32_t, ResidentTile> myResidentTiles;
+    // Unpinned resident tiles, least recently requested first
+    std::list<uint32_t> myLeastRecentlyUsedTiles;
+    std::vector<int> myFreeSlots;
+    std::vector<uint32_t> myMissingTiles;
+    uint64_t myFrameIndex;
+    std::size_t myPinnedCount;
+    std::size_t myPendingCount;
+    std::size_t myLoadCount;
+    std::size_t myEvictedCount;
+    int mySlotsPerSide;
+};
@@ -0,0 +1,152 @@
+#include "VirtualTextureFeedback.h"
+
+#include "LogUtility.h"
+#include "Profiler.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+VirtualTextureFeedback::VirtualTextureFeedback()
+    : myFramebufferObject(0)
+    , myColorTexture(0)
+    , myDepthRenderbuffer(0)
+    , myWidth(0)
+    , myHeight(0)
+    , myWriteIndex(0)
+    , myReadIndex(0)
+    , myPendingCount(0)
+    , myPreviousFramebuffer(0)
+    , myPreviousViewport{}
+{
+}
+
+void VirtualTextureFeedback::Initialize(int aWidth, int aHeight)
+{
+    myWidth = std::max(aWidth, 1);
+    myHeight = std::max(aHeight, 1);
+
+    glGenTextures(1, &myColorTexture);
+    glBindTexture(GL_TEXTURE_2D, myColorTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, myWidth, myHeight);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &myDepthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, myDepthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, myWidth, myHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &myFramebufferObject);
+    glBindFramebuffer(GL_FRAMEBUFFER, myFramebufferObject);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, myColorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, myDepthRenderbuffer);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        LogUtility::PrintError(LogUtility::LogCategory::Graphics, "Virtual texture feedback framebuffer is incomplete");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    const GLsizeiptr readbackSize = static_cast<GLsizeiptr>(myWidth) * myHeight * sizeof(uint32_t);
+    for (Readback& readback : myReadbacks)
+    {
+        glGenBuffers(1, &readback.myPixelBuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.myPixelBuffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, readbackSize, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void VirtualTextureFeedback::Destroy()
+{
+    for (Readback& readback : myReadbacks)
+    {
+        glDeleteSync(readback.myFence);
+        glDeleteBuffers(1, &readback.myPixelBuffer);
+        readback = Readback();
+    }
+
+    glDeleteFramebuffers(1, &myFramebufferObject);
+    glDeleteTextures(1, &myColorTexture);
+    glDeleteRenderbuffers(1, &myDepthRenderbuffer);
+    myFramebufferObject = 0;
+    myColorTexture = 0;
+    myDepthRenderbuffer = 0;
+    myPendingCount = 0;
+}
+
+void VirtualTextureFeedback::Begin()
+{
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &myPreviousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, myPreviousViewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, myFramebufferObject);
+    glViewport(0, 0, myWidth, myHeight);
+
+    // 0 is no tile, which is what the texels no virtual textured draw covers read back as
+    const GLuint noTile[4] = {};
+    const GLfloat farDepth = 1.0f;
+    glClearBufferuiv(GL_COLOR, 0, noTile);
+    glClearBufferfv(GL_DEPTH, 0, &farDepth);
+}
+
+void VirtualTextureFeedback::End()
+{
+    // Every readback is still waiting to be read, this frame's feedback is dropped rather than stalling on the oldest one
+    if (myPendingCount < FrameLatency)
+    {
+        Readback& readback = myReadbacks[myWriteIndex];
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.myPixelBuffer);
+        glReadPixels(0, 0, myWidth, myHeight, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        readback.myFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        myWriteIndex = (myWriteIndex + 1) % FrameLatency;
+        ++myPendingCount;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(myPreviousFramebuffer));
+    glViewport(myPreviousViewport[0], myPreviousViewport[1], myPreviousViewport[2], myPreviousViewport[3]);
+}
+
+bool VirtualTextureFeedback::Read(std::vector<uint32_t>& someTiles, bool aShouldWait)
+{
+    PROFILE_FUNCTION();
+
+    if (myPendingCount == 0)
+        return false;
+
+    Readback& readback = myReadbacks[myReadIndex];
+    GLenum waitResult = glClientWaitSync(readback.myFence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (aShouldWait && waitResult == GL_TIMEOUT_EXPIRED)
+        waitResult = glClientWaitSync(readback.myFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+
+    if (waitResult == GL_TIMEOUT_EXPIRED)
+        return false;
+
+    glDeleteSync(readback.myFence);
+    readback.myFence = nullptr;
+    myReadIndex = (myReadIndex + 1) % FrameLatency;
+    --myPendingCount;
+
+    const std::size_t texelCount = static_cast<std::size_t>(myWidth) * myHeight;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.myPixelBuffer);
+    const uint32_t* texels = static_cast<const uint32_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(texelCount * sizeof(uint32_t)), GL_MAP_READ_BIT));
+    if (texels)
+    {
+        // Neighbouring texels mostly sample the same tile, skipping runs keeps the sort below short
+        const std::size_t firstTile = someTiles.size();
+        uint32_t previousTexel = 0;
+        for (std::size_t texel = 0; texel < texelCount; ++texel)
+        {
+            if (texels[texel] != 0 && texels[texel] != previousTexel)
+                someTiles.push_back(texels[texel]);
+            previousTexel = texels[texel];
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+        std::sort(someTiles.begin() + static_cast<std::ptrdiff_t>(firstTile), someTiles.end());
+        someTiles.erase(std::unique(someTiles.begin() + static_cast<std::ptrdiff_t>(firstTile), someTiles.end()), someTiles.end());
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+typedef struct __GLsync* GLsync;
+
+// The feedback pass of virtual texturing. The virtual textured draws are rendered between Begin and End into a small integer
+// target where every texel holds the tile it sampled, packed as in VirtualTextureTile, and End reads that target back into a
+// pixel pack buffer. Read picks a readback up once its fence has signaled, up to FrameLatency frames later, so the GPU never
+// has to drain for it unless the caller asks to wait.
+class VirtualTextureFeedback
+{
+public:
+    VirtualTextureFeedback();
+
+    void Initialize(int aWidth, int aHeight);
+    void Destroy();
+
+    void Begin();
+    void End();
+
+    // Appends the distinct tiles of the oldest readback, sorted. Returns false when no readback has finished, after waiting for
+    // the oldest one when aShouldWait is set.
+    bool Read(std::vector<uint32_t>& someTiles, bool aShouldWait);
+
+private:
+    static constexpr int FrameLatency = 3;
+
+    struct Readback
+    {
+        unsigned int myPixelBuffer = 0;
+        GLsync myFence = nullptr;
+    };
+
+    std::array<Readback, FrameLatency> myReadbacks;
+    unsigned int myFramebufferObject;
+    unsigned int myColorTexture;
+    unsigned int myDepthRenderbuffer;
+    int myWidth;
+    int myHeight;
+    // The next readback to write and the oldest one waiting to be read
+    int myWriteIndex;
+    int myReadIndex;
+    int myPendingCount;
+    int myPreviousFramebuffer;
+    int myPreviousViewport[4];
+};
@@ -0,0 +1,254 @@
+#include "VirtualTexturePageFile.h"
+
+#include "FileUtility.h"
+#include "LogUtility.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    constexpr char PageFileMagic[4] = { 'L', 'O', 'V', 'T' };
+    constexpr uint32_t PageFileVersion = 1;
+
+    struct PageFileHeader
+    {
+        char myMagic[4];
+        uint32_t myVersion;
+        uint64_t mySourceSize;
+        int64_t mySourceModificationTime;
+        int32_t myWidth;
+        int32_t myHeight;
+        int32_t myLevelCount;
+        // The layout the tiles were cooked with, a page file written with other tile constants is stale as well
+        int32_t myTileSize;
+        int32_t myTileBorder;
+        int32_t myPadding;
+    };
+
+    int GetLevelSize(int aSize, int aLevel)
+    {
+        return std::max(aSize >> aLevel, 1);
+    }
+
+    // Expands to RGBA8 the way the GL formats TextureLoader picks would sample, one channel reads as red only
+    std::vector<unsigned char> ExpandToRgba(const unsigned char* somePixels, int aWidth, int aHeight, int aChannelCount)
+    {
+        const std::size_t texelCount = static_cast<std::size_t>(aWidth) * aHeight;
+        std::vector<unsigned char> rgbaPixels(texelCount * 4);
+        for (std::size_t texel = 0; texel < texelCount; ++texel)
+        {
+            const unsigned char* source = somePixels + texel * aChannelCount;
+            unsigned char* destination = rgbaPixels.data() + texel * 4;
+            destination[0] = source[0];
+            destination[1] = aChannelCount > 1 ? source[1] : 0;
+            destination[2] = aChannelCount > 2 ? source[2] : 0;
+            destination[3] = aChannelCount > 3 ? source[3] : 255;
+        }
+
+        return rgbaPixels;
+    }
+
+    // Box filter that halves both sides, clamping the last row and column of odd sizes like glGenerateMipmap would filter them
+    std::vector<unsigned char> Downsample(const std::vector<unsigned char>& someRgbaPixels, int aWidth, int aHeight)
+    {
+        const int width = std::max(aWidth / 2, 1);
+        const int height = std::max(aHeight / 2, 1);
+        std::vector<unsigned char> rgbaPixels(static_cast<std::size_t>(width) * height * 4);
+        for (int y = 0; y < height; ++y)
+        {
+            const int sourceY0 = std::min(y * 2, aHeight - 1);
+            const int sourceY1 = std::min(y * 2 + 1, aHeight - 1);
+            for (int x = 0; x < width; ++x)
+            {
+                const int sourceX0 = std::min(x * 2, aWidth - 1);
+                const int sourceX1 = std::min(x * 2 + 1, aWidth - 1);
+                for (int channel = 0; channel < 4; ++channel)
+                {
+                    const int sum = someRgbaPixels[(static_cast<std::size_t>(sourceY0) * aWidth + sourceX0) * 4 + channel]
+                        + someRgbaPixels[(static_cast<std::size_t>(sourceY0) * aWidth + sourceX1) * 4 + channel]
+                        + someRgbaPixels[(static_cast<std::size_t>(sourceY1) * aWidth + sourceX0) * 4 + channel]
+                        + someRgbaPixels[(static_cast<std::size_t>(sourceY1) * aWidth + sourceX1) * 4 + channel];
+                    rgbaPixels[(static_cast<std::size_t>(y) * width + x) * 4 + channel] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+
+        return rgbaPixels;
+    }
+
+    void CopyTile(const std::vector<unsigned char>& someRgbaPixels, int aWidth, int aHeight, int aTileX, int aTileY, unsigned char* aTile)
+    {
+        const int originX = aTileX * VirtualTexturePageFile::TilePayloadSize - virtualTextureTileBorder;
+        const int originY = aTileY * VirtualTexturePageFile::TilePayloadSize - virtualTextureTileBorder;
+        for (int y = 0; y < virtualTextureTileSize; ++y)
+        {
+            const int sourceY = ((originY + y) % aHeight + aHeight) % aHeight;
+            for (int x = 0; x < virtualTextureTileSize; ++x)
+            {
+                const int sourceX = ((originX + x) % aWidth + aWidth) % aWidth;
+                std::memcpy(aTile + (static_cast<std::size_t>(y) * virtualTextureTileSize + x) * 4, someRgbaPixels.data() + (static_cast<std::size_t>(sourceY) * aWidth + sourceX) * 4, 4);
+            }
+        }
+    }
+}
+
+VirtualTexturePageFile::VirtualTexturePageFile()
+    : myWidth(0)
+    , myHeight(0)
+{
+}
+
+std::string VirtualTexturePageFile::GetPageFilePath(const std::string& aSourceFilepath)
+{
+    return aSourceFilepath + ".vtpages";
+}
+
+int VirtualTexturePageFile::GetLevelCount(int aWidth, int aHeight)
+{
+    int levelCount = 1;
+    while (GetLevelSize(aWidth, levelCount - 1) > TilePayloadSize || GetLevelSize(aHeight, levelCount - 1) > TilePayloadSize)
+        ++levelCount;
+
+    return levelCount;
+}
+
+int VirtualTexturePageFile::GetTileCount(int aSize, int aLevel)
+{
+    return (GetLevelSize(aSize, aLevel) + TilePayloadSize - 1) / TilePayloadSize;
+}
+
+std::size_t VirtualTexturePageFile::GetWriteWorkingSize(int aWidth, int aHeight)
+{
+    const std::size_t firstLevelBytes = static_cast<std::size_t>(aWidth) * aHeight * 4;
+    const std::size_t secondLevelBytes = static_cast<std::size_t>(GetLevelSize(aWidth, 1)) * GetLevelSize(aHeight, 1) * 4;
+    return firstLevelBytes + secondLevelBytes + TileByteSize;
+}
+
+bool VirtualTexturePageFile::Write(const std::string& aSourceFilepath, const unsigned char* somePixels, int aWidth, int aHeight, int aChannelCount)
+{
+    PROFILE_FUNCTION();
+
+    if (!somePixels || aWidth <= 0 || aHeight <= 0 || aChannelCount < 1 || aChannelCount > 4)
+        return false;
+
+    PageFileHeader header = {};
+    std::memcpy(header.myMagic, PageFileMagic, sizeof(PageFileMagic));
+    header.myVersion = PageFileVersion;
+    if (!FileUtility::GetFileStamp(aSourceFilepath, header.mySourceSize, header.mySourceModificationTime))
+        return false;
+
+    header.myWidth = aWidth;
+    header.myHeight = aHeight;
+    header.myLevelCount = GetLevelCount(aWidth, aHeight);
+    header.myTileSize = virtualTextureTileSize;
+    header.myTileBorder = virtualTextureTileBorder;
+
+    const std::string pageFilePath = GetPageFilePath(aSourceFilepath);
+    const bool isWritten = FileUtility::WriteFileAtomically(pageFilePath, [&](std::ofstream& aStream)
+    {
+        aStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        std::vector<unsigned char> tile(TileByteSize);
+        std::vector<unsigned char> rgbaPixels = ExpandToRgba(somePixels, aWidth, aHeight, aChannelCount);
+        for (int level = 0; level < header.myLevelCount && aStream; ++level)
+        {
+            const int width = GetLevelSize(aWidth, level);
+            const int height = GetLevelSize(aHeight, level);
+            if (level > 0)
+                rgbaPixels = Downsample(rgbaPixels, GetLevelSize(aWidth, level - 1), GetLevelSize(aHeight, level - 1));
+
+            for (int tileY = 0; tileY < GetTileCount(aHeight, level); ++tileY)
+            {
+                for (int tileX = 0; tileX < GetTileCount(aWidth, level); ++tileX)
+                {
+                    CopyTile(rgbaPixels, width, height, tileX, tileY, tile.data());
+                    aStream.write(reinterpret_cast<const char*>(tile.data()), static_cast<std::streamsize>(tile.size()));
+                }
+            }
+        }
+    });
+
+    if (!isWritten)
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::File, "Failed to write virtual texture page file %s", pageFilePath.c_str());
+        return false;
+    }
+
+    LogUtility::PrintMessage(LogUtility::LogCategory::File, "Wrote virtual texture page file %s with %i levels", pageFilePath.c_str(), header.myLevelCount);
+    return true;
+}
+
+bool VirtualTexturePageFile::Open(const std::string& aSourceFilepath)
+{
+    PROFILE_FUNCTION();
+
+    Close();
+
+    uint64_t sourceSize = 0;
+    int64_t sourceModificationTime = 0;
+    if (!FileUtility::GetFileStamp(aSourceFilepath, sourceSize, sourceModificationTime))
+        return false;
+
+    const std::string pageFilePath = GetPageFilePath(aSourceFilepath);
+    if (!myFile.Open(pageFilePath))
+        return false;
+
+    PageFileHeader header;
+    if (myFile.GetSize() < sizeof(header))
+    {
+        myFile.Close();
+        return false;
+    }
+
+    std::memcpy(&header, myFile.GetData(), sizeof(header));
+    if (std::memcmp(header.myMagic, PageFileMagic, sizeof(PageFileMagic)) != 0 || header.myVersion != PageFileVersion
+        || header.myTileSize != virtualTextureTileSize || header.myTileBorder != virtualTextureTileBorder)
+    {
+        LogUtility::PrintMessage(LogUtility::LogCategory::File, "Ignoring outdated virtual texture page file %s", pageFilePath.c_str());
+        myFile.Close();
+        return false;
+    }
+
+    if (header.mySourceSize != sourceSize || header.mySourceModificationTime != sourceModificationTime)
+    {
+        LogUtility::PrintMessage(LogUtility::LogCategory::File, "Ignoring stale virtual texture page file %s", pageFilePath.c_str());
+        myFile.Close();
+        return false;
+    }
+
+    std::size_t tileCount = 0;
+    for (int level = 0; level < header.myLevelCount; ++level)
+    {
+        myLevelFirstTiles.push_back(tileCount);
+        tileCount += static_cast<std::size_t>(GetTileCount(header.myWidth, level)) * GetTileCount(header.myHeight, level);
+    }
+
+    if (header.myLevelCount != GetLevelCount(header.myWidth, header.myHeight) || myFile.GetSize() != sizeof(header) + tileCount * TileByteSize)
+    {
+        myFile.Close();
+        myLevelFirstTiles.clear();
+        return false;
+    }
+
+    myWidth = header.myWidth;
+    myHeight = header.myHeight;
+    return true;
+}
+
+void VirtualTexturePageFile::Close()
+{
+    myFile.Close();
+    myLevelFirstTiles.clear();
+    myWidth = 0;
+    myHeight = 0;
+}
+
+const unsigned char* VirtualTexturePageFile::GetTile(int aLevel, int aX, int aY) const
+{
+    const std::size_t tile = myLevelFirstTiles[aLevel] + static_cast<std::size_t>(aY) * GetTileCountX(aLevel) + aX;
+    return myFile.GetData() + sizeof(PageFileHeader) + tile * TileByteSize;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "AppDefinitions.h"
+#include "MemoryMappedFile.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// The tiles of a virtual texture and its mip chain, cooked once from the source image into a file beside it and memory mapped
+// afterwards, so a tile can be uploaded without decoding anything. Tiles are RGBA8 and cover TilePayloadSize texels of their
+// level plus a border copied from their neighbours, wrapping around the edges like GL_REPEAT, so filtering inside the physical
+// tile cache never reads another tile. The chain stops at the first level that fits a single tile.
+// Like the other caches, a page file is only used while the size and modification time of the source match the ones it was written for.
+class VirtualTexturePageFile
+{
+public:
+    static constexpr int TilePayloadSize = virtualTextureTileSize - 2 * virtualTextureTileBorder;
+    static constexpr std::size_t TileByteSize = static_cast<std::size_t>(virtualTextureTileSize) * virtualTextureTileSize * 4;
+
+    VirtualTexturePageFile();
+
+    static std::string GetPageFilePath(const std::string& aSourceFilepath);
+    [[nodiscard]] static int GetLevelCount(int aWidth, int aHeight);
+    [[nodiscard]] static int GetTileCount(int aSize, int aLevel);
+
+    // Bytes Write allocates on top of the decoded pixels, which peaks while the RGBA copy of the first level is downsampled
+    [[nodiscard]] static std::size_t GetWriteWorkingSize(int aWidth, int aHeight);
+    // Cooks the page file from decoded pixels with one to four channels, safe to call from any thread
+    static bool Write(const std::string& aSourceFilepath, const unsigned char* somePixels, int aWidth, int aHeight, int aChannelCount);
+
+    [[nodiscard]] bool Open(const std::string& aSourceFilepath);
+    void Close();
+
+    [[nodiscard]] bool IsOpen() const { return myFile.GetData() != nullptr; }
+    [[nodiscard]] int GetWidth() const { return myWidth; }
+    [[nodiscard]] int GetHeight() const { return myHeight; }
+    [[nodiscard]] int GetLevelCount() const { return static_cast<int>(myLevelFirstTiles.size()); }
+    [[nodiscard]] int GetTileCountX(int aLevel) const { return GetTileCount(myWidth, aLevel); }
+    [[nodiscard]] int GetTileCountY(int aLevel) const { return GetTileCount(myHeight, aLevel); }
+    // TileByteSize bytes of RGBA8 texels, row by row
+    [[nodiscard]] const unsigned char* GetTile(int aLevel, int aX, int aY) const;
+
+private:
+    MemoryMappedFile myFile;
+    // Index of the first tile of every level, tiles are stored level by level and row by row inside a level
+    std::vector<std::size_t> myLevelFirstTiles;
+    int myWidth;
+    int myHeight;
+};
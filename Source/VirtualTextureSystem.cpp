@@ -0,0 +1,308 @@
+#include "VirtualTextureSystem.h"
+
+#include "AppDefinitions.h"
+#include "LogUtility.h"
+#include "Profiler.h"
+#include "UploadRing.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    static_assert(virtualTexturePhysicalTileCount <= 256, "Page table entries store the slot coordinates in 8 bits");
+
+    int GetNextPowerOfTwo(int aValue)
+    {
+        int powerOfTwo = 1;
+        while (powerOfTwo < aValue)
+            powerOfTwo *= 2;
+
+        return powerOfTwo;
+    }
+
+    // Page table levels are sized like a mip chain over a power of two, which covers the tiles of every level of the page file
+    // even where rounding the levels of the texture up to whole tiles leaves one more tile than half the level above
+    int GetPageTableLevelCount(int aTileCountX, int aTileCountY)
+    {
+        return static_cast<int>(std::log2(std::max(GetNextPowerOfTwo(aTileCountX), GetNextPowerOfTwo(aTileCountY)))) + 1;
+    }
+}
+
+VirtualTextureSystem::VirtualTextureSystem(UploadRing& anUploadRing)
+    : myCache(virtualTexturePhysicalTileCount)
+    , myUploadRing(anUploadRing)
+    , myPhysicalTexture(0)
+{
+}
+
+void VirtualTextureSystem::Initialize()
+{
+    const int physicalSize = virtualTexturePhysicalTileCount * virtualTextureTileSize;
+    glGenTextures(1, &myPhysicalTexture);
+    glBindTexture(GL_TEXTURE_2D, myPhysicalTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, physicalSize, physicalSize);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    myShader.Load("Data/Shaders/TexturedCube.vert.glsl", "Data/Shaders/VirtualTexture.frag.glsl");
+    myUniforms.myTextureSize = myShader.GetUniform<glm::vec2>("uVirtualTextureSize");
+    myUniforms.myLevelCount = myShader.GetUniform<int>("uVirtualTextureLevelCount");
+    myUniforms.myPhysicalTileCount = myShader.GetUniform<float>("uPhysicalTileCount");
+
+    myFeedbackShader.Load("Data/Shaders/TexturedCube.vert.glsl", "Data/Shaders/VirtualTextureFeedback.frag.glsl");
+    myFeedbackUniforms.myTextureSize = myFeedbackShader.GetUniform<glm::vec2>("uVirtualTextureSize");
+    myFeedbackUniforms.myLevelCount = myFeedbackShader.GetUniform<int>("uVirtualTextureLevelCount");
+    myFeedbackUniforms.myTextureIndex = myFeedbackShader.GetUniform<int>("uVirtualTextureIndex");
+    myFeedbackUniforms.myLevelBias = myFeedbackShader.GetUniform<float>("uLevelBias");
+
+    LogUtility::PrintMessage(LogUtility::LogCategory::Graphics, "Virtual texturing with %i by %i tiles of %i texels, %.2f MB of physical texture",
+        virtualTexturePhysicalTileCount, virtualTexturePhysicalTileCount, virtualTextureTileSize, static_cast<double>(GetMemoryBytes()) / (1024.0 * 1024.0));
+}
+
+void VirtualTextureSystem::Destroy()
+{
+    for (std::unique_ptr<VirtualTexture>& texture : myTextures)
+    {
+        if (!texture)
+            continue;
+
+        myCache.RemoveTexture(texture->myIndex);
+        glDeleteTextures(1, &texture->myPageTable);
+    }
+
+    myTextures.clear();
+    glDeleteTextures(1, &myPhysicalTexture);
+    glDeleteProgram(myShader.myIdentifier);
+    glDeleteProgram(myFeedbackShader.myIdentifier);
+    myPhysicalTexture = 0;
+}
+
+bool VirtualTextureSystem::IsVirtualSize(int aWidth, int aHeight)
+{
+    if (std::max(aWidth, aHeight) < virtualTextureMinimumSize)
+        return false;
+
+    // Larger textures do not fit the packed tiles the feedback pass writes, they are loaded whole like before
+    return VirtualTexturePageFile::GetTileCount(aWidth, 0) <= VirtualTextureTile::MaxTileCount && VirtualTexturePageFile::GetTileCount(aHeight, 0) <= VirtualTextureTile::MaxTileCount
+        && VirtualTexturePageFile::GetLevelCount(aWidth, aHeight) <= VirtualTextureTile::MaxLevelCount;
+}
+
+unsigned int VirtualTextureSystem::AddTexture(const std::string& aSourceFilepath)
+{
+    PROFILE_FUNCTION();
+
+    const std::vector<std::unique_ptr<VirtualTexture>>::iterator freeEntry = std::find(myTextures.begin(), myTextures.end(), nullptr);
+    const int index = static_cast<int>(freeEntry - myTextures.begin());
+    if (index >= VirtualTextureTile::MaxTextureCount)
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::Graphics, "Failed to add virtual texture %s, all %i virtual textures are in use", aSourceFilepath.c_str(), VirtualTextureTile::MaxTextureCount);
+        return 0;
+    }
+
+    std::unique_ptr<VirtualTexture> texture = std::make_unique<VirtualTexture>();
+    texture->myIndex = index;
+    if (!texture->myPageFile.Open(aSourceFilepath) || !IsVirtualSize(texture->myPageFile.GetWidth(), texture->myPageFile.GetHeight()))
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::Graphics, "Failed to open the virtual texture page file of %s", aSourceFilepath.c_str());
+        return 0;
+    }
+
+    const VirtualTexturePageFile& pageFile = texture->myPageFile;
+    for (int level = 0; level < pageFile.GetLevelCount(); ++level)
+        texture->myTileCounts.emplace_back(pageFile.GetTileCountX(level), pageFile.GetTileCountY(level));
+
+    // The coarsest level is a single tile that stays resident, so every lookup of the page table resolves to something
+    VirtualTextureCache::TileLoad coarsestLoad;
+    if (!myCache.Pin(VirtualTextureTile::Pack(index, pageFile.GetLevelCount() - 1, 0, 0), coarsestLoad))
+    {
+        LogUtility::PrintError(LogUtility::LogCategory::Graphics, "Failed to add virtual texture %s, the physical texture is full", aSourceFilepath.c_str());
+        return 0;
+    }
+
+    const int pageTableWidth = GetNextPowerOfTwo(texture->myTileCounts[0].first);
+    const int pageTableHeight = GetNextPowerOfTwo(texture->myTileCounts[0].second);
+    const int pageTableLevelCount = GetPageTableLevelCount(pageTableWidth, pageTableHeight);
+    for (int level = 0; level < pageTableLevelCount; ++level)
+        texture->myPageTableBytes += static_cast<std::size_t>(std::max(pageTableWidth >> level, 1)) * std::max(pageTableHeight >> level, 1) * 4;
+
+    // Integer textures are only complete with nearest filtering, even though they are only ever read with texelFetch
+    glGenTextures(1, &texture->myPageTable);
+    glBindTexture(GL_TEXTURE_2D, texture->myPageTable);
+    glTexStorage2D(GL_TEXTURE_2D, pageTableLevelCount, GL_RGBA8UI, pageTableWidth, pageTableHeight);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    UploadTile(*texture, coarsestLoad);
+    UploadPageTable(*texture);
+    if (VirtualTexture* evictedTexture = GetTexture(coarsestLoad.myEvictedTile))
+        UploadPageTable(*evictedTexture);
+
+    LogUtility::PrintMessage(LogUtility::LogCategory::Graphics, "Added virtual texture %s with identifier %u, width %i, height %i and %i levels", aSourceFilepath.c_str(),
+        texture->myPageTable, pageFile.GetWidth(), pageFile.GetHeight(), pageFile.GetLevelCount());
+
+    const unsigned int identifier = texture->myPageTable;
+    if (freeEntry == myTextures.end())
+        myTextures.push_back(std::move(texture));
+    else
+        *freeEntry = std::move(texture);
+
+    return identifier;
+}
+
+bool VirtualTextureSystem::RemoveTexture(unsigned int anIdentifier)
+{
+    for (std::unique_ptr<VirtualTexture>& texture : myTextures)
+    {
+        if (!texture || texture->myPageTable != anIdentifier)
+            continue;
+
+        myCache.RemoveTexture(texture->myIndex);
+        glDeleteTextures(1, &texture->myPageTable);
+        texture.reset();
+        return true;
+    }
+
+    return false;
+}
+
+const VirtualTexture* VirtualTextureSystem::FindTexture(unsigned int anIdentifier) const
+{
+    for (const std::unique_ptr<VirtualTexture>& texture : myTextures)
+    {
+        if (texture && texture->myPageTable == anIdentifier)
+            return texture.get();
+    }
+
+    return nullptr;
+}
+
+std::size_t VirtualTextureSystem::Update(const std::vector<uint32_t>& someRequestedTiles)
+{
+    PROFILE_FUNCTION();
+
+    // Requests of a removed texture, or of one that took over its index, may still arrive from feedback read back late
+    myRequestedTiles.clear();
+    for (const uint32_t requestedTile : someRequestedTiles)
+    {
+        const VirtualTexture* texture = GetTexture(requestedTile);
+        int level = VirtualTextureTile::GetLevel(requestedTile);
+        int x = VirtualTextureTile::GetX(requestedTile);
+        int y = VirtualTextureTile::GetY(requestedTile);
+        if (!texture || level >= static_cast<int>(texture->myTileCounts.size()) || x >= texture->myTileCounts[level].first || y >= texture->myTileCounts[level].second)
+            continue;
+
+        for (; level + 1 < static_cast<int>(texture->myTileCounts.size()); ++level, x /= 2, y /= 2)
+            myRequestedTiles.push_back(VirtualTextureTile::Pack(texture->myIndex, level, x, y));
+    }
+
+    myTileLoads.clear();
+    myCache.Update(myRequestedTiles, virtualTextureTilesPerFrame, myTileLoads);
+
+    for (const VirtualTextureCache::TileLoad& tileLoad : myTileLoads)
+    {
+        VirtualTexture* texture = GetTexture(tileLoad.myTile);
+        UploadTile(*texture, tileLoad);
+        texture->myIsPageTableDirty = true;
+
+        if (VirtualTexture* evictedTexture = GetTexture(tileLoad.myEvictedTile))
+            evictedTexture->myIsPageTableDirty = true;
+    }
+
+    for (std::unique_ptr<VirtualTexture>& texture : myTextures)
+    {
+        if (texture && texture->myIsPageTableDirty)
+            UploadPageTable(*texture);
+    }
+
+    return myTileLoads.size();
+}
+
+void VirtualTextureSystem::BeginDraw(bool anIsFeedback) const
+{
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, myPhysicalTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    if (anIsFeedback)
+    {
+        // The feedback target is smaller than the screen, which makes every derivative larger by its scale
+        myFeedbackShader.Use();
+        myFeedbackShader.Set(myFeedbackUniforms.myLevelBias, -std::log2(static_cast<float>(virtualTextureFeedbackScale)));
+    }
+    else
+    {
+        myShader.Use();
+        myShader.Set(myUniforms.myPhysicalTileCount, static_cast<float>(virtualTexturePhysicalTileCount));
+    }
+}
+
+void VirtualTextureSystem::SetTexture(const VirtualTexture& aTexture, bool anIsFeedback) const
+{
+    const Shader& shader = anIsFeedback ? myFeedbackShader : myShader;
+    const DrawUniforms& uniforms = anIsFeedback ? myFeedbackUniforms : myUniforms;
+    shader.Set(uniforms.myTextureSize, glm::vec2(static_cast<float>(aTexture.myPageFile.GetWidth()), static_cast<float>(aTexture.myPageFile.GetHeight())));
+    shader.Set(uniforms.myLevelCount, aTexture.myPageFile.GetLevelCount());
+    shader.Set(uniforms.myTextureIndex, aTexture.myIndex);
+}
+
+std::size_t VirtualTextureSystem::GetTextureCount() const
+{
+    return static_cast<std::size_t>(std::count_if(myTextures.begin(), myTextures.end(), [](const std::unique_ptr<VirtualTexture>& aTexture) { return aTexture != nullptr; }));
+}
+
+std::size_t VirtualTextureSystem::GetMemoryBytes() const
+{
+    std::size_t memoryBytes = myCache.GetSlotCount() * VirtualTexturePageFile::TileByteSize;
+    for (const std::unique_ptr<VirtualTexture>& texture : myTextures)
+    {
+        if (texture)
+            memoryBytes += texture->myPageTableBytes;
+    }
+
+    return memoryBytes;
+}
+
+VirtualTexture* VirtualTextureSystem::GetTexture(uint32_t aTile) const
+{
+    const int index = VirtualTextureTile::GetTexture(aTile);
+    return aTile != 0 && index < static_cast<int>(myTextures.size()) ? myTextures[index].get() : nullptr;
+}
+
+void VirtualTextureSystem::UploadTile(const VirtualTexture& aTexture, const VirtualTextureCache::TileLoad& aLoad)
+{
+    const int slotsPerSide = myCache.GetSlotsPerSide();
+    const unsigned char* tileData = aTexture.myPageFile.GetTile(VirtualTextureTile::GetLevel(aLoad.myTile), VirtualTextureTile::GetX(aLoad.myTile), VirtualTextureTile::GetY(aLoad.myTile));
+
+    glBindTexture(GL_TEXTURE_2D, myPhysicalTexture);
+    tileData = myUploadRing.StagePixels(tileData, VirtualTexturePageFile::TileByteSize);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, aLoad.mySlot % slotsPerSide * virtualTextureTileSize, aLoad.mySlot / slotsPerSide * virtualTextureTileSize,
+        virtualTextureTileSize, virtualTextureTileSize, GL_RGBA, GL_UNSIGNED_BYTE, tileData);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void VirtualTextureSystem::UploadPageTable(VirtualTexture& aTexture)
+{
+    myCache.BuildPageTable(aTexture.myIndex, aTexture.myTileCounts, aTexture.myPageTableData);
+
+    glBindTexture(GL_TEXTURE_2D, aTexture.myPageTable);
+    const unsigned char* pageTableData = myUploadRing.StagePixels(aTexture.myPageTableData.data(), aTexture.myPageTableData.size());
+    std::size_t levelOffset = 0;
+    for (std::size_t level = 0; level < aTexture.myTileCounts.size(); ++level)
+    {
+        const std::pair<int, int>& tileCount = aTexture.myTileCounts[level];
+        glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0, tileCount.first, tileCount.second, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, pageTableData + levelOffset);
+        levelOffset += static_cast<std::size_t>(tileCount.first) * tileCount.second * 4;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    aTexture.myIsPageTableDirty = false;
+}
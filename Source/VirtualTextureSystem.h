@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Shader.h"
+#include "VirtualTextureCache.h"
+#include "VirtualTexturePageFile.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class UploadRing;
+
+// A texture streamed by the VirtualTextureSystem, drawn with its page table bound in place of a regular texture
+struct VirtualTexture
+{
+    VirtualTexturePageFile myPageFile;
+    // Tiles in x and y for every level of the page file
+    std::vector<std::pair<int, int>> myTileCounts;
+    std::vector<unsigned char> myPageTableData;
+    std::size_t myPageTableBytes = 0;
+    unsigned int myPageTable = 0;
+    int myIndex = 0;
+    bool myIsPageTableDirty = false;
+};
+
+// Virtual texturing on top of TextureLoader. Textures at least virtualTextureMinimumSize wide or tall are cooked into a
+// VirtualTexturePageFile instead of being uploaded whole, and only the tiles the feedback pass asked for are copied into one
+// physical texture shared by all of them. Their video memory is that texture plus a small page table per texture, whatever
+// the size of the sources. Tiles are assigned to the physical texture by a VirtualTextureCache and staged through the UploadRing.
+class VirtualTextureSystem
+{
+public:
+    explicit VirtualTextureSystem(UploadRing& anUploadRing);
+
+    void Initialize();
+    void Destroy();
+
+    // Safe to call from any thread
+    [[nodiscard]] static bool IsVirtualSize(int aWidth, int aHeight);
+
+    // Opens the page file of a cooked texture and makes its coarsest tile resident for good. Returns the page table texture, which
+    // identifies the virtual texture from then on, or 0 when the page file cannot be opened or the physical texture has no room left.
+    [[nodiscard]] unsigned int AddTexture(const std::string& aSourceFilepath);
+    // Returns false when anIdentifier is not a virtual texture
+    bool RemoveTexture(unsigned int anIdentifier);
+    // Returns nullptr for regular textures
+    [[nodiscard]] const VirtualTexture* FindTexture(unsigned int anIdentifier) const;
+
+    // Loads at most virtualTextureTilesPerFrame of the tiles read back from the feedback pass and of their ancestors, which the
+    // finer tiles fall back to until they arrive, then updates the page tables that changed. Returns the number of tiles loaded.
+    std::size_t Update(const std::vector<uint32_t>& someRequestedTiles);
+
+    // Uses the program of the color or of the feedback pass and binds the physical texture, SetTexture then selects the texture to draw
+    void BeginDraw(bool anIsFeedback) const;
+    void SetTexture(const VirtualTexture& aTexture, bool anIsFeedback) const;
+
+    [[nodiscard]] std::size_t GetTextureCount() const;
+    // The physical texture and every page table
+    [[nodiscard]] std::size_t GetMemoryBytes() const;
+    [[nodiscard]] const VirtualTextureCache& GetCache() const { return myCache; }
+
+private:
+    struct DrawUniforms
+    {
+        UniformHandle<glm::vec2> myTextureSize;
+        UniformHandle<int> myLevelCount;
+        UniformHandle<int> myTextureIndex;
+        UniformHandle<float> myPhysicalTileCount;
+        UniformHandle<float> myLevelBias;
+    };
+
+    [[nodiscard]] VirtualTexture* GetTexture(uint32_t aTile) const;
+    void UploadTile(const VirtualTexture& aTexture, const VirtualTextureCache::TileLoad& aLoad);
+    void UploadPageTable(VirtualTexture& aTexture);
+
+    // Indexed by the texture index of the tiles, removed textures leave an empty entry for the next one
+    std::vector<std::unique_ptr<VirtualTexture>> myTextures;
+    std::vector<uint32_t> myRequestedTiles;
+    std::vector<VirtualTextureCache::TileLoad> myTileLoads;
+    VirtualTextureCache myCache;
+    Shader myShader;
+    Shader myFeedbackShader;
+    DrawUniforms myUniforms;
+    DrawUniforms myFeedbackUniforms;
+    UploadRing& myUploadRing;
+    unsigned int myPhysicalTexture;
+};